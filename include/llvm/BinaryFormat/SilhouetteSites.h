@@ -0,0 +1,52 @@
+//===- llvm/BinaryFormat/SilhouetteSites.h - Silhouette sites -*- C++ -*-===//
+//
+// Part of the LLVM and Silhouette Projects, under the Apache License v2.0
+// with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the layout of the .silhouette_sites section, which lists
+// every code sequence inserted by the Silhouette passes.
+//
+// The section is a sequence of per-function tables.  Each table starts with a
+// header followed by one entry per instrumentation site, in address order:
+//
+//   Header: uint32 FunctionAddress, uint32 NumSites
+//   Entry:  uint32 SiteAddress, uint16 Length, uint8 Kind, uint8 Reserved
+//
+// All fields use the byte order of the object file.  FunctionAddress is the
+// address of the function symbol (bit 0 is set for Thumb functions);
+// SiteAddress is the address of the first instruction of the site.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_BINARYFORMAT_SILHOUETTESITES_H
+#define LLVM_BINARYFORMAT_SILHOUETTESITES_H
+
+#include <cstdint>
+
+namespace llvm {
+namespace silhouette {
+
+/// Name of the section holding the instrumentation site tables.
+static const char SiteTableSectionName[] = ".silhouette_sites";
+
+/// Sizes in bytes of a table header and of a site entry.
+enum : unsigned { SiteTableHeaderSize = 8, SiteEntrySize = 8 };
+
+/// The kind of code sequence found at an instrumentation site.
+enum SiteKind : uint8_t {
+  SK_ShadowStackPush = 1, ///< Saves the return address on the shadow stack.
+  SK_ShadowStackPop = 2,  ///< Reloads the return address from the shadow stack.
+  SK_SFI = 3,             ///< Bit-masks the address of a store.
+  SK_STRT = 4,            ///< A store rewritten into unprivileged stores.
+  SK_CFILabel = 5,        ///< A CFI label at a call or jump target.
+  SK_CFICheck = 6,        ///< A CFI check before an indirect branch or call.
+};
+
+} // end namespace silhouette
+} // end namespace llvm
+
+#endif // LLVM_BINARYFORMAT_SILHOUETTESITES_H
@@ -168,6 +168,44 @@ public:
     return tryFoldImplicitDef(MI, DeadInsts);
   }
 
+  /// Fold a truncation of a merge into its low source, e.g.
+  ///   %2:_(s64) = G_MERGE_VALUES %0:_(s32), %1:_(s32)
+  ///   %3:_(s16) = G_TRUNC %2:_(s64)
+  /// to
+  ///   %3:_(s16) = G_TRUNC %0:_(s32)
+  /// so that merges of types the target cannot handle go away even when
+  /// nothing unmerges them.
+  bool tryCombineTrunc(MachineInstr &MI,
+                       SmallVectorImpl<MachineInstr *> &DeadInsts) {
+    assert(MI.getOpcode() == TargetOpcode::G_TRUNC);
+
+    Builder.setInstr(MI);
+    Register DstReg = MI.getOperand(0).getReg();
+    Register SrcReg = lookThroughCopyInstrs(MI.getOperand(1).getReg());
+    MachineInstr *MergeI = MRI.getVRegDef(SrcReg);
+    if (!MergeI || MergeI->getOpcode() != TargetOpcode::G_MERGE_VALUES)
+      return false;
+
+    Register MergeSrcReg = MergeI->getOperand(1).getReg();
+    const LLT DstTy = MRI.getType(DstReg);
+    const LLT MergeSrcTy = MRI.getType(MergeSrcReg);
+    if (!DstTy.isScalar() || !MergeSrcTy.isScalar() ||
+        DstTy.getSizeInBits() > MergeSrcTy.getSizeInBits())
+      return false;
+
+    if (DstTy == MergeSrcTy) {
+      LLVM_DEBUG(dbgs() << ".. Combine MI: " << MI;);
+      Builder.buildCopy(DstReg, MergeSrcReg);
+    } else {
+      if (isInstUnsupported({TargetOpcode::G_TRUNC, {DstTy, MergeSrcTy}}))
+        return false;
+      LLVM_DEBUG(dbgs() << ".. Combine MI: " << MI;);
+      Builder.buildTrunc(DstReg, MergeSrcReg);
+    }
+    markInstAndDefDead(MI, *MergeI, DeadInsts);
+    return true;
+  }
+
   /// Try to fold G_[ASZ]EXT (G_IMPLICIT_DEF).
   bool tryFoldImplicitDef(MachineInstr &MI,
                           SmallVectorImpl<MachineInstr *> &DeadInsts) {
@@ -240,8 +278,11 @@ public:
     // FIXME: Handle scalarizing concat_vectors (scalar result type with vector
     // source)
     unsigned MergingOpcode = getMergeOpcode(OpTy, DestTy);
-    if (!MergeI || MergeI->getOpcode() != MergingOpcode)
+    if (!MergeI || MergeI->getOpcode() != MergingOpcode) {
+      if (ConvertOp && ConvertOp != TargetOpcode::G_TRUNC)
+        return tryCombineUnmergeExt(MI, *SrcDef, DeadInsts);
       return false;
+    }
 
     const unsigned NumMergeRegs = MergeI->getNumOperands() - 1;
 
@@ -317,6 +358,58 @@ public:
     return true;
   }
 
+  /// Split an extension into the two halves an unmerge takes from it, e.g.
+  ///   %1:_(s64) = G_SEXT %0:_(s32)
+  ///   %2:_(s32), %3:_(s32) = G_UNMERGE_VALUES %1:_(s64)
+  /// to
+  ///   %2:_(s32) = COPY %0:_(s32)
+  ///   %3:_(s32) = G_ASHR %0:_(s32), 31
+  bool tryCombineUnmergeExt(MachineInstr &MI, MachineInstr &ExtMI,
+                            SmallVectorImpl<MachineInstr *> &DeadInsts) {
+    unsigned ExtOp = ExtMI.getOpcode();
+    Register SrcReg = ExtMI.getOperand(1).getReg();
+    const LLT SrcTy = MRI.getType(SrcReg);
+    const LLT DestTy = MRI.getType(MI.getOperand(0).getReg());
+    if (MI.getNumOperands() != 3 || !SrcTy.isScalar() || !DestTy.isScalar() ||
+        SrcTy.getSizeInBits() > DestTy.getSizeInBits())
+      return false;
+    if (SrcTy != DestTy && isInstUnsupported({ExtOp, {DestTy, SrcTy}}))
+      return false;
+    if (ExtOp != TargetOpcode::G_ANYEXT &&
+        isInstUnsupported({TargetOpcode::G_CONSTANT, {DestTy}}))
+      return false;
+    if (ExtOp == TargetOpcode::G_SEXT &&
+        isInstUnsupported({TargetOpcode::G_ASHR, {DestTy, DestTy}}))
+      return false;
+
+    LLVM_DEBUG(dbgs() << ".. Combine MI: " << MI;);
+    Builder.setInstr(MI);
+    // The unmerge still defines its results, so compute the low half into a
+    // register of its own for the high half to be built from.
+    Register Lo = SrcReg;
+    if (SrcTy != DestTy)
+      Lo = Builder.buildInstr(ExtOp, {DestTy}, {SrcReg}).getReg(0);
+    Builder.buildCopy(MI.getOperand(0).getReg(), Lo);
+
+    Register HiReg = MI.getOperand(1).getReg();
+    switch (ExtOp) {
+    case TargetOpcode::G_SEXT:
+      Builder.buildAShr(
+          HiReg, Lo, Builder.buildConstant(DestTy, DestTy.getSizeInBits() - 1));
+      break;
+    case TargetOpcode::G_ZEXT:
+      Builder.buildConstant(HiReg, 0);
+      break;
+    default:
+      // The high half of a G_ANYEXT is undefined, so anything will do.
+      Builder.buildCopy(HiReg, Lo);
+      break;
+    }
+
+    markInstAndDefDead(MI, ExtMI, DeadInsts);
+    return true;
+  }
+
   static bool isMergeLikeOpcode(unsigned Opc) {
     switch (Opc) {
     case TargetOpcode::G_MERGE_VALUES:
@@ -402,6 +495,8 @@ public:
     case TargetOpcode::G_EXTRACT:
       return tryCombineExtract(MI, DeadInsts);
     case TargetOpcode::G_TRUNC: {
+      if (tryCombineTrunc(MI, DeadInsts))
+        return true;
       bool Changed = false;
       for (auto &Use : MRI.use_instructions(MI.getOperand(0).getReg()))
         Changed |= tryCombineInstruction(Use, DeadInsts, WrapperObserver);
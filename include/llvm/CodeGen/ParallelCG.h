@@ -34,13 +34,19 @@ class raw_pwrite_stream;
 /// Writes bitcode for individual partitions into output streams in BCOSs, if
 /// BCOSs is not empty.
 ///
+/// AddPasses, if set, is called with the code generation pass manager of each
+/// partition before the code generation passes are added, e.g. to add a
+/// TargetLibraryInfo for the target.
+///
 /// \returns M if OSs.size() == 1, otherwise returns std::unique_ptr<Module>().
 std::unique_ptr<Module>
 splitCodeGen(std::unique_ptr<Module> M, ArrayRef<raw_pwrite_stream *> OSs,
              ArrayRef<llvm::raw_pwrite_stream *> BCOSs,
              const std::function<std::unique_ptr<TargetMachine>()> &TMFactory,
              TargetMachine::CodeGenFileType FileType = TargetMachine::CGFT_ObjectFile,
-             bool PreserveLocals = false);
+             bool PreserveLocals = false,
+             const std::function<void(legacy::PassManagerBase &)> &AddPasses =
+                 nullptr);
 
 } // namespace llvm
 
@@ -14,6 +14,7 @@
 #ifndef LLVM_DEBUGINFO_DICONTEXT_H
 #define LLVM_DEBUGINFO_DICONTEXT_H
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Object/ObjectFile.h"
 #include "llvm/Support/raw_ostream.h"
@@ -23,6 +24,7 @@
 #include <string>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 namespace llvm {
 
@@ -177,6 +179,8 @@ struct DIDumpOptions {
   bool SummarizeTypes = false;
   bool Verbose = false;
   bool DisplayRawContents = false;
+  /// Threads used when verifying; 0 means one per hardware thread.
+  unsigned VerifyThreads = 1;
 
   /// Return default option set for printing a single DIE without children.
   static DIDumpOptions getForSingleDIE() {
@@ -226,6 +230,18 @@ public:
       object::SectionedAddress Address,
       DILineInfoSpecifier Specifier = DILineInfoSpecifier()) = 0;
 
+  /// Returns getInliningInfoForAddress for each of the addresses, which
+  /// should be sorted so that implementations can walk their tables once.
+  virtual std::vector<DIInliningInfo> getInliningInfoForAddresses(
+      ArrayRef<object::SectionedAddress> Addresses,
+      DILineInfoSpecifier Specifier = DILineInfoSpecifier()) {
+    std::vector<DIInliningInfo> Result;
+    Result.reserve(Addresses.size());
+    for (object::SectionedAddress Address : Addresses)
+      Result.push_back(getInliningInfoForAddress(Address, Specifier));
+    return Result;
+  }
+
   virtual std::vector<DILocal>
   getLocalsForAddress(object::SectionedAddress Address) = 0;
 
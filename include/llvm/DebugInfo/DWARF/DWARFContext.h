@@ -330,6 +330,9 @@ public:
   DIInliningInfo getInliningInfoForAddress(
       object::SectionedAddress Address,
       DILineInfoSpecifier Specifier = DILineInfoSpecifier()) override;
+  std::vector<DIInliningInfo> getInliningInfoForAddresses(
+      ArrayRef<object::SectionedAddress> Addresses,
+      DILineInfoSpecifier Specifier = DILineInfoSpecifier()) override;
 
   std::vector<DILocal>
   getLocalsForAddress(object::SectionedAddress Address) override;
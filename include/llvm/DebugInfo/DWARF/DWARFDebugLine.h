@@ -292,7 +292,45 @@ public:
     RowVector Rows;
     SequenceVector Sequences;
 
+    /// Looks up a series of addresses in a table. As long as the addresses
+    /// do not decrease, it only moves forward through the sequences and their
+    /// rows instead of searching the whole table for every address.
+    class Cursor {
+    public:
+      explicit Cursor(const LineTable &LT);
+
+      /// Returns the same row index as LineTable::lookupAddress.
+      uint32_t lookupAddress(object::SectionedAddress Address);
+
+      /// Same as LineTable::getFileLineInfoForAddress.
+      bool getFileLineInfoForAddress(object::SectionedAddress Address,
+                                     const char *CompDir,
+                                     DILineInfoSpecifier::FileLineInfoKind Kind,
+                                     DILineInfo &Result);
+
+    private:
+      struct Position {
+        /// The last address looked up from this position.
+        object::SectionedAddress Last;
+        /// The first sequence ending after Last.
+        SequenceIter Seq;
+        /// The first row of Seq starting after Last.
+        RowIter Row;
+      };
+
+      void reset(Position &Pos, SequenceIter Seq);
+      uint32_t lookupAddressImpl(Position &Pos,
+                                 object::SectionedAddress Address);
+
+      const LineTable &LT;
+      /// Relocatable and absolute addresses are looked up separately.
+      Position Relocatable, Absolute;
+    };
+
   private:
+    bool getFileLineInfoForRow(uint32_t RowIndex, const char *CompDir,
+                               DILineInfoSpecifier::FileLineInfoKind Kind,
+                               DILineInfo &Result) const;
     uint32_t findRowInSeq(const DWARFDebugLine::Sequence &Seq,
                           object::SectionedAddress Address) const;
     Optional<StringRef>
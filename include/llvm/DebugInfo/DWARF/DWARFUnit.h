@@ -434,6 +434,32 @@ public:
   void getInlinedChainForAddress(uint64_t Address,
                                  SmallVectorImpl<DWARFDie> &InlinedChain);
 
+  /// getInlinedChainForSubroutine - fetches inlined chain ending at a DIE
+  /// returned by getSubroutineForAddress.
+  static void
+  getInlinedChainForSubroutine(DWARFDie SubroutineDIE,
+                               SmallVectorImpl<DWARFDie> &InlinedChain);
+
+  /// Looks up the subroutines containing a series of addresses, using the
+  /// DWO file if there is one. As long as the addresses do not decrease, it
+  /// moves forward through the address ranges of the subroutines instead of
+  /// searching them afresh for every address.
+  class SubroutineCursor {
+  public:
+    explicit SubroutineCursor(DWARFUnit &U);
+
+    /// Returns the same DIE as getSubroutineForAddress.
+    DWARFDie getSubroutineForAddress(uint64_t Address);
+
+  private:
+    using AddrDieMapTy = std::map<uint64_t, std::pair<uint64_t, DWARFDie>>;
+
+    const AddrDieMapTy *Map;
+    /// The first range starting after the last address looked up.
+    AddrDieMapTy::const_iterator Next;
+    uint64_t LastAddress = 0;
+  };
+
   /// Return the DWARFUnitVector containing this unit.
   const DWARFUnitVector &getUnitVector() const { return UnitVector; }
 
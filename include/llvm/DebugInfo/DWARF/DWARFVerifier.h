@@ -9,9 +9,11 @@
 #ifndef LLVM_DEBUGINFO_DWARF_DWARFVERIFIER_H
 #define LLVM_DEBUGINFO_DWARF_DWARFVERIFIER_H
 
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/DebugInfo/DIContext.h"
 #include "llvm/DebugInfo/DWARF/DWARFAcceleratorTable.h"
 #include "llvm/DebugInfo/DWARF/DWARFAddressRange.h"
+#include "llvm/DebugInfo/DWARF/DWARFDebugLine.h"
 #include "llvm/DebugInfo/DWARF/DWARFDie.h"
 #include "llvm/DebugInfo/DWARF/DWARFUnitIndex.h"
 
@@ -99,12 +101,29 @@ private:
   // Used to relax some checks that do not currently work portably
   bool IsObjectFile;
   bool IsMachOObject;
+  /// The number of threads used to verify units, line tables and name index
+  /// completeness.
+  unsigned NumThreads;
 
   raw_ostream &error() const;
   raw_ostream &warn() const;
   raw_ostream &note() const;
   raw_ostream &dump(const DWARFDie &Die, unsigned indent = 0) const;
 
+  /// Runs \p Verify on each of \p NumItems independent work items.
+  ///
+  /// With more than one thread, each item is verified on a thread pool by a
+  /// verifier of its own that buffers the messages.  The buffers are written
+  /// to OS in item order and the references collected by each item are
+  /// merged into ReferenceToDIEOffsets, so the output does not depend on the
+  /// number of threads.  Everything the items share in DCtx must have been
+  /// parsed beforehand.
+  ///
+  /// \returns The sum of the error counts returned by \p Verify.
+  unsigned
+  verifyInParallel(size_t NumItems,
+                   function_ref<unsigned(DWARFVerifier &, size_t)> Verify);
+
   /// Verifies the abbreviations section.
   ///
   /// This function currently checks that:
@@ -233,6 +252,12 @@ private:
   /// - invalid file indexes
   void verifyDebugLineRows();
 
+  /// Verify the prologue and rows of the line table of a single unit.
+  ///
+  /// \returns The number of errors that occurred during verification.
+  unsigned verifyDebugLineRows(DWARFUnit &CU, const DWARFDie &Die,
+                               const DWARFDebugLine::LineTable &LineTable);
+
   /// Verify that an Apple-style accelerator table is valid.
   ///
   /// This function currently checks that:
@@ -30,6 +30,10 @@ public:
   virtual DIInliningInfo
   symbolizeInlinedCode(object::SectionedAddress ModuleOffset,
                        FunctionNameKind FNKind, bool UseSymbolTable) const = 0;
+  // Symbolizes several offsets at once, which is cheaper when they are sorted.
+  virtual std::vector<DIInliningInfo>
+  symbolizeInlinedCode(ArrayRef<object::SectionedAddress> ModuleOffsets,
+                       FunctionNameKind FNKind, bool UseSymbolTable) const = 0;
   virtual DIGlobal
   symbolizeData(object::SectionedAddress ModuleOffset) const = 0;
   virtual std::vector<DILocal>
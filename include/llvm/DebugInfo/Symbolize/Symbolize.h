@@ -59,6 +59,11 @@ public:
   Expected<DIInliningInfo>
   symbolizeInlinedCode(const std::string &ModuleName,
                        object::SectionedAddress ModuleOffset);
+  /// Symbolizes several offsets in the same module at once. Sorted offsets
+  /// let the debug info be walked once rather than searched for each offset.
+  Expected<std::vector<DIInliningInfo>>
+  symbolizeInlinedCode(const std::string &ModuleName,
+                       ArrayRef<object::SectionedAddress> ModuleOffsets);
   Expected<DIGlobal> symbolizeData(const std::string &ModuleName,
                                    object::SectionedAddress ModuleOffset);
   Expected<std::vector<DILocal>>
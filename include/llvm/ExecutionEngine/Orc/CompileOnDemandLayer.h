@@ -43,6 +43,7 @@
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/Utils/ValueMapper.h"
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <functional>
 #include <iterator>
@@ -91,6 +92,18 @@ public:
   /// Sets the partition function.
   void setPartitionFunction(PartitionFunction Partition);
 
+  /// Enables speculative compilation. Whenever a partition is emitted, the
+  /// functions that it calls directly and that have not been emitted yet are
+  /// requested in the background, so that they are likely to be compiled
+  /// before their first call. At most MaxInFlight speculative requests are
+  /// outstanding at any time; zero (the default) disables speculation.
+  ///
+  /// Speculation only helps if materialization is dispatched to other
+  /// threads: otherwise the requested functions are compiled on the spot.
+  void setSpeculationLimit(unsigned MaxInFlight) {
+    SpeculationLimit = MaxInFlight;
+  }
+
   /// Emits the given module. This should not be called by clients: it will be
   /// called by the JIT when a definition added via the add method is requested.
   void emit(MaterializationResponsibility R, ThreadSafeModule TSM) override;
@@ -120,6 +133,11 @@ private:
   void emitPartition(MaterializationResponsibility R, ThreadSafeModule TSM,
                      IRMaterializationUnit::SymbolNameToDefinitionMap Defs);
 
+  SymbolNameSet getSpeculationCandidates(const Module &M,
+                                         const GlobalValueSet &Partition);
+
+  void speculate(JITDylib &ImplD, const SymbolNameSet &Names);
+
   mutable std::mutex CODLayerMutex;
 
   IRLayer &BaseLayer;
@@ -128,6 +146,8 @@ private:
   PerDylibResourcesMap DylibResources;
   PartitionFunction Partition = compileRequested;
   SymbolLinkagePromoter PromoteSymbols;
+  unsigned SpeculationLimit = 0;
+  std::atomic<unsigned> SpeculationsInFlight{0};
 };
 
 /// Compile-on-demand layer.
@@ -22,6 +22,7 @@
 #include "llvm/ExecutionEngine/Orc/ObjectTransformLayer.h"
 #include "llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
 #include "llvm/Support/ThreadPool.h"
+#include <chrono>
 
 namespace llvm {
 namespace orc {
@@ -29,6 +30,22 @@ namespace orc {
 class LLJITBuilderState;
 class LLLazyJITBuilderState;
 
+/// Receives an event for each module compiled by an LLJIT instance, e.g. to
+/// gather compile latency statistics. With compile threads, events are
+/// delivered concurrently from all of them.
+class CompileEventListener {
+  virtual void anchor();
+
+public:
+  virtual ~CompileEventListener() = default;
+
+  /// Called after module M has been compiled (or loaded from an object cache)
+  /// on the compiling thread. Latency is the wall-clock time that the compile
+  /// took.
+  virtual void notifyModuleCompiled(const Module &M,
+                                    std::chrono::nanoseconds Latency) = 0;
+};
+
 /// A pre-fabricated ORC JIT stack that can serve as an alternative to MCJIT.
 ///
 /// Create instances using LLJITBuilder.
@@ -124,6 +141,10 @@ protected:
   static Expected<IRCompileLayer::CompileFunction>
   createCompileFunction(LLJITBuilderState &S, JITTargetMachineBuilder JTMB);
 
+  static IRCompileLayer::CompileFunction
+  notifyCompiles(IRCompileLayer::CompileFunction Compile,
+                 std::vector<CompileEventListener *> Listeners);
+
   /// Create an LLJIT instance with a single compile thread.
   LLJIT(LLJITBuilderState &S, Error &Err);
 
@@ -195,6 +216,8 @@ public:
   Optional<JITTargetMachineBuilder> JTMB;
   ObjectLinkingLayerCreator CreateObjectLinkingLayer;
   CompileFunctionCreator CreateCompileFunction;
+  ObjectCache *ObjCache = nullptr;
+  std::vector<CompileEventListener *> CompileListeners;
   unsigned NumCompileThreads = 0;
 
   /// Called prior to JIT class construcion to fix up defaults.
@@ -241,6 +264,17 @@ public:
     return impl();
   }
 
+  /// Set an ObjectCache to query before compiling, and to notify of compiled
+  /// objects, e.g. a PersistentObjectCache. The cache is not owned by the JIT
+  /// and must outlive it.
+  ///
+  /// The cache is used by the default compile function only: a custom
+  /// CompileFunctionCreator is responsible for setting up its own cache.
+  SetterImpl &setObjectCache(ObjectCache *ObjCache) {
+    impl().ObjCache = ObjCache;
+    return impl();
+  }
+
   /// Set the number of compile threads to use.
   ///
   /// If set to zero, compilation will be performed on the execution thread when
@@ -254,6 +288,13 @@ public:
     return impl();
   }
 
+  /// Register a listener to notify of each compile. The listener is not owned
+  /// by the JIT and must outlive it.
+  SetterImpl &addCompileEventListener(CompileEventListener &L) {
+    impl().CompileListeners.push_back(&L);
+    return impl();
+  }
+
   /// Create an instance of the JIT.
   Expected<std::unique_ptr<JITType>> create() {
     if (auto Err = impl().prepareForConstruction())
@@ -286,6 +327,7 @@ public:
   JITTargetAddress LazyCompileFailureAddr = 0;
   std::unique_ptr<LazyCallThroughManager> LCTMgr;
   IndirectStubsManagerBuilderFunction ISMBuilder;
+  unsigned SpeculationLimit = 0;
 
   Error prepareForConstruction();
 };
@@ -321,6 +363,17 @@ public:
     this->impl().ISMBuilder = std::move(ISMBuilder);
     return this->impl();
   }
+
+  /// Enable speculative compilation of the functions called by each compiled
+  /// function, with at most MaxInFlight speculative compiles outstanding (see
+  /// CompileOnDemandLayer::setSpeculationLimit). Speculation runs on the
+  /// compile threads, so it requires a non-zero number of them.
+  ///
+  /// If this method is not called then speculation is disabled.
+  SetterImpl &setSpeculationLimit(unsigned MaxInFlight) {
+    this->impl().SpeculationLimit = MaxInFlight;
+    return this->impl();
+  }
 };
 
 /// Constructs LLLazyJIT instances.
@@ -0,0 +1,73 @@
+//===- PersistentObjectCache.h - On-disk object cache for ORC ---*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// An ObjectCache that keeps the objects compiled by a JIT in a directory, so
+// that later runs of the JIT can skip compiling the same modules.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_EXECUTIONENGINE_ORC_PERSISTENTOBJECTCACHE_H
+#define LLVM_EXECUTIONENGINE_ORC_PERSISTENTOBJECTCACHE_H
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ExecutionEngine/ObjectCache.h"
+#include "llvm/Support/CachePruning.h"
+#include "llvm/Support/Error.h"
+#include <memory>
+#include <string>
+
+namespace llvm {
+namespace orc {
+
+class JITTargetMachineBuilder;
+
+/// A content-addressed, on-disk ObjectCache.
+///
+/// Objects are keyed by a hash of the module's bitcode, of the configuration
+/// of the JITTargetMachineBuilder used to compile it, and of the LLVM version.
+/// Each object is stored in the cache directory in a file named
+/// "llvmcache-<key>", so the directory can be pruned with a
+/// CachePruningPolicy like the other LLVM caches.
+///
+/// Entries are written atomically and the cache holds no mutable state, so it
+/// can be shared by concurrent compile threads and by concurrent processes.
+class PersistentObjectCache : public ObjectCache {
+public:
+  /// Create a cache in directory CacheDir, which is created if it does not
+  /// exist, for objects compiled with the configuration in JTMB.
+  static Expected<std::unique_ptr<PersistentObjectCache>>
+  Create(StringRef CacheDir, const JITTargetMachineBuilder &JTMB);
+
+  void notifyObjectCompiled(const Module *M, MemoryBufferRef Obj) override;
+
+  std::unique_ptr<MemoryBuffer> getObject(const Module *M) override;
+
+  /// Return the key under which the object for M is cached.
+  std::string getKey(const Module &M) const;
+
+  /// Prune the cache directory according to Policy. Returns true if pruning
+  /// was performed.
+  bool prune(const CachePruningPolicy &Policy);
+
+  /// Return the cache directory.
+  StringRef getCacheDir() const { return CacheDir; }
+
+private:
+  PersistentObjectCache(std::string CacheDir, std::string ConfigKey)
+      : CacheDir(std::move(CacheDir)), ConfigKey(std::move(ConfigKey)) {}
+
+  std::string getEntryPath(StringRef Key) const;
+
+  std::string CacheDir;
+  std::string ConfigKey;
+};
+
+} // end namespace orc
+} // end namespace llvm
+
+#endif // LLVM_EXECUTIONENGINE_ORC_PERSISTENTOBJECTCACHE_H
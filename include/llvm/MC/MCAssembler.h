@@ -10,8 +10,10 @@
 #define LLVM_MC_MCASSEMBLER_H
 
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/iterator.h"
 #include "llvm/ADT/iterator_range.h"
@@ -154,6 +156,29 @@ private:
 
   VersionInfoType VersionInfo;
 
+  /// The layout of a fixup the last time it was found not to need
+  /// relaxation. Only fixups whose value is a label in the fixup's own section
+  /// plus a constant are tracked.
+  struct RelaxedFixupLayout {
+    bool Tracked;
+    /// Offset of the fragment holding the fixup.
+    uint64_t FragmentOffset;
+    /// Offset of the fragment defining the fixup target.
+    uint64_t TargetOffset;
+  };
+
+  /// For each relaxable fragment which was last found not to need
+  /// relaxation, the layout of each of its fixups at that time. Every
+  /// fragment of a section is still visited on each layout pass over it, but
+  /// the tracked fixups which have not moved relative to their targets are
+  /// not re-evaluated.
+  DenseMap<const MCRelaxableFragment *, SmallVector<RelaxedFixupLayout, 1>>
+      RelaxationCache;
+
+  /// Sections whose layout is final. A section settles once it stops
+  /// relaxing and nothing in it depends on the layout of other sections.
+  SmallPtrSet<const MCSection *, 16> SettledSections;
+
   /// Evaluate a fixup to a relocatable expression and the value which should be
   /// placed into the fixup.
   ///
@@ -182,6 +207,16 @@ private:
   bool fragmentNeedsRelaxation(const MCRelaxableFragment *IF,
                                const MCAsmLayout &Layout) const;
 
+  /// Variant of fragmentNeedsRelaxation used during layout which only
+  /// re-evaluates fixups whose target moved relative to the fixup since the
+  /// fragment was last found not to need relaxation.
+  bool fragmentNeedsRelaxationIncremental(const MCRelaxableFragment &F,
+                                          const MCAsmLayout &Layout);
+
+  /// Check whether the layout of \p Sec can only change through relaxation
+  /// of its own fragments.
+  bool isSectionLayoutSelfContained(const MCSection &Sec) const;
+
   /// Perform one layout iteration and return true if any offsets
   /// were adjusted.
   bool layoutOnce(MCAsmLayout &Layout);
@@ -12,6 +12,7 @@
 #include "llvm/MC/MCDisassembler/MCSymbolizer.h"
 #include <cstdint>
 #include <memory>
+#include <string>
 
 namespace llvm {
 
@@ -97,6 +98,15 @@ public:
                                      raw_ostream &VStream,
                                      raw_ostream &CStream) const;
 
+  /// Returns the state that decoding carries over from one instruction to the
+  /// next, such as the conditions of the rest of an ARM IT block, in the form
+  /// setDecoderState accepts. Empty if decoding is stateless.
+  virtual std::string getDecoderState() const;
+
+  /// Restores a state returned by getDecoderState, possibly of another
+  /// instance for the same target, so that decoding continues from there.
+  virtual void setDecoderState(StringRef State);
+
 private:
   MCContext &Ctx;
 
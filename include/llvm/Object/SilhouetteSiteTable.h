@@ -0,0 +1,133 @@
+//===- SilhouetteSiteTable.h - Silhouette site table parsing ----*- C++ -*-===//
+//
+// Part of the LLVM and Silhouette Projects, under the Apache License v2.0
+// with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file provides a parser for the .silhouette_sites section described in
+// llvm/BinaryFormat/SilhouetteSites.h.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_OBJECT_SILHOUETTESITETABLE_H
+#define LLVM_OBJECT_SILHOUETTESITETABLE_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/BinaryFormat/SilhouetteSites.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/Error.h"
+#include <cstdint>
+#include <vector>
+
+namespace llvm {
+
+/// A Silhouette instrumentation site.
+struct SilhouetteSite {
+  uint32_t Address;
+  uint16_t Length;
+  silhouette::SiteKind Kind;
+};
+
+/// The instrumentation sites of one function.
+struct SilhouetteFunctionSites {
+  uint32_t FunctionAddress;
+  ArrayRef<SilhouetteSite> Sites;
+};
+
+/// A parsed .silhouette_sites section.  Sites can be looked up by address in
+/// constant time.
+class SilhouetteSiteTable {
+public:
+  /// Parse the contents of a .silhouette_sites section.
+  template <support::endianness Endianness>
+  static Expected<SilhouetteSiteTable> parse(ArrayRef<uint8_t> Contents) {
+    using namespace silhouette;
+    SilhouetteSiteTable Table;
+    std::vector<std::pair<uint32_t, size_t>> Headers;
+    const uint8_t *P = Contents.data();
+    const uint8_t *End = P + Contents.size();
+    while (P != End) {
+      if (size_t(End - P) < SiteTableHeaderSize)
+        return createStringError(inconvertibleErrorCode(),
+                                 "truncated Silhouette site table header");
+      uint32_t FunctionAddress = read32<Endianness>(P);
+      uint32_t NumSites = read32<Endianness>(P + 4);
+      P += SiteTableHeaderSize;
+      if (uint64_t(End - P) < uint64_t(NumSites) * SiteEntrySize)
+        return createStringError(inconvertibleErrorCode(),
+                                 "truncated Silhouette site table");
+      Headers.emplace_back(FunctionAddress, NumSites);
+      for (uint32_t I = 0; I != NumSites; ++I, P += SiteEntrySize)
+        Table.Sites.push_back({read32<Endianness>(P),
+                               read16<Endianness>(P + 4),
+                               static_cast<SiteKind>(P[6])});
+    }
+
+    // Only slice the site array once it no longer grows.
+    ArrayRef<SilhouetteSite> Sites = Table.Sites;
+    for (const auto &H : Headers) {
+      Table.Functions.push_back({H.first, Sites.take_front(H.second)});
+      Sites = Sites.drop_front(H.second);
+    }
+    for (const SilhouetteSite &Site : Table.Sites)
+      Table.SiteIndex.insert({Site.Address, &Site});
+    return std::move(Table);
+  }
+
+  ArrayRef<SilhouetteFunctionSites> functions() const { return Functions; }
+  ArrayRef<SilhouetteSite> sites() const { return Sites; }
+
+  /// Return the site starting at Address, or null if there is none.
+  const SilhouetteSite *lookup(uint32_t Address) const {
+    return SiteIndex.lookup(Address);
+  }
+
+  SilhouetteSiteTable(SilhouetteSiteTable &&) = default;
+  SilhouetteSiteTable &operator=(SilhouetteSiteTable &&) = default;
+
+private:
+  SilhouetteSiteTable() = default;
+
+  template <support::endianness Endianness>
+  static uint32_t read32(const uint8_t *P) {
+    return support::endian::read<uint32_t, Endianness, 1>(P);
+  }
+  template <support::endianness Endianness>
+  static uint16_t read16(const uint8_t *P) {
+    return support::endian::read<uint16_t, Endianness, 1>(P);
+  }
+
+  std::vector<SilhouetteSite> Sites;
+  std::vector<SilhouetteFunctionSites> Functions;
+  // Keyed by 64-bit integers, so that the empty and tombstone keys of the map
+  // can never be the address of a site.
+  DenseMap<uint64_t, const SilhouetteSite *> SiteIndex;
+};
+
+/// Return the name of a site kind, or "Unknown".
+inline StringRef getSilhouetteSiteKindName(silhouette::SiteKind Kind) {
+  switch (Kind) {
+  case silhouette::SK_ShadowStackPush:
+    return "ShadowStackPush";
+  case silhouette::SK_ShadowStackPop:
+    return "ShadowStackPop";
+  case silhouette::SK_SFI:
+    return "SFI";
+  case silhouette::SK_STRT:
+    return "STRT";
+  case silhouette::SK_CFILabel:
+    return "CFILabel";
+  case silhouette::SK_CFICheck:
+    return "CFICheck";
+  }
+  return "Unknown";
+}
+
+} // end namespace llvm
+
+#endif // LLVM_OBJECT_SILHOUETTESITETABLE_H
@@ -197,7 +197,9 @@ private:
   uint64_t NamesDelta;
   const RawInstrProf::ProfileData<IntPtrT> *Data;
   const RawInstrProf::ProfileData<IntPtrT> *DataEnd;
-  const uint64_t *CountersStart;
+  const char *CountersStart;
+  // The width in bits of the region counters, from the version variant bits.
+  unsigned CounterWidth;
   const char *NamesStart;
   uint64_t NamesSize;
   // After value profile is all read, this pointer points to
@@ -268,8 +270,8 @@ private:
       return (const char *)ValueDataStart;
   }
 
-  const uint64_t *getCounter(IntPtrT CounterPtr) const {
-    ptrdiff_t Offset = (swap(CounterPtr) - CountersDelta) / sizeof(uint64_t);
+  const char *getCounter(IntPtrT CounterPtr) const {
+    ptrdiff_t Offset = swap(CounterPtr) - CountersDelta;
     return CountersStart + Offset;
   }
 
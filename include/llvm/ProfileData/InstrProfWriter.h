@@ -33,6 +33,9 @@ class raw_fd_ostream;
 class InstrProfWriter {
 public:
   using ProfilingData = SmallDenseMap<uint64_t, InstrProfRecord>;
+  /// Reads the record of function \p Name with hash \p Hash.
+  using RecordLoader =
+      function_ref<InstrProfRecord(StringRef Name, uint64_t Hash)>;
   // PF_IRLevelWithCS is the profile from context sensitive IR instrumentation.
   enum ProfKind { PF_Unknown = 0, PF_FE, PF_IRLevel, PF_IRLevelWithCS };
 
@@ -56,15 +59,25 @@ public:
     addRecord(std::move(I), 1, Warn);
   }
 
+  /// Add function \p Name with hash \p Hash without its counts. Its record
+  /// is read by the RecordLoader passed to write or writeText when the
+  /// function is written out, so that only one record is held in memory.
+  /// Either all records of a writer are deferred or none are.
+  void addDeferredRecord(StringRef Name, uint64_t Hash);
+
   /// Merge existing function counts from the given writer.
   void mergeRecordsFromWriter(InstrProfWriter &&IPW,
                               function_ref<void(Error)> Warn);
 
-  /// Write the profile to \c OS
-  void write(raw_fd_ostream &OS);
+  /// Return true if no function has been added.
+  bool empty() const { return FunctionData.empty(); }
+
+  /// Write the profile to \c OS. \p Load reads the deferred records.
+  void write(raw_fd_ostream &OS, RecordLoader Load = nullptr);
 
-  /// Write the profile in text format to \c OS
-  Error writeText(raw_fd_ostream &OS);
+  /// Write the profile in text format to \c OS. \p Load reads the deferred
+  /// records.
+  Error writeText(raw_fd_ostream &OS, RecordLoader Load = nullptr);
 
   /// Write \c Record in text format to \c OS
   static void writeRecordInText(StringRef Name, uint64_t Hash,
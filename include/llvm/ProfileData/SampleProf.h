@@ -105,6 +105,9 @@ static inline StringRef getRepInFormat(StringRef Name,
 
 static inline uint64_t SPVersion() { return 103; }
 
+/// Version of binary profiles that also carry a function offset table.
+static inline uint64_t SPIndexedVersion() { return 104; }
+
 /// Represents the relative location of an instruction.
 ///
 /// Instruction locations are specified by the line offset from the
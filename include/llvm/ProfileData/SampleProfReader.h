@@ -158,6 +158,10 @@
 //    NAMES
 //        A NUL-separated list of SIZE strings.
 //
+// FUNCTION OFFSET TABLE OFFSET (uint64_t, little-endian, not LEB128-encoded)
+//    Only present if the version is SPIndexedVersion(). The offset from the
+//    start of the file of the FUNCTION OFFSET TABLE below.
+//
 // FUNCTION BODY (one for each uninlined function body present in the profile)
 //    HEAD_SAMPLES (uint64_t) [only for top-level functions]
 //        Total number of samples collected at the head (prologue) of the
@@ -203,6 +207,15 @@
 //          in the text format documentation above).
 //        FUNCTION BODY
 //          A FUNCTION BODY entry describing the inlined function.
+//
+// FUNCTION OFFSET TABLE (only present if the version is SPIndexedVersion())
+//    SIZE (uint64_t)
+//        Number of entries in the table.
+//    A list of SIZE entries, one per top-level function:
+//        NAME_IDX (uint32_t)
+//            Index into the name table indicating the function name.
+//        OFFSET (uint64_t)
+//            Offset from the start of the file of the function's HEAD_SAMPLES.
 //===----------------------------------------------------------------------===//
 
 #ifndef LLVM_PROFILEDATA_SAMPLEPROFREADER_H
@@ -381,8 +394,22 @@ public:
   virtual std::error_code readHeader() override;
 
   /// Read sample profiles from the associated file.
+  ///
+  /// If the profile has a function offset table and collectFuncsToUse was
+  /// called, nothing is decoded here; the profile of a function is decoded
+  /// the first time getSamplesFor asks for it.
   std::error_code read() override;
 
+  /// Defer decoding function profiles until they are asked for, if the
+  /// profile has a function offset table.
+  void collectFuncsToUse(const Module &M) override;
+
+  /// Return the samples collected for function \p Fname, decoding them first
+  /// if they have not been read yet. If they cannot be decoded, an error is
+  /// reported and nullptr is returned.
+  FunctionSamples *getSamplesFor(StringRef Fname) override;
+  using SampleProfileReader::getSamplesFor;
+
 protected:
   /// Read a numeric value of type T from the profile.
   ///
@@ -422,6 +449,20 @@ protected:
   /// Points to the end of the buffer.
   const uint8_t *End = nullptr;
 
+  /// The version of the profile.
+  uint64_t Version = 0;
+
+  /// The table mapping from function name to the offset of its FunctionSample
+  /// towards file start. Entries are removed once they have been decoded.
+  DenseMap<StringRef, uint64_t> FuncOffsetTable;
+
+  /// Whether function profiles are decoded on first use.
+  bool LoadOnDemand = false;
+
+  /// Read the function offset table, whose offset is stored at the current
+  /// position.
+  std::error_code readFuncOffsetTable();
+
 private:
   std::error_code readSummaryEntry(std::vector<ProfileSummaryEntry> &Entries);
   virtual std::error_code verifySPMagic(uint64_t Magic) = 0;
@@ -444,6 +485,7 @@ private:
   virtual std::error_code readNameTable() override;
   /// Read a string indirectly via the name table.
   virtual ErrorOr<StringRef> readStringFromTable() override;
+  virtual std::error_code readHeader() override;
 
 public:
   SampleProfileReaderRawBinary(std::unique_ptr<MemoryBuffer> B, LLVMContext &C)
@@ -457,17 +499,11 @@ class SampleProfileReaderCompactBinary : public SampleProfileReaderBinary {
 private:
   /// Function name table.
   std::vector<std::string> NameTable;
-  /// The table mapping from function name to the offset of its FunctionSample
-  /// towards file start.
-  DenseMap<StringRef, uint64_t> FuncOffsetTable;
-  /// The set containing the functions to use when compiling a module.
-  DenseSet<StringRef> FuncsToUse;
   virtual std::error_code verifySPMagic(uint64_t Magic) override;
   virtual std::error_code readNameTable() override;
   /// Read a string indirectly via the name table.
   virtual ErrorOr<StringRef> readStringFromTable() override;
   virtual std::error_code readHeader() override;
-  std::error_code readFuncOffsetTable();
 
 public:
   SampleProfileReaderCompactBinary(std::unique_ptr<MemoryBuffer> B,
@@ -476,12 +512,6 @@ public:
 
   /// \brief Return true if \p Buffer is in the format supported by this class.
   static bool hasFormat(const MemoryBuffer &Buffer);
-
-  /// Read samples only for functions to use.
-  std::error_code read() override;
-
-  /// Collect functions to be used when compiling Module \p M.
-  void collectFuncsToUse(const Module &M) override;
 };
 
 using InlineCallStack = SmallVector<FunctionSamples *, 10>;
@@ -45,6 +45,10 @@ public:
 
   raw_ostream &getOutputStream() { return *OutputStream; }
 
+  /// Write a function offset table, so that readers can decode the profile
+  /// of a function only when it is needed. Only binary formats support it.
+  virtual void setUseFuncOffsetTable() {}
+
   /// Profile writer factory.
   ///
   /// Create a new file writer based on the value of \p Format.
@@ -103,9 +107,13 @@ private:
 class SampleProfileWriterBinary : public SampleProfileWriter {
 public:
   virtual std::error_code write(const FunctionSamples &S) override;
+  virtual std::error_code
+  write(const StringMap<FunctionSamples> &ProfileMap) override;
   SampleProfileWriterBinary(std::unique_ptr<raw_ostream> &OS)
       : SampleProfileWriter(OS) {}
 
+  void setUseFuncOffsetTable() override { UseFuncOffsetTable = true; }
+
 protected:
   virtual std::error_code writeNameTable() = 0;
   virtual std::error_code writeMagicIdent() = 0;
@@ -115,9 +123,19 @@ protected:
   std::error_code writeNameIdx(StringRef FName);
   std::error_code writeBody(const FunctionSamples &S);
   inline void stablizeNameTable(std::set<StringRef> &V);
+  std::error_code writeFuncOffsetTable();
 
   MapVector<StringRef, uint32_t> NameTable;
 
+  /// Whether to write a function offset table after the function profiles.
+  bool UseFuncOffsetTable = false;
+  /// The table mapping from function name to the offset of its FunctionSample
+  /// towards profile start.
+  MapVector<StringRef, uint64_t> FuncOffsetTable;
+  /// The offset of the slot to be filled with the offset of FuncOffsetTable
+  /// towards profile start.
+  uint64_t TableOffset;
+
 private:
   void addName(StringRef FName);
   void addNames(const FunctionSamples &S);
@@ -127,6 +145,9 @@ private:
                               SampleProfileFormat Format);
 };
 
+// The binary format optionally carries the same function offset table as the
+// compact format below; such profiles are written with SPIndexedVersion() so
+// that older readers reject them instead of misreading the table.
 class SampleProfileWriterRawBinary : public SampleProfileWriterBinary {
   using SampleProfileWriterBinary::SampleProfileWriterBinary;
 
@@ -166,25 +187,15 @@ protected:
 // We need Part2 because profile reader can use it to find out and read
 // function offset table without reading Part3 first.
 class SampleProfileWriterCompactBinary : public SampleProfileWriterBinary {
-  using SampleProfileWriterBinary::SampleProfileWriterBinary;
-
 public:
-  virtual std::error_code write(const FunctionSamples &S) override;
-  virtual std::error_code
-  write(const StringMap<FunctionSamples> &ProfileMap) override;
+  SampleProfileWriterCompactBinary(std::unique_ptr<raw_ostream> &OS)
+      : SampleProfileWriterBinary(OS) {
+    UseFuncOffsetTable = true;
+  }
 
 protected:
-  /// The table mapping from function name to the offset of its FunctionSample
-  /// towards profile start.
-  MapVector<StringRef, uint64_t> FuncOffsetTable;
-  /// The offset of the slot to be filled with the offset of FuncOffsetTable
-  /// towards profile start.
-  uint64_t TableOffset;
   virtual std::error_code writeNameTable() override;
   virtual std::error_code writeMagicIdent() override;
-  virtual std::error_code
-  writeHeader(const StringMap<FunctionSamples> &ProfileMap) override;
-  std::error_code writeFuncOffsetTable();
 };
 
 } // end namespace sampleprof
@@ -139,6 +139,10 @@ struct InstrProfOptions {
   // Use BFI to guide register promotion
   bool UseBFIInPromotion = false;
 
+  // Width in bits of the region counters: 8, 16, 32 or 64. Counters narrower
+  // than 64 bits saturate instead of wrapping.
+  unsigned CounterWidth = 64;
+
   // Name of the profile file to use as output
   std::string InstrProfileOutput;
 
@@ -84,6 +84,9 @@ private:
   /// Returns true if profile counter update register promotion is enabled.
   bool isCounterPromotionEnabled() const;
 
+  /// Returns the width in bits of the region counters.
+  unsigned getCounterWidth() const;
+
   /// Count the number of instrumented value sites for the function.
   void computeNumValueSiteCounts(InstrProfValueProfileInst *Ins);
 
@@ -118,6 +121,10 @@ private:
   /// Add uses of our data variables and runtime hook.
   void emitUses();
 
+  /// Record the counter width in the raw profile version variable, so that
+  /// the runtime writes it into the profile header.
+  void emitCounterWidthVariant();
+
   /// Create a static initializer for our data, on platforms that need it,
   /// and for any profile output file that was specified.
   void emitInitialization();
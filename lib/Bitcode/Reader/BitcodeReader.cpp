@@ -17,6 +17,7 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/ADT/Twine.h"
@@ -87,6 +88,10 @@
 
 using namespace llvm;
 
+#define DEBUG_TYPE "bitcode-reader"
+
+STATISTIC(NumFunctionBodiesLoaded, "Number of function bodies materialized");
+
 static cl::opt<bool> PrintSummaryGUIDs(
     "print-summary-global-ids", cl::init(false), cl::Hidden,
     cl::desc(
@@ -5218,6 +5223,7 @@ Error BitcodeReader::materialize(GlobalValue *GV) {
   if (Error Err = parseFunctionBody(F))
     return Err;
   F->setIsMaterializable(false);
+  ++NumFunctionBodiesLoaded;
 
   if (StripDebugInfo)
     stripDebugInfo(*F);
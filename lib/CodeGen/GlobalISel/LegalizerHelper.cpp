@@ -2604,7 +2604,7 @@ LegalizerHelper::narrowScalarShift(MachineInstr &MI, unsigned TypeIdx,
   switch (MI.getOpcode()) {
   case TargetOpcode::G_SHL: {
     // Short: ShAmt < NewBitSize
-    auto LoS = MIRBuilder.buildShl(HalfTy, InH, Amt);
+    auto LoS = MIRBuilder.buildShl(HalfTy, InL, Amt);
 
     auto OrLHS = MIRBuilder.buildShl(HalfTy, InH, Amt);
     auto OrRHS = MIRBuilder.buildLShr(HalfTy, InL, AmtLack);
@@ -2647,7 +2647,7 @@ LegalizerHelper::narrowScalarShift(MachineInstr &MI, unsigned TypeIdx,
     auto HiS = MIRBuilder.buildAShr(HalfTy, InH, Amt);
 
     auto OrLHS = MIRBuilder.buildLShr(HalfTy, InL, Amt);
-    auto OrRHS = MIRBuilder.buildLShr(HalfTy, InH, AmtLack);
+    auto OrRHS = MIRBuilder.buildShl(HalfTy, InH, AmtLack);
     auto LoS = MIRBuilder.buildOr(HalfTy, OrLHS, OrRHS);
 
     // Long: ShAmt >= NewBitSize
@@ -26,9 +26,12 @@ using namespace llvm;
 
 static void codegen(Module *M, llvm::raw_pwrite_stream &OS,
                     function_ref<std::unique_ptr<TargetMachine>()> TMFactory,
-                    TargetMachine::CodeGenFileType FileType) {
+                    TargetMachine::CodeGenFileType FileType,
+                    function_ref<void(legacy::PassManagerBase &)> AddPasses) {
   std::unique_ptr<TargetMachine> TM = TMFactory();
   legacy::PassManager CodeGenPasses;
+  if (AddPasses)
+    AddPasses(CodeGenPasses);
   if (TM->addPassesToEmitFile(CodeGenPasses, OS, nullptr, FileType))
     report_fatal_error("Failed to setup codegen");
   CodeGenPasses.run(*M);
@@ -38,13 +41,14 @@ std::unique_ptr<Module> llvm::splitCodeGen(
     std::unique_ptr<Module> M, ArrayRef<llvm::raw_pwrite_stream *> OSs,
     ArrayRef<llvm::raw_pwrite_stream *> BCOSs,
     const std::function<std::unique_ptr<TargetMachine>()> &TMFactory,
-    TargetMachine::CodeGenFileType FileType, bool PreserveLocals) {
+    TargetMachine::CodeGenFileType FileType, bool PreserveLocals,
+    const std::function<void(legacy::PassManagerBase &)> &AddPasses) {
   assert(BCOSs.empty() || BCOSs.size() == OSs.size());
 
   if (OSs.size() == 1) {
     if (!BCOSs.empty())
       WriteBitcodeToFile(*M, *BCOSs[0]);
-    codegen(M.get(), *OSs[0], TMFactory, FileType);
+    codegen(M.get(), *OSs[0], TMFactory, FileType, AddPasses);
     return M;
   }
 
@@ -75,7 +79,8 @@ std::unique_ptr<Module> llvm::splitCodeGen(
           llvm::raw_pwrite_stream *ThreadOS = OSs[ThreadCount++];
           // Enqueue the task
           CodegenThreadPool.async(
-              [TMFactory, FileType, ThreadOS](const SmallString<0> &BC) {
+              [TMFactory, FileType, ThreadOS,
+               AddPasses](const SmallString<0> &BC) {
                 LLVMContext Ctx;
                 Expected<std::unique_ptr<Module>> MOrErr = parseBitcodeFile(
                     MemoryBufferRef(StringRef(BC.data(), BC.size()),
@@ -85,7 +90,8 @@ std::unique_ptr<Module> llvm::splitCodeGen(
                   report_fatal_error("Failed to read bitcode");
                 std::unique_ptr<Module> MPartInCtx = std::move(MOrErr.get());
 
-                codegen(MPartInCtx.get(), *ThreadOS, TMFactory, FileType);
+                codegen(MPartInCtx.get(), *ThreadOS, TMFactory, FileType,
+                        AddPasses);
               },
               // Pass BC using std::move to ensure that it get moved rather than
               // copied into the thread's context.
@@ -58,14 +58,19 @@
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/JSON.h"
 #include "llvm/Support/KnownBits.h"
 #include "llvm/Support/MachineValueType.h"
+#include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MathExtras.h"
+#include "llvm/Support/Mutex.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetOptions.h"
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <iterator>
@@ -115,6 +120,112 @@ static cl::opt<unsigned> TokenFactorInlineLimit(
     "combiner-tokenfactor-inline-limit", cl::Hidden, cl::init(2048),
     cl::desc("Limit the number of operands to inline for Token Factors"));
 
+static cl::opt<std::string> CombinerProfileFile(
+    "combiner-profile-file", cl::Hidden,
+    cl::desc("Write the attempts, hits, created and deleted nodes and time of "
+             "each combine rule, per function, as JSON to this file"),
+    cl::value_desc("filename"));
+
+namespace {
+
+/// The profile of one combine rule: the generic visit routine, or the target
+/// combine, of one opcode.
+struct CombineRuleProfile {
+  std::string Name;
+  uint64_t Attempts = 0;
+  uint64_t Hits = 0;
+  uint64_t NodesCreated = 0;
+  uint64_t NodesDeleted = 0;
+  double Seconds = 0;
+
+  void merge(const CombineRuleProfile &Other) {
+    Attempts += Other.Attempts;
+    Hits += Other.Hits;
+    NodesCreated += Other.NodesCreated;
+    NodesDeleted += Other.NodesDeleted;
+    Seconds += Other.Seconds;
+  }
+};
+
+/// The profiles of the combine rules of all the combiner runs on each
+/// function, which are written to -combiner-profile-file at shutdown.
+class CombineProfileReport {
+  sys::SmartMutex<true> Lock;
+  // The functions in the order they were first combined, and their rules by
+  // name.
+  std::vector<std::pair<std::string, StringMap<CombineRuleProfile>>> Functions;
+  StringMap<unsigned> FunctionIndex;
+
+public:
+  ~CombineProfileReport();
+
+  void add(StringRef Function, ArrayRef<CombineRuleProfile> Rules);
+};
+
+} // end anonymous namespace
+
+static ManagedStatic<CombineProfileReport> CombineProfile;
+
+void CombineProfileReport::add(StringRef Function,
+                               ArrayRef<CombineRuleProfile> Rules) {
+  sys::SmartScopedLock<true> Guard(Lock);
+  auto Inserted = FunctionIndex.try_emplace(Function, Functions.size());
+  if (Inserted.second)
+    Functions.emplace_back(Function, StringMap<CombineRuleProfile>());
+  StringMap<CombineRuleProfile> &FunctionRules =
+      Functions[Inserted.first->second].second;
+  for (const CombineRuleProfile &Rule : Rules) {
+    CombineRuleProfile &Total = FunctionRules[Rule.Name];
+    Total.Name = Rule.Name;
+    Total.merge(Rule);
+  }
+}
+
+CombineProfileReport::~CombineProfileReport() {
+  if (Functions.empty())
+    return;
+
+  std::error_code EC;
+  raw_fd_ostream OS(CombinerProfileFile, EC, sys::fs::F_Text);
+  if (EC) {
+    errs() << "error: could not open DAG combiner profile file '"
+           << CombinerProfileFile << "': " << EC.message() << "\n";
+    return;
+  }
+
+  json::OStream J(OS, /*IndentSize=*/2);
+  J.object([&] {
+    J.attributeArray("functions", [&] {
+      for (auto &Function : Functions) {
+        // List the most expensive rules of each function first.
+        std::vector<const CombineRuleProfile *> Rules;
+        for (const auto &Rule : Function.second)
+          Rules.push_back(&Rule.second);
+        llvm::sort(Rules, [](const CombineRuleProfile *A,
+                             const CombineRuleProfile *B) {
+          return std::tie(B->Seconds, A->Name) < std::tie(A->Seconds, B->Name);
+        });
+
+        J.object([&] {
+          J.attribute("name", Function.first);
+          J.attributeArray("rules", [&] {
+            for (const CombineRuleProfile *Rule : Rules)
+              J.object([&] {
+                J.attribute("rule", Rule->Name);
+                J.attribute("attempts", int64_t(Rule->Attempts));
+                J.attribute("hits", int64_t(Rule->Hits));
+                J.attribute("nodes-created", int64_t(Rule->NodesCreated));
+                J.attribute("nodes-deleted", int64_t(Rule->NodesDeleted));
+                J.attribute("seconds", Rule->Seconds);
+              });
+          });
+        });
+      }
+    });
+  });
+  OS << "\n";
+}
+
 namespace {
 
   class DAGCombiner {
@@ -155,6 +266,25 @@ namespace {
     // AA - Used for DAG load/store alias analysis.
     AliasAnalysis *AA;
 
+    /// Whether the combine rules of this run are profiled, because
+    /// -combiner-profile-file is given.
+    bool ProfileRules;
+
+    enum RuleKind { VisitRule, TargetRule };
+
+    /// The profiles of the combine rules that were tried in this run, and
+    /// their indices by kind and opcode.
+    SmallVector<CombineRuleProfile, 32> RuleProfiles;
+    DenseMap<std::pair<unsigned, unsigned>, unsigned> RuleIndices;
+
+    /// The rule that combined the node being combined, if any, which is also
+    /// charged for deleting the node once it has been replaced.
+    Optional<unsigned> LastHitRule;
+
+    /// The number of nodes created and deleted so far, when profiling.
+    uint64_t NumNodesCreated = 0;
+    uint64_t NumNodesDeleted = 0;
+
     /// When an instruction is simplified, add all users of the instruction to
     /// the work lists because they might get more simplified now.
     void AddUsersToWorklist(SDNode *N) {
@@ -196,11 +326,16 @@ namespace {
     /// Call the node-specific routine that folds each particular type of node.
     SDValue visit(SDNode *N);
 
+    /// Run the combine rule of the given kind for N, recording its profile if
+    /// the rules are profiled.
+    SDValue runRule(RuleKind Kind, SDNode *N, function_ref<SDValue()> Rule);
+
   public:
     DAGCombiner(SelectionDAG &D, AliasAnalysis *AA, CodeGenOpt::Level OL)
         : DAG(D), TLI(D.getTargetLoweringInfo()), Level(BeforeLegalizeTypes),
           OptLevel(OL), AA(AA) {
       ForCodeSize = DAG.getMachineFunction().getFunction().hasOptSize();
+      ProfileRules = !CombinerProfileFile.empty();
 
       MaximumLegalStoreInBits = 0;
       for (MVT VT : MVT::all_valuetypes())
@@ -215,6 +350,9 @@ namespace {
       PruningList.insert(N);
     }
 
+    /// Count a node created in the DAG, for the profile of the running rule.
+    void NodeCreated() { ++NumNodesCreated; }
+
     /// Add to the worklist making sure its instance is at the back (next to be
     /// processed.)
     void AddToWorklist(SDNode *N) {
@@ -234,6 +372,8 @@ namespace {
 
     /// Remove all instances of N from the worklist.
     void removeFromWorklist(SDNode *N) {
+      // Nodes are removed from the worklist as they are deleted.
+      ++NumNodesDeleted;
       CombinedNodes.erase(N);
       PruningList.remove(N);
 
@@ -714,7 +854,10 @@ public:
 
   // FIXME: Ideally we could add N to the worklist, but this causes exponential
   //        compile time costs in large DAGs, e.g. Halide.
-  void NodeInserted(SDNode *N) override { DC.ConsiderForPruning(N); }
+  void NodeInserted(SDNode *N) override {
+    DC.ConsiderForPruning(N);
+    DC.NodeCreated();
+  }
 };
 
 } // end anonymous namespace
@@ -1628,6 +1771,8 @@ void DAGCombiner::Run(CombineLevel AtLevel) {
 
     LLVM_DEBUG(dbgs() << " ... into: "; RV.getNode()->dump(&DAG));
 
+    uint64_t DeletedBefore = NumNodesDeleted;
+
     if (N->getNumValues() == RV.getNode()->getNumValues())
       DAG.ReplaceAllUsesWith(N, RV.getNode());
     else {
@@ -1645,11 +1790,53 @@ void DAGCombiner::Run(CombineLevel AtLevel) {
     // something else needing this node. This will also take care of adding any
     // operands which have lost a user to the worklist.
     recursivelyDeleteUnusedNodes(N);
+
+    if (LastHitRule)
+      RuleProfiles[*LastHitRule].NodesDeleted +=
+          NumNodesDeleted - DeletedBefore;
   }
 
   // If the root changed (e.g. it was a dead load, update the root).
   DAG.setRoot(Dummy.getValue());
   DAG.RemoveDeadNodes();
+
+  if (ProfileRules)
+    CombineProfile->add(DAG.getMachineFunction().getName(), RuleProfiles);
+}
+
+SDValue DAGCombiner::runRule(RuleKind Kind, SDNode *N,
+                             function_ref<SDValue()> Rule) {
+  if (!ProfileRules)
+    return Rule();
+
+  // The rule may delete N, so name the rule first.
+  auto Inserted = RuleIndices.try_emplace(
+      std::make_pair(unsigned(Kind), N->getOpcode()), RuleProfiles.size());
+  if (Inserted.second) {
+    RuleProfiles.emplace_back();
+    RuleProfiles.back().Name =
+        (Kind == VisitRule ? "visit " : "target ") + N->getOperationName(&DAG);
+  }
+  unsigned Index = Inserted.first->second;
+
+  uint64_t CreatedBefore = NumNodesCreated;
+  uint64_t DeletedBefore = NumNodesDeleted;
+  auto Start = std::chrono::steady_clock::now();
+  SDValue RV = Rule();
+  std::chrono::duration<double> Elapsed =
+      std::chrono::steady_clock::now() - Start;
+
+  CombineRuleProfile &Profile = RuleProfiles[Index];
+  ++Profile.Attempts;
+  LastHitRule = None;
+  if (RV.getNode()) {
+    ++Profile.Hits;
+    LastHitRule = Index;
+  }
+  Profile.NodesCreated += NumNodesCreated - CreatedBefore;
+  Profile.NodesDeleted += NumNodesDeleted - DeletedBefore;
+  Profile.Seconds += Elapsed.count();
+  return RV;
 }
 
 SDValue DAGCombiner::visit(SDNode *N) {
@@ -1784,7 +1971,7 @@ SDValue DAGCombiner::visit(SDNode *N) {
 }
 
 SDValue DAGCombiner::combine(SDNode *N) {
-  SDValue RV = visit(N);
+  SDValue RV = runRule(VisitRule, N, [&] { return visit(N); });
 
   // If nothing happened, try a target-specific DAG combine.
   if (!RV.getNode()) {
@@ -1798,7 +1985,9 @@ SDValue DAGCombiner::combine(SDNode *N) {
       TargetLowering::DAGCombinerInfo
         DagCombineInfo(DAG, Level, false, this);
 
-      RV = TLI.PerformDAGCombine(N, DagCombineInfo);
+      RV = runRule(TargetRule, N, [&] {
+        return TLI.PerformDAGCombine(N, DagCombineInfo);
+      });
     }
   }
 
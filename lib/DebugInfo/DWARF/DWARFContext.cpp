@@ -7,6 +7,8 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/DebugInfo/DWARF/DWARFContext.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
@@ -1158,35 +1160,17 @@ DILineInfoTable DWARFContext::getLineInfoForAddressRange(
   return Lines;
 }
 
-DIInliningInfo
-DWARFContext::getInliningInfoForAddress(object::SectionedAddress Address,
-                                        DILineInfoSpecifier Spec) {
-  DIInliningInfo InliningInfo;
-
-  DWARFCompileUnit *CU = getCompileUnitForAddress(Address.Address);
-  if (!CU)
-    return InliningInfo;
-
-  const DWARFLineTable *LineTable = nullptr;
-  SmallVector<DWARFDie, 4> InlinedChain;
-  CU->getInlinedChainForAddress(Address.Address, InlinedChain);
-  if (InlinedChain.size() == 0) {
-    // If there is no DIE for address (e.g. it is in unavailable .dwo file),
-    // try to at least get file/line info from symbol table.
-    if (Spec.FLIKind != FileLineInfoKind::None) {
-      DILineInfo Frame;
-      LineTable = getLineTableForUnit(CU);
-      if (LineTable && LineTable->getFileLineInfoForAddress(
-                           {Address.Address, Address.SectionIndex},
-                           CU->getCompilationDir(), Spec.FLIKind, Frame))
-        InliningInfo.addFrame(Frame);
-    }
-    return InliningInfo;
-  }
-
+/// Adds a frame for each DIE of an inlined chain to \p InliningInfo, except
+/// for the file and line of the topmost frame, which the caller takes from
+/// the line table.
+static void addInlinedFrames(DWARFCompileUnit *CU,
+                             ArrayRef<DWARFDie> InlinedChain,
+                             const DWARFLineTable *LineTable,
+                             DILineInfoSpecifier Spec,
+                             DIInliningInfo &InliningInfo) {
   uint32_t CallFile = 0, CallLine = 0, CallColumn = 0, CallDiscriminator = 0;
   for (uint32_t i = 0, n = InlinedChain.size(); i != n; i++) {
-    DWARFDie &FunctionDIE = InlinedChain[i];
+    DWARFDie FunctionDIE = InlinedChain[i];
     DILineInfo Frame;
     // Get function name if necessary.
     if (const char *Name = FunctionDIE.getSubroutineName(Spec.FNKind))
@@ -1194,18 +1178,9 @@ DWARFContext::getInliningInfoForAddress(object::SectionedAddress Address,
     if (auto DeclLineResult = FunctionDIE.getDeclLine())
       Frame.StartLine = DeclLineResult;
     if (Spec.FLIKind != FileLineInfoKind::None) {
-      if (i == 0) {
-        // For the topmost frame, initialize the line table of this
-        // compile unit and fetch file/line info from it.
-        LineTable = getLineTableForUnit(CU);
-        // For the topmost routine, get file/line info from line table.
-        if (LineTable)
-          LineTable->getFileLineInfoForAddress(
-              {Address.Address, Address.SectionIndex}, CU->getCompilationDir(),
-              Spec.FLIKind, Frame);
-      } else {
-        // Otherwise, use call file, call line and call column from
-        // previous DIE in inlined chain.
+      if (i != 0) {
+        // Use call file, call line and call column from previous DIE in
+        // inlined chain.
         if (LineTable)
           LineTable->getFileNameByIndex(CallFile, CU->getCompilationDir(),
                                         Spec.FLIKind, Frame.FileName);
@@ -1221,9 +1196,105 @@ DWARFContext::getInliningInfoForAddress(object::SectionedAddress Address,
     }
     InliningInfo.addFrame(Frame);
   }
+}
+
+DIInliningInfo
+DWARFContext::getInliningInfoForAddress(object::SectionedAddress Address,
+                                        DILineInfoSpecifier Spec) {
+  DIInliningInfo InliningInfo;
+
+  DWARFCompileUnit *CU = getCompileUnitForAddress(Address.Address);
+  if (!CU)
+    return InliningInfo;
+
+  const DWARFLineTable *LineTable = nullptr;
+  SmallVector<DWARFDie, 4> InlinedChain;
+  CU->getInlinedChainForAddress(Address.Address, InlinedChain);
+  if (Spec.FLIKind != FileLineInfoKind::None)
+    LineTable = getLineTableForUnit(CU);
+  if (InlinedChain.size() == 0) {
+    // If there is no DIE for address (e.g. it is in unavailable .dwo file),
+    // try to at least get file/line info from symbol table.
+    DILineInfo Frame;
+    if (LineTable && LineTable->getFileLineInfoForAddress(
+                         Address, CU->getCompilationDir(), Spec.FLIKind, Frame))
+      InliningInfo.addFrame(Frame);
+    return InliningInfo;
+  }
+
+  addInlinedFrames(CU, InlinedChain, LineTable, Spec, InliningInfo);
+  // For the topmost routine, get file/line info from line table.
+  if (LineTable)
+    LineTable->getFileLineInfoForAddress(Address, CU->getCompilationDir(),
+                                         Spec.FLIKind,
+                                         *InliningInfo.getMutableFrame(0));
   return InliningInfo;
 }
 
+std::vector<DIInliningInfo> DWARFContext::getInliningInfoForAddresses(
+    ArrayRef<object::SectionedAddress> Addresses, DILineInfoSpecifier Spec) {
+  // Where the walk through the addresses stands in one compile unit.
+  struct UnitCursor {
+    UnitCursor(DWARFUnit &U) : Subroutines(U) {}
+
+    DWARFUnit::SubroutineCursor Subroutines;
+    Optional<DWARFDebugLine::LineTable::Cursor> Lines;
+    const DWARFLineTable *LineTable = nullptr;
+    /// The innermost subroutine of the last address and its frames, which
+    /// only lack the file and line of the topmost frame.
+    DWARFDie Subroutine;
+    DIInliningInfo Frames;
+  };
+  DenseMap<DWARFCompileUnit *, std::unique_ptr<UnitCursor>> Cursors;
+
+  std::vector<DIInliningInfo> Result(Addresses.size());
+  for (size_t I = 0, E = Addresses.size(); I != E; ++I) {
+    object::SectionedAddress Address = Addresses[I];
+    DIInliningInfo &InliningInfo = Result[I];
+    DWARFCompileUnit *CU = getCompileUnitForAddress(Address.Address);
+    if (!CU)
+      continue;
+
+    std::unique_ptr<UnitCursor> &Cursor = Cursors[CU];
+    if (!Cursor) {
+      Cursor = llvm::make_unique<UnitCursor>(*CU);
+      if (Spec.FLIKind != FileLineInfoKind::None)
+        Cursor->LineTable = getLineTableForUnit(CU);
+      if (Cursor->LineTable)
+        Cursor->Lines.emplace(*Cursor->LineTable);
+    }
+
+    DWARFDie Subroutine =
+        Cursor->Subroutines.getSubroutineForAddress(Address.Address);
+    if (!Subroutine) {
+      // As in getInliningInfoForAddress, fall back to the line table.
+      DILineInfo Frame;
+      if (Cursor->Lines &&
+          Cursor->Lines->getFileLineInfoForAddress(
+              Address, CU->getCompilationDir(), Spec.FLIKind, Frame))
+        InliningInfo.addFrame(Frame);
+      continue;
+    }
+
+    // Neighbouring addresses mostly share their innermost subroutine, so
+    // only build the frames again when it changes.
+    if (Subroutine != Cursor->Subroutine) {
+      SmallVector<DWARFDie, 4> InlinedChain;
+      DWARFUnit::getInlinedChainForSubroutine(Subroutine, InlinedChain);
+      Cursor->Subroutine = Subroutine;
+      Cursor->Frames = DIInliningInfo();
+      addInlinedFrames(CU, InlinedChain, Cursor->LineTable, Spec,
+                       Cursor->Frames);
+    }
+    InliningInfo = Cursor->Frames;
+    if (Cursor->Lines)
+      Cursor->Lines->getFileLineInfoForAddress(
+          Address, CU->getCompilationDir(), Spec.FLIKind,
+          *InliningInfo.getMutableFrame(0));
+  }
+  return Result;
+}
+
 std::shared_ptr<DWARFContext>
 DWARFContext::getDWOContext(StringRef AbsolutePath) {
   if (auto S = DWP.lock()) {
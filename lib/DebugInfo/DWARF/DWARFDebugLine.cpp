@@ -925,6 +925,77 @@ uint32_t DWARFDebugLine::LineTable::lookupAddressImpl(
   return findRowInSeq(*It, Address);
 }
 
+DWARFDebugLine::LineTable::Cursor::Cursor(const LineTable &LT) : LT(LT) {
+  reset(Relocatable, LT.Sequences.begin());
+  reset(Absolute, LT.Sequences.begin());
+  // Start below every address, whichever section it is in.
+  Relocatable.Last = Absolute.Last = object::SectionedAddress(0, 0);
+}
+
+void DWARFDebugLine::LineTable::Cursor::reset(Position &Pos,
+                                              SequenceIter Seq) {
+  Pos.Seq = Seq;
+  if (Seq != LT.Sequences.end())
+    Pos.Row = LT.Rows.begin() + Seq->FirstRowIndex + 1;
+}
+
+uint32_t DWARFDebugLine::LineTable::Cursor::lookupAddress(
+    object::SectionedAddress Address) {
+  if (Address.SectionIndex == object::SectionedAddress::UndefSection)
+    return lookupAddressImpl(Absolute, Address);
+
+  // Search for relocatable addresses, then for absolute ones, just like
+  // LineTable::lookupAddress.
+  uint32_t Result = lookupAddressImpl(Relocatable, Address);
+  if (Result != LT.UnknownRowIndex)
+    return Result;
+  Address.SectionIndex = object::SectionedAddress::UndefSection;
+  return lookupAddressImpl(Absolute, Address);
+}
+
+uint32_t DWARFDebugLine::LineTable::Cursor::lookupAddressImpl(
+    Position &Pos, object::SectionedAddress Address) {
+  DWARFDebugLine::Sequence Sequence;
+  Sequence.SectionIndex = Address.SectionIndex;
+  Sequence.HighPC = Address.Address;
+  DWARFDebugLine::Row Row;
+  Row.Address = Address;
+
+  // The upper bounds below only move forward as long as the addresses do, so
+  // start over with a binary search when an address goes backwards.
+  if (std::tie(Address.SectionIndex, Address.Address) <
+      std::tie(Pos.Last.SectionIndex, Pos.Last.Address)) {
+    reset(Pos, llvm::upper_bound(LT.Sequences, Sequence,
+                                 DWARFDebugLine::Sequence::orderByHighPC));
+  } else {
+    SequenceIter Seq = Pos.Seq;
+    while (Seq != LT.Sequences.end() &&
+           !DWARFDebugLine::Sequence::orderByHighPC(Sequence, *Seq))
+      ++Seq;
+    if (Seq != Pos.Seq)
+      reset(Pos, Seq);
+  }
+  Pos.Last = Address;
+
+  if (Pos.Seq == LT.Sequences.end() || !Pos.Seq->containsPC(Address))
+    return LT.UnknownRowIndex;
+  // As in findRowInSeq, we want the last row whose address is less than or
+  // equal to Address, searching no further than the row before the end of
+  // the sequence.
+  RowIter LastRow = LT.Rows.begin() + Pos.Seq->LastRowIndex - 1;
+  while (Pos.Row != LastRow &&
+         !DWARFDebugLine::Row::orderByAddress(Row, *Pos.Row))
+    ++Pos.Row;
+  return (Pos.Row - 1) - LT.Rows.begin();
+}
+
+bool DWARFDebugLine::LineTable::Cursor::getFileLineInfoForAddress(
+    object::SectionedAddress Address, const char *CompDir,
+    FileLineInfoKind Kind, DILineInfo &Result) {
+  return LT.getFileLineInfoForRow(lookupAddress(Address), CompDir, Kind,
+                                  Result);
+}
+
 bool DWARFDebugLine::LineTable::lookupAddressRange(
     object::SectionedAddress Address, uint64_t Size,
     std::vector<uint32_t> &Result) const {
@@ -1050,6 +1121,12 @@ bool DWARFDebugLine::LineTable::getFileLineInfoForAddress(
     FileLineInfoKind Kind, DILineInfo &Result) const {
   // Get the index of row we're looking for in the line table.
   uint32_t RowIndex = lookupAddress(Address);
+  return getFileLineInfoForRow(RowIndex, CompDir, Kind, Result);
+}
+
+bool DWARFDebugLine::LineTable::getFileLineInfoForRow(
+    uint32_t RowIndex, const char *CompDir, FileLineInfoKind Kind,
+    DILineInfo &Result) const {
   if (RowIndex == -1U)
     return false;
   // Take file number and line/column from the row.
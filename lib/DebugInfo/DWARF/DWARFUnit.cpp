@@ -647,6 +647,12 @@ DWARFUnit::getInlinedChainForAddress(uint64_t Address,
   if (!SubroutineDIE)
     return;
 
+  getInlinedChainForSubroutine(SubroutineDIE, InlinedChain);
+}
+
+void DWARFUnit::getInlinedChainForSubroutine(
+    DWARFDie SubroutineDIE, SmallVectorImpl<DWARFDie> &InlinedChain) {
+  assert(InlinedChain.empty());
   while (!SubroutineDIE.isSubprogramDIE()) {
     if (SubroutineDIE.getTag() == DW_TAG_inlined_subroutine)
       InlinedChain.push_back(SubroutineDIE);
@@ -655,6 +661,32 @@ DWARFUnit::getInlinedChainForAddress(uint64_t Address,
   InlinedChain.push_back(SubroutineDIE);
 }
 
+DWARFUnit::SubroutineCursor::SubroutineCursor(DWARFUnit &U) {
+  U.parseDWO();
+  DWARFUnit &Unit = U.DWO ? *U.DWO : U;
+  Unit.extractDIEsIfNeeded(false);
+  if (Unit.AddrDieMap.empty())
+    Unit.updateAddressDieMap(Unit.getUnitDIE());
+  Map = &Unit.AddrDieMap;
+  Next = Map->begin();
+}
+
+DWARFDie
+DWARFUnit::SubroutineCursor::getSubroutineForAddress(uint64_t Address) {
+  if (Address < LastAddress)
+    Next = Map->upper_bound(Address);
+  LastAddress = Address;
+  while (Next != Map->end() && Next->first <= Address)
+    ++Next;
+  if (Next == Map->begin())
+    return DWARFDie();
+  // The previous item is the only one that can contain Address.
+  auto R = std::prev(Next);
+  if (Address >= R->second.first)
+    return DWARFDie();
+  return R->second.second;
+}
+
 const DWARFUnitIndex &llvm::getDWARFUnitIndex(DWARFContext &Context,
                                               DWARFSectionKind Kind) {
   if (Kind == DW_SECT_INFO)
@@ -16,6 +16,8 @@
 #include "llvm/DebugInfo/DWARF/DWARFSection.h"
 #include "llvm/Support/DJB.h"
 #include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/WithColor.h"
 #include "llvm/Support/raw_ostream.h"
 #include <map>
@@ -280,17 +282,29 @@ unsigned DWARFVerifier::verifyUnitSection(const DWARFSection &S,
   bool hasDIE = DebugInfoData.isValidOffset(Offset);
   DWARFUnitVector TypeUnitVector;
   DWARFUnitVector CompileUnitVector;
+  // With more than one thread, the header chain is still walked here, but the
+  // messages about each header are buffered and the unit contents are
+  // verified by verifyInParallel() once all units are known.
+  bool Parallel = NumThreads > 1;
+  std::vector<std::pair<DWARFUnit *, std::string>> UnitItems;
   while (hasDIE) {
     OffsetStart = Offset;
-    if (!verifyUnitHeader(DebugInfoData, &Offset, UnitIdx, UnitType,
-                          isUnitDWARF64)) {
+    std::string HeaderLog;
+    raw_string_ostream HeaderOS(HeaderLog);
+    DWARFVerifier BufferedVerifier(HeaderOS, DCtx, DumpOpts);
+    DWARFVerifier &HeaderVerifier = Parallel ? BufferedVerifier : *this;
+    DWARFUnit *Unit = nullptr;
+    if (!HeaderVerifier.verifyUnitHeader(DebugInfoData, &Offset, UnitIdx,
+                                         UnitType, isUnitDWARF64)) {
       isHeaderChainValid = false;
-      if (isUnitDWARF64)
+      if (isUnitDWARF64) {
+        if (Parallel)
+          UnitItems.emplace_back(nullptr, std::move(HeaderOS.str()));
         break;
+      }
     } else {
       DWARFUnitHeader Header;
       Header.extract(DCtx, DebugInfoData, &OffsetStart, SectionKind);
-      DWARFUnit *Unit;
       switch (UnitType) {
       case dwarf::DW_UT_type:
       case dwarf::DW_UT_split_type: {
@@ -318,11 +332,32 @@ unsigned DWARFVerifier::verifyUnitSection(const DWARFSection &S,
       }
       default: { llvm_unreachable("Invalid UnitType."); }
       }
-      NumDebugInfoErrors += verifyUnitContents(*Unit);
+      if (!Parallel)
+        NumDebugInfoErrors += verifyUnitContents(*Unit);
     }
+    if (Parallel)
+      UnitItems.emplace_back(Unit, std::move(HeaderOS.str()));
     hasDIE = DebugInfoData.isValidOffset(Offset);
     ++UnitIdx;
   }
+  if (Parallel) {
+    // References to other units and DIE dumps in error messages reach into
+    // state that is parsed lazily; parse it before going parallel.
+    for (const auto &Item : UnitItems) {
+      if (DWARFUnit *Unit = Item.first) {
+        Unit->getNumDIEs();
+        DCtx.getLineTableForUnit(Unit);
+      }
+    }
+    DCtx.getDebugLoc();
+    NumDebugInfoErrors += verifyInParallel(
+        UnitItems.size(), [&](DWARFVerifier &Verifier, size_t I) {
+          Verifier.OS << UnitItems[I].second;
+          if (DWARFUnit *Unit = UnitItems[I].first)
+            return Verifier.verifyUnitContents(*Unit);
+          return 0u;
+        });
+  }
   if (UnitIdx == 0 && !hasDIE) {
     warn() << "Section is empty.\n";
     isHeaderChainValid = true;
@@ -693,6 +728,14 @@ void DWARFVerifier::verifyDebugLineStmtOffsets() {
 }
 
 void DWARFVerifier::verifyDebugLineRows() {
+  // Line tables are parsed and cached by DCtx, so look them up in order here
+  // and only verify their contents in parallel.
+  struct LineTableItem {
+    DWARFUnit *CU;
+    DWARFDie Die;
+    const DWARFDebugLine::LineTable *LineTable;
+  };
+  std::vector<LineTableItem> Items;
   for (const auto &CU : DCtx.compile_units()) {
     auto Die = CU->getUnitDIE();
     auto LineTable = DCtx.getLineTableForUnit(CU.get());
@@ -700,86 +743,98 @@ void DWARFVerifier::verifyDebugLineRows() {
     // .debug_info verifier or in verifyDebugLineStmtOffsets().
     if (!LineTable)
       continue;
+    Items.push_back({CU.get(), Die, LineTable});
+  }
+  NumDebugLineErrors +=
+      verifyInParallel(Items.size(), [&](DWARFVerifier &Verifier, size_t I) {
+        return Verifier.verifyDebugLineRows(*Items[I].CU, Items[I].Die,
+                                            *Items[I].LineTable);
+      });
+}
 
-    // Verify prologue.
-    uint32_t MaxDirIndex = LineTable->Prologue.IncludeDirectories.size();
-    uint32_t FileIndex = 1;
-    StringMap<uint16_t> FullPathMap;
-    for (const auto &FileName : LineTable->Prologue.FileNames) {
-      // Verify directory index.
-      if (FileName.DirIdx > MaxDirIndex) {
-        ++NumDebugLineErrors;
-        error() << ".debug_line["
-                << format("0x%08" PRIx64,
-                          *toSectionOffset(Die.find(DW_AT_stmt_list)))
-                << "].prologue.file_names[" << FileIndex
-                << "].dir_idx contains an invalid index: " << FileName.DirIdx
-                << "\n";
-      }
-
-      // Check file paths for duplicates.
-      std::string FullPath;
-      const bool HasFullPath = LineTable->getFileNameByIndex(
-          FileIndex, CU->getCompilationDir(),
-          DILineInfoSpecifier::FileLineInfoKind::AbsoluteFilePath, FullPath);
-      assert(HasFullPath && "Invalid index?");
-      (void)HasFullPath;
-      auto It = FullPathMap.find(FullPath);
-      if (It == FullPathMap.end())
-        FullPathMap[FullPath] = FileIndex;
-      else if (It->second != FileIndex) {
-        warn() << ".debug_line["
-               << format("0x%08" PRIx64,
-                         *toSectionOffset(Die.find(DW_AT_stmt_list)))
-               << "].prologue.file_names[" << FileIndex
-               << "] is a duplicate of file_names[" << It->second << "]\n";
-      }
+unsigned
+DWARFVerifier::verifyDebugLineRows(DWARFUnit &CU, const DWARFDie &Die,
+                                   const DWARFDebugLine::LineTable &LineTable) {
+  unsigned NumErrors = 0;
+  // Verify prologue.
+  uint32_t MaxDirIndex = LineTable.Prologue.IncludeDirectories.size();
+  uint32_t FileIndex = 1;
+  StringMap<uint16_t> FullPathMap;
+  for (const auto &FileName : LineTable.Prologue.FileNames) {
+    // Verify directory index.
+    if (FileName.DirIdx > MaxDirIndex) {
+      ++NumErrors;
+      error() << ".debug_line["
+              << format("0x%08" PRIx64,
+                        *toSectionOffset(Die.find(DW_AT_stmt_list)))
+              << "].prologue.file_names[" << FileIndex
+              << "].dir_idx contains an invalid index: " << FileName.DirIdx
+              << "\n";
+    }
 
-      FileIndex++;
+    // Check file paths for duplicates.
+    std::string FullPath;
+    const bool HasFullPath = LineTable.getFileNameByIndex(
+        FileIndex, CU.getCompilationDir(),
+        DILineInfoSpecifier::FileLineInfoKind::AbsoluteFilePath, FullPath);
+    assert(HasFullPath && "Invalid index?");
+    (void)HasFullPath;
+    auto It = FullPathMap.find(FullPath);
+    if (It == FullPathMap.end())
+      FullPathMap[FullPath] = FileIndex;
+    else if (It->second != FileIndex) {
+      warn() << ".debug_line["
+             << format("0x%08" PRIx64,
+                       *toSectionOffset(Die.find(DW_AT_stmt_list)))
+             << "].prologue.file_names[" << FileIndex
+             << "] is a duplicate of file_names[" << It->second << "]\n";
     }
 
-    // Verify rows.
-    uint64_t PrevAddress = 0;
-    uint32_t RowIndex = 0;
-    for (const auto &Row : LineTable->Rows) {
-      // Verify row address.
-      if (Row.Address.Address < PrevAddress) {
-        ++NumDebugLineErrors;
-        error() << ".debug_line["
-                << format("0x%08" PRIx64,
-                          *toSectionOffset(Die.find(DW_AT_stmt_list)))
-                << "] row[" << RowIndex
-                << "] decreases in address from previous row:\n";
-
-        DWARFDebugLine::Row::dumpTableHeader(OS);
-        if (RowIndex > 0)
-          LineTable->Rows[RowIndex - 1].dump(OS);
-        Row.dump(OS);
-        OS << '\n';
-      }
+    FileIndex++;
+  }
 
-      // Verify file index.
-      if (!LineTable->hasFileAtIndex(Row.File)) {
-        ++NumDebugLineErrors;
-        bool isDWARF5 = LineTable->Prologue.getVersion() >= 5;
-        error() << ".debug_line["
-                << format("0x%08" PRIx64,
-                          *toSectionOffset(Die.find(DW_AT_stmt_list)))
-                << "][" << RowIndex << "] has invalid file index " << Row.File
-                << " (valid values are [" << (isDWARF5 ? "0," : "1,")
-                << LineTable->Prologue.FileNames.size()
-                << (isDWARF5 ? ")" : "]") << "):\n";
-        DWARFDebugLine::Row::dumpTableHeader(OS);
-        Row.dump(OS);
-        OS << '\n';
-      }
-      if (Row.EndSequence)
-        PrevAddress = 0;
-      else
-        PrevAddress = Row.Address.Address;
-      ++RowIndex;
+  // Verify rows.
+  uint64_t PrevAddress = 0;
+  uint32_t RowIndex = 0;
+  for (const auto &Row : LineTable.Rows) {
+    // Verify row address.
+    if (Row.Address.Address < PrevAddress) {
+      ++NumErrors;
+      error() << ".debug_line["
+              << format("0x%08" PRIx64,
+                        *toSectionOffset(Die.find(DW_AT_stmt_list)))
+              << "] row[" << RowIndex
+              << "] decreases in address from previous row:\n";
+
+      DWARFDebugLine::Row::dumpTableHeader(OS);
+      if (RowIndex > 0)
+        LineTable.Rows[RowIndex - 1].dump(OS);
+      Row.dump(OS);
+      OS << '\n';
+    }
+
+    // Verify file index.
+    if (!LineTable.hasFileAtIndex(Row.File)) {
+      ++NumErrors;
+      bool isDWARF5 = LineTable.Prologue.getVersion() >= 5;
+      error() << ".debug_line["
+              << format("0x%08" PRIx64,
+                        *toSectionOffset(Die.find(DW_AT_stmt_list)))
+              << "][" << RowIndex << "] has invalid file index " << Row.File
+              << " (valid values are [" << (isDWARF5 ? "0," : "1,")
+              << LineTable.Prologue.FileNames.size()
+              << (isDWARF5 ? ")" : "]") << "):\n";
+      DWARFDebugLine::Row::dumpTableHeader(OS);
+      Row.dump(OS);
+      OS << '\n';
     }
+    if (Row.EndSequence)
+      PrevAddress = 0;
+    else
+      PrevAddress = Row.Address.Address;
+    ++RowIndex;
   }
+  return NumErrors;
 }
 
 DWARFVerifier::DWARFVerifier(raw_ostream &S, DWARFContext &D,
@@ -790,6 +845,42 @@ DWARFVerifier::DWARFVerifier(raw_ostream &S, DWARFContext &D,
     IsObjectFile = F->isRelocatableObject();
     IsMachOObject = F->isMachO();
   }
+  NumThreads = this->DumpOpts.VerifyThreads;
+  if (NumThreads == 0)
+    NumThreads = hardware_concurrency();
+}
+
+unsigned DWARFVerifier::verifyInParallel(
+    size_t NumItems, function_ref<unsigned(DWARFVerifier &, size_t)> Verify) {
+  unsigned NumErrors = 0;
+  if (NumThreads <= 1 || NumItems <= 1) {
+    for (size_t I = 0; I != NumItems; ++I)
+      NumErrors += Verify(*this, I);
+    return NumErrors;
+  }
+
+  std::vector<std::string> Logs(NumItems);
+  std::vector<unsigned> ItemErrors(NumItems);
+  std::vector<std::map<uint64_t, std::set<uint32_t>>> ItemReferences(NumItems);
+  ThreadPool Pool(std::min<size_t>(NumThreads, NumItems));
+  for (size_t I = 0; I != NumItems; ++I) {
+    Pool.async([&, I] {
+      raw_string_ostream LogOS(Logs[I]);
+      DWARFVerifier Verifier(LogOS, DCtx, DumpOpts);
+      ItemErrors[I] = Verify(Verifier, I);
+      ItemReferences[I] = std::move(Verifier.ReferenceToDIEOffsets);
+    });
+  }
+  Pool.wait();
+
+  for (size_t I = 0; I != NumItems; ++I) {
+    OS << Logs[I];
+    NumErrors += ItemErrors[I];
+    for (auto &Ref : ItemReferences[I])
+      ReferenceToDIEOffsets[Ref.first].insert(Ref.second.begin(),
+                                              Ref.second.end());
+  }
+  return NumErrors;
 }
 
 bool DWARFVerifier::handleDebugLine() {
@@ -1442,14 +1533,38 @@ unsigned DWARFVerifier::verifyDebugNames(const DWARFSection &AccelSection,
   if (NumErrors > 0)
     return NumErrors;
 
+  // Only the DIEs that have been extracted so far are checked for each unit.
+  struct CompletenessItem {
+    DWARFCompileUnit *CU;
+    const DWARFDebugNames::NameIndex *NI;
+    size_t NumDies;
+  };
+  std::vector<CompletenessItem> Items;
   for (const std::unique_ptr<DWARFUnit> &U : DCtx.compile_units()) {
     if (const DWARFDebugNames::NameIndex *NI =
             AccelTable.getCUNameIndex(U->getOffset())) {
       auto *CU = cast<DWARFCompileUnit>(U.get());
-      for (const DWARFDebugInfoEntry &Die : CU->dies())
-        NumErrors += verifyNameIndexCompleteness(DWARFDie(CU, &Die), *NI);
+      Items.push_back({CU, NI, size_t(llvm::size(CU->dies()))});
     }
   }
+  if (NumThreads > 1 && Items.size() > 1) {
+    // Names of DIEs are looked up through references that may cross units;
+    // make sure all units are parsed before going parallel.
+    for (const std::unique_ptr<DWARFUnit> &U : DCtx.compile_units())
+      U->getNumDIEs();
+    DCtx.getDebugLoc();
+  }
+  NumErrors +=
+      verifyInParallel(Items.size(), [&](DWARFVerifier &Verifier, size_t I) {
+        const CompletenessItem &Item = Items[I];
+        unsigned NumItemErrors = 0;
+        auto Dies = Item.CU->dies();
+        for (const DWARFDebugInfoEntry &Die :
+             make_range(Dies.begin(), Dies.begin() + Item.NumDies))
+          NumItemErrors += Verifier.verifyNameIndexCompleteness(
+              DWARFDie(Item.CU, &Die), *Item.NI);
+        return NumItemErrors;
+      });
   return NumErrors;
 }
 
@@ -271,7 +271,32 @@ DIInliningInfo SymbolizableObjectFile::symbolizeInlinedCode(
         getModuleSectionIndexForAddress(ModuleOffset.Address);
   DIInliningInfo InlinedContext = DebugInfoContext->getInliningInfoForAddress(
       ModuleOffset, getDILineInfoSpecifier(FNKind));
+  completeInlinedContext(ModuleOffset.Address, FNKind, UseSymbolTable,
+                         InlinedContext);
+  return InlinedContext;
+}
+
+std::vector<DIInliningInfo> SymbolizableObjectFile::symbolizeInlinedCode(
+    ArrayRef<object::SectionedAddress> ModuleOffsets, FunctionNameKind FNKind,
+    bool UseSymbolTable) const {
+  std::vector<object::SectionedAddress> Offsets(ModuleOffsets.begin(),
+                                                ModuleOffsets.end());
+  for (object::SectionedAddress &ModuleOffset : Offsets)
+    if (ModuleOffset.SectionIndex == object::SectionedAddress::UndefSection)
+      ModuleOffset.SectionIndex =
+          getModuleSectionIndexForAddress(ModuleOffset.Address);
+  std::vector<DIInliningInfo> InlinedContexts =
+      DebugInfoContext->getInliningInfoForAddresses(
+          Offsets, getDILineInfoSpecifier(FNKind));
+  for (size_t I = 0, E = Offsets.size(); I != E; ++I)
+    completeInlinedContext(Offsets[I].Address, FNKind, UseSymbolTable,
+                           InlinedContexts[I]);
+  return InlinedContexts;
+}
 
+void SymbolizableObjectFile::completeInlinedContext(
+    uint64_t Address, FunctionNameKind FNKind, bool UseSymbolTable,
+    DIInliningInfo &InlinedContext) const {
   // Make sure there is at least one frame in context.
   if (InlinedContext.getNumberOfFrames() == 0)
     InlinedContext.addFrame(DILineInfo());
@@ -280,14 +305,12 @@ DIInliningInfo SymbolizableObjectFile::symbolizeInlinedCode(
   if (shouldOverrideWithSymbolTable(FNKind, UseSymbolTable)) {
     std::string FunctionName;
     uint64_t Start, Size;
-    if (getNameFromSymbolTable(SymbolRef::ST_Function, ModuleOffset.Address,
-                               FunctionName, Start, Size)) {
+    if (getNameFromSymbolTable(SymbolRef::ST_Function, Address, FunctionName,
+                               Start, Size)) {
       InlinedContext.getMutableFrame(InlinedContext.getNumberOfFrames() - 1)
           ->FunctionName = FunctionName;
     }
   }
-
-  return InlinedContext;
 }
 
 DIGlobal SymbolizableObjectFile::symbolizeData(
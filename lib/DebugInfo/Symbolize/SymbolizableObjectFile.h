@@ -39,6 +39,10 @@ public:
   DIInliningInfo symbolizeInlinedCode(object::SectionedAddress ModuleOffset,
                                       FunctionNameKind FNKind,
                                       bool UseSymbolTable) const override;
+  std::vector<DIInliningInfo>
+  symbolizeInlinedCode(ArrayRef<object::SectionedAddress> ModuleOffsets,
+                       FunctionNameKind FNKind,
+                       bool UseSymbolTable) const override;
   DIGlobal symbolizeData(object::SectionedAddress ModuleOffset) const override;
   std::vector<DILocal>
   symbolizeFrame(object::SectionedAddress ModuleOffset) const override;
@@ -54,6 +58,11 @@ private:
   bool shouldOverrideWithSymbolTable(FunctionNameKind FNKind,
                                      bool UseSymbolTable) const;
 
+  // Fills in what the debug info left out of an inlined context.
+  void completeInlinedContext(uint64_t Address, FunctionNameKind FNKind,
+                              bool UseSymbolTable,
+                              DIInliningInfo &InlinedContext) const;
+
   bool getNameFromSymbolTable(object::SymbolRef::Type Type, uint64_t Address,
                               std::string &Name, uint64_t &Addr,
                               uint64_t &Size) const;
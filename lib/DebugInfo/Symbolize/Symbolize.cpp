@@ -127,6 +127,42 @@ LLVMSymbolizer::symbolizeInlinedCode(const std::string &ModuleName,
   return InlinedContext;
 }
 
+Expected<std::vector<DIInliningInfo>>
+LLVMSymbolizer::symbolizeInlinedCode(
+    const std::string &ModuleName,
+    ArrayRef<object::SectionedAddress> ModuleOffsets) {
+  SymbolizableModule *Info;
+  if (auto InfoOrErr = getOrCreateModuleInfo(ModuleName))
+    Info = InfoOrErr.get();
+  else
+    return InfoOrErr.takeError();
+
+  // A null module means an error has already been reported. Return empty
+  // results.
+  if (!Info)
+    return std::vector<DIInliningInfo>(ModuleOffsets.size());
+
+  // If the user is giving us relative addresses, add the preferred base of the
+  // object to the offsets before we do the query. It's what DIContext expects.
+  std::vector<object::SectionedAddress> Offsets(ModuleOffsets.begin(),
+                                                ModuleOffsets.end());
+  if (Opts.RelativeAddresses)
+    for (object::SectionedAddress &ModuleOffset : Offsets)
+      ModuleOffset.Address += Info->getModulePreferredBase();
+
+  std::vector<DIInliningInfo> InlinedContexts = Info->symbolizeInlinedCode(
+      Offsets, Opts.PrintFunctions, Opts.UseSymbolTable);
+  if (Opts.Demangle) {
+    for (DIInliningInfo &InlinedContext : InlinedContexts) {
+      for (int i = 0, n = InlinedContext.getNumberOfFrames(); i < n; i++) {
+        auto *Frame = InlinedContext.getMutableFrame(i);
+        Frame->FunctionName = DemangleName(Frame->FunctionName, Info);
+      }
+    }
+  }
+  return InlinedContexts;
+}
+
 Expected<DIGlobal>
 LLVMSymbolizer::symbolizeData(const std::string &ModuleName,
                               object::SectionedAddress ModuleOffset) {
@@ -7,12 +7,21 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/ExecutionEngine/Orc/CompileOnDemandLayer.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
 #include "llvm/IR/Mangler.h"
 #include "llvm/IR/Module.h"
 
 using namespace llvm;
 using namespace llvm::orc;
 
+#define DEBUG_TYPE "orc"
+
+STATISTIC(NumSpeculativeLookups, "Number of speculative lookups issued");
+STATISTIC(NumSpeculationsDropped,
+          "Number of speculative compiles dropped at the in-flight limit");
+
 static ThreadSafeModule extractSubModule(ThreadSafeModule &TSM,
                                          StringRef Suffix,
                                          GVPredicate ShouldExtract) {
@@ -285,6 +294,14 @@ void CompileOnDemandLayer::emitPartition(
 
   expandPartition(*GVsToExtract);
 
+  // Find the functions worth compiling ahead of their first call while their
+  // bodies are still in the source module.
+  SymbolNameSet SpeculationCandidates;
+  if (SpeculationLimit)
+    SpeculationCandidates =
+        getSpeculationCandidates(*TSM.getModule(), *GVsToExtract);
+  auto &ImplD = R.getTargetJITDylib();
+
   // Extract the requested partiton (plus any necessary aliases) and
   // put the rest back into the impl dylib.
   auto ShouldExtract = [&](const GlobalValue &GV) -> bool {
@@ -296,6 +313,58 @@ void CompileOnDemandLayer::emitPartition(
       ES, std::move(TSM), R.getVModuleKey(), *this));
 
   BaseLayer.emit(std::move(R), std::move(ExtractedTSM));
+
+  if (!SpeculationCandidates.empty())
+    speculate(ImplD, SpeculationCandidates);
+}
+
+SymbolNameSet
+CompileOnDemandLayer::getSpeculationCandidates(const Module &M,
+                                               const GlobalValueSet &Partition) {
+  // The likely next functions to run are those called directly from the
+  // partition. Functions without a body have been emitted already.
+  MangleAndInterner Mangle(getExecutionSession(), M.getDataLayout());
+  SymbolNameSet Candidates;
+  for (auto *GV : Partition) {
+    auto *F = dyn_cast<Function>(GV);
+    if (!F || F->isDeclaration())
+      continue;
+    for (auto &I : instructions(*F)) {
+      auto *Call = dyn_cast<CallBase>(&I);
+      if (!Call)
+        continue;
+      auto *Callee = Call->getCalledFunction();
+      if (!Callee || Callee->isDeclaration() || Callee->hasLocalLinkage() ||
+          !Callee->hasName() || Partition.count(Callee))
+        continue;
+      Candidates.insert(Mangle(Callee->getName()));
+    }
+  }
+  return Candidates;
+}
+
+void CompileOnDemandLayer::speculate(JITDylib &ImplD,
+                                     const SymbolNameSet &Names) {
+  auto &ES = getExecutionSession();
+  for (auto &Name : Names) {
+    // Keep speculation from crowding out the compiles that a caller is
+    // actually waiting for.
+    if (SpeculationsInFlight.fetch_add(1) >= SpeculationLimit) {
+      --SpeculationsInFlight;
+      ++NumSpeculationsDropped;
+      continue;
+    }
+
+    ++NumSpeculativeLookups;
+    LLVM_DEBUG(dbgs() << "Speculatively compiling " << Name << "\n");
+    ES.lookup(JITDylibSearchList({{&ImplD, true}}), {Name}, SymbolState::Ready,
+              [this, &ES](Expected<SymbolMap> Result) {
+                if (!Result)
+                  ES.reportError(Result.takeError());
+                --SpeculationsInFlight;
+              },
+              NoDependenciesToRegister);
+  }
 }
 
 } // end namespace orc
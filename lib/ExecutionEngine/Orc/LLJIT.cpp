@@ -15,6 +15,8 @@
 namespace llvm {
 namespace orc {
 
+void CompileEventListener::anchor() {}
+
 Error LLJITBuilderState::prepareForConstruction() {
 
   if (!JTMB) {
@@ -82,13 +84,30 @@ LLJIT::createCompileFunction(LLJITBuilderState &S,
   // Otherwise default to creating a SimpleCompiler, or ConcurrentIRCompiler,
   // depending on the number of threads requested.
   if (S.NumCompileThreads > 0)
-    return ConcurrentIRCompiler(std::move(JTMB));
+    return ConcurrentIRCompiler(std::move(JTMB), S.ObjCache);
 
   auto TM = JTMB.createTargetMachine();
   if (!TM)
     return TM.takeError();
 
-  return TMOwningSimpleCompiler(std::move(*TM));
+  return TMOwningSimpleCompiler(std::move(*TM), S.ObjCache);
+}
+
+IRCompileLayer::CompileFunction
+LLJIT::notifyCompiles(IRCompileLayer::CompileFunction Compile,
+                      std::vector<CompileEventListener *> Listeners) {
+  return [Compile, Listeners](Module &M)
+             -> Expected<std::unique_ptr<MemoryBuffer>> {
+    auto Start = std::chrono::steady_clock::now();
+    auto Obj = Compile(M);
+    if (!Obj)
+      return Obj.takeError();
+    auto Latency = std::chrono::steady_clock::now() - Start;
+    for (auto *L : Listeners)
+      L->notifyModuleCompiled(
+          M, std::chrono::duration_cast<std::chrono::nanoseconds>(Latency));
+    return Obj;
+  };
 }
 
 LLJIT::LLJIT(LLJITBuilderState &S, Error &Err)
@@ -113,6 +132,9 @@ LLJIT::LLJIT(LLJITBuilderState &S, Error &Err)
       Err = CompileFunction.takeError();
       return;
     }
+    if (!S.CompileListeners.empty())
+      *CompileFunction = notifyCompiles(std::move(*CompileFunction),
+                                        std::move(S.CompileListeners));
     CompileLayer = llvm::make_unique<IRCompileLayer>(
         *ES, *ObjLinkingLayer, std::move(*CompileFunction));
   }
@@ -220,6 +242,16 @@ LLLazyJIT::LLLazyJIT(LLLazyJITBuilderState &S, Error &Err) : LLJIT(S, Err) {
 
   if (S.NumCompileThreads > 0)
     CODLayer->setCloneToNewContextOnEmit(true);
+
+  if (S.SpeculationLimit > 0) {
+    if (S.NumCompileThreads == 0) {
+      Err = make_error<StringError>(
+          "Speculative compilation requires compile threads",
+          inconvertibleErrorCode());
+      return;
+    }
+    CODLayer->setSpeculationLimit(S.SpeculationLimit);
+  }
 }
 
 } // End namespace orc.
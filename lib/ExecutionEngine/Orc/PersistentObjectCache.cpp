@@ -0,0 +1,148 @@
+//===- PersistentObjectCache.cpp - On-disk object cache for ORC -----------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/PersistentObjectCache.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA1.h"
+#include "llvm/Support/raw_ostream.h"
+
+#define DEBUG_TYPE "orc"
+
+using namespace llvm;
+using namespace llvm::orc;
+
+// Describe everything in JTMB that affects the generated code.
+static std::string getConfigKey(const JITTargetMachineBuilder &JTMB) {
+  std::string Key;
+  raw_string_ostream OS(Key);
+  OS << LLVM_VERSION_STRING << '\0' << JTMB.getTargetTriple().str() << '\0'
+     << JTMB.getCPU() << '\0' << JTMB.getFeatures().getString() << '\0';
+
+  auto &RM = JTMB.getRelocationModel();
+  auto &CM = JTMB.getCodeModel();
+  OS << (RM ? int(*RM) : -1) << ' ' << (CM ? int(*CM) : -1) << ' '
+     << int(JTMB.getCodeGenOptLevel());
+
+  const TargetOptions &TO = JTMB.getOptions();
+  for (unsigned Flag :
+       {TO.UnsafeFPMath, TO.NoInfsFPMath, TO.NoNaNsFPMath, TO.NoTrappingFPMath,
+        TO.NoSignedZerosFPMath, TO.HonorSignDependentRoundingFPMathOption,
+        TO.NoZerosInBSS, TO.GuaranteedTailCallOpt, TO.StackSymbolOrdering,
+        TO.EnableFastISel, TO.EnableGlobalISel, TO.UseInitArray,
+        TO.RelaxELFRelocations, TO.FunctionSections, TO.DataSections,
+        TO.UniqueSectionNames, TO.TrapUnreachable, TO.NoTrapAfterNoreturn,
+        TO.EmulatedTLS, TO.ExplicitEmulatedTLS, TO.EnableIPRA,
+        TO.EmitStackSizeSection, TO.EnableMachineOutliner, TO.EmitAddrsig,
+        TO.EnableDebugEntryValues})
+    OS << ' ' << Flag;
+  OS << ' ' << TO.StackAlignmentOverride << ' ' << int(TO.GlobalISelAbort)
+     << ' ' << int(TO.FloatABIType) << ' ' << int(TO.AllowFPOpFusion) << ' '
+     << int(TO.ThreadModel) << ' ' << int(TO.EABIVersion) << ' '
+     << int(TO.DebuggerTuning) << ' ' << int(TO.FPDenormalMode) << ' '
+     << int(TO.ExceptionModel);
+  return OS.str();
+}
+
+Expected<std::unique_ptr<PersistentObjectCache>>
+PersistentObjectCache::Create(StringRef CacheDir,
+                              const JITTargetMachineBuilder &JTMB) {
+  if (CacheDir.empty())
+    return make_error<StringError>("No object cache directory given",
+                                   inconvertibleErrorCode());
+  if (auto EC = sys::fs::create_directories(CacheDir))
+    return make_error<StringError>("Can't create object cache directory " +
+                                       CacheDir + ": " + EC.message(),
+                                   EC);
+  return std::unique_ptr<PersistentObjectCache>(
+      new PersistentObjectCache(CacheDir, getConfigKey(JTMB)));
+}
+
+std::string PersistentObjectCache::getKey(const Module &M) const {
+  SmallVector<char, 0> Bitcode;
+  {
+    BitcodeWriter W(Bitcode);
+    W.writeModule(M);
+    W.writeStrtab();
+  }
+
+  SHA1 Hasher;
+  Hasher.update(ConfigKey);
+  Hasher.update(ArrayRef<uint8_t>(
+      reinterpret_cast<const uint8_t *>(Bitcode.data()), Bitcode.size()));
+  return toHex(Hasher.result());
+}
+
+std::string PersistentObjectCache::getEntryPath(StringRef Key) const {
+  SmallString<128> Path(CacheDir);
+  sys::path::append(Path, "llvmcache-" + Key);
+  return Path.str();
+}
+
+void PersistentObjectCache::notifyObjectCompiled(const Module *M,
+                                                 MemoryBufferRef Obj) {
+  std::string EntryPath = getEntryPath(getKey(*M));
+
+  // Write the object to a temporary file and rename it into place, so that
+  // readers never see a partial entry. The temporary name must not start with
+  // "llvmcache-" or pruning would consider it an entry. Failing to write an
+  // entry only costs a recompile in the next run, so errors are dropped.
+  SmallString<128> TempModel(CacheDir);
+  sys::path::append(TempModel, "Orc-%%%%%%.tmp.o");
+  Expected<sys::fs::TempFile> Temp = sys::fs::TempFile::create(TempModel);
+  if (!Temp) {
+    consumeError(Temp.takeError());
+    return;
+  }
+
+  {
+    raw_fd_ostream OS(Temp->FD, /*shouldClose=*/false);
+    OS << Obj.getBuffer();
+    OS.flush();
+    if (OS.has_error()) {
+      OS.clear_error();
+      consumeError(Temp->discard());
+      return;
+    }
+  }
+
+  if (Error E = Temp->keep(EntryPath)) {
+    consumeError(std::move(E));
+    consumeError(Temp->discard());
+    return;
+  }
+  LLVM_DEBUG(dbgs() << "Cached object for " << M->getModuleIdentifier()
+                    << " in " << EntryPath << "\n");
+}
+
+std::unique_ptr<MemoryBuffer>
+PersistentObjectCache::getObject(const Module *M) {
+  std::string EntryPath = getEntryPath(getKey(*M));
+  ErrorOr<std::unique_ptr<MemoryBuffer>> Obj =
+      MemoryBuffer::getFile(EntryPath, /*FileSize=*/-1,
+                            /*RequiresNullTerminator=*/false);
+  if (!Obj) {
+    LLVM_DEBUG(dbgs() << "No cached object for " << M->getModuleIdentifier()
+                      << "\n");
+    return nullptr;
+  }
+  LLVM_DEBUG(dbgs() << "Using cached object " << EntryPath << " for "
+                    << M->getModuleIdentifier() << "\n");
+  return std::move(*Obj);
+}
+
+bool PersistentObjectCache::prune(const CachePruningPolicy &Policy) {
+  return pruneCache(CacheDir, Policy);
+}
@@ -66,6 +66,12 @@ STATISTIC(evaluateFixup, "Number of evaluated fixups");
 STATISTIC(FragmentLayouts, "Number of fragment layouts");
 STATISTIC(ObjectBytes, "Number of emitted object file bytes");
 STATISTIC(RelaxationSteps, "Number of assembler layout and relaxation steps");
+STATISTIC(SectionLayoutSteps, "Number of section layout passes");
+STATISTIC(SkippedSectionLayoutSteps,
+          "Number of section layout passes skipped for settled sections");
+STATISTIC(ReusedFixupEvaluations,
+          "Number of fixups not re-evaluated because their target did not "
+          "move");
 STATISTIC(RelaxedInstructions, "Number of relaxed instructions");
 STATISTIC(PaddingFragmentsRelaxations,
           "Number of Padding Fragments relaxations");
@@ -103,6 +109,8 @@ void MCAssembler::reset() {
   LinkerOptions.clear();
   FileNames.clear();
   ThumbFuncs.clear();
+  RelaxationCache.clear();
+  SettledSections.clear();
   BundleAlignSize = 0;
   RelaxAll = false;
   SubsectionsViaSymbols = false;
@@ -782,6 +790,8 @@ void MCAssembler::layout(MCAsmLayout &Layout) {
   }
 
   // Layout until everything fits.
+  RelaxationCache.clear();
+  SettledSections.clear();
   while (layoutOnce(Layout))
     if (getContext().hadError())
       return;
@@ -896,11 +906,97 @@ bool MCAssembler::fragmentNeedsRelaxation(const MCRelaxableFragment *F,
   return false;
 }
 
+/// If the value of \p Fixup is a label defined in \p Sec plus a constant,
+/// return the fragment defining that label. The fixup value then only depends
+/// on the offset of that fragment and, for PC-relative fixups, on the offset of
+/// the fixup itself.
+static const MCFragment *getLocalFixupTarget(const MCFixup &Fixup,
+                                             const MCSection &Sec) {
+  const MCExpr *Expr = Fixup.getValue();
+  if (const auto *BE = dyn_cast<MCBinaryExpr>(Expr))
+    if (BE->getOpcode() == MCBinaryExpr::Add &&
+        isa<MCConstantExpr>(BE->getRHS()))
+      Expr = BE->getLHS();
+
+  const auto *SRE = dyn_cast<MCSymbolRefExpr>(Expr);
+  if (!SRE || SRE->getKind() != MCSymbolRefExpr::VK_None)
+    return nullptr;
+  const MCSymbol &Sym = SRE->getSymbol();
+  if (Sym.isVariable() || Sym.isUndefined())
+    return nullptr;
+  const MCFragment *TF = Sym.getFragment();
+  if (!TF || TF->getParent() != &Sec)
+    return nullptr;
+  return TF;
+}
+
+bool MCAssembler::fragmentNeedsRelaxationIncremental(
+    const MCRelaxableFragment &F, const MCAsmLayout &Layout) {
+  assert(getBackendPtr() && "Expected assembler backend");
+  if (!getBackend().mayNeedRelaxation(F.getInst(), *F.getSubtargetInfo()))
+    return false;
+
+  ArrayRef<MCFixup> Fixups = F.getFixups();
+  auto CacheIt = RelaxationCache.find(&F);
+  bool HasCache =
+      CacheIt != RelaxationCache.end() && CacheIt->second.size() == Fixups.size();
+
+  SmallVector<RelaxedFixupLayout, 1> NewCache;
+  for (unsigned I = 0, E = Fixups.size(); I != E; ++I) {
+    const MCFixup &Fixup = Fixups[I];
+    const MCFragment *TF = getLocalFixupTarget(Fixup, *F.getParent());
+    if (!TF) {
+      if (fixupNeedsRelaxation(Fixup, &F, Layout)) {
+        RelaxationCache.erase(&F);
+        return true;
+      }
+      NewCache.push_back({false, 0, 0});
+      continue;
+    }
+
+    // Query the layout in the same order as evaluateFixup does, so that the
+    // fragments laid out by this pass do not depend on whether the fixup is
+    // re-evaluated.
+    unsigned Flags = getBackend().getFixupKindInfo(Fixup.getKind()).Flags;
+    bool IsPCRel = Flags & MCFixupKindInfo::FKF_IsPCRel;
+    uint64_t TargetOffset = Layout.getFragmentOffset(TF);
+    uint64_t FragmentOffset = IsPCRel ? Layout.getFragmentOffset(&F) : 0;
+
+    if (HasCache && CacheIt->second[I].Tracked) {
+      const RelaxedFixupLayout &Old = CacheIt->second[I];
+      uint64_t TargetDelta = TargetOffset - Old.TargetOffset;
+      uint64_t FragmentDelta = FragmentOffset - Old.FragmentOffset;
+      // A PC-relative value is unchanged if the fixup and its target moved
+      // together, unless the PC is aligned down and the move was not a
+      // multiple of the alignment.
+      bool Unchanged =
+          IsPCRel ? TargetDelta == FragmentDelta &&
+                        (!(Flags & MCFixupKindInfo::FKF_IsAlignedDownTo32Bits) ||
+                         (FragmentDelta & 3) == 0)
+                  : TargetDelta == 0;
+      if (Unchanged) {
+        ++stats::ReusedFixupEvaluations;
+        NewCache.push_back(Old);
+        continue;
+      }
+    }
+
+    if (fixupNeedsRelaxation(Fixup, &F, Layout)) {
+      RelaxationCache.erase(&F);
+      return true;
+    }
+    NewCache.push_back({true, FragmentOffset, TargetOffset});
+  }
+
+  RelaxationCache[&F] = std::move(NewCache);
+  return false;
+}
+
 bool MCAssembler::relaxInstruction(MCAsmLayout &Layout,
                                    MCRelaxableFragment &F) {
   assert(getEmitterPtr() &&
          "Expected CodeEmitter defined for relaxInstruction");
-  if (!fragmentNeedsRelaxation(&F, Layout))
+  if (!fragmentNeedsRelaxationIncremental(F, Layout))
     return false;
 
   ++stats::RelaxedInstructions;
@@ -1038,7 +1134,39 @@ bool MCAssembler::relaxCVDefRange(MCAsmLayout &Layout,
   return OldSize != F.getContents().size();
 }
 
+bool MCAssembler::isSectionLayoutSelfContained(const MCSection &Sec) const {
+  for (const MCFragment &F : Sec) {
+    switch (F.getKind()) {
+    case MCFragment::FT_Align:
+    case MCFragment::FT_CompactEncodedInst:
+    case MCFragment::FT_Data:
+      break;
+    case MCFragment::FT_Fill:
+      if (!isa<MCConstantExpr>(cast<MCFillFragment>(F).getNumValues()))
+        return false;
+      break;
+    case MCFragment::FT_Relaxable: {
+      const auto &RF = cast<MCRelaxableFragment>(F);
+      if (!getBackend().mayNeedRelaxation(RF.getInst(),
+                                          *RF.getSubtargetInfo()))
+        break;
+      for (const MCFixup &Fixup : RF.getFixups())
+        if (!getLocalFixupTarget(Fixup, Sec))
+          return false;
+      break;
+    }
+    default:
+      // Org, LEB, DWARF, CodeView and padding fragments may be sized from
+      // expressions over other sections, or by target state.
+      return false;
+    }
+  }
+  return true;
+}
+
 bool MCAssembler::layoutSectionOnce(MCAsmLayout &Layout, MCSection &Sec) {
+  ++stats::SectionLayoutSteps;
+
   // Holds the first fragment which needed relaxing during this layout. It will
   // remain NULL if none were relaxed.
   // When a fragment is relaxed, all the fragments following it should get
@@ -1096,8 +1224,16 @@ bool MCAssembler::layoutOnce(MCAsmLayout &Layout) {
   bool WasRelaxed = false;
   for (iterator it = begin(), ie = end(); it != ie; ++it) {
     MCSection &Sec = *it;
+    // Once a section stops relaxing and none of its fragments depend on other
+    // sections, another pass over it cannot change anything.
+    if (SettledSections.count(&Sec)) {
+      ++stats::SkippedSectionLayoutSteps;
+      continue;
+    }
     while (layoutSectionOnce(Layout, Sec))
       WasRelaxed = true;
+    if (isSectionLayoutSelfContained(Sec))
+      SettledSections.insert(&Sec);
   }
 
   return WasRelaxed;
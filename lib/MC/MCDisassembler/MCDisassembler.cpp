@@ -23,6 +23,10 @@ MCDisassembler::DecodeStatus MCDisassembler::onSymbolStart(
   return MCDisassembler::Success;
 }
 
+std::string MCDisassembler::getDecoderState() const { return std::string(); }
+
+void MCDisassembler::setDecoderState(StringRef State) {}
+
 bool MCDisassembler::tryAddingSymbolicOperand(MCInst &Inst, int64_t Value,
                                               uint64_t Address, bool IsBranch,
                                               uint64_t Offset,
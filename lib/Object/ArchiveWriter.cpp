@@ -14,14 +14,17 @@
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/BinaryFormat/Magic.h"
+#include "llvm/Bitcode/BitcodeReader.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/Object/Archive.h"
+#include "llvm/Object/IRSymtab.h"
 #include "llvm/Object/ObjectFile.h"
 #include "llvm/Object/SymbolicFile.h"
 #include "llvm/Support/EndianStream.h"
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/Format.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/raw_ostream.h"
@@ -345,6 +348,32 @@ static void writeSymbolTable(raw_ostream &Out, object::Archive::Kind Kind,
     Out.write(uint8_t(0));
 }
 
+// Read the archive symbols of a bitcode member from its irsymtab, which
+// records the same names and flags as IRObjectFile.  Bitcode written by this
+// version of LLVM already carries one, so its modules need not be loaded.
+// Returns false if the symbol table can not be read.
+static bool getIRSymtabSymbols(MemoryBufferRef Buf, raw_ostream &SymNames,
+                               std::vector<unsigned> &Ret) {
+  Expected<BitcodeFileContents> BFCOrErr = getBitcodeFileContents(Buf);
+  if (!BFCOrErr) {
+    consumeError(BFCOrErr.takeError());
+    return false;
+  }
+  Expected<irsymtab::FileContents> FCOrErr = irsymtab::readBitcode(*BFCOrErr);
+  if (!FCOrErr) {
+    consumeError(FCOrErr.takeError());
+    return false;
+  }
+
+  for (const irsymtab::Reader::SymbolRef &S : FCOrErr->TheReader.symbols()) {
+    if (S.isFormatSpecific() || !S.isGlobal() || S.isUndefined())
+      continue;
+    Ret.push_back(SymNames.tell());
+    SymNames << S.getName() << '\0';
+  }
+  return true;
+}
+
 static Expected<std::vector<unsigned>>
 getSymbols(MemoryBufferRef Buf, raw_ostream &SymNames, bool &HasObject) {
   std::vector<unsigned> Ret;
@@ -354,6 +383,10 @@ getSymbols(MemoryBufferRef Buf, raw_ostream &SymNames, bool &HasObject) {
   LLVMContext Context;
   std::unique_ptr<object::SymbolicFile> Obj;
   if (identify_magic(Buf.getBuffer()) == file_magic::bitcode) {
+    if (getIRSymtabSymbols(Buf, SymNames, Ret)) {
+      HasObject = true;
+      return Ret;
+    }
     auto ObjOrErr = object::SymbolicFile::createSymbolicFile(
         Buf, file_magic::bitcode, &Context);
     if (!ObjOrErr) {
@@ -384,6 +417,45 @@ getSymbols(MemoryBufferRef Buf, raw_ostream &SymNames, bool &HasObject) {
   return Ret;
 }
 
+namespace {
+// The archive symbols of one member.  Offsets are relative to Names.
+struct MemberSymbols {
+  std::string Names;
+  Optional<Expected<std::vector<unsigned>>> Offsets;
+  bool HasObject = false;
+};
+} // end anonymous namespace
+
+// Compute the archive symbols of every member.  Each member is independent of
+// the others and, for bitcode, may require loading a module, so this is done
+// in parallel.
+static Expected<std::vector<MemberSymbols>>
+computeMemberSymbols(ArrayRef<NewArchiveMember> NewMembers) {
+  std::vector<MemberSymbols> Ret(NewMembers.size());
+  parallel::for_each_n(parallel::par, size_t(0), NewMembers.size(),
+                       [&](size_t I) {
+                         MemberSymbols &MS = Ret[I];
+                         raw_string_ostream SymNames(MS.Names);
+                         MS.Offsets.emplace(
+                             getSymbols(NewMembers[I].Buf->getMemBufferRef(),
+                                        SymNames, MS.HasObject));
+                       });
+
+  // Report the first error in member order, as the serial code did.
+  Error Err = Error::success();
+  for (MemberSymbols &MS : Ret) {
+    if (*MS.Offsets)
+      continue;
+    if (Err)
+      consumeError(MS.Offsets->takeError());
+    else
+      Err = MS.Offsets->takeError();
+  }
+  if (Err)
+    return std::move(Err);
+  return std::move(Ret);
+}
+
 static Expected<std::vector<MemberData>>
 computeMemberData(raw_ostream &StringTable, raw_ostream &SymNames,
                   object::Archive::Kind Kind, bool Thin, bool Deterministic,
@@ -397,6 +469,11 @@ computeMemberData(raw_ostream &StringTable, raw_ostream &SymNames,
   std::vector<MemberData> Ret;
   bool HasObject = false;
 
+  Expected<std::vector<MemberSymbols>> SymbolsOrErr =
+      computeMemberSymbols(NewMembers);
+  if (!SymbolsOrErr)
+    return SymbolsOrErr.takeError();
+
   // Deduplicate long member names in the string table and reuse earlier name
   // offsets. This especially saves space for COFF Import libraries where all
   // members have the same name.
@@ -452,7 +529,8 @@ computeMemberData(raw_ostream &StringTable, raw_ostream &SymNames,
       Entry.second = Entry.second > 1 ? 1 : 0;
   }
 
-  for (const NewArchiveMember &M : NewMembers) {
+  for (size_t I = 0, E = NewMembers.size(); I != E; ++I) {
+    const NewArchiveMember &M = NewMembers[I];
     std::string Header;
     raw_string_ostream Out(Header);
 
@@ -478,13 +556,17 @@ computeMemberData(raw_ostream &StringTable, raw_ostream &SymNames,
                       ModTime, Buf.getBufferSize() + MemberPadding);
     Out.flush();
 
-    Expected<std::vector<unsigned>> Symbols =
-        getSymbols(Buf, SymNames, HasObject);
-    if (auto E = Symbols.takeError())
-      return std::move(E);
+    // Append the member's symbol names and rebase their offsets.
+    MemberSymbols &MS = (*SymbolsOrErr)[I];
+    std::vector<unsigned> Symbols = std::move(**MS.Offsets);
+    unsigned Base = SymNames.tell();
+    for (unsigned &Offset : Symbols)
+      Offset += Base;
+    SymNames << MS.Names;
+    HasObject |= MS.HasObject;
 
     Pos += Header.size() + Data.size() + Padding.size();
-    Ret.push_back({std::move(*Symbols), std::move(Header), Data, Padding});
+    Ret.push_back({std::move(Symbols), std::move(Header), Data, Padding});
   }
   // If there are no symbols, emit an empty symbol table, to satisfy Solaris
   // tools, older versions of which expect a symbol table in a non-empty
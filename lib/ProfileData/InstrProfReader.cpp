@@ -22,6 +22,7 @@
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/ErrorOr.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SymbolRemappingReader.h"
 #include "llvm/Support/SwapByteOrder.h"
@@ -358,6 +359,7 @@ Error RawInstrProfReader<IntPtrT>::readHeader(
   Version = swap(Header.Version);
   if (GET_VERSION(Version) != RawInstrProf::Version)
     return error(instrprof_error::unsupported_version);
+  CounterWidth = GET_COUNTER_WIDTH(Version);
 
   CountersDelta = swap(Header.CountersDelta);
   NamesDelta = swap(Header.NamesDelta);
@@ -381,10 +383,23 @@ Error RawInstrProfReader<IntPtrT>::readHeader(
   Data = reinterpret_cast<const RawInstrProf::ProfileData<IntPtrT> *>(
       Start + DataOffset);
   DataEnd = Data + DataSize;
-  CountersStart = reinterpret_cast<const uint64_t *>(Start + CountersOffset);
+  CountersStart = Start + CountersOffset;
   NamesStart = Start + NamesOffset;
   ValueDataStart = reinterpret_cast<const uint8_t *>(Start + ValueDataOffset);
 
+  // The counter arrays of narrow counters are padded to 8 bytes and tile the
+  // counters section. They do not add up to it if the program also has units
+  // that were instrumented with another counter width, whose counters would
+  // be misread.
+  if (CounterWidth != 64) {
+    uint64_t CountersSizeInBytes = 0;
+    for (const RawInstrProf::ProfileData<IntPtrT> *I = Data; I != DataEnd; ++I)
+      CountersSizeInBytes +=
+          alignTo(uint64_t(swap(I->NumCounters)) * CounterWidth / 8, 8);
+    if (CountersSizeInBytes != sizeof(uint64_t) * CountersSize)
+      return error(instrprof_error::malformed);
+  }
+
   std::unique_ptr<InstrProfSymtab> NewSymtab = make_unique<InstrProfSymtab>();
   if (Error E = createSymtab(*NewSymtab.get()))
     return E;
@@ -413,21 +428,45 @@ Error RawInstrProfReader<IntPtrT>::readRawCounts(
   if (NumCounters == 0)
     return error(instrprof_error::malformed);
 
-  auto RawCounts = makeArrayRef(getCounter(CounterPtr), NumCounters);
-  auto *NamesStartAsCounter = reinterpret_cast<const uint64_t *>(NamesStart);
+  const char *RawCounts = getCounter(CounterPtr);
+  size_t CounterSize = CounterWidth / 8;
 
   // Check bounds.
-  if (RawCounts.data() < CountersStart ||
-      RawCounts.data() + RawCounts.size() > NamesStartAsCounter)
+  if (RawCounts < CountersStart ||
+      RawCounts + NumCounters * CounterSize > NamesStart)
     return error(instrprof_error::malformed);
 
-  if (ShouldSwapBytes) {
-    Record.Counts.clear();
-    Record.Counts.reserve(RawCounts.size());
-    for (uint64_t Count : RawCounts)
-      Record.Counts.push_back(swap(Count));
-  } else
-    Record.Counts = RawCounts;
+  if (CounterWidth == 64 && !ShouldSwapBytes) {
+    auto *Counts = reinterpret_cast<const uint64_t *>(RawCounts);
+    Record.Counts.assign(Counts, Counts + NumCounters);
+    return success();
+  }
+
+  // Narrow counters are zero-extended; a saturated counter reads back as the
+  // maximum value of its width.
+  support::endianness Endian = getDataEndianness();
+  Record.Counts.clear();
+  Record.Counts.reserve(NumCounters);
+  for (uint32_t I = 0; I != NumCounters; ++I) {
+    const char *P = RawCounts + I * CounterSize;
+    switch (CounterWidth) {
+    case 8:
+      Record.Counts.push_back(uint8_t(*P));
+      break;
+    case 16:
+      Record.Counts.push_back(
+          support::endian::read<uint16_t, support::unaligned>(P, Endian));
+      break;
+    case 32:
+      Record.Counts.push_back(
+          support::endian::read<uint32_t, support::unaligned>(P, Endian));
+      break;
+    default:
+      Record.Counts.push_back(
+          support::endian::read<uint64_t, support::unaligned>(P, Endian));
+      break;
+    }
+  }
 
   return success();
 }
@@ -103,23 +103,35 @@ public:
   InstrProfSummaryBuilder *SummaryBuilder;
   InstrProfSummaryBuilder *CSSummaryBuilder;
 
+  // If set, the writer only holds the names and hashes of the functions, and
+  // the records of each function are read into Loaded as it is written out.
+  InstrProfWriter::RecordLoader Load;
+  InstrProfWriter::ProfilingData Loaded;
+
   InstrProfRecordWriterTrait() = default;
 
   static hash_value_type ComputeHash(key_type_ref K) {
     return IndexedInstrProf::ComputeHash(K);
   }
 
-  static std::pair<offset_type, offset_type>
+  std::pair<offset_type, offset_type>
   EmitKeyDataLength(raw_ostream &Out, key_type_ref K, data_type_ref V) {
     using namespace support;
 
+    // EmitData is called right after this for the same function.
+    if (Load) {
+      Loaded.clear();
+      for (const auto &ProfileData : *V)
+        Loaded.insert({ProfileData.first, Load(K, ProfileData.first)});
+    }
+
     endian::Writer LE(Out, little);
 
     offset_type N = K.size();
     LE.write<offset_type>(N);
 
     offset_type M = 0;
-    for (const auto &ProfileData : *V) {
+    for (const auto &ProfileData : Load ? Loaded : *V) {
       const InstrProfRecord &ProfRecord = ProfileData.second;
       M += sizeof(uint64_t); // The function hash
       M += sizeof(uint64_t); // The size of the Counts vector
@@ -141,7 +153,7 @@ public:
     using namespace support;
 
     endian::Writer LE(Out, little);
-    for (const auto &ProfileData : *V) {
+    for (const auto &ProfileData : Load ? Loaded : *V) {
       const InstrProfRecord &ProfRecord = ProfileData.second;
       if (NamedInstrProfRecord::hasCSFlagInHash(ProfileData.first))
         CSSummaryBuilder->addRecord(ProfRecord);
@@ -249,6 +261,10 @@ void InstrProfWriter::addRecord(StringRef Name, uint64_t Hash,
   Dest.sortValueData();
 }
 
+void InstrProfWriter::addDeferredRecord(StringRef Name, uint64_t Hash) {
+  FunctionData[Name].insert(std::make_pair(Hash, InstrProfRecord()));
+}
+
 void InstrProfWriter::mergeRecordsFromWriter(InstrProfWriter &&IPW,
                                              function_ref<void(Error)> Warn) {
   for (auto &I : IPW.FunctionData)
@@ -257,7 +273,8 @@ void InstrProfWriter::mergeRecordsFromWriter(InstrProfWriter &&IPW,
 }
 
 bool InstrProfWriter::shouldEncodeData(const ProfilingData &PD) {
-  if (!Sparse)
+  // The counts of deferred records are not known here.
+  if (!Sparse || InfoObj->Load)
     return true;
   for (const auto &Func : PD) {
     const InstrProfRecord &IPR = Func.second;
@@ -374,10 +391,13 @@ void InstrProfWriter::writeImpl(ProfOStream &OS) {
   OS.patch(PatchItems, sizeof(PatchItems) / sizeof(*PatchItems));
 }
 
-void InstrProfWriter::write(raw_fd_ostream &OS) {
+void InstrProfWriter::write(raw_fd_ostream &OS, RecordLoader Load) {
+  InfoObj->Load = Load;
   // Write the hash table.
   ProfOStream POS(OS);
   writeImpl(POS);
+  InfoObj->Load = nullptr;
+  InfoObj->Loaded.clear();
 }
 
 std::unique_ptr<MemoryBuffer> InstrProfWriter::writeBuffer() {
@@ -436,7 +456,7 @@ void InstrProfWriter::writeRecordInText(StringRef Name, uint64_t Hash,
   OS << "\n";
 }
 
-Error InstrProfWriter::writeText(raw_fd_ostream &OS) {
+Error InstrProfWriter::writeText(raw_fd_ostream &OS, RecordLoader Load) {
   if (ProfileKind == PF_IRLevel)
     OS << "# IR level Instrumentation Flag\n:ir\n";
   else if (ProfileKind == PF_IRLevelWithCS)
@@ -448,7 +468,7 @@ Error InstrProfWriter::writeText(raw_fd_ostream &OS) {
   SmallVector<RecordType, 4> OrderedFuncData;
 
   for (const auto &I : FunctionData) {
-    if (shouldEncodeData(I.getValue())) {
+    if (Load || shouldEncodeData(I.getValue())) {
       if (Error E = Symtab.addFuncName(I.getKey()))
         return E;
       for (const auto &Func : I.getValue())
@@ -464,7 +484,10 @@ Error InstrProfWriter::writeText(raw_fd_ostream &OS) {
   for (const auto &record : OrderedFuncData) {
     const StringRef &Name = record.first;
     const FuncPair &Func = record.second;
-    writeRecordInText(Name, Func.first, Func.second, Symtab, OS);
+    if (Load)
+      writeRecordInText(Name, Func.first, Load(Name, Func.first), Symtab, OS);
+    else
+      writeRecordInText(Name, Func.first, Func.second, Symtab, OS);
   }
 
   return Error::success();
@@ -459,28 +459,44 @@ std::error_code SampleProfileReaderBinary::readFuncProfile() {
 }
 
 std::error_code SampleProfileReaderBinary::read() {
+  if (LoadOnDemand)
+    return sampleprof_error::success;
+
   while (!at_eof()) {
     if (std::error_code EC = readFuncProfile())
       return EC;
   }
 
+  // Every function has been decoded; the offset table is no longer needed.
+  FuncOffsetTable.clear();
   return sampleprof_error::success;
 }
 
-std::error_code SampleProfileReaderCompactBinary::read() {
-  for (auto Name : FuncsToUse) {
-    auto GUID = std::to_string(MD5Hash(Name));
-    auto iter = FuncOffsetTable.find(StringRef(GUID));
-    if (iter == FuncOffsetTable.end())
-      continue;
-    const uint8_t *SavedData = Data;
-    Data = reinterpret_cast<const uint8_t *>(Buffer->getBufferStart()) +
-           iter->second;
-    if (std::error_code EC = readFuncProfile())
-      return EC;
-    Data = SavedData;
+void SampleProfileReaderBinary::collectFuncsToUse(const Module &M) {
+  LoadOnDemand = !FuncOffsetTable.empty();
+}
+
+FunctionSamples *SampleProfileReaderBinary::getSamplesFor(StringRef Fname) {
+  if (LoadOnDemand) {
+    std::string FGUID;
+    auto Iter = FuncOffsetTable.find(getRepInFormat(Fname, getFormat(), FGUID));
+    if (Iter != FuncOffsetTable.end()) {
+      const uint8_t *SavedData = Data;
+      Data = reinterpret_cast<const uint8_t *>(Buffer->getBufferStart()) +
+             Iter->second;
+      FuncOffsetTable.erase(Iter);
+      std::error_code EC = readFuncProfile();
+      Data = SavedData;
+      if (EC) {
+        // Do not hand out a partially decoded profile.
+        Profiles.erase(getRepInFormat(Fname, getFormat(), FGUID));
+        reportError(0, "could not decode the profile of " + Fname + ": " +
+                           EC.message());
+        return nullptr;
+      }
+    }
   }
-  return sampleprof_error::success;
+  return SampleProfileReader::getSamplesFor(Fname);
 }
 
 std::error_code SampleProfileReaderRawBinary::verifySPMagic(uint64_t Magic) {
@@ -540,8 +556,9 @@ std::error_code SampleProfileReaderBinary::readHeader() {
   auto Version = readNumber<uint64_t>();
   if (std::error_code EC = Version.getError())
     return EC;
-  else if (*Version != SPVersion())
+  else if (*Version != SPVersion() && *Version != SPIndexedVersion())
     return sampleprof_error::unsupported_version;
+  this->Version = *Version;
 
   if (std::error_code EC = readSummary())
     return EC;
@@ -551,18 +568,30 @@ std::error_code SampleProfileReaderBinary::readHeader() {
   return sampleprof_error::success;
 }
 
+std::error_code SampleProfileReaderRawBinary::readHeader() {
+  if (std::error_code EC = SampleProfileReaderBinary::readHeader())
+    return EC;
+  if (Version == SPIndexedVersion())
+    return readFuncOffsetTable();
+  return sampleprof_error::success;
+}
+
 std::error_code SampleProfileReaderCompactBinary::readHeader() {
-  SampleProfileReaderBinary::readHeader();
+  if (std::error_code EC = SampleProfileReaderBinary::readHeader())
+    return EC;
   if (std::error_code EC = readFuncOffsetTable())
     return EC;
   return sampleprof_error::success;
 }
 
-std::error_code SampleProfileReaderCompactBinary::readFuncOffsetTable() {
+std::error_code SampleProfileReaderBinary::readFuncOffsetTable() {
   auto TableOffset = readUnencodedNumber<uint64_t>();
   if (std::error_code EC = TableOffset.getError())
     return EC;
 
+  if (*TableOffset > Buffer->getBufferSize())
+    return sampleprof_error::truncated;
+
   const uint8_t *SavedData = Data;
   const uint8_t *TableStart =
       reinterpret_cast<const uint8_t *>(Buffer->getBufferStart()) +
@@ -590,14 +619,6 @@ std::error_code SampleProfileReaderCompactBinary::readFuncOffsetTable() {
   return sampleprof_error::success;
 }
 
-void SampleProfileReaderCompactBinary::collectFuncsToUse(const Module &M) {
-  FuncsToUse.clear();
-  for (auto &F : M) {
-    StringRef CanonName = FunctionSamples::getCanonicalFnName(F);
-    FuncsToUse.insert(CanonName);
-  }
-}
-
 std::error_code SampleProfileReaderBinary::readSummaryEntry(
     std::vector<ProfileSummaryEntry> &Entries) {
   auto Cutoff = readNumber<uint64_t>();
@@ -64,12 +64,13 @@ SampleProfileWriter::write(const StringMap<FunctionSamples> &ProfileMap) {
   return sampleprof_error::success;
 }
 
-std::error_code SampleProfileWriterCompactBinary::write(
+std::error_code SampleProfileWriterBinary::write(
     const StringMap<FunctionSamples> &ProfileMap) {
   if (std::error_code EC = SampleProfileWriter::write(ProfileMap))
     return EC;
-  if (std::error_code EC = writeFuncOffsetTable())
-    return EC;
+  if (UseFuncOffsetTable)
+    if (std::error_code EC = writeFuncOffsetTable())
+      return EC;
   return sampleprof_error::success;
 }
 
@@ -177,7 +178,7 @@ std::error_code SampleProfileWriterRawBinary::writeNameTable() {
   return sampleprof_error::success;
 }
 
-std::error_code SampleProfileWriterCompactBinary::writeFuncOffsetTable() {
+std::error_code SampleProfileWriterBinary::writeFuncOffsetTable() {
   auto &OS = *OutputStream;
 
   // Fill the slot remembered by TableOffset with the offset of FuncOffsetTable.
@@ -218,7 +219,7 @@ std::error_code SampleProfileWriterRawBinary::writeMagicIdent() {
   auto &OS = *OutputStream;
   // Write file magic identifier.
   encodeULEB128(SPMagic(), OS);
-  encodeULEB128(SPVersion(), OS);
+  encodeULEB128(UseFuncOffsetTable ? SPIndexedVersion() : SPVersion(), OS);
   return sampleprof_error::success;
 }
 
@@ -245,19 +246,14 @@ std::error_code SampleProfileWriterBinary::writeHeader(
   }
 
   writeNameTable();
-  return sampleprof_error::success;
-}
 
-std::error_code SampleProfileWriterCompactBinary::writeHeader(
-    const StringMap<FunctionSamples> &ProfileMap) {
-  support::endian::Writer Writer(*OutputStream, support::little);
-  if (auto EC = SampleProfileWriterBinary::writeHeader(ProfileMap))
-    return EC;
-
-  // Reserve a slot for the offset of function offset table. The slot will
-  // be populated with the offset of FuncOffsetTable later.
-  TableOffset = OutputStream->tell();
-  Writer.write(static_cast<uint64_t>(-2));
+  if (UseFuncOffsetTable) {
+    // Reserve a slot for the offset of function offset table. The slot will
+    // be populated with the offset of FuncOffsetTable later.
+    support::endian::Writer Writer(*OutputStream, support::little);
+    TableOffset = OutputStream->tell();
+    Writer.write(static_cast<uint64_t>(-2));
+  }
   return sampleprof_error::success;
 }
 
@@ -325,15 +321,8 @@ std::error_code SampleProfileWriterBinary::writeBody(const FunctionSamples &S) {
 ///
 /// \returns true if the samples were written successfully, false otherwise.
 std::error_code SampleProfileWriterBinary::write(const FunctionSamples &S) {
-  encodeULEB128(S.getHeadSamples(), *OutputStream);
-  return writeBody(S);
-}
-
-std::error_code
-SampleProfileWriterCompactBinary::write(const FunctionSamples &S) {
-  uint64_t Offset = OutputStream->tell();
-  StringRef Name = S.getName();
-  FuncOffsetTable[Name] = Offset;
+  if (UseFuncOffsetTable)
+    FuncOffsetTable[S.getName()] = OutputStream->tell();
   encodeULEB128(S.getHeadSamples(), *OutputStream);
   return writeBody(S);
 }
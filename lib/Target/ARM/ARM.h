@@ -33,6 +33,7 @@ class MachineBasicBlock;
 class MachineFunction;
 class MachineInstr;
 class MCInst;
+class ModulePass;
 class PassRegistry;
 
 FunctionPass *createARMLowOverheadLoopsPass();
@@ -47,7 +48,10 @@ FunctionPass *createARMConstantIslandPass();
 FunctionPass *createMLxExpansionPass();
 FunctionPass *createThumb2ITBlockPass();
 FunctionPass *createMVEVPTBlockPass();
+Pass *createMVETailPredicationPass();
 FunctionPass *createARMOptimizeBarriersPass();
+ModulePass *createARMTCMPlacementPass();
+FunctionPass *createARMStackUsagePass();
 FunctionPass *createThumb2SizeReductionPass(
     std::function<bool(const Function &)> Ftor = nullptr);
 InstructionSelector *
@@ -66,7 +70,10 @@ void initializeARMExpandPseudoPass(PassRegistry &);
 void initializeThumb2SizeReducePass(PassRegistry &);
 void initializeThumb2ITBlockPass(PassRegistry &);
 void initializeMVEVPTBlockPass(PassRegistry &);
+void initializeMVETailPredicationPass(PassRegistry &);
 void initializeARMLowOverheadLoopsPass(PassRegistry &);
+void initializeARMTCMPlacementPass(PassRegistry &);
+void initializeARMStackUsagePass(PassRegistry &);
 
 } // end namespace llvm
 
@@ -24,6 +24,8 @@
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/BinaryFormat/COFF.h"
+#include "llvm/BinaryFormat/ELF.h"
+#include "llvm/BinaryFormat/SilhouetteSites.h"
 #include "llvm/CodeGen/MachineFunctionPass.h"
 #include "llvm/CodeGen/MachineJumpTableInfo.h"
 #include "llvm/CodeGen/MachineModuleInfoImpls.h"
@@ -39,8 +41,10 @@
 #include "llvm/MC/MCInst.h"
 #include "llvm/MC/MCInstBuilder.h"
 #include "llvm/MC/MCObjectStreamer.h"
+#include "llvm/MC/MCSectionELF.h"
 #include "llvm/MC/MCStreamer.h"
 #include "llvm/MC/MCSymbol.h"
+#include "llvm/MC/MCSymbolELF.h"
 #include "llvm/Support/ARMBuildAttributes.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
@@ -55,7 +59,59 @@ using namespace llvm;
 ARMAsmPrinter::ARMAsmPrinter(TargetMachine &TM,
                              std::unique_ptr<MCStreamer> Streamer)
     : AsmPrinter(TM, std::move(Streamer)), AFI(nullptr), MCP(nullptr),
-      InConstantPool(false), OptimizationGoals(-1) {}
+      InConstantPool(false), OptimizationGoals(-1), SilhouetteSiteTableID(0) {}
+
+/// emitSilhouetteSiteTable - Emit a table listing the address, length and
+/// kind of every code sequence the Silhouette passes inserted into the
+/// function.  The layout is described in llvm/BinaryFormat/SilhouetteSites.h.
+void ARMAsmPrinter::emitSilhouetteSiteTable() {
+  ArrayRef<ARMFunctionInfo::SilhouetteSite> Sites = AFI->getSilhouetteSites();
+  if (Sites.empty() || !Subtarget->isTargetELF())
+    return;
+
+  // Later passes may delete instructions of a recorded site, in which case
+  // its symbols were never emitted.  Emit the remaining sites in the order
+  // their first instructions appear in the function.
+  DenseMap<const MCSymbol *, unsigned> Order;
+  for (const MachineBasicBlock &MBB : *MF)
+    for (const MachineInstr &MI : MBB)
+      if (MCSymbol *Sym = MI.getPreInstrSymbol())
+        Order.insert(std::make_pair(Sym, Order.size()));
+
+  SmallVector<const ARMFunctionInfo::SilhouetteSite *, 32> Emitted;
+  for (const ARMFunctionInfo::SilhouetteSite &Site : Sites)
+    if (Site.Begin->isDefined() && Site.End->isDefined())
+      Emitted.push_back(&Site);
+  llvm::stable_sort(Emitted, [&](const ARMFunctionInfo::SilhouetteSite *A,
+                                 const ARMFunctionInfo::SilhouetteSite *B) {
+    return Order.lookup(A->Begin) < Order.lookup(B->Begin);
+  });
+
+  // Keep the table with the function, like the XRay instrumentation map.
+  const Function &F = MF->getFunction();
+  unsigned Flags = ELF::SHF_ALLOC | ELF::SHF_LINK_ORDER;
+  std::string GroupName;
+  if (F.hasComdat()) {
+    Flags |= ELF::SHF_GROUP;
+    GroupName = F.getComdat()->getName();
+  }
+  MCSection *Section = OutContext.getELFSection(
+      silhouette::SiteTableSectionName, ELF::SHT_PROGBITS, Flags, 0, GroupName,
+      ++SilhouetteSiteTableID, cast<MCSymbolELF>(CurrentFnSym));
+
+  OutStreamer->PushSection();
+  OutStreamer->SwitchSection(Section);
+  EmitAlignment(2);
+  OutStreamer->EmitSymbolValue(CurrentFnSym, 4);
+  OutStreamer->EmitIntValue(Emitted.size(), 4);
+  for (const ARMFunctionInfo::SilhouetteSite *Site : Emitted) {
+    OutStreamer->EmitSymbolValue(Site->Begin, 4);
+    EmitLabelDifference(Site->End, Site->Begin, 2);
+    OutStreamer->EmitIntValue(Site->Kind, 1);
+    OutStreamer->EmitIntValue(0, 1);
+  }
+  OutStreamer->PopSection();
+}
 
 void ARMAsmPrinter::EmitFunctionBodyEnd() {
   // Make sure to terminate any constant pools that were at the end
@@ -163,6 +219,9 @@ bool ARMAsmPrinter::runOnMachineFunction(MachineFunction &MF) {
   // Emit the XRay table for this function.
   emitXRayTable();
 
+  // Emit the Silhouette instrumentation sites of this function.
+  emitSilhouetteSiteTable();
+
   // If we need V4T thumb mode Register Indirect Jump pads, emit them.
   // These are created per function, rather than per TU, since it's
   // relatively easy to exceed the thumb branch range within a TU.
@@ -65,6 +65,10 @@ class LLVM_LIBRARY_VISIBILITY ARMAsmPrinter : public AsmPrinter {
   /// debug info can link properly.
   SmallPtrSet<const GlobalVariable*,2> EmittedPromotedGlobalLabels;
 
+  /// SilhouetteSiteTableID - Unique ID of the last per-function section
+  /// created for the Silhouette instrumentation site table.
+  unsigned SilhouetteSiteTableID;
+
 public:
   explicit ARMAsmPrinter(TargetMachine &TM,
                          std::unique_ptr<MCStreamer> Streamer);
@@ -116,10 +120,14 @@ public:
 
 private:
   void EmitSled(const MachineInstr &MI, SledKind Kind);
+  void EmitThumb2Sled(const MachineInstr &MI, SledKind Kind);
 
   // Helpers for EmitStartOfAsmFile() and EmitEndOfAsmFile()
   void emitAttributes();
 
+  // Emit the table of Silhouette instrumentation sites of this function.
+  void emitSilhouetteSiteTable();
+
   // Generic helper used to emit e.g. ARMv5 mul pseudos
   void EmitPatchedInstruction(const MachineInstr *MI, unsigned TargetOpc);
 
@@ -10,6 +10,10 @@
 // which are scattered through-out the function.  This is required due to the
 // limited pc-relative displacements that ARM has.
 //
+// With -arm-share-constant-islands, Thumb2 functions also load constants from
+// the island at the end of the previous function in the same section, when it
+// is in range, instead of keeping a copy of their own.
+//
 //===----------------------------------------------------------------------===//
 
 #include "ARM.h"
@@ -37,6 +41,8 @@
 #include "llvm/Config/llvm-config.h"
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/DebugLoc.h"
+#include "llvm/IR/Module.h"
+#include "llvm/MC/MCContext.h"
 #include "llvm/MC/MCInstrDesc.h"
 #include "llvm/Pass.h"
 #include "llvm/Support/CommandLine.h"
@@ -46,6 +52,8 @@
 #include "llvm/Support/Format.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetLoweringObjectFile.h"
+#include "llvm/Target/TargetMachine.h"
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
@@ -69,6 +77,8 @@ STATISTIC(NumT2BrShrunk, "Number of Thumb2 immediate branches shrunk");
 STATISTIC(NumCBZ,        "Number of CBZ / CBNZ formed");
 STATISTIC(NumJTMoved,    "Number of jump table destination blocks moved");
 STATISTIC(NumJTInserted, "Number of jump table intermediate blocks inserted");
+STATISTIC(NumCPShared,   "Number of constpool users sharing an entry of the "
+                         "previous function");
 
 static cl::opt<bool>
 AdjustJumpTableBlocks("arm-adjust-jump-tables", cl::Hidden, cl::init(true),
@@ -78,6 +88,11 @@ static cl::opt<unsigned>
 CPMaxIteration("arm-constant-island-max-iteration", cl::Hidden, cl::init(30),
           cl::desc("The max number of iteration for converge"));
 
+static cl::opt<bool>
+ShareConstantIslands("arm-share-constant-islands", cl::Hidden, cl::init(false),
+          cl::desc("Share constant pool entries with the island at the end of "
+                   "the previous function"));
+
 static cl::opt<bool> SynthesizeThumb1TBB(
     "arm-synthesize-thumb-1-tbb", cl::Hidden, cl::init(true),
     cl::desc("Use compressed jump tables in Thumb-1 by synthesizing an "
@@ -203,6 +218,31 @@ namespace {
     /// T2JumpTables - Keep track of all the Thumb2 jumptable instructions.
     SmallVector<MachineInstr*, 4> T2JumpTables;
 
+    /// SharedCPEntry - An entry of the island at the end of the previous
+    /// function, which can be loaded from by the users in this function.
+    struct SharedCPEntry {
+      MCSymbol *Label;
+      /// The distance from the entry to the end of the previous function.
+      unsigned DistanceToEnd;
+    };
+
+    /// PrevIsland - The entries of the island at the end of the previous
+    /// function, by constant, and the function and section they belong to.
+    DenseMap<const Constant *, SharedCPEntry> PrevIsland;
+    const Function *PrevFunction = nullptr;
+    const MCSection *PrevSection = nullptr;
+
+    /// SharedCPUser - A user that loads from an entry of the previous
+    /// function's island instead of its own entry.  It is kept out of CPUsers,
+    /// so its own entry stays where it is, until it is known to be in range of
+    /// the shared entry in the final layout.
+    struct SharedCPUser {
+      CPUser U;
+      SharedCPEntry Entry;
+    };
+
+    std::vector<SharedCPUser> SharedCPUsers;
+
     /// HasFarJump - True if any far jump instruction has been emitted during
     /// the branch fix up pass.
     bool HasFarJump;
@@ -276,6 +316,13 @@ namespace {
     void dumpBBs();
     void verify();
 
+    bool isPrevFunctionAdjacent() const;
+    void shareConstantPoolEntries();
+    bool isSharedCPUserInRange(SharedCPUser &SU);
+    bool unshareOutOfRangeCPUsers();
+    bool removeSharedCPEntries();
+    void recordTrailingIsland();
+
     bool isOffsetInRange(unsigned UserOffset, unsigned TrialOffset,
                          unsigned Disp, bool NegativeOK, bool IsSoImm = false);
     bool isOffsetInRange(unsigned UserOffset, unsigned TrialOffset,
@@ -403,6 +450,10 @@ bool ARMConstantIslands::runOnMachineFunction(MachineFunction &mf) {
   /// Remove dead constant pool entries.
   MadeChange |= removeUnusedCPEntries();
 
+  // Let the users load from the previous function's island where possible.
+  if (ShareConstantIslands && isThumb2 && isPrevFunctionAdjacent())
+    shareConstantPoolEntries();
+
   // Iteratively place constant pool entries and fix up branches until there
   // is no change.
   unsigned NoCPIters = 0, NoBRIters = 0;
@@ -414,6 +465,7 @@ bool ARMConstantIslands::runOnMachineFunction(MachineFunction &mf) {
       // If it doesn't end in 10, the input may have huge BB or many CPEs.
       // In this case, we will try different heuristics.
       CPChange |= handleConstantPoolUser(i, NoCPIters >= CPMaxIteration / 2);
+    CPChange |= unshareOutOfRangeCPUsers();
     if (CPChange && ++NoCPIters > CPMaxIteration)
       report_fatal_error("Constant Island pass failed to converge!");
     LLVM_DEBUG(dumpBBs());
@@ -435,6 +487,9 @@ bool ARMConstantIslands::runOnMachineFunction(MachineFunction &mf) {
     MadeChange = true;
   }
 
+  // The remaining shared users are in range; drop their own entries.
+  MadeChange |= removeSharedCPEntries();
+
   // Shrink 32-bit Thumb2 load and store instructions.
   if (isThumb2 && !STI->prefers32BitThumb())
     MadeChange |= optimizeThumb2Instructions();
@@ -466,6 +521,9 @@ bool ARMConstantIslands::runOnMachineFunction(MachineFunction &mf) {
 
   LLVM_DEBUG(dbgs() << '\n'; dumpBBs());
 
+  if (ShareConstantIslands)
+    recordTrailingIsland();
+
   BBUtils->clear();
   WaterList.clear();
   CPUsers.clear();
@@ -475,6 +533,7 @@ bool ARMConstantIslands::runOnMachineFunction(MachineFunction &mf) {
   ImmBranches.clear();
   PushPopMIs.clear();
   T2JumpTables.clear();
+  SharedCPUsers.clear();
 
   return MadeChange;
 }
@@ -2344,3 +2403,173 @@ FunctionPass *llvm::createARMConstantIslandPass() {
 
 INITIALIZE_PASS(ARMConstantIslands, "arm-cp-islands", ARM_CP_ISLANDS_OPT_NAME,
                 false, false)
+
+/// isPrevFunctionAdjacent - Returns true if the previous function whose island
+/// was recorded is emitted right before this one, in the same section, so that
+/// only the alignment of this function is between the two.
+bool ARMConstantIslands::isPrevFunctionAdjacent() const {
+  const Function &F = MF->getFunction();
+  if (!PrevFunction || PrevIsland.empty() || F.hasPrefixData())
+    return false;
+
+  // The functions are emitted in the order of the module, skipping those that
+  // are not code generated.
+  const Module &M = *F.getParent();
+  for (auto I = F.getIterator(); I != M.begin();) {
+    --I;
+    if (I->isDeclaration() || I->hasAvailableExternallyLinkage())
+      continue;
+    if (&*I != PrevFunction)
+      return false;
+    break;
+  }
+
+  const TargetMachine &TM = MF->getTarget();
+  return TM.getObjFileLowering()->SectionForGlobal(&F, TM) == PrevSection;
+}
+
+/// shareConstantPoolEntries - Make each user that can load from an entry of
+/// the previous function's island for the same constant a shared user.
+void ARMConstantIslands::shareConstantPoolEntries() {
+  const std::vector<MachineConstantPoolEntry> &CPs = MCP->getConstants();
+  for (unsigned i = 0; i != CPUsers.size();) {
+    CPUser &U = CPUsers[i];
+    switch (U.MI->getOpcode()) {
+    default:
+      ++i;
+      continue;
+    // The users that can reach backwards and are lowered with a plain symbol
+    // operand. Thumb2SizeReduction has already narrowed the loads into low
+    // registers, which can only reach forwards; they are widened back below.
+    case ARM::tLDRpci:
+    case ARM::t2LDRpci:
+    case ARM::VLDRS:
+    case ARM::VLDRD:
+      break;
+    }
+
+    const MachineConstantPoolEntry &CPE =
+        CPs[U.CPEMI->getOperand(1).getIndex()];
+    auto It = CPE.isMachineConstantPoolEntry()
+                  ? PrevIsland.end()
+                  : PrevIsland.find(CPE.Val.ConstVal);
+    if (It == PrevIsland.end()) {
+      ++i;
+      continue;
+    }
+
+    SharedCPUser SU = {U, It->second};
+    bool Widen = U.MI->getOpcode() == ARM::tLDRpci;
+    if (Widen) {
+      SU.U.MaxDisp = (1 << 12) - 1;
+      SU.U.NegOk = true;
+    }
+    if (!isSharedCPUserInRange(SU)) {
+      ++i;
+      continue;
+    }
+    if (Widen) {
+      MachineBasicBlock *MBB = U.MI->getParent();
+      U.MI->setDesc(TII->get(ARM::t2LDRpci));
+      BBUtils->adjustBBSize(MBB, 2);
+      BBUtils->adjustBBOffsetsAfter(MBB);
+    }
+    LLVM_DEBUG(dbgs() << "Sharing " << *It->second.Label << " with "
+                      << *U.MI);
+    SharedCPUsers.push_back(SU);
+    CPUsers.erase(CPUsers.begin() + i);
+  }
+}
+
+/// isSharedCPUserInRange - Returns true if the shared entry of SU is in range
+/// of its user however this function ends up aligned after the previous one.
+bool ARMConstantIslands::isSharedCPUserInRange(SharedCPUser &SU) {
+  unsigned UserOffset = getUserOffset(SU.U);
+  const Function &F = MF->getFunction();
+  unsigned LogAlign = std::max(MF->getAlignment(),
+                               Log2_32(std::max(F.getAlignment(), 1u)));
+  unsigned MaxPadding = (1u << LogAlign) - 1;
+  return UserOffset + MaxPadding + SU.Entry.DistanceToEnd <=
+         SU.U.getMaxDisp();
+}
+
+/// unshareOutOfRangeCPUsers - Hand the shared users that are no longer in range
+/// of the previous function's island back to the normal placement, which will
+/// find them an entry of this function.
+bool ARMConstantIslands::unshareOutOfRangeCPUsers() {
+  bool MadeChange = false;
+  for (unsigned i = 0; i != SharedCPUsers.size();) {
+    SharedCPUser &SU = SharedCPUsers[i];
+    if (isSharedCPUserInRange(SU)) {
+      ++i;
+      continue;
+    }
+    LLVM_DEBUG(dbgs() << "Unsharing " << *SU.Entry.Label << " with "
+                      << *SU.U.MI);
+    CPUsers.push_back(SU.U);
+    SharedCPUsers.erase(SharedCPUsers.begin() + i);
+    MadeChange = true;
+  }
+  return MadeChange;
+}
+
+/// removeSharedCPEntries - Point the shared users at the previous function's
+/// island, and remove the entries of this function that are no longer used.
+/// This only shrinks the function, so every user stays in range.
+bool ARMConstantIslands::removeSharedCPEntries() {
+  for (SharedCPUser &SU : SharedCPUsers) {
+    MachineInstr *MI = SU.U.MI;
+    unsigned CPI = getCombinedIndex(SU.U.CPEMI);
+    for (MachineOperand &MO : MI->operands())
+      if (MO.isCPI()) {
+        MO.ChangeToMCSymbol(SU.Entry.Label);
+        break;
+      }
+    decrementCPEReferenceCount(CPI, SU.U.CPEMI);
+    ++NumCPShared;
+  }
+  return !SharedCPUsers.empty();
+}
+
+/// recordTrailingIsland - Remember the entries of the island at the end of
+/// this function, for the next function to share.
+void ARMConstantIslands::recordTrailingIsland() {
+  PrevIsland.clear();
+  PrevFunction = nullptr;
+  PrevSection = nullptr;
+  if (!isThumb2 || STI->getTargetTriple().isOSWindows())
+    return;
+
+  const Function &F = MF->getFunction();
+  const TargetMachine &TM = MF->getTarget();
+  PrevFunction = &F;
+  PrevSection = TM.getObjFileLowering()->SectionForGlobal(&F, TM);
+
+  BBInfoVector &BBInfo = BBUtils->getBBInfo();
+  unsigned FunctionEnd = BBInfo[MF->back().getNumber()].postOffset();
+  const DataLayout &DL = MF->getDataLayout();
+  const std::vector<MachineConstantPoolEntry> &CPs = MCP->getConstants();
+  for (auto MBBI = MF->rbegin(), E = MF->rend(); MBBI != E; ++MBBI) {
+    if (!llvm::all_of(*MBBI, [](const MachineInstr &MI) {
+          return MI.getOpcode() == ARM::CONSTPOOL_ENTRY;
+        }))
+      break;
+
+    for (MachineInstr &CPEMI : *MBBI) {
+      if (!CPEMI.getOperand(1).isCPI())
+        continue;
+      const MachineConstantPoolEntry &CPE =
+          CPs[CPEMI.getOperand(1).getIndex()];
+      if (CPE.isMachineConstantPoolEntry())
+        continue;
+
+      // This is the label that the AsmPrinter gives the entry.
+      MCSymbol *Label = MF->getContext().getOrCreateSymbol(
+          Twine(DL.getPrivateGlobalPrefix()) + "CPI" +
+          Twine(MF->getFunctionNumber()) + "_" +
+          Twine(CPEMI.getOperand(0).getImm()));
+      unsigned DistanceToEnd = FunctionEnd - BBUtils->getOffsetOf(&CPEMI);
+      PrevIsland.insert({CPE.Val.ConstVal, {Label, DistanceToEnd}});
+    }
+  }
+}
@@ -43,6 +43,8 @@ DisableShifterOp("disable-shifter-op", cl::Hidden,
   cl::desc("Disable isel of shifter-op"),
   cl::init(false));
 
+extern bool SilhouetteStr2Strt;
+
 //===--------------------------------------------------------------------===//
 /// ARMDAGToDAGISel - ARM specific code to select ARM machine
 /// instructions for SelectionDAG operations.
@@ -180,6 +182,10 @@ private:
   bool tryT1IndexedLoad(SDNode *N);
   bool tryT2IndexedLoad(SDNode *N);
 
+  /// Select a Thumb2 store for Silhouette, avoiding the addressing modes that
+  /// its unprivileged stores do not have.
+  bool tryT2SilhouetteStore(StoreSDNode *ST);
+
   /// SelectVLD - Select NEON load intrinsics.  NumVecs should be
   /// 1, 2, 3 or 4.  The opcode arrays specify the instructions used for
   /// loads of D registers and even subregs and odd subregs of Q registers.
@@ -211,6 +217,14 @@ private:
                     const uint16_t *QOpcodes0 = nullptr,
                     const uint16_t *QOpcodes1 = nullptr);
 
+  /// SelectMVE_VLD - Select MVE interleaving load intrinsics. NumVecs
+  /// should be 2 or 4. The opcode array specifies the instructions
+  /// used for 8, 16 and 32-bit lane sizes respectively, and each
+  /// pointer points to a set of NumVecs sub-opcodes used for the
+  /// different stages (e.g. VLD20 versus VLD21) of each load family.
+  void SelectMVE_VLD(SDNode *N, unsigned NumVecs,
+                     const uint16_t *const *Opcodes);
+
   /// Try to select SBFX/UBFX instructions for ARM.
   bool tryV6T2BitfieldExtractOp(SDNode *N, bool isSigned);
 
@@ -1565,6 +1579,59 @@ bool ARMDAGToDAGISel::tryT2IndexedLoad(SDNode *N) {
   return false;
 }
 
+bool ARMDAGToDAGISel::tryT2SilhouetteStore(StoreSDNode *ST) {
+  // Silhouette turns every store into an unprivileged store, whose only
+  // addressing mode is a base register plus an immediate offset of 0 to 255.
+  // It brackets the stores with other offsets with an ADD and a SUB of the
+  // offset to the base register. Compute these addresses into a register of
+  // their own instead, which takes one instruction rather than two and can be
+  // shared by several stores. Privileged functions keep their stores as they
+  // are.
+  if (!SilhouetteStr2Strt || !Subtarget->isThumb2() || !ST->isUnindexed() ||
+      ST->getValue().getValueType() != MVT::i32 ||
+      MF->getFunction().getSection().equals("privileged_functions"))
+    return false;
+
+  unsigned Opcode;
+  EVT StoredVT = ST->getMemoryVT();
+  if (StoredVT == MVT::i32)
+    Opcode = ARM::t2STRi12;
+  else if (StoredVT == MVT::i16)
+    Opcode = ARM::t2STRHi12;
+  else if (StoredVT == MVT::i8)
+    Opcode = ARM::t2STRBi12;
+  else
+    return false;
+
+  SDValue Ptr = ST->getBasePtr();
+  if (CurDAG->isBaseWithConstantOffset(Ptr) ||
+      (Ptr.getOpcode() == ISD::SUB && isa<ConstantSDNode>(Ptr.getOperand(1)))) {
+    // Frame objects are addressed off SP or FP once the frame is laid out.
+    if (Ptr.getOperand(0).getOpcode() == ISD::FrameIndex)
+      return false;
+    int64_t RHSC = cast<ConstantSDNode>(Ptr.getOperand(1))->getSExtValue();
+    if (Ptr.getOpcode() == ISD::SUB)
+      RHSC = -RHSC;
+    if (RHSC >= 0 && RHSC <= 255)
+      return false;
+  } else if (Ptr.getOpcode() != ISD::ADD) {
+    // Only a register plus a register offset is left to avoid.
+    return false;
+  }
+
+  SDLoc dl(ST);
+  SDValue Ops[] = {ST->getValue(),
+                   Ptr,
+                   CurDAG->getTargetConstant(0, dl, MVT::i32),
+                   getAL(CurDAG, dl),
+                   CurDAG->getRegister(0, MVT::i32),
+                   ST->getChain()};
+  MachineSDNode *New = CurDAG->getMachineNode(Opcode, dl, MVT::Other, Ops);
+  CurDAG->setNodeMemRefs(New, {ST->getMemOperand()});
+  ReplaceNode(ST, New);
+  return true;
+}
+
 /// Form a GPRPair pseudo register from a pair of GPR regs.
 SDNode *ARMDAGToDAGISel::createGPRPairNode(EVT VT, SDValue V0, SDValue V1) {
   SDLoc dl(V0.getNode());
@@ -2215,6 +2282,49 @@ void ARMDAGToDAGISel::SelectVLDSTLane(SDNode *N, bool IsLoad, bool isUpdating,
   CurDAG->RemoveDeadNode(N);
 }
 
+void ARMDAGToDAGISel::SelectMVE_VLD(SDNode *N, unsigned NumVecs,
+                                    const uint16_t *const *Opcodes) {
+  EVT VT = N->getValueType(0);
+  SDLoc Loc(N);
+
+  const uint16_t *OurOpcodes;
+  switch (VT.getVectorElementType().getSizeInBits()) {
+  case 8:
+    OurOpcodes = Opcodes[0];
+    break;
+  case 16:
+    OurOpcodes = Opcodes[1];
+    break;
+  case 32:
+    OurOpcodes = Opcodes[2];
+    break;
+  default:
+    llvm_unreachable("bad vector element size in SelectMVE_VLD");
+  }
+
+  // Each stage of the sequence loads part of every vector, so the stages are
+  // chained through a register tuple holding all of them.
+  EVT DataTy = EVT::getVectorVT(*CurDAG->getContext(), MVT::i64, NumVecs * 2);
+  EVT ResultTys[] = {DataTy, MVT::Other};
+
+  auto Data = SDValue(
+      CurDAG->getMachineNode(TargetOpcode::IMPLICIT_DEF, Loc, DataTy), 0);
+  SDValue Chain = N->getOperand(0);
+  for (unsigned Stage = 0; Stage < NumVecs; ++Stage) {
+    SDValue Ops[] = {Data, N->getOperand(2), Chain};
+    auto LoadInst =
+        CurDAG->getMachineNode(OurOpcodes[Stage], Loc, ResultTys, Ops);
+    Data = SDValue(LoadInst, 0);
+    Chain = SDValue(LoadInst, 1);
+  }
+
+  for (unsigned i = 0; i < NumVecs; i++)
+    ReplaceUses(SDValue(N, i),
+                CurDAG->getTargetExtractSubreg(ARM::qsub_0 + i, Loc, VT, Data));
+  ReplaceUses(SDValue(N, NumVecs), Chain);
+  CurDAG->RemoveDeadNode(N);
+}
+
 void ARMDAGToDAGISel::SelectVLDDup(SDNode *N, bool IsIntrinsic,
                                    bool isUpdating, unsigned NumVecs,
                                    const uint16_t *DOpcodes,
@@ -2677,6 +2787,8 @@ void ARMDAGToDAGISel::Select(SDNode *N) {
         return;
       }
     }
+    if (tryT2SilhouetteStore(ST))
+      return;
     break;
   }
   case ISD::WRITE_REGISTER:
@@ -3924,6 +4036,31 @@ void ARMDAGToDAGISel::Select(SDNode *N) {
       SelectVLDSTLane(N, false, false, 4, DOpcodes, QOpcodes);
       return;
     }
+
+    case Intrinsic::arm_mve_vld2q: {
+      static const uint16_t Opcodes8[] = {ARM::MVE_VLD20_8, ARM::MVE_VLD21_8};
+      static const uint16_t Opcodes16[] = {ARM::MVE_VLD20_16,
+                                           ARM::MVE_VLD21_16};
+      static const uint16_t Opcodes32[] = {ARM::MVE_VLD20_32,
+                                           ARM::MVE_VLD21_32};
+      static const uint16_t *const Opcodes[] = {Opcodes8, Opcodes16, Opcodes32};
+      SelectMVE_VLD(N, 2, Opcodes);
+      return;
+    }
+
+    case Intrinsic::arm_mve_vld4q: {
+      static const uint16_t Opcodes8[] = {ARM::MVE_VLD40_8, ARM::MVE_VLD41_8,
+                                          ARM::MVE_VLD42_8, ARM::MVE_VLD43_8};
+      static const uint16_t Opcodes16[] = {ARM::MVE_VLD40_16, ARM::MVE_VLD41_16,
+                                           ARM::MVE_VLD42_16,
+                                           ARM::MVE_VLD43_16};
+      static const uint16_t Opcodes32[] = {ARM::MVE_VLD40_32, ARM::MVE_VLD41_32,
+                                           ARM::MVE_VLD42_32,
+                                           ARM::MVE_VLD43_32};
+      static const uint16_t *const Opcodes[] = {Opcodes8, Opcodes16, Opcodes32};
+      SelectMVE_VLD(N, 4, Opcodes);
+      return;
+    }
     }
     break;
   }
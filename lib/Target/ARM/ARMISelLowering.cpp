@@ -142,6 +142,8 @@ static cl::opt<unsigned> ConstpoolPromotionMaxTotal(
     cl::desc("Maximum size of ALL constants to promote into a constant pool"),
     cl::init(128));
 
+extern bool SilhouetteStr2Strt;
+
 // The APCS parameter registers.
 static const MCPhysReg GPRArgRegs[] = {
   ARM::R0, ARM::R1, ARM::R2, ARM::R3
@@ -259,6 +261,14 @@ void ARMTargetLowering::addMVEVectorTypes(bool HasMVEFP) {
     setOperationAction(ISD::UMAX, VT, Legal);
     setOperationAction(ISD::ABS, VT, Legal);
 
+    // VADDV and VMLADAV reduce across the lanes of a vector.
+    setOperationAction(ISD::VECREDUCE_ADD, VT, Legal);
+
+    // Predicated loads zero the false lanes, so masked loads need their
+    // passthru made zero. Masked stores are selected as they are.
+    setOperationAction(ISD::MLOAD, VT, Custom);
+    setOperationAction(ISD::MSTORE, VT, Legal);
+
     // No native support for these.
     setOperationAction(ISD::UDIV, VT, Expand);
     setOperationAction(ISD::SDIV, VT, Expand);
@@ -287,6 +297,8 @@ void ARMTargetLowering::addMVEVectorTypes(bool HasMVEFP) {
     setOperationAction(ISD::BUILD_VECTOR, VT, Custom);
     setOperationAction(ISD::BUILD_VECTOR, VT.getVectorElementType(), Custom);
     setOperationAction(ISD::SCALAR_TO_VECTOR, VT, Legal);
+    setOperationAction(ISD::MLOAD, VT, Custom);
+    setOperationAction(ISD::MSTORE, VT, Legal);
 
     if (HasMVEFP) {
       setOperationAction(ISD::FMINNUM, VT, Legal);
@@ -334,6 +346,12 @@ void ARMTargetLowering::addMVEVectorTypes(bool HasMVEFP) {
   setTruncStoreAction(MVT::v4i32, MVT::v4i16, Legal);
   setTruncStoreAction(MVT::v4i32, MVT::v4i8,  Legal);
   setTruncStoreAction(MVT::v8i16, MVT::v8i8,  Legal);
+
+  // The predicate types are promoted, so VCTP is replaced by a node that
+  // makes a mask of the promoted type.
+  const MVT PredTypes[] = { MVT::v16i1, MVT::v8i1, MVT::v4i1 };
+  for (auto VT : PredTypes)
+    setOperationAction(ISD::INTRINSIC_WO_CHAIN, VT, Custom);
 }
 
 ARMTargetLowering::ARMTargetLowering(const TargetMachine &TM,
@@ -1426,6 +1444,13 @@ ARMTargetLowering::findRepresentativeClass(const TargetRegisterInfo *TRI,
     RRC = &ARM::DPRRegClass;
     Cost = 8;
     break;
+  // The MVE predicates aren't legal types, but the VCTPs and VCMPs that
+  // instruction selection makes for masks still define them in VPR.
+  case MVT::v16i1: case MVT::v8i1: case MVT::v4i1:
+    if (!Subtarget->hasMVEIntegerOps())
+      return TargetLowering::findRepresentativeClass(TRI, VT);
+    RRC = &ARM::VCCRRegClass;
+    break;
   }
   return std::make_pair(RRC, Cost);
 }
@@ -1532,6 +1557,7 @@ const char *ARMTargetLowering::getTargetNodeName(unsigned Opcode) const {
   case ARMISD::VMOVIMM:       return "ARMISD::VMOVIMM";
   case ARMISD::VMVNIMM:       return "ARMISD::VMVNIMM";
   case ARMISD::VMOVFPIMM:     return "ARMISD::VMOVFPIMM";
+  case ARMISD::VCTP:          return "ARMISD::VCTP";
   case ARMISD::VDUP:          return "ARMISD::VDUP";
   case ARMISD::VDUPLANE:      return "ARMISD::VDUPLANE";
   case ARMISD::VEXT:          return "ARMISD::VEXT";
@@ -8255,6 +8281,38 @@ void ARMTargetLowering::ExpandDIV_Windows(
   Results.push_back(Upper);
 }
 
+static SDValue LowerMLOAD(SDValue Op, SelectionDAG &DAG) {
+  MaskedLoadSDNode *N = cast<MaskedLoadSDNode>(Op.getNode());
+  MVT VT = Op.getSimpleValueType();
+  SDValue Mask = N->getMask();
+  SDValue PassThru = N->getPassThru();
+  SDLoc dl(Op);
+
+  // The predicated loads zero the false lanes. Load with a zero passthru of
+  // the loaded type and select the real one back in if it is anything else.
+  auto IsZeroOf = [](SDValue PassThru, EVT VT) {
+    return PassThru.getOpcode() == ARMISD::VMOVIMM &&
+           PassThru.getValueType() == VT &&
+           isNullConstant(PassThru.getOperand(0));
+  };
+
+  if (IsZeroOf(PassThru, VT))
+    return Op;
+
+  SDValue Zero = DAG.getNode(ARMISD::VMOVIMM, dl, VT,
+                             DAG.getTargetConstant(0, dl, MVT::i32));
+  SDValue NewLoad = DAG.getMaskedLoad(
+      VT, dl, N->getChain(), N->getBasePtr(), Mask, Zero, N->getMemoryVT(),
+      N->getMemOperand(), N->getExtensionType(), N->isExpandingLoad());
+  SDValue Combo = NewLoad;
+  SDValue Source = peekThroughBitcasts(PassThru);
+  if (!PassThru.isUndef() &&
+      !ISD::isBuildVectorAllZeros(Source.getNode()) &&
+      !IsZeroOf(Source, Source.getValueType()))
+    Combo = DAG.getNode(ISD::VSELECT, dl, VT, Mask, NewLoad, PassThru);
+  return DAG.getMergeValues({Combo, NewLoad.getValue(1)}, dl);
+}
+
 static SDValue LowerAtomicLoadStore(SDValue Op, SelectionDAG &DAG) {
   if (isStrongerThanMonotonic(cast<AtomicSDNode>(Op)->getOrdering()))
     // Acquire/Release load/store is not legal for targets without a dmb or
@@ -8455,6 +8513,7 @@ SDValue ARMTargetLowering::LowerOperation(SDValue Op, SelectionDAG &DAG) const {
   case ISD::ATOMIC_LOAD:
   case ISD::ATOMIC_STORE:  return LowerAtomicLoadStore(Op, DAG);
   case ISD::FSINCOS:       return LowerFSINCOS(Op, DAG);
+  case ISD::MLOAD:         return LowerMLOAD(Op, DAG);
   case ISD::SDIVREM:
   case ISD::UDIVREM:       return LowerDivRem(Op, DAG);
   case ISD::DYNAMIC_STACKALLOC:
@@ -8499,6 +8558,23 @@ static void ReplaceLongIntrinsic(SDNode *N, SmallVectorImpl<SDValue> &Results,
   Results.push_back(LongMul.getValue(1));
 }
 
+/// ReplaceVCTP - The MVE predicate types are not legal, so build the mask of
+/// the tail predication intrinsics in the vector type they are promoted to,
+/// and truncate it for the type legalizer to promote again.
+static SDValue ReplaceVCTP(SDNode *N, SelectionDAG &DAG) {
+  unsigned IntNo = cast<ConstantSDNode>(N->getOperand(0))->getZExtValue();
+  if (IntNo != Intrinsic::arm_mve_vctp8 &&
+      IntNo != Intrinsic::arm_mve_vctp16 &&
+      IntNo != Intrinsic::arm_mve_vctp32)
+    return SDValue();
+
+  SDLoc dl(N);
+  EVT VT = DAG.getTargetLoweringInfo().getTypeToTransformTo(
+      *DAG.getContext(), N->getValueType(0));
+  SDValue VCTP = DAG.getNode(ARMISD::VCTP, dl, VT, N->getOperand(1));
+  return DAG.getNode(ISD::TRUNCATE, dl, N->getValueType(0), VCTP);
+}
+
 /// ReplaceNodeResults - Replace the results of node with an illegal result
 /// type with new values built out of custom code.
 void ARMTargetLowering::ReplaceNodeResults(SDNode *N,
@@ -8542,6 +8618,10 @@ void ARMTargetLowering::ReplaceNodeResults(SDNode *N,
     ReplaceCMP_SWAP_64Results(N, Results, DAG);
     return;
   case ISD::INTRINSIC_WO_CHAIN:
+    if (N->getValueType(0).isVector()) {
+      Res = ReplaceVCTP(N, DAG);
+      break;
+    }
     return ReplaceLongIntrinsic(N, Results, DAG);
   case ISD::ABS:
      lowerABS(N, Results, DAG);
@@ -12382,11 +12462,63 @@ static SDValue PerformLOADCombine(SDNode *N,
   return SDValue();
 }
 
+/// PerformSilhouetteFPStoreCombine - Store FP values from core registers for
+/// Silhouette. It turns every store, volatile ones included, into unprivileged
+/// stores of core registers, which cannot store FP registers. Rather than have
+/// it find free core registers to move FP values through after register
+/// allocation, or spill some, move them into core registers here and let the
+/// register allocator pick the registers.
+static SDValue
+PerformSilhouetteFPStoreCombine(StoreSDNode *St,
+                                TargetLowering::DAGCombinerInfo &DCI,
+                                const ARMSubtarget *Subtarget) {
+  SDValue StVal = St->getValue();
+  EVT VT = StVal.getValueType();
+  SelectionDAG &DAG = DCI.DAG;
+  // Privileged functions keep their stores as they are.
+  if (!SilhouetteStr2Strt || !Subtarget->isThumb2() ||
+      (VT != MVT::f32 && VT != MVT::f64) ||
+      !DAG.getTargetLoweringInfo().isTypeLegal(VT) || !St->isUnindexed() ||
+      St->isTruncatingStore() ||
+      DAG.getMachineFunction().getFunction().getSection().equals(
+          "privileged_functions"))
+    return SDValue();
+
+  SDLoc DL(St);
+  SDValue BasePtr = St->getBasePtr();
+  if (VT == MVT::f32) {
+    SDValue IntVal = DAG.getNode(ISD::BITCAST, DL, MVT::i32, StVal);
+    return DAG.getStore(St->getChain(), DL, IntVal, BasePtr,
+                        St->getPointerInfo(), St->getAlignment(),
+                        St->getMemOperand()->getFlags(), St->getAAInfo());
+  }
+
+  bool isBigEndian = DAG.getDataLayout().isBigEndian();
+  SDValue Halves = DAG.getNode(ARMISD::VMOVRRD, DL,
+                               DAG.getVTList(MVT::i32, MVT::i32), StVal);
+  SDValue NewST1 = DAG.getStore(
+      St->getChain(), DL, Halves.getValue(isBigEndian ? 1 : 0), BasePtr,
+      St->getPointerInfo(), St->getAlignment(),
+      St->getMemOperand()->getFlags());
+
+  SDValue OffsetPtr = DAG.getNode(ISD::ADD, DL, MVT::i32, BasePtr,
+                                  DAG.getConstant(4, DL, MVT::i32));
+  return DAG.getStore(NewST1.getValue(0), DL,
+                      Halves.getValue(isBigEndian ? 0 : 1), OffsetPtr,
+                      St->getPointerInfo().getWithOffset(4),
+                      MinAlign(St->getAlignment(), 4),
+                      St->getMemOperand()->getFlags());
+}
+
 /// PerformSTORECombine - Target-specific dag combine xforms for
 /// ISD::STORE.
 static SDValue PerformSTORECombine(SDNode *N,
-                                   TargetLowering::DAGCombinerInfo &DCI) {
+                                   TargetLowering::DAGCombinerInfo &DCI,
+                                   const ARMSubtarget *Subtarget) {
   StoreSDNode *St = cast<StoreSDNode>(N);
+  if (SDValue NewST = PerformSilhouetteFPStoreCombine(St, DCI, Subtarget))
+    return NewST;
+
   if (St->isVolatile())
     return SDValue();
 
@@ -13305,7 +13437,7 @@ SDValue ARMTargetLowering::PerformDAGCombine(SDNode *N,
   case ARMISD::BFI:     return PerformBFICombine(N, DCI);
   case ARMISD::VMOVRRD: return PerformVMOVRRDCombine(N, DCI, Subtarget);
   case ARMISD::VMOVDRR: return PerformVMOVDRRCombine(N, DCI.DAG);
-  case ISD::STORE:      return PerformSTORECombine(N, DCI);
+  case ISD::STORE:      return PerformSTORECombine(N, DCI, Subtarget);
   case ISD::BUILD_VECTOR: return PerformBUILD_VECTORCombine(N, DCI, Subtarget);
   case ISD::INSERT_VECTOR_ELT: return PerformInsertEltCombine(N, DCI);
   case ISD::VECTOR_SHUFFLE: return PerformVECTOR_SHUFFLECombine(N, DCI.DAG);
@@ -13423,6 +13555,19 @@ bool ARMTargetLowering::isDesirableToTransformToIntegerOp(unsigned Opc,
   return (VT == MVT::f32) && (Opc == ISD::LOAD || Opc == ISD::STORE);
 }
 
+bool ARMTargetLowering::isStoreBitCastBeneficial(
+    EVT StoreVT, EVT BitcastVT, const SelectionDAG &DAG,
+    const MachineMemOperand &MMO) const {
+  // Keep storing the f32 values that PerformSTORECombine moved into core
+  // registers for Silhouette from there.
+  if (SilhouetteStr2Strt && Subtarget->isThumb2() && BitcastVT == MVT::f32 &&
+      !DAG.getMachineFunction().getFunction().getSection().equals(
+          "privileged_functions"))
+    return false;
+  return TargetLowering::isStoreBitCastBeneficial(StoreVT, BitcastVT, DAG,
+                                                  MMO);
+}
+
 bool ARMTargetLowering::allowsMisalignedMemoryAccesses(EVT VT, unsigned,
                                                        unsigned Alignment,
                                                        MachineMemOperand::Flags,
@@ -14226,6 +14371,18 @@ void ARMTargetLowering::computeKnownBitsForTargetNode(const SDValue Op,
   }
 }
 
+unsigned ARMTargetLowering::ComputeNumSignBitsForTargetNode(
+    SDValue Op, const APInt &DemandedElts, const SelectionDAG &DAG,
+    unsigned Depth) const {
+  switch (Op.getOpcode()) {
+  default: break;
+  case ARMISD::VCTP:
+    // Each lane of the mask is all ones or all zeros.
+    return Op.getScalarValueSizeInBits();
+  }
+  return 1;
+}
+
 bool
 ARMTargetLowering::targetShrinkDemandedConstant(SDValue Op,
                                                 const APInt &DemandedAPInt,
@@ -15450,11 +15607,18 @@ ARMTargetLowering::getNumInterleavedAccesses(VectorType *VecTy,
 }
 
 bool ARMTargetLowering::isLegalInterleavedAccessType(
-    VectorType *VecTy, const DataLayout &DL) const {
+    unsigned Factor, VectorType *VecTy, const DataLayout &DL) const {
 
   unsigned VecSize = DL.getTypeSizeInBits(VecTy);
   unsigned ElSize = DL.getTypeSizeInBits(VecTy->getElementType());
 
+  if (!Subtarget->hasNEON() && !Subtarget->hasMVEIntegerOps())
+    return false;
+
+  // MVE only has interleaving loads and stores of 2 and 4 vectors.
+  if (Subtarget->hasMVEIntegerOps() && Factor == 3)
+    return false;
+
   // Ensure the vector doesn't have f16 elements. Even though we could do an
   // i16 vldN, we can't hold the f16 vectors and will end up converting via
   // f32.
@@ -15470,8 +15634,11 @@ bool ARMTargetLowering::isLegalInterleavedAccessType(
     return false;
 
   // Ensure the total vector size is 64 or a multiple of 128. Types larger than
-  // 128 will be split into multiple interleaved accesses.
-  return VecSize == 64 || VecSize % 128 == 0;
+  // 128 will be split into multiple interleaved accesses. MVE only has 128-bit
+  // vectors.
+  if (Subtarget->hasNEON() && VecSize == 64)
+    return true;
+  return VecSize % 128 == 0;
 }
 
 /// Lower an interleaved load into a vldN intrinsic.
@@ -15485,6 +15652,8 @@ bool ARMTargetLowering::isLegalInterleavedAccessType(
 ///        %vld2 = { <4 x i32>, <4 x i32> } call llvm.arm.neon.vld2(%ptr, 4)
 ///        %vec0 = extractelement { <4 x i32>, <4 x i32> } %vld2, i32 0
 ///        %vec1 = extractelement { <4 x i32>, <4 x i32> } %vld2, i32 1
+///
+/// With MVE, the load becomes a call to llvm.arm.mve.vld2q or vld4q instead.
 bool ARMTargetLowering::lowerInterleavedLoad(
     LoadInst *LI, ArrayRef<ShuffleVectorInst *> Shuffles,
     ArrayRef<unsigned> Indices, unsigned Factor) const {
@@ -15499,10 +15668,10 @@ bool ARMTargetLowering::lowerInterleavedLoad(
 
   const DataLayout &DL = LI->getModule()->getDataLayout();
 
-  // Skip if we do not have NEON and skip illegal vector types. We can
+  // Skip if we do not have NEON or MVE and skip illegal vector types. We can
   // "legalize" wide vector types into multiple interleaved accesses as long as
   // the vector types are divisible by 128.
-  if (!Subtarget->hasNEON() || !isLegalInterleavedAccessType(VecTy, DL))
+  if (!isLegalInterleavedAccessType(Factor, VecTy, DL))
     return false;
 
   unsigned NumLoads = getNumInterleavedAccesses(VecTy, DL);
@@ -15534,13 +15703,36 @@ bool ARMTargetLowering::lowerInterleavedLoad(
 
   assert(isTypeLegal(EVT::getEVT(VecTy)) && "Illegal vldN vector type!");
 
-  Type *Int8Ptr = Builder.getInt8PtrTy(LI->getPointerAddressSpace());
-  Type *Tys[] = {VecTy, Int8Ptr};
-  static const Intrinsic::ID LoadInts[3] = {Intrinsic::arm_neon_vld2,
-                                            Intrinsic::arm_neon_vld3,
-                                            Intrinsic::arm_neon_vld4};
-  Function *VldnFunc =
-      Intrinsic::getDeclaration(LI->getModule(), LoadInts[Factor - 2], Tys);
+  auto createLoadIntrinsic = [&](Value *BaseAddr) -> CallInst * {
+    if (Subtarget->hasNEON()) {
+      Type *Int8Ptr = Builder.getInt8PtrTy(LI->getPointerAddressSpace());
+      Type *Tys[] = {VecTy, Int8Ptr};
+      static const Intrinsic::ID LoadInts[3] = {Intrinsic::arm_neon_vld2,
+                                                Intrinsic::arm_neon_vld3,
+                                                Intrinsic::arm_neon_vld4};
+      Function *VldnFunc =
+          Intrinsic::getDeclaration(LI->getModule(), LoadInts[Factor - 2], Tys);
+
+      SmallVector<Value *, 2> Ops;
+      Ops.push_back(Builder.CreateBitCast(BaseAddr, Int8Ptr));
+      Ops.push_back(Builder.getInt32(LI->getAlignment()));
+
+      return Builder.CreateCall(VldnFunc, Ops, "vldN");
+    }
+
+    assert((Factor == 2 || Factor == 4) &&
+           "expected interleave factor of 2 or 4 for MVE");
+    Intrinsic::ID LoadInt =
+        Factor == 2 ? Intrinsic::arm_mve_vld2q : Intrinsic::arm_mve_vld4q;
+    Type *EltPtrTy = VecTy->getVectorElementType()->getPointerTo(
+        LI->getPointerAddressSpace());
+    Type *Tys[] = {VecTy, EltPtrTy};
+    Function *VldnFunc =
+        Intrinsic::getDeclaration(LI->getModule(), LoadInt, Tys);
+
+    return Builder.CreateCall(
+        VldnFunc, {Builder.CreateBitCast(BaseAddr, EltPtrTy)}, "vldN");
+  };
 
   // Holds sub-vectors extracted from the load intrinsic return values. The
   // sub-vectors are associated with the shufflevector instructions they will
@@ -15555,11 +15747,7 @@ bool ARMTargetLowering::lowerInterleavedLoad(
           Builder.CreateConstGEP1_32(VecTy->getVectorElementType(), BaseAddr,
                                      VecTy->getVectorNumElements() * Factor);
 
-    SmallVector<Value *, 2> Ops;
-    Ops.push_back(Builder.CreateBitCast(BaseAddr, Int8Ptr));
-    Ops.push_back(Builder.getInt32(LI->getAlignment()));
-
-    CallInst *VldN = Builder.CreateCall(VldnFunc, Ops, "vldN");
+    CallInst *VldN = createLoadIntrinsic(BaseAddr);
 
     // Replace uses of each shufflevector with the corresponding vector loaded
     // by ldN.
@@ -15619,6 +15807,9 @@ bool ARMTargetLowering::lowerInterleavedLoad(
 ///        %sub.v1 = shuffle <32 x i32> %v0, <32 x i32> v1, <32, 33, 34, 35>
 ///        %sub.v2 = shuffle <32 x i32> %v0, <32 x i32> v1, <16, 17, 18, 19>
 ///        call void llvm.arm.neon.vst3(%ptr, %sub.v0, %sub.v1, %sub.v2, 4)
+///
+/// With MVE, the store becomes one call to llvm.arm.mve.vst2q or vst4q for
+/// each stage of the VST2/VST4 sequence.
 bool ARMTargetLowering::lowerInterleavedStore(StoreInst *SI,
                                               ShuffleVectorInst *SVI,
                                               unsigned Factor) const {
@@ -15635,10 +15826,10 @@ bool ARMTargetLowering::lowerInterleavedStore(StoreInst *SI,
 
   const DataLayout &DL = SI->getModule()->getDataLayout();
 
-  // Skip if we do not have NEON and skip illegal vector types. We can
+  // Skip if we do not have NEON or MVE and skip illegal vector types. We can
   // "legalize" wide vector types into multiple interleaved accesses as long as
   // the vector types are divisible by 128.
-  if (!Subtarget->hasNEON() || !isLegalInterleavedAccessType(SubVecTy, DL))
+  if (!isLegalInterleavedAccessType(Factor, SubVecTy, DL))
     return false;
 
   unsigned NumStores = getNumInterleavedAccesses(SubVecTy, DL);
@@ -15682,11 +15873,45 @@ bool ARMTargetLowering::lowerInterleavedStore(StoreInst *SI,
 
   auto Mask = SVI->getShuffleMask();
 
-  Type *Int8Ptr = Builder.getInt8PtrTy(SI->getPointerAddressSpace());
-  Type *Tys[] = {Int8Ptr, SubVecTy};
-  static const Intrinsic::ID StoreInts[3] = {Intrinsic::arm_neon_vst2,
-                                             Intrinsic::arm_neon_vst3,
-                                             Intrinsic::arm_neon_vst4};
+  auto createStoreIntrinsic = [&](Value *BaseAddr,
+                                  SmallVectorImpl<Value *> &Shuffles) {
+    if (Subtarget->hasNEON()) {
+      static const Intrinsic::ID StoreInts[3] = {Intrinsic::arm_neon_vst2,
+                                                 Intrinsic::arm_neon_vst3,
+                                                 Intrinsic::arm_neon_vst4};
+      Type *Int8Ptr = Builder.getInt8PtrTy(SI->getPointerAddressSpace());
+      Type *Tys[] = {Int8Ptr, SubVecTy};
+
+      Function *VstNFunc = Intrinsic::getDeclaration(
+          SI->getModule(), StoreInts[Factor - 2], Tys);
+
+      SmallVector<Value *, 6> Ops;
+      Ops.push_back(Builder.CreateBitCast(BaseAddr, Int8Ptr));
+      Ops.append(Shuffles.begin(), Shuffles.end());
+      Ops.push_back(Builder.getInt32(SI->getAlignment()));
+      Builder.CreateCall(VstNFunc, Ops);
+      return;
+    }
+
+    assert((Factor == 2 || Factor == 4) &&
+           "expected interleave factor of 2 or 4 for MVE");
+    Intrinsic::ID StoreInt =
+        Factor == 2 ? Intrinsic::arm_mve_vst2q : Intrinsic::arm_mve_vst4q;
+    Type *EltPtrTy = SubVecTy->getVectorElementType()->getPointerTo(
+        SI->getPointerAddressSpace());
+    Type *Tys[] = {EltPtrTy, SubVecTy};
+    Function *VstNFunc =
+        Intrinsic::getDeclaration(SI->getModule(), StoreInt, Tys);
+
+    SmallVector<Value *, 6> Ops;
+    Ops.push_back(Builder.CreateBitCast(BaseAddr, EltPtrTy));
+    Ops.append(Shuffles.begin(), Shuffles.end());
+    for (unsigned F = 0; F < Factor; F++) {
+      Ops.push_back(Builder.getInt32(F));
+      Builder.CreateCall(VstNFunc, Ops);
+      Ops.pop_back();
+    }
+  };
 
   for (unsigned StoreCount = 0; StoreCount < NumStores; ++StoreCount) {
     // If we generating more than one store, we compute the base address of
@@ -15695,17 +15920,13 @@ bool ARMTargetLowering::lowerInterleavedStore(StoreInst *SI,
       BaseAddr = Builder.CreateConstGEP1_32(SubVecTy->getVectorElementType(),
                                             BaseAddr, LaneLen * Factor);
 
-    SmallVector<Value *, 6> Ops;
-    Ops.push_back(Builder.CreateBitCast(BaseAddr, Int8Ptr));
-
-    Function *VstNFunc =
-        Intrinsic::getDeclaration(SI->getModule(), StoreInts[Factor - 2], Tys);
+    SmallVector<Value *, 4> Shuffles;
 
     // Split the shufflevector operands into sub vectors for the new vstN call.
     for (unsigned i = 0; i < Factor; i++) {
       unsigned IdxI = StoreCount * LaneLen * Factor + i;
       if (Mask[IdxI] >= 0) {
-        Ops.push_back(Builder.CreateShuffleVector(
+        Shuffles.push_back(Builder.CreateShuffleVector(
             Op0, Op1, createSequentialMask(Builder, Mask[IdxI], LaneLen, 0)));
       } else {
         unsigned StartMask = 0;
@@ -15722,13 +15943,12 @@ bool ARMTargetLowering::lowerInterleavedStore(StoreInst *SI,
         // In the case of all undefs we're defaulting to using elems from 0
         // Note: StartMask cannot be negative, it's checked in
         // isReInterleaveMask
-        Ops.push_back(Builder.CreateShuffleVector(
+        Shuffles.push_back(Builder.CreateShuffleVector(
             Op0, Op1, createSequentialMask(Builder, StartMask, LaneLen, 0)));
       }
     }
 
-    Ops.push_back(Builder.getInt32(SI->getAlignment()));
-    Builder.CreateCall(VstNFunc, Ops);
+    createStoreIntrinsic(BaseAddr, Shuffles);
   }
   return true;
 }
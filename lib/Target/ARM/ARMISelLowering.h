@@ -182,6 +182,9 @@ class VectorType;
       // Vector move f32 immediate:
       VMOVFPIMM,
 
+      // MVE tail predication mask (VCTP):
+      VCTP,
+
       // Move H <-> R, clearing top 16 bits
       VMOVrh,
       VMOVhr,
@@ -326,6 +329,10 @@ class VectorType;
 
     bool isDesirableToTransformToIntegerOp(unsigned Opc, EVT VT) const override;
 
+    bool isStoreBitCastBeneficial(EVT StoreVT, EVT BitcastVT,
+                                  const SelectionDAG &DAG,
+                                  const MachineMemOperand &MMO) const override;
+
     /// allowsMisalignedMemoryAccesses - Returns true if the target allows
     /// unaligned memory accesses of the specified type. Returns whether it
     /// is "fast" by reference in the second argument.
@@ -403,6 +410,11 @@ class VectorType;
                                        const SelectionDAG &DAG,
                                        unsigned Depth) const override;
 
+    unsigned ComputeNumSignBitsForTargetNode(SDValue Op,
+                                             const APInt &DemandedElts,
+                                             const SelectionDAG &DAG,
+                                             unsigned Depth) const override;
+
     bool targetShrinkDemandedConstant(SDValue Op, const APInt &Demanded,
                                       TargetLoweringOpt &TLO) const override;
 
@@ -592,10 +604,10 @@ class VectorType;
     CCAssignFn *CCAssignFnForCall(CallingConv::ID CC, bool isVarArg) const;
     CCAssignFn *CCAssignFnForReturn(CallingConv::ID CC, bool isVarArg) const;
 
-    /// Returns true if \p VecTy is a legal interleaved access type. This
-    /// function checks the vector element type and the overall width of the
-    /// vector.
-    bool isLegalInterleavedAccessType(VectorType *VecTy,
+    /// Returns true if \p VecTy is a legal interleaved access type with
+    /// interleave factor \p Factor. This function checks the vector element
+    /// type and the overall width of the vector.
+    bool isLegalInterleavedAccessType(unsigned Factor, VectorType *VecTy,
                                       const DataLayout &DL) const;
 
     bool alignLoopsWithOptSize() const override;
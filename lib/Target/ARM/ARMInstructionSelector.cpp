@@ -60,6 +60,11 @@ private:
   bool selectSelect(MachineInstrBuilder &MIB, MachineRegisterInfo &MRI) const;
   bool selectShift(unsigned ShiftOpc, MachineInstrBuilder &MIB) const;
 
+  // Select G_UADDO, G_UADDE, G_USUBO and G_USUBE by going through the carry
+  // flag. The carry out, if used, is materialized as 0 or 1.
+  bool selectCarryArith(MachineInstrBuilder &MIB,
+                        MachineRegisterInfo &MRI) const;
+
   // Check if the types match and both operands have the expected size and
   // register bank.
   bool validOpRegPair(MachineRegisterInfo &MRI, unsigned LHS, unsigned RHS,
@@ -105,6 +110,12 @@ private:
     unsigned ADDrr;
     unsigned ADDri;
 
+    // Used for G_UADDO/G_UADDE/G_USUBO/G_USUBE
+    unsigned SUBrr;
+    unsigned ADCrr;
+    unsigned SBCrr;
+    unsigned CMPri;
+
     // Used for G_ICMP
     unsigned CMPrr;
     unsigned MOVi;
@@ -318,6 +329,11 @@ ARMInstructionSelector::OpcodeCache::OpcodeCache(const ARMSubtarget &STI) {
   STORE_OPCODE(ADDrr, ADDrr);
   STORE_OPCODE(ADDri, ADDri);
 
+  STORE_OPCODE(SUBrr, SUBrr);
+  STORE_OPCODE(ADCrr, ADCrr);
+  STORE_OPCODE(SBCrr, SBCrr);
+  STORE_OPCODE(CMPri, CMPri);
+
   STORE_OPCODE(CMPrr, CMPrr);
   STORE_OPCODE(MOVi, MOVi);
   STORE_OPCODE(MOVCCi, MOVCCi);
@@ -800,6 +816,143 @@ bool ARMInstructionSelector::selectSelect(MachineInstrBuilder &MIB,
   return true;
 }
 
+static bool isCarryArith(unsigned Opc, bool IsAdd) {
+  using namespace TargetOpcode;
+  if (IsAdd)
+    return Opc == G_UADDO || Opc == G_UADDE;
+  return Opc == G_USUBO || Opc == G_USUBE;
+}
+
+bool ARMInstructionSelector::selectCarryArith(MachineInstrBuilder &MIB,
+                                              MachineRegisterInfo &MRI) const {
+  using namespace TargetOpcode;
+
+  auto &MBB = *MIB->getParent();
+  auto InsertBefore = std::next(MIB->getIterator());
+  auto &DbgLoc = MIB->getDebugLoc();
+
+  unsigned Opc = MIB->getOpcode();
+  bool IsAdd = isCarryArith(Opc, /*IsAdd=*/true);
+  bool HasCarryIn = Opc == G_UADDE || Opc == G_USUBE;
+
+  auto ResReg = MIB->getOperand(0).getReg();
+  auto CarryOutReg = MIB->getOperand(1).getReg();
+  auto LHSReg = MIB->getOperand(2).getReg();
+  auto RHSReg = MIB->getOperand(3).getReg();
+  assert(validOpRegPair(MRI, LHSReg, RHSReg, 32, ARM::GPRRegBankID) &&
+         validReg(MRI, ResReg, 32, ARM::GPRRegBankID) &&
+         validReg(MRI, CarryOutReg, 1, ARM::GPRRegBankID) &&
+         "Unsupported types for carry operation");
+
+  // The legalizer starts wide additions with a constant 0 carry in, which
+  // doesn't need to go through the flags.
+  if (HasCarryIn) {
+    auto CarryIn =
+        getConstantVRegValWithLookThrough(MIB->getOperand(4).getReg(), MRI);
+    if (CarryIn && CarryIn->Value == 0)
+      HasCarryIn = false;
+  }
+
+  // If the carry in comes straight from the previous part of a wide addition
+  // or subtraction, it is still in the flags. The instruction that computes it
+  // hasn't been selected yet (we select bottom-up), so leave it an implicit
+  // use of the carry to find and turn into the flags when its turn comes.
+  bool CarryInFromFlags = false;
+  if (HasCarryIn) {
+    auto CarryInReg = MIB->getOperand(4).getReg();
+    auto *CarryInDef = MRI.getVRegDef(CarryInReg);
+    CarryInFromFlags =
+        CarryInDef && isCarryArith(CarryInDef->getOpcode(), IsAdd) &&
+        CarryInDef->getOperand(1).getReg() == CarryInReg &&
+        MRI.hasOneNonDBGUse(CarryInReg) &&
+        std::next(CarryInDef->getIterator()) == MIB->getIterator();
+  }
+
+  if (HasCarryIn && !CarryInFromFlags) {
+    auto CarryInReg = MIB->getOperand(4).getReg();
+    assert(validReg(MRI, CarryInReg, 1, ARM::GPRRegBankID) &&
+           "Unsupported types for carry operation");
+
+    // Only the lowest bit of a 1-bit value is meaningful.
+    auto MaskedReg = MRI.createVirtualRegister(&ARM::GPRRegClass);
+    auto AndI = BuildMI(MBB, InsertBefore, DbgLoc, TII.get(Opcodes.AND))
+                    .addDef(MaskedReg)
+                    .addUse(CarryInReg)
+                    .addImm(1)
+                    .add(predOps(ARMCC::AL))
+                    .add(condCodeOp());
+    if (!constrainSelectedInstRegOperands(*AndI, TII, TRI, RBI))
+      return false;
+
+    // Move the carry into the C flag. ARM subtractions use C as an inverted
+    // borrow, so for those C must be set iff there is no borrow in.
+    MachineInstrBuilder SetCI;
+    if (IsAdd)
+      SetCI = BuildMI(MBB, InsertBefore, DbgLoc, TII.get(Opcodes.CMPri))
+                  .addUse(MaskedReg)
+                  .addImm(1)
+                  .add(predOps(ARMCC::AL));
+    else
+      SetCI = BuildMI(MBB, InsertBefore, DbgLoc, TII.get(Opcodes.RSB))
+                  .addDef(MRI.createVirtualRegister(&ARM::GPRRegClass))
+                  .addUse(MaskedReg)
+                  .addImm(0)
+                  .add(predOps(ARMCC::AL))
+                  .addReg(ARM::CPSR, RegState::Define);
+    if (!constrainSelectedInstRegOperands(*SetCI, TII, TRI, RBI))
+      return false;
+  }
+
+  // Check if the next part of a wide operation has left us a note that it
+  // reads the carry out from the flags.
+  bool CarryOutToFlags = false;
+  if (MRI.hasOneNonDBGUse(CarryOutReg)) {
+    auto &Use = *MRI.use_nodbg_begin(CarryOutReg);
+    auto *User = Use.getParent();
+    if (Use.isImplicit() && !isPreISelGenericOpcode(User->getOpcode())) {
+      User->RemoveOperand(User->getOperandNo(&Use));
+      CarryOutToFlags = true;
+    }
+  }
+  bool NeedsCarryOut = !MRI.use_nodbg_empty(CarryOutReg);
+
+  unsigned NewOpc = HasCarryIn ? (IsAdd ? Opcodes.ADCrr : Opcodes.SBCrr)
+                               : (IsAdd ? Opcodes.ADDrr : Opcodes.SUBrr);
+  auto ArithI = BuildMI(MBB, InsertBefore, DbgLoc, TII.get(NewOpc))
+                    .addDef(ResReg)
+                    .addUse(LHSReg)
+                    .addUse(RHSReg)
+                    .add(predOps(ARMCC::AL));
+  if (CarryOutToFlags || NeedsCarryOut)
+    ArithI.addReg(ARM::CPSR, RegState::Define);
+  else {
+    // ADC and SBC implicitly define CPSR, but nobody reads it.
+    ArithI.add(condCodeOp());
+    ArithI->addRegisterDead(ARM::CPSR, &TRI);
+  }
+  if (CarryInFromFlags)
+    ArithI.addReg(MIB->getOperand(4).getReg(), RegState::Implicit);
+  if (!constrainSelectedInstRegOperands(*ArithI, TII, TRI, RBI))
+    return false;
+
+  if (NeedsCarryOut) {
+    // Set the carry out to 1 if the flags say there was a carry (for
+    // additions) or a borrow (for subtractions), and to 0 otherwise.
+    auto ZeroReg = MRI.createVirtualRegister(&ARM::GPRRegClass);
+    putConstant(InsertInfo(MIB), ZeroReg, 0);
+    auto Mov1I = BuildMI(MBB, InsertBefore, DbgLoc, TII.get(Opcodes.MOVCCi))
+                     .addDef(CarryOutReg)
+                     .addUse(ZeroReg)
+                     .addImm(1)
+                     .add(predOps(IsAdd ? ARMCC::HS : ARMCC::LO, ARM::CPSR));
+    if (!constrainSelectedInstRegOperands(*Mov1I, TII, TRI, RBI))
+      return false;
+  }
+
+  MIB->eraseFromParent();
+  return true;
+}
+
 bool ARMInstructionSelector::selectShift(unsigned ShiftOpc,
                                          MachineInstrBuilder &MIB) const {
   assert(!STI.isThumb() && "Unsupported subtarget");
@@ -979,8 +1132,7 @@ bool ARMInstructionSelector::select(MachineInstr &I,
       }
     }
 
-    assert(!STI.isThumb() && "Unsupported subtarget");
-    I.setDesc(TII.get(ARM::MOVi));
+    I.setDesc(TII.get(Opcodes.MOVi));
     MIB.add(predOps(ARMCC::AL)).add(condCodeOp());
     break;
   }
@@ -1055,6 +1207,29 @@ bool ARMInstructionSelector::select(MachineInstr &I,
                         Opcodes.MOVCCi, ARM::FPRRegBankID, Size);
     return selectCmp(Helper, MIB, MRI);
   }
+  case G_UADDO:
+  case G_UADDE:
+  case G_USUBO:
+  case G_USUBE:
+    return selectCarryArith(MIB, MRI);
+  case G_UMULH: {
+    // Take the high half of a long multiply; the low half is dead.
+    unsigned Opc = STI.isThumb() ? ARM::t2UMULL
+                                 : STI.hasV6Ops() ? ARM::UMULL : ARM::UMULLv5;
+    auto MulI = BuildMI(MBB, I, I.getDebugLoc(), TII.get(Opc))
+                    .addDef(MRI.createVirtualRegister(&ARM::GPRRegClass),
+                            RegState::Dead)
+                    .add(I.getOperand(0))
+                    .add(I.getOperand(1))
+                    .add(I.getOperand(2))
+                    .add(predOps(ARMCC::AL));
+    if (!STI.isThumb())
+      MulI.add(condCodeOp());
+    if (!constrainSelectedInstRegOperands(*MulI, TII, TRI, RBI))
+      return false;
+    I.eraseFromParent();
+    return true;
+  }
   case G_LSHR:
     return selectShift(ARM_AM::ShiftOpc::lsr, MIB);
   case G_ASHR:
@@ -1156,6 +1331,38 @@ bool ARMInstructionSelector::select(MachineInstr &I,
     I.eraseFromParent();
     return true;
   }
+  case G_JUMP_TABLE:
+    // Only legal for Thumb2, where we branch through the table with t2BR_JT.
+    I.setDesc(TII.get(ARM::t2LEApcrelJT));
+    MIB.add(predOps(ARMCC::AL));
+    break;
+  case G_BRJT: {
+    // Like SelectionDAG, jump to the table entry rather than loading the
+    // destination from it, so that ARMConstantIslands can still turn this
+    // into a TBB/TBH.
+    auto TableReg = I.getOperand(0).getReg();
+    auto IndexReg = I.getOperand(2).getReg();
+    auto EntryReg = MRI.createVirtualRegister(&ARM::GPRnopcRegClass);
+    auto AddI =
+        BuildMI(MBB, I, I.getDebugLoc(), TII.get(ARM::t2ADDrs))
+            .addDef(EntryReg)
+            .addUse(TableReg)
+            .addUse(IndexReg)
+            .addImm(ARM_AM::getSORegOpc(ARM_AM::lsl, 2))
+            .add(predOps(ARMCC::AL))
+            .add(condCodeOp());
+    if (!constrainSelectedInstRegOperands(*AddI, TII, TRI, RBI))
+      return false;
+
+    auto Branch = BuildMI(MBB, I, I.getDebugLoc(), TII.get(ARM::t2BR_JT))
+                      .addUse(EntryReg)
+                      .addUse(IndexReg)
+                      .add(I.getOperand(1));
+    if (!constrainSelectedInstRegOperands(*Branch, TII, TRI, RBI))
+      return false;
+    I.eraseFromParent();
+    return true;
+  }
   case G_PHI: {
     I.setDesc(TII.get(PHI));
 
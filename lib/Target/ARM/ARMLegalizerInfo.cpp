@@ -82,12 +82,28 @@ ARMLegalizerInfo::ARMLegalizerInfo(const ARMSubtarget &ST) {
   }
 
   getActionDefinitionsBuilder({G_SEXT, G_ZEXT, G_ANYEXT})
-      .legalForCartesianProduct({s8, s16, s32}, {s1, s8, s16});
+      .legalForCartesianProduct({s8, s16, s32}, {s1, s8, s16})
+      .customForCartesianProduct({s64}, {s1, s8, s16, s32});
 
-  getActionDefinitionsBuilder({G_MUL, G_AND, G_OR, G_XOR})
+  getActionDefinitionsBuilder(G_TRUNC)
+      .legalForCartesianProduct({s1, s8, s16}, {s8, s16, s32})
+      .customForCartesianProduct({s1, s8, s16, s32}, {s64});
+
+  // 64-bit multiplications are split into 32-bit halves, taking the high half
+  // of the low product from a long multiply.
+  getActionDefinitionsBuilder(G_MUL)
       .legalFor({s32})
-      .minScalar(0, s32);
+      .clampScalar(0, s32, s32);
 
+  getActionDefinitionsBuilder(G_UMULH)
+      .legalFor({s32});
+
+  getActionDefinitionsBuilder({G_AND, G_OR, G_XOR})
+      .legalFor({s32})
+      .clampScalar(0, s32, s32);
+
+  // Without NEON, 64-bit additions and subtractions are split into 32-bit
+  // halves chained through the carry.
   if (ST.hasNEON())
     getActionDefinitionsBuilder({G_ADD, G_SUB})
         .legalFor({s32, s64})
@@ -95,12 +111,15 @@ ARMLegalizerInfo::ARMLegalizerInfo(const ARMSubtarget &ST) {
   else
     getActionDefinitionsBuilder({G_ADD, G_SUB})
         .legalFor({s32})
-        .minScalar(0, s32);
+        .clampScalar(0, s32, s32);
+
+  getActionDefinitionsBuilder({G_UADDO, G_UADDE, G_USUBO, G_USUBE})
+      .legalFor({{s32, s1}});
 
   getActionDefinitionsBuilder({G_ASHR, G_LSHR, G_SHL})
     .legalFor({{s32, s32}})
-    .minScalar(0, s32)
-    .clampScalar(1, s32, s32);
+    .clampScalar(1, s32, s32)
+    .clampScalar(0, s32, s32);
 
   bool HasHWDivide = (!ST.isThumb() && ST.hasDivideInARMMode()) ||
                      (ST.isThumb() && ST.hasDivideInThumbMode());
@@ -136,11 +155,11 @@ ARMLegalizerInfo::ARMLegalizerInfo(const ARMSubtarget &ST) {
 
   getActionDefinitionsBuilder(G_ICMP)
       .legalForCartesianProduct({s1}, {s32, p0})
-      .minScalar(1, s32);
+      .clampScalar(1, s32, s32);
 
   getActionDefinitionsBuilder(G_SELECT)
       .legalForCartesianProduct({s32, p0}, {s1})
-      .minScalar(0, s32);
+      .clampScalar(0, s32, s32);
 
   // We're keeping these builders around because we'll want to add support for
   // floating point to them.
@@ -166,7 +185,14 @@ ARMLegalizerInfo::ARMLegalizerInfo(const ARMSubtarget &ST) {
 
   getActionDefinitionsBuilder(G_BRCOND).legalFor({s1});
 
-  if (!ST.useSoftFloat() && ST.hasVFP2Base()) {
+  // Jump tables are only selected for Thumb2, which branches through the table
+  // with t2BR_JT like SelectionDAG does.
+  if (ST.isThumb2()) {
+    getActionDefinitionsBuilder(G_JUMP_TABLE).legalFor({p0});
+    getActionDefinitionsBuilder(G_BRJT).legalFor({{p0, s32}});
+  }
+
+  if (!ST.useSoftFloat() && ST.hasVFP2Base() && ST.hasFP64()) {
     getActionDefinitionsBuilder(
         {G_FADD, G_FSUB, G_FMUL, G_FDIV, G_FCONSTANT, G_FNEG})
         .legalFor({s32, s64});
@@ -189,11 +215,49 @@ ARMLegalizerInfo::ARMLegalizerInfo(const ARMSubtarget &ST) {
         .legalForCartesianProduct({s32}, {s32, s64});
     getActionDefinitionsBuilder({G_SITOFP, G_UITOFP})
         .legalForCartesianProduct({s32, s64}, {s32});
+  } else if (!ST.useSoftFloat() && ST.hasVFP2Base()) {
+    // Single precision only VFPs (e.g. on Cortex-M4F) can still load, store
+    // and move doubles, but need libcalls to compute with them.
+    getActionDefinitionsBuilder({G_FADD, G_FSUB, G_FMUL, G_FDIV})
+        .legalFor({s32})
+        .libcallFor({s64});
+
+    getActionDefinitionsBuilder(G_FCONSTANT).legalFor({s32, s64});
+
+    getActionDefinitionsBuilder(G_FNEG).legalFor({s32}).lowerFor({s64});
+
+    LoadStoreBuilder
+        .legalForTypesWithMemDesc({{s64, p0, 64, 32}})
+        .maxScalar(0, s32);
+    PhiBuilder.legalFor({s64});
+
+    getActionDefinitionsBuilder(G_FCMP)
+        .legalForCartesianProduct({s1}, {s32})
+        .customForCartesianProduct({s1}, {s64});
+
+    if (AEABI(ST))
+      setFCmpLibcallsAEABI();
+    else
+      setFCmpLibcallsGNU();
+
+    getActionDefinitionsBuilder(G_MERGE_VALUES).legalFor({{s64, s32}});
+    getActionDefinitionsBuilder(G_UNMERGE_VALUES).legalFor({{s32, s64}});
+
+    getActionDefinitionsBuilder(G_FPEXT).libcallFor({{s64, s32}});
+    getActionDefinitionsBuilder(G_FPTRUNC).libcallFor({{s32, s64}});
+
+    getActionDefinitionsBuilder({G_FPTOSI, G_FPTOUI})
+        .legalFor({{s32, s32}})
+        .libcallFor({{s32, s64}});
+    getActionDefinitionsBuilder({G_SITOFP, G_UITOFP})
+        .legalFor({{s32, s32}})
+        .libcallFor({{s64, s32}});
   } else {
     getActionDefinitionsBuilder({G_FADD, G_FSUB, G_FMUL, G_FDIV})
         .libcallFor({s32, s64});
 
     LoadStoreBuilder.maxScalar(0, s32);
+    PhiBuilder.maxScalar(0, s32);
 
     for (auto Ty : {s32, s64})
       setAction({G_FNEG, Ty}, Lower);
@@ -217,8 +281,10 @@ ARMLegalizerInfo::ARMLegalizerInfo(const ARMSubtarget &ST) {
         .libcallForCartesianProduct({s32, s64}, {s32});
   }
 
-  if (!ST.useSoftFloat() && ST.hasVFP4Base())
+  if (!ST.useSoftFloat() && ST.hasVFP4Base() && ST.hasFP64())
     getActionDefinitionsBuilder(G_FMA).legalFor({s32, s64});
+  else if (!ST.useSoftFloat() && ST.hasVFP4Base())
+    getActionDefinitionsBuilder(G_FMA).legalFor({s32}).libcallFor({s64});
   else
     getActionDefinitionsBuilder(G_FMA).libcallFor({s32, s64});
 
@@ -456,6 +522,41 @@ bool ARMLegalizerInfo::legalizeCustom(MachineInstr &MI,
     }
     break;
   }
+  case G_SEXT:
+  case G_ZEXT:
+  case G_ANYEXT: {
+    // Extend into the low half and fill the high half with copies of the sign
+    // bit, with zeros or, for G_ANYEXT, with whatever is already at hand.
+    const LLT s32 = LLT::scalar(32);
+    Register SrcReg = MI.getOperand(1).getReg();
+    Register LoReg = SrcReg;
+    if (MRI.getType(SrcReg) != s32)
+      LoReg = MIRBuilder.buildInstr(MI.getOpcode(), {s32}, {SrcReg}).getReg(0);
+
+    Register HiReg = LoReg;
+    if (MI.getOpcode() == G_SEXT)
+      HiReg =
+          MIRBuilder.buildAShr(s32, LoReg, MIRBuilder.buildConstant(s32, 31))
+              .getReg(0);
+    else if (MI.getOpcode() == G_ZEXT)
+      HiReg = MIRBuilder.buildConstant(s32, 0).getReg(0);
+
+    MIRBuilder.buildMerge(MI.getOperand(0).getReg(), {LoReg, HiReg});
+    break;
+  }
+  case G_TRUNC: {
+    // Only the low half matters.
+    const LLT s32 = LLT::scalar(32);
+    Register DstReg = MI.getOperand(0).getReg();
+    Register LoReg = MRI.createGenericVirtualRegister(s32);
+    Register HiReg = MRI.createGenericVirtualRegister(s32);
+    MIRBuilder.buildUnmerge({LoReg, HiReg}, MI.getOperand(1).getReg());
+    if (MRI.getType(DstReg) == s32)
+      MIRBuilder.buildCopy(DstReg, LoReg);
+    else
+      MIRBuilder.buildTrunc(DstReg, LoReg);
+    break;
+  }
   case G_FCONSTANT: {
     // Convert to integer constants, while preserving the binary representation.
     auto AsInteger =
@@ -16,6 +16,15 @@
 /// - t2LoopDec - placed within in the loop body.
 /// - t2LoopEnd - the loop latch terminator.
 ///
+/// Single block loops that compute a vector predicate with a VCTP, from an
+/// element count that is decremented by the vector width each iteration, and
+/// that predicate all of their MVE instructions other than lane-wise
+/// operations upon it, are converted into tail-predicated loops using
+/// DLSTP/WLSTP and LETP. Such VCTPs are introduced for vectorized loops by the
+/// MVE tail predication pass. The VCTP, and the VPST blocks inserted by the
+/// MVE VPT block pass, are then removed as the loop instructions predicate
+/// the remaining lanes implicitly.
+///
 //===----------------------------------------------------------------------===//
 
 #include "ARM.h"
@@ -23,6 +32,7 @@
 #include "ARMBaseRegisterInfo.h"
 #include "ARMBasicBlockInfo.h"
 #include "ARMSubtarget.h"
+#include "Thumb2InstrInfo.h"
 #include "llvm/CodeGen/MachineFunctionPass.h"
 #include "llvm/CodeGen/MachineLoopInfo.h"
 #include "llvm/CodeGen/MachineRegisterInfo.h"
@@ -32,10 +42,17 @@ using namespace llvm;
 #define DEBUG_TYPE "arm-low-overhead-loops"
 #define ARM_LOW_OVERHEAD_LOOPS_NAME "ARM Low Overhead Loops pass"
 
+static cl::opt<bool>
+DisableTailPredication("arm-loloops-disable-tail-pred", cl::Hidden,
+                       cl::init(false),
+                       cl::desc("Disable tail-predication in the ARM Low "
+                                "Overhead Loops pass"));
+
 namespace {
 
   class ARMLowOverheadLoops : public MachineFunctionPass {
     const ARMBaseInstrInfo    *TII = nullptr;
+    const TargetRegisterInfo  *TRI = nullptr;
     MachineRegisterInfo       *MRI = nullptr;
     std::unique_ptr<ARMBasicBlockUtils> BBUtils = nullptr;
 
@@ -60,8 +77,16 @@ namespace {
 
     void RevertLoopEnd(MachineInstr *MI) const;
 
+    MachineInstr *FindStartInsertPt(MachineInstr *Start) const;
+
+    bool CanTailPredicate(MachineLoop *ML, MachineInstr *Start,
+                          MachineInstr *VCTP) const;
+
+    void ConvertVPTBlocks(MachineLoop *ML, MachineInstr *VCTP);
+
     void Expand(MachineLoop *ML, MachineInstr *Start,
-                MachineInstr *Dec, MachineInstr *End, bool Revert);
+                MachineInstr *Dec, MachineInstr *End, MachineInstr *VCTP,
+                bool Revert);
 
     MachineFunctionProperties getRequiredProperties() const override {
       return MachineFunctionProperties().set(
@@ -79,6 +104,93 @@ char ARMLowOverheadLoops::ID = 0;
 INITIALIZE_PASS(ARMLowOverheadLoops, DEBUG_TYPE, ARM_LOW_OVERHEAD_LOOPS_NAME,
                 false, false)
 
+static bool isVCTP(MachineInstr *MI) {
+  switch (MI->getOpcode()) {
+  default:
+    break;
+  case ARM::MVE_VCTP8:
+  case ARM::MVE_VCTP16:
+  case ARM::MVE_VCTP32:
+  case ARM::MVE_VCTP64:
+    return true;
+  }
+  return false;
+}
+
+// The number of elements in a vector for the given VCTP.
+static unsigned getVCTPLanes(MachineInstr *VCTP) {
+  switch (VCTP->getOpcode()) {
+  default:
+    llvm_unreachable("unexpected VCTP");
+  case ARM::MVE_VCTP8:
+    return 16;
+  case ARM::MVE_VCTP16:
+    return 8;
+  case ARM::MVE_VCTP32:
+    return 4;
+  case ARM::MVE_VCTP64:
+    return 2;
+  }
+}
+
+static bool isMVEInstr(const MachineInstr &MI) {
+  return (MI.getDesc().TSFlags & ARMII::DomainMask) == ARMII::DomainMVE;
+}
+
+// Whether each lane of MI's result only depends upon the same lane of its
+// vector operands, so that leaving the lanes beyond the element count
+// untouched doesn't change the active ones.
+static bool isLanewiseOp(const MachineInstr &MI) {
+  switch (MI.getOpcode()) {
+  default:
+    return false;
+  case ARM::MVE_VADDi8:
+  case ARM::MVE_VADDi16:
+  case ARM::MVE_VADDi32:
+  case ARM::MVE_VADDf16:
+  case ARM::MVE_VADDf32:
+  case ARM::MVE_VSUBi8:
+  case ARM::MVE_VSUBi16:
+  case ARM::MVE_VSUBi32:
+  case ARM::MVE_VSUBf16:
+  case ARM::MVE_VSUBf32:
+  case ARM::MVE_VMULt1i8:
+  case ARM::MVE_VMULt1i16:
+  case ARM::MVE_VMULt1i32:
+  case ARM::MVE_VMULf16:
+  case ARM::MVE_VMULf32:
+  case ARM::MVE_VAND:
+  case ARM::MVE_VORR:
+  case ARM::MVE_VEOR:
+  case ARM::MVE_VBIC:
+  case ARM::MVE_VMVN:
+  case ARM::MVE_VDUP8:
+  case ARM::MVE_VDUP16:
+  case ARM::MVE_VDUP32:
+  case ARM::MVE_VMOVimmi8:
+  case ARM::MVE_VMOVimmi16:
+  case ARM::MVE_VMOVimmi32:
+  case ARM::MVE_VMOVimmf32:
+  case ARM::MVE_VMVNimmi16:
+  case ARM::MVE_VMVNimmi32:
+    return true;
+  }
+}
+
+// Whether MI computes Dst = Src Opc Imm, unpredicated. The Thumb1 encodings
+// also define CPSR, so their register and immediate sources follow both defs.
+static bool isRegImmOp(const MachineInstr &MI, ArrayRef<unsigned> Opcs,
+                       unsigned Dst, unsigned Src, int64_t Imm) {
+  if (!is_contained(Opcs, MI.getOpcode()))
+    return false;
+  unsigned Idx = MI.getDesc().getNumDefs();
+  unsigned PredReg = 0;
+  return MI.getOperand(0).getReg() == Dst &&
+         MI.getOperand(Idx).getReg() == Src &&
+         MI.getOperand(Idx + 1).getImm() == Imm &&
+         getInstrPredicate(MI, PredReg) == ARMCC::AL;
+}
+
 bool ARMLowOverheadLoops::runOnMachineFunction(MachineFunction &MF) {
   if (!static_cast<const ARMSubtarget&>(MF.getSubtarget()).hasLOB())
     return false;
@@ -89,6 +201,7 @@ bool ARMLowOverheadLoops::runOnMachineFunction(MachineFunction &MF) {
   MRI = &MF.getRegInfo();
   TII = static_cast<const ARMBaseInstrInfo*>(
     MF.getSubtarget().getInstrInfo());
+  TRI = MF.getSubtarget().getRegisterInfo();
   BBUtils = std::unique_ptr<ARMBasicBlockUtils>(new ARMBasicBlockUtils(MF));
   BBUtils->computeAllBlockSizes();
   BBUtils->adjustBBOffsetsAfter(&MF.front());
@@ -132,7 +245,9 @@ bool ARMLowOverheadLoops::ProcessLoop(MachineLoop *ML) {
   MachineInstr *Start = nullptr;
   MachineInstr *Dec = nullptr;
   MachineInstr *End = nullptr;
+  MachineInstr *VCTP = nullptr;
   bool Revert = false;
+  bool CannotTailPredicate = false;
 
   // Search the preheader for the start intrinsic, or look through the
   // predecessors of the header to find exactly one set.iterations intrinsic.
@@ -170,6 +285,14 @@ bool ARMLowOverheadLoops::ProcessLoop(MachineLoop *ML) {
         // mean we should revert? Always executing LE hopefully should be
         // faster than performing a sub,cmp,br or even subs,br.
         Revert = true;
+      else if (isVCTP(&MI)) {
+        // Only a single predicate can be implied by the loop, though ISel
+        // repeats the VCTP that computes it for each VPT block.
+        if (!VCTP)
+          VCTP = &MI;
+        else if (!VCTP->isIdenticalTo(MI))
+          CannotTailPredicate = true;
+      }
 
       if (!Dec)
         continue;
@@ -220,10 +343,259 @@ bool ARMLowOverheadLoops::ProcessLoop(MachineLoop *ML) {
                     << " - Found Loop Dec: " << *Dec
                     << " - Found Loop End: " << *End);
 
-  Expand(ML, Start, Dec, End, Revert);
+  if (VCTP && (CannotTailPredicate || Revert || DisableTailPredication ||
+               !CanTailPredicate(ML, Start, VCTP)))
+    VCTP = nullptr;
+
+  Expand(ML, Start, Dec, End, VCTP, Revert);
   return true;
 }
 
+// The trip count is expected to be moved into LR before the loop start, as
+// LR is the only register that the loop instructions can read and write.
+// WLS/DLS perform this move, so return the original move if it is in the
+// same block, otherwise the loop start itself.
+MachineInstr *
+ARMLowOverheadLoops::FindStartInsertPt(MachineInstr *Start) const {
+  MachineBasicBlock *MBB = Start->getParent();
+  for (auto &I : MRI->def_instructions(ARM::LR)) {
+    if (I.getParent() != MBB)
+      continue;
+
+    // Always execute.
+    if (!I.getOperand(2).isImm() || I.getOperand(2).getImm() != ARMCC::AL)
+      continue;
+
+    // Only handle move reg, if the trip count it will need moving into a reg
+    // before the setup instruction anyway.
+    if (!I.getDesc().isMoveReg() ||
+        !I.getOperand(1).isIdenticalTo(Start->getOperand(0)))
+      continue;
+    return &I;
+  }
+  return Start;
+}
+
+// Check whether the loop can be tail-predicated upon VCTP. The VCTP must
+// compute the predicate from the number of elements left to process, which
+// is decremented by the vector width after it, and every MVE instruction
+// that follows must be predicated upon it, other than lane-wise operations
+// whose results are not live-out of the loop. Then LETP, which decrements LR
+// by the vector width, will produce the same predicate for each iteration as
+// long as LR is initialised to the element count by DLSTP/WLSTP.
+bool ARMLowOverheadLoops::CanTailPredicate(MachineLoop *ML,
+                                           MachineInstr *Start,
+                                           MachineInstr *VCTP) const {
+  MachineBasicBlock *Header = ML->getHeader();
+  if (ML->getNumBlocks() != 1 || VCTP->getParent() != Header) {
+    LLVM_DEBUG(dbgs() << "ARM Loops: Can only tail-predicate a single block "
+                      << "loop.\n");
+    return false;
+  }
+
+  unsigned PredReg = 0;
+  if (getVPTInstrPredicate(*VCTP, PredReg) != ARMVCC::None) {
+    LLVM_DEBUG(dbgs() << "ARM Loops: The VCTP is predicated.\n");
+    return false;
+  }
+
+  unsigned NumElts = VCTP->getOperand(1).getReg();
+  unsigned Lanes = getVCTPLanes(VCTP);
+  MachineInstr *EltsDec = nullptr;
+  bool SeenVCTP = false;
+  for (auto &MI : *Header) {
+    if (&MI == VCTP) {
+      SeenVCTP = true;
+      continue;
+    }
+
+    if (MI.modifiesRegister(NumElts, TRI)) {
+      // Expect a single sub of the vector width from the element count.
+      if (EltsDec || !SeenVCTP ||
+          !isRegImmOp(MI, { ARM::t2SUBri, ARM::tSUBi8 }, NumElts, NumElts,
+                      Lanes)) {
+        LLVM_DEBUG(dbgs() << "ARM Loops: Unexpected def of element count: "
+                          << MI);
+        return false;
+      }
+      EltsDec = &MI;
+      continue;
+    }
+
+    if (MI.getOpcode() == ARM::MVE_VPST)
+      continue;
+
+    // A repeat of the VCTP produces the same predicate, as long as the element
+    // count hasn't been decremented yet.
+    if (isVCTP(&MI)) {
+      if (EltsDec) {
+        LLVM_DEBUG(dbgs() << "ARM Loops: VCTP after the element count sub: "
+                          << MI);
+        return false;
+      }
+      continue;
+    }
+
+    if (MI.modifiesRegister(ARM::VPR, TRI)) {
+      LLVM_DEBUG(dbgs() << "ARM Loops: VPR is redefined by: " << MI);
+      return false;
+    }
+
+    if (!isMVEInstr(MI))
+      continue;
+
+    // The implicit predicate will apply to every vector instruction. The
+    // lanes that it leaves untouched in the result of an unpredicated
+    // lane-wise operation can only reach the lanes that the stores leave
+    // untouched too, as long as the result isn't live-out.
+    if (isLanewiseOp(MI) &&
+        getVPTInstrPredicate(MI, PredReg) == ARMVCC::None)
+      continue;
+
+    // Anything else must already be predicated upon the VCTP.
+    if (!SeenVCTP ||
+        getVPTInstrPredicate(MI, PredReg) != ARMVCC::Then ||
+        PredReg != ARM::VPR) {
+      LLVM_DEBUG(dbgs() << "ARM Loops: Not predicated upon the VCTP: " << MI);
+      return false;
+    }
+  }
+
+  if (!EltsDec) {
+    LLVM_DEBUG(dbgs() << "ARM Loops: Didn't find the element count sub.\n");
+    return false;
+  }
+
+  SmallVector<MachineBasicBlock*, 2> ExitBlocks;
+  ML->getExitBlocks(ExitBlocks);
+  for (auto *Exit : ExitBlocks) {
+    if (Exit->isLiveIn(ARM::VPR)) {
+      LLVM_DEBUG(dbgs() << "ARM Loops: VPR is live-out of the loop.\n");
+      return false;
+    }
+    for (auto &LiveIn : Exit->liveins()) {
+      for (unsigned QReg : ARM::MQPRRegClass) {
+        if (TRI->regsOverlap(LiveIn.PhysReg, QReg)) {
+          LLVM_DEBUG(dbgs() << "ARM Loops: " << printReg(QReg, TRI)
+                            << " is live-out of the loop.\n");
+          return false;
+        }
+      }
+    }
+  }
+
+  // LETP will iterate ceil(elements / lanes) times, so the trip count given to
+  // the loop start must be (elements + lanes - 1) >> log2(lanes), computed
+  // from the element count that the VCTP consumes and the sub decrements.
+  unsigned TripCount = Start->getOperand(0).getReg();
+  MachineInstr *Shift = nullptr;
+  bool FoundRoundUp = false;
+  for (auto I = MachineBasicBlock::reverse_iterator(Start),
+       E = Start->getParent()->rend(); I != E; ++I) {
+    if (&*I == Start)
+      continue;
+    if (I->modifiesRegister(NumElts, TRI))
+      break;
+    if (!Shift) {
+      if (!I->modifiesRegister(TripCount, TRI))
+        continue;
+      if (!isRegImmOp(*I, { ARM::t2LSRri, ARM::tLSRri }, TripCount,
+                      I->getOperand(I->getDesc().getNumDefs()).getReg(),
+                      Log2_32(Lanes)))
+        break;
+      Shift = &*I;
+      continue;
+    }
+    unsigned Sum = Shift->getOperand(Shift->getDesc().getNumDefs()).getReg();
+    if (!I->modifiesRegister(Sum, TRI))
+      continue;
+    FoundRoundUp =
+      isRegImmOp(*I, { ARM::t2ADDri, ARM::tADDi3 }, Sum,
+                 NumElts, Lanes - 1);
+    break;
+  }
+  if (!FoundRoundUp) {
+    LLVM_DEBUG(dbgs() << "ARM Loops: Trip count isn't the rounded up element "
+                      << "count divided by the vector width.\n");
+    return false;
+  }
+
+  // The element count will be used by DLSTP/WLSTP, in place of the trip count,
+  // so it must hold its initial value from the insertion point to the loop.
+  MachineInstr *InsertPt = FindStartInsertPt(Start);
+  MachineBasicBlock *MBB = InsertPt->getParent();
+  for (MachineBasicBlock::iterator I = InsertPt->getIterator(),
+       E = MBB->end(); I != E; ++I) {
+    if (I->modifiesRegister(NumElts, TRI)) {
+      LLVM_DEBUG(dbgs() << "ARM Loops: Element count redefined by: " << *I);
+      return false;
+    }
+  }
+  MachineBasicBlock *Preheader = ML->getLoopPreheader();
+  if (Preheader != MBB) {
+    if (!Preheader || Preheader->pred_size() != 1 ||
+        *Preheader->pred_begin() != MBB)
+      return false;
+    for (auto &MI : *Preheader) {
+      if (MI.modifiesRegister(NumElts, TRI)) {
+        LLVM_DEBUG(dbgs() << "ARM Loops: Element count redefined by: " << MI);
+        return false;
+      }
+    }
+  }
+
+  LLVM_DEBUG(dbgs() << "ARM Loops: Will tail-predicate upon: " << *VCTP);
+  return true;
+}
+
+// The loop instructions are now implicitly predicated, so remove the VCTPs and
+// the VPT blocks, and make the instructions within them unpredicated. LR now
+// holds the element count too, so also remove its decrement unless the count
+// is read by something else.
+void ARMLowOverheadLoops::ConvertVPTBlocks(MachineLoop *ML,
+                                           MachineInstr *VCTP) {
+  SmallVector<MachineInstr*, 4> Dead;
+  unsigned NumElts = VCTP->getOperand(1).getReg();
+  MachineInstr *EltsDec = nullptr;
+  bool EltsLive = false;
+  for (auto &MI : *ML->getHeader()) {
+    if (MI.getOpcode() == ARM::MVE_VPST || isVCTP(&MI)) {
+      Dead.push_back(&MI);
+      continue;
+    }
+
+    if (MI.modifiesRegister(NumElts, TRI))
+      EltsDec = &MI;
+    else if (MI.readsRegister(NumElts, TRI))
+      EltsLive = true;
+
+    int PIdx = findFirstVPTPredOperandIdx(MI);
+    if (PIdx == -1 || MI.getOperand(PIdx).getImm() == ARMVCC::None)
+      continue;
+
+    MachineOperand &PredRegMO = MI.getOperand(PIdx + 1);
+    MI.getOperand(PIdx).setImm(ARMVCC::None);
+    PredRegMO.setIsKill(false);
+    PredRegMO.setIsRenamable(false);
+    PredRegMO.setReg(0);
+    LLVM_DEBUG(dbgs() << "ARM Loops: Unpredicated: " << MI);
+  }
+
+  SmallVector<MachineBasicBlock*, 2> ExitBlocks;
+  ML->getExitBlocks(ExitBlocks);
+  for (auto *Exit : ExitBlocks)
+    EltsLive |= Exit->isLiveIn(NumElts);
+  if (EltsDec && !EltsLive) {
+    LLVM_DEBUG(dbgs() << "ARM Loops: Removing element count sub: "
+                      << *EltsDec);
+    Dead.push_back(EltsDec);
+  }
+
+  LLVM_DEBUG(dbgs() << "ARM Loops: Removing VCTP: " << *VCTP);
+  for (auto *MI : Dead)
+    MI->eraseFromParent();
+}
+
 // WhileLoopStart holds the exit block, so produce a cmp lr, 0 and then a
 // beq that branches to the exit branch.
 // FIXME: Need to check that we're not trashing the CPSR when generating the
@@ -288,40 +660,47 @@ void ARMLowOverheadLoops::RevertLoopEnd(MachineInstr *MI) const {
 
 void ARMLowOverheadLoops::Expand(MachineLoop *ML, MachineInstr *Start,
                                  MachineInstr *Dec, MachineInstr *End,
-                                 bool Revert) {
+                                 MachineInstr *VCTP, bool Revert) {
 
-  auto ExpandLoopStart = [this](MachineLoop *ML, MachineInstr *Start) {
+  auto ExpandLoopStart = [this](MachineLoop *ML, MachineInstr *Start,
+                                MachineInstr *VCTP) {
     // The trip count should already been held in LR since the instructions
     // within the loop can only read and write to LR. So, there should be a
     // mov to setup the count. WLS/DLS perform this move, so find the original
     // and delete it - inserting WLS/DLS in its place.
     MachineBasicBlock *MBB = Start->getParent();
-    MachineInstr *InsertPt = Start;
-    for (auto &I : MRI->def_instructions(ARM::LR)) {
-      if (I.getParent() != MBB)
-        continue;
-
-      // Always execute.
-      if (!I.getOperand(2).isImm() || I.getOperand(2).getImm() != ARMCC::AL)
-        continue;
-
-      // Only handle move reg, if the trip count it will need moving into a reg
-      // before the setup instruction anyway.
-      if (!I.getDesc().isMoveReg() ||
-          !I.getOperand(1).isIdenticalTo(Start->getOperand(0)))
-        continue;
-      InsertPt = &I;
-      break;
+    MachineInstr *InsertPt = FindStartInsertPt(Start);
+
+    bool IsDo = Start->getOpcode() == ARM::t2DoLoopStart;
+    unsigned Opc = IsDo ? ARM::t2DLS : ARM::t2WLS;
+    if (VCTP) {
+      switch (VCTP->getOpcode()) {
+      default:
+        llvm_unreachable("unexpected VCTP");
+      case ARM::MVE_VCTP8:
+        Opc = IsDo ? ARM::MVE_DLSTP_8 : ARM::MVE_WLSTP_8;
+        break;
+      case ARM::MVE_VCTP16:
+        Opc = IsDo ? ARM::MVE_DLSTP_16 : ARM::MVE_WLSTP_16;
+        break;
+      case ARM::MVE_VCTP32:
+        Opc = IsDo ? ARM::MVE_DLSTP_32 : ARM::MVE_WLSTP_32;
+        break;
+      case ARM::MVE_VCTP64:
+        Opc = IsDo ? ARM::MVE_DLSTP_64 : ARM::MVE_WLSTP_64;
+        break;
+      }
     }
-
-    unsigned Opc = Start->getOpcode() == ARM::t2DoLoopStart ?
-      ARM::t2DLS : ARM::t2WLS;
     MachineInstrBuilder MIB =
       BuildMI(*MBB, InsertPt, InsertPt->getDebugLoc(), TII->get(Opc));
 
+    // A tail-predicated loop counts the elements, rather than the iterations.
     MIB.addDef(ARM::LR);
-    MIB.add(Start->getOperand(0));
-    if (Opc == ARM::t2WLS)
+    if (VCTP)
+      MIB.addReg(VCTP->getOperand(1).getReg());
+    else
+      MIB.add(Start->getOperand(0));
+    if (!IsDo)
       MIB.add(Start->getOperand(1));
 
     if (InsertPt != Start)
@@ -333,10 +712,11 @@ void ARMLowOverheadLoops::Expand(MachineLoop *ML, MachineInstr *Start,
 
   // Combine the LoopDec and LoopEnd instructions into LE(TP).
   auto ExpandLoopEnd = [this](MachineLoop *ML, MachineInstr *Dec,
-                              MachineInstr *End) {
+                              MachineInstr *End, MachineInstr *VCTP) {
     MachineBasicBlock *MBB = End->getParent();
+    unsigned Opc = VCTP ? ARM::MVE_LETP : ARM::t2LEUpdate;
     MachineInstrBuilder MIB = BuildMI(*MBB, End, End->getDebugLoc(),
-                                      TII->get(ARM::t2LEUpdate));
+                                      TII->get(Opc));
     MIB.addDef(ARM::LR);
     MIB.add(End->getOperand(0));
     MIB.add(End->getOperand(1));
@@ -372,10 +752,12 @@ void ARMLowOverheadLoops::Expand(MachineLoop *ML, MachineInstr *Start,
     RevertLoopDec(Dec);
     RevertLoopEnd(End);
   } else {
-    Start = ExpandLoopStart(ML, Start);
+    Start = ExpandLoopStart(ML, Start, VCTP);
     RemoveDeadBranch(Start);
-    End = ExpandLoopEnd(ML, Dec, End);
+    End = ExpandLoopEnd(ML, Dec, End, VCTP);
     RemoveDeadBranch(End);
+    if (VCTP)
+      ConvertVPTBlocks(ML, VCTP);
   }
 }
 
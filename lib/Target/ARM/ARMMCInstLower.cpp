@@ -106,6 +106,9 @@ bool ARMAsmPrinter::lowerOperand(const MachineOperand &MO,
   case MachineOperand::MO_BlockAddress:
     MCOp = GetSymbolRef(MO, GetBlockAddressSymbol(MO.getBlockAddress()));
     break;
+  case MachineOperand::MO_MCSymbol:
+    MCOp = GetSymbolRef(MO, MO.getMCSymbol());
+    break;
   case MachineOperand::MO_FPImmediate: {
     APFloat Val = MO.getFPImm()->getValueAPF();
     bool ignored;
@@ -170,8 +173,12 @@ void ARMAsmPrinter::EmitSled(const MachineInstr &MI, SledKind Kind)
   if (MI.getParent()->getParent()->getInfo<ARMFunctionInfo>()
     ->isThumbFunction())
   {
-    MI.emitError("An attempt to perform XRay instrumentation for a"
-      " Thumb function (not supported). Detected when emitting a sled.");
+    if (!Subtarget->isThumb2()) {
+      MI.emitError("An attempt to perform XRay instrumentation for a"
+        " Thumb1 function (not supported). Detected when emitting a sled.");
+      return;
+    }
+    EmitThumb2Sled(MI, Kind);
     return;
   }
   static const int8_t NoopsInSledCount = 6;
@@ -216,6 +223,59 @@ void ARMAsmPrinter::EmitSled(const MachineInstr &MI, SledKind Kind)
   recordSled(CurSled, MI, Kind);
 }
 
+void ARMAsmPrinter::EmitThumb2Sled(const MachineInstr &MI, SledKind Kind)
+{
+  static const int8_t NoopsInSledCount = 11;
+  // We want to emit the following pattern:
+  //
+  // .Lxray_sled_N:
+  //   ALIGN
+  //   B #20
+  //   ; 11 NOP instructions (22 bytes)
+  // .tmpN
+  //
+  // We need the 22 bytes because at runtime, we'd be patching over the full
+  // 24 bytes with the following pattern:
+  //
+  //   PUSH{ r0, lr }
+  //   MOVW r0, #<lower 16 bits of function ID>
+  //   MOVT r0, #<higher 16 bits of function ID>
+  //   MOVW ip, #<lower 16 bits of address of __xray_FunctionEntry/Exit>
+  //   MOVT ip, #<higher 16 bits of address of __xray_FunctionEntry/Exit>
+  //   BLX ip
+  //   POP.W{ r0, lr }
+  //
+  // The sled is word aligned so that the runtime can patch it with word
+  // stores, finishing with the branch at its start.
+  OutStreamer->EmitCodeAlignment(4);
+  auto CurSled = OutContext.createTempSymbol("xray_sled_", true);
+  OutStreamer->EmitLabel(CurSled);
+  auto Target = OutContext.createTempSymbol();
+
+  // Emit "B #20" instruction, which jumps over the next 22 bytes (because
+  // register pc is 4 bytes ahead of the jump instruction by the moment CPU
+  // is executing it).
+  EmitToStreamer(*OutStreamer, MCInstBuilder(ARM::tB).addImm(20)
+    .addImm(ARMCC::AL).addReg(0));
+
+  MCInst Noop;
+  Subtarget->getInstrInfo()->getNoop(Noop);
+  for (int8_t I = 0; I < NoopsInSledCount; I++)
+    OutStreamer->EmitInstruction(Noop, getSubtargetInfo());
+
+  OutStreamer->EmitLabel(Target);
+
+  // Record the address of the sled with bit 0 set, as for any other Thumb
+  // code address, so that the runtime can tell it apart from an ARM sled.
+  MCSymbol *ThumbSled = OutContext.createTempSymbol("xray_sled_thumb_", true);
+  OutStreamer->EmitAssignment(
+      ThumbSled,
+      MCBinaryExpr::createAdd(MCSymbolRefExpr::create(CurSled, OutContext),
+                              MCConstantExpr::create(1, OutContext),
+                              OutContext));
+  recordSled(ThumbSled, MI, Kind);
+}
+
 void ARMAsmPrinter::LowerPATCHABLE_FUNCTION_ENTER(const MachineInstr &MI)
 {
   EmitSled(MI, SledKind::FUNCTION_ENTER);
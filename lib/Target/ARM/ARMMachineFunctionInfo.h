@@ -15,6 +15,8 @@
 
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/BinaryFormat/SilhouetteSites.h"
 #include "llvm/CodeGen/MachineFunction.h"
 #include "llvm/Support/ErrorHandling.h"
 #include <utility>
@@ -247,6 +249,26 @@ public:
   }
 
   DenseMap<unsigned, unsigned> EHPrologueRemappedRegs;
+
+  /// SilhouetteSite - A code sequence inserted by a Silhouette pass, bounded
+  /// by the pre-instruction symbol of its first instruction and the
+  /// post-instruction symbol of its last one.
+  struct SilhouetteSite {
+    MCSymbol *Begin;
+    MCSymbol *End;
+    silhouette::SiteKind Kind;
+  };
+
+  void addSilhouetteSite(MCSymbol *Begin, MCSymbol *End,
+                         silhouette::SiteKind Kind) {
+    SilhouetteSites.push_back({Begin, End, Kind});
+  }
+  ArrayRef<SilhouetteSite> getSilhouetteSites() const {
+    return SilhouetteSites;
+  }
+
+private:
+  SmallVector<SilhouetteSite, 0> SilhouetteSites;
 };
 
 } // end namespace llvm
@@ -11,20 +11,25 @@
 /// purpose of this pass is do some IR pattern matching to create ACLE
 /// DSP intrinsics, which map on these 32-bit SIMD operations.
 /// This pass runs only when unaligned accesses is supported/enabled.
+///
+/// The pass looks at each basic block for add and sub reductions of products
+/// of sign-extended, consecutive narrow loads. Pairs of halfword products are
+/// combined into the dual 16-bit multiplies SMLAD/SMLALD, or SMUAD when there
+/// is no accumulator, and differences of halfword products into
+/// SMLSD/SMLSLD/SMUSD. Groups of four byte products are computed by unpacking
+/// wide loads with SXTB16 and accumulating with SMLAD.
 //
 //===----------------------------------------------------------------------===//
 
 #include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/AssumptionCache.h"
 #include "llvm/Analysis/LoopAccessAnalysis.h"
-#include "llvm/Analysis/LoopPass.h"
-#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ScalarEvolution.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/NoFolder.h"
 #include "llvm/Transforms/Scalar.h"
-#include "llvm/Transforms/Utils/BasicBlockUtils.h"
-#include "llvm/Transforms/Utils/LoopUtils.h"
 #include "llvm/Pass.h"
 #include "llvm/PassRegistry.h"
 #include "llvm/PassSupport.h"
@@ -40,6 +45,10 @@ using namespace PatternMatch;
 #define DEBUG_TYPE "arm-parallel-dsp"
 
 STATISTIC(NumSMLAD , "Number of smlad instructions generated");
+STATISTIC(NumSMUAD , "Number of smuad instructions generated");
+STATISTIC(NumSMLSD , "Number of smlsd instructions generated");
+STATISTIC(NumSMUSD , "Number of smusd instructions generated");
+STATISTIC(NumSXTB16, "Number of sxtb16 byte multiply-accumulates generated");
 
 static cl::opt<bool>
 DisableParallelDSP("disable-arm-parallel-dsp", cl::Hidden, cl::init(false),
@@ -58,6 +67,8 @@ namespace {
   using PMACPairList    = SmallVector<PMACPair, 8>;
   using Instructions    = SmallVector<Instruction*,16>;
   using MemLocList      = SmallVector<MemoryLocation, 4>;
+  using InstSet         = std::set<Instruction*>;
+  using DepMap          = std::map<Instruction*, InstSet>;
 
   struct OpChain {
     Instruction   *Root;
@@ -85,6 +96,7 @@ namespace {
     ValueList     LHS;      // List of all (narrow) left hand operands.
     ValueList     RHS;      // List of all (narrow) right hand operands.
     bool Exchange = false;
+    bool Paired = false;
 
     BinOpChain(Instruction *I, ValueList &lhs, ValueList &rhs) :
       OpChain(I, lhs), LHS(lhs), RHS(rhs) {
@@ -95,13 +107,30 @@ namespace {
     bool AreSymmetrical(BinOpChain *Other);
   };
 
+  // 'SubChain' holds a subtraction of two halfword multiplications, which is
+  // a candidate for a single subtracting dual multiply.
+  struct SubChain {
+    Instruction                 *Root;
+    std::unique_ptr<BinOpChain> Mul0;   // The minuend.
+    std::unique_ptr<BinOpChain> Mul1;   // The subtrahend.
+    bool Paired = false;
+
+    SubChain(Instruction *I, std::unique_ptr<BinOpChain> M0,
+             std::unique_ptr<BinOpChain> M1) :
+      Root(I), Mul0(std::move(M0)), Mul1(std::move(M1)) { }
+  };
+
   /// Represent a sequence of multiply-accumulate operations with the aim to
   /// perform the multiplications in parallel.
   class Reduction {
     Instruction     *Root = nullptr;
     Value           *Acc = nullptr;
+    bool            Invalid = false;
     OpChainList     Muls;
+    OpChainList     ByteMuls;
+    SmallVector<SubChain, 4> Subs;
     PMACPairList        MulPairs;
+    SmallVector<std::pair<MemInstList, MemInstList>, 2> ByteQuads;
     SmallPtrSet<Instruction*, 4> Adds;
 
   public:
@@ -109,7 +138,7 @@ namespace {
 
     Reduction (Instruction *Add) : Root(Add) { }
 
-    /// Record an Add instruction that is a part of the this reduction.
+    /// Record an Add or Sub instruction that is a part of the this reduction.
     void InsertAdd(Instruction *I) { Adds.insert(I); }
 
     /// Record a BinOpChain, rooted at a Mul instruction, that is a part of
@@ -118,22 +147,51 @@ namespace {
       Muls.push_back(make_unique<BinOpChain>(I, LHS, RHS));
     }
 
-    /// Add the incoming accumulator value, returns true if a value had not
-    /// already been added. Returning false signals to the user that this
-    /// reduction already has a value to initialise the accumulator.
-    bool InsertAcc(Value *V) {
-      if (Acc)
-        return false;
-      Acc = V;
-      return true;
+    /// Record a BinOpChain, rooted at a Mul instruction of two sign-extended
+    /// bytes, that is a part of this reduction.
+    void InsertByteMul(Instruction *I, ValueList &LHS, ValueList &RHS) {
+      ByteMuls.push_back(make_unique<BinOpChain>(I, LHS, RHS));
     }
 
+    /// Record a Sub instruction of two muls that is a part of this reduction.
+    void InsertSub(Instruction *I, Instruction *Mul0, ValueList &LHS0,
+                   ValueList &RHS0, Instruction *Mul1, ValueList &LHS1,
+                   ValueList &RHS1) {
+      Subs.emplace_back(I, make_unique<BinOpChain>(Mul0, LHS0, RHS0),
+                        make_unique<BinOpChain>(Mul1, LHS1, RHS1));
+    }
+
+    /// Add the incoming accumulator value. A reduction can only have a single
+    /// accumulator, of the same type as the root, so adding a second one, or
+    /// one of another type, invalidates the reduction.
+    void InsertAcc(Value *V) {
+      if (Acc || V->getType() != Root->getType())
+        Invalid = true;
+      else
+        Acc = V;
+    }
+
+    /// Return false if the search found a value that can't be part of this
+    /// reduction.
+    bool isValid() const { return !Invalid; }
+
     /// Set two BinOpChains, rooted at muls, that can be executed as a single
     /// parallel operation.
     void AddMulPair(BinOpChain *Mul0, BinOpChain *Mul1) {
+      Mul0->Paired = true;
+      Mul1->Paired = true;
       MulPairs.push_back(std::make_pair(Mul0, Mul1));
     }
 
+    /// Set four byte BinOpChains, whose operands are the consecutive loads in
+    /// LoadsA and LoadsB, that can be executed as two parallel operations.
+    void AddByteQuad(ArrayRef<BinOpChain*> Quad, MemInstList &LoadsA,
+                     MemInstList &LoadsB) {
+      for (auto *Mul : Quad)
+        Mul->Paired = true;
+      ByteQuads.push_back(std::make_pair(LoadsA, LoadsB));
+    }
+
     /// Return true if enough mul operations are found that can be executed in
     /// parallel.
     bool CreateParallelPairs();
@@ -151,10 +209,23 @@ namespace {
     /// the reduction.
     OpChainList &getMuls() { return Muls; }
 
+    /// Return the BinOpChains, rooted at byte mul instructions, that comprise
+    /// the reduction.
+    OpChainList &getByteMuls() { return ByteMuls; }
+
+    /// Return the subs of two muls that comprise the reduction.
+    SmallVectorImpl<SubChain> &getSubs() { return Subs; }
+
     /// Return the BinOpChain, rooted at mul instructions, that have been
     /// paired for parallel execution.
     PMACPairList &getMulPairs() { return MulPairs; }
 
+    /// Return the loads of the groups of four byte muls that are executed in
+    /// parallel.
+    SmallVectorImpl<std::pair<MemInstList, MemInstList>> &getByteQuads() {
+      return ByteQuads;
+    }
+
     /// To finalise, replace the uses of the root with the intrinsic call.
     void UpdateRoot(Instruction *SMLAD) {
       Root->replaceAllUsesWith(SMLAD);
@@ -176,88 +247,69 @@ namespace {
     }
   };
 
-  class ARMParallelDSP : public LoopPass {
+  class ARMParallelDSP : public FunctionPass {
     ScalarEvolution   *SE;
     AliasAnalysis     *AA;
-    TargetLibraryInfo *TLI;
     DominatorTree     *DT;
-    LoopInfo          *LI;
-    Loop              *L;
     const DataLayout  *DL;
     Module            *M;
     std::map<LoadInst*, LoadInst*> LoadPairs;
     SmallPtrSet<LoadInst*, 4> OffsetLoads;
     std::map<LoadInst*, std::unique_ptr<WidenedLoad>> WideLoads;
+    DepMap RAWDeps;
 
     template<unsigned>
     bool IsNarrowSequence(Value *V, ValueList &VL);
 
+    template<unsigned>
+    bool IsNarrowMul(Value *V, ValueList &LHS, ValueList &RHS);
+
     bool RecordMemoryOps(BasicBlock *BB);
+    void MoveBefore(Value *A, Value *B);
     void InsertParallelMACs(Reduction &Reduction);
     bool AreSequentialLoads(LoadInst *Ld0, LoadInst *Ld1, MemInstList &VecMem);
     LoadInst* CreateWideLoad(SmallVectorImpl<LoadInst*> &Loads,
                              IntegerType *LoadTy);
+    LoadInst* CreateWideByteLoad(MemInstList &Loads, IntegerType *LoadTy);
     bool CreateParallelPairs(Reduction &R);
+    void CreateSubPairs(Reduction &R);
+    void CreateByteQuads(Reduction &R);
 
     /// Try to match and generate: SMLAD, SMLADX - Signed Multiply Accumulate
     /// Dual performs two signed 16x16-bit multiplications. It adds the
     /// products to a 32-bit accumulate operand. Optionally, the instruction can
     /// exchange the halfwords of the second operand before performing the
-    /// arithmetic.
-    bool MatchSMLAD(Loop *L);
+    /// arithmetic. SMUAD, SMLSD, SMUSD and their long and exchanging forms are
+    /// matched in the same way, as are byte products unpacked with SXTB16.
+    bool MatchSMLAD(BasicBlock *BB);
 
   public:
     static char ID;
 
-    ARMParallelDSP() : LoopPass(ID) { }
-
-    bool doInitialization(Loop *L, LPPassManager &LPM) override {
-      LoadPairs.clear();
-      WideLoads.clear();
-      return true;
-    }
+    ARMParallelDSP() : FunctionPass(ID) { }
 
     void getAnalysisUsage(AnalysisUsage &AU) const override {
-      LoopPass::getAnalysisUsage(AU);
+      FunctionPass::getAnalysisUsage(AU);
       AU.addRequired<AssumptionCacheTracker>();
       AU.addRequired<ScalarEvolutionWrapperPass>();
       AU.addRequired<AAResultsWrapperPass>();
-      AU.addRequired<TargetLibraryInfoWrapperPass>();
-      AU.addRequired<LoopInfoWrapperPass>();
       AU.addRequired<DominatorTreeWrapperPass>();
       AU.addRequired<TargetPassConfig>();
-      AU.addPreserved<LoopInfoWrapperPass>();
+      AU.addPreserved<ScalarEvolutionWrapperPass>();
       AU.setPreservesCFG();
     }
 
-    bool runOnLoop(Loop *TheLoop, LPPassManager &) override {
+    bool runOnFunction(Function &F) override {
       if (DisableParallelDSP)
         return false;
-      L = TheLoop;
+      if (skipFunction(F))
+        return false;
+
       SE = &getAnalysis<ScalarEvolutionWrapperPass>().getSE();
       AA = &getAnalysis<AAResultsWrapperPass>().getAAResults();
-      TLI = &getAnalysis<TargetLibraryInfoWrapperPass>().getTLI();
       DT = &getAnalysis<DominatorTreeWrapperPass>().getDomTree();
-      LI = &getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
       auto &TPC = getAnalysis<TargetPassConfig>();
 
-      BasicBlock *Header = TheLoop->getHeader();
-      if (!Header)
-        return false;
-
-      // TODO: We assume the loop header and latch to be the same block.
-      // This is not a fundamental restriction, but lifting this would just
-      // require more work to do the transformation and then patch up the CFG.
-      if (Header != TheLoop->getLoopLatch()) {
-        LLVM_DEBUG(dbgs() << "The loop header is not the loop latch: not "
-                             "running pass ARMParallelDSP\n");
-        return false;
-      }
-
-      if (!TheLoop->getLoopPreheader())
-        InsertPreheaderForLoop(L, DT, LI, nullptr, true);
-
-      Function &F = *Header->getParent();
       M = F.getParent();
       DL = &M->getDataLayout();
 
@@ -282,17 +334,23 @@ namespace {
         return false;
       }
 
-      LoopAccessInfo LAI(L, SE, TLI, AA, DT, LI);
-
       LLVM_DEBUG(dbgs() << "\n== Parallel DSP pass ==\n");
       LLVM_DEBUG(dbgs() << " - " << F.getName() << "\n\n");
 
-      if (!RecordMemoryOps(Header)) {
-        LLVM_DEBUG(dbgs() << " - No sequential loads found.\n");
-        return false;
+      bool Changes = false;
+      for (auto &BB : F) {
+        LoadPairs.clear();
+        OffsetLoads.clear();
+        WideLoads.clear();
+        RAWDeps.clear();
+
+        if (!RecordMemoryOps(&BB)) {
+          LLVM_DEBUG(dbgs() << " - No sequential loads found in "
+                            << BB.getName() << ".\n");
+          continue;
+        }
+        Changes |= MatchSMLAD(&BB);
       }
-
-      bool Changes = MatchSMLAD(L);
       return Changes;
     }
   };
@@ -325,11 +383,10 @@ bool ARMParallelDSP::AreSequentialLoads(LoadInst *Ld0, LoadInst *Ld1,
   return true;
 }
 
-// MaxBitwidth: the maximum supported bitwidth of the elements in the DSP
-// instructions, which is set to 16. So here we should collect all i8 and i16
-// narrow operations.
-// TODO: we currently only collect i16, and will support i8 later, so that's
-// why we check that types are equal to MaxBitWidth, and not <= MaxBitWidth.
+// MaxBitwidth: the bitwidth of the elements in the DSP instructions, which is
+// 16 for the dual halfword multiplies and 8 for the byte products unpacked
+// with sxtb16. The types are checked to be equal to MaxBitWidth, because the
+// two kinds of product are combined in different ways.
 template<unsigned MaxBitWidth>
 bool ARMParallelDSP::IsNarrowSequence(Value *V, ValueList &VL) {
   ConstantInt *CInt;
@@ -370,6 +427,23 @@ bool ARMParallelDSP::IsNarrowSequence(Value *V, ValueList &VL) {
   return false;
 }
 
+// Return true if V is a mul of two sign-extended, pairable loads of
+// MaxBitWidth bits, recording the narrow operands in LHS and RHS.
+template<unsigned MaxBitWidth>
+bool ARMParallelDSP::IsNarrowMul(Value *V, ValueList &LHS, ValueList &RHS) {
+  auto *I = dyn_cast<Instruction>(V);
+  if (!I || I->getOpcode() != Instruction::Mul)
+    return false;
+
+  Value *MulOp0 = I->getOperand(0);
+  Value *MulOp1 = I->getOperand(1);
+  if (!isa<SExtInst>(MulOp0) || !isa<SExtInst>(MulOp1))
+    return false;
+
+  return IsNarrowSequence<MaxBitWidth>(MulOp0, LHS) &&
+         IsNarrowSequence<MaxBitWidth>(MulOp1, RHS);
+}
+
 /// Iterate through the block and record base, offset pairs of loads which can
 /// be widened into a single load.
 bool ARMParallelDSP::RecordMemoryOps(BasicBlock *BB) {
@@ -389,10 +463,6 @@ bool ARMParallelDSP::RecordMemoryOps(BasicBlock *BB) {
     Loads.push_back(Ld);
   }
 
-  using InstSet = std::set<Instruction*>;
-  using DepMap = std::map<Instruction*, InstSet>;
-  DepMap RAWDeps;
-
   // Record any writes that may alias a load.
   const auto Size = LocationSize::unknown();
   for (auto Read : Loads) {
@@ -453,8 +523,8 @@ bool ARMParallelDSP::RecordMemoryOps(BasicBlock *BB) {
   return LoadPairs.size() > 1;
 }
 
-// Loop Pass that needs to identify integer add/sub reductions of 16-bit vector
-// multiplications.
+// Identify integer add/sub reductions of 16-bit vector multiplications, in any
+// basic block.
 // To use SMLAD:
 // 1) we first need to find integer add then look for this pattern:
 //
@@ -484,54 +554,86 @@ bool ARMParallelDSP::RecordMemoryOps(BasicBlock *BB) {
 // If loop invariants are used instead of loads, these need to be packed
 // before the loop begins.
 //
-bool ARMParallelDSP::MatchSMLAD(Loop *L) {
+// 2) a sub of two such muls is selected to smlsd, or smusd if it is not
+// accumulated, and adds of muls with no accumulator at all use smuad.
+//
+// 3) four muls of sign-extended bytes, whose operands are loaded from two
+// sequences of four consecutive bytes, are computed from two word loads:
+//
+// sxtb16 r2, r0          @ bytes 0 and 2 of r0
+// sxtb16 r3, r1
+// smlad r4, r2, r3, r4
+// sxtb16 r2, r0, ror #8  @ bytes 1 and 3 of r0
+// sxtb16 r3, r1, ror #8
+// smlad r4, r2, r3, r4
+//
+bool ARMParallelDSP::MatchSMLAD(BasicBlock *BB) {
   // Search recursively back through the operands to find a tree of values that
-  // form a multiply-accumulate chain. The search records the Add and Mul
-  // instructions that form the reduction and allows us to find a single value
-  // to be used as the initial input to the accumlator.
+  // form a multiply-accumulate chain. The search records the Add, Sub and Mul
+  // instructions that form the reduction, and returns false if V is not a
+  // part of it, in which case nothing has been recorded. When only one operand
+  // of an Add is part of the chain, the other is used as the initial input to
+  // the accumulator.
   std::function<bool(Value*, Reduction&)> Search = [&]
     (Value *V, Reduction &R) -> bool {
 
-    // If we find a non-instruction, try to use it as the initial accumulator
-    // value. This may have already been found during the search in which case
-    // this function will return false, signaling a search fail.
+    // Values from other blocks can only be accumulated, as the loads are
+    // recorded, and the wide loads created, per block.
     auto *I = dyn_cast<Instruction>(V);
-    if (!I)
-      return R.InsertAcc(V);
+    if (!I || I->getParent() != BB)
+      return false;
 
     switch (I->getOpcode()) {
     default:
       break;
-    case Instruction::PHI:
-      // Could be the accumulator value.
-      return R.InsertAcc(V);
     case Instruction::Add: {
       // Adds should be adding together two muls, or another add and a mul to
       // be within the mac chain. One of the operands may also be the
       // accumulator value at which point we should stop searching.
       bool ValidLHS = Search(I->getOperand(0), R);
       bool ValidRHS = Search(I->getOperand(1), R);
-      if (!ValidLHS && !ValidLHS)
+      if (!ValidLHS && !ValidRHS)
         return false;
-      else if (ValidLHS && ValidRHS) {
-        R.InsertAdd(I);
-        return true;
-      } else {
-        R.InsertAdd(I);
-        return R.InsertAcc(I);
-      }
+      else if (!ValidLHS)
+        R.InsertAcc(I->getOperand(0));
+      else if (!ValidRHS)
+        R.InsertAcc(I->getOperand(1));
+      R.InsertAdd(I);
+      return true;
+    }
+    case Instruction::Sub: {
+      // Subs should be subtracting two muls, possibly sign extended, which
+      // can be performed by a single subtracting dual multiply.
+      Value *SubOp0 = I->getOperand(0);
+      Value *SubOp1 = I->getOperand(1);
+      Value *Val;
+      if (match(SubOp0, m_SExt(m_Value(Val))))
+        SubOp0 = Val;
+      if (match(SubOp1, m_SExt(m_Value(Val))))
+        SubOp1 = Val;
+
+      ValueList LHS0, RHS0, LHS1, RHS1;
+      if (!IsNarrowMul<16>(SubOp0, LHS0, RHS0) ||
+          !IsNarrowMul<16>(SubOp1, LHS1, RHS1))
+        return false;
+      R.InsertSub(I, cast<Instruction>(SubOp0), LHS0, RHS0,
+                  cast<Instruction>(SubOp1), LHS1, RHS1);
+      R.InsertAdd(I);
+      return true;
     }
     case Instruction::Mul: {
-      Value *MulOp0 = I->getOperand(0);
-      Value *MulOp1 = I->getOperand(1);
-      if (isa<SExtInst>(MulOp0) && isa<SExtInst>(MulOp1)) {
-        ValueList LHS;
-        ValueList RHS;
-        if (IsNarrowSequence<16>(MulOp0, LHS) &&
-            IsNarrowSequence<16>(MulOp1, RHS)) {
-          R.InsertMul(I, LHS, RHS);
-          return true;
-        }
+      ValueList LHS;
+      ValueList RHS;
+      if (IsNarrowMul<16>(I, LHS, RHS)) {
+        R.InsertMul(I, LHS, RHS);
+        return true;
+      }
+      // The products of bytes are computed with 32-bit lanes.
+      LHS.clear();
+      RHS.clear();
+      if (I->getType()->isIntegerTy(32) && IsNarrowMul<8>(I, LHS, RHS)) {
+        R.InsertByteMul(I, LHS, RHS);
+        return true;
       }
       return false;
     }
@@ -543,10 +645,10 @@ bool ARMParallelDSP::MatchSMLAD(Loop *L) {
 
   bool Changed = false;
   SmallPtrSet<Instruction*, 4> AllAdds;
-  BasicBlock *Latch = L->getLoopLatch();
 
-  for (Instruction &I : reverse(*Latch)) {
-    if (I.getOpcode() != Instruction::Add)
+  for (Instruction &I : reverse(*BB)) {
+    if (I.getOpcode() != Instruction::Add &&
+        I.getOpcode() != Instruction::Sub)
       continue;
 
     if (AllAdds.count(&I))
@@ -557,7 +659,7 @@ bool ARMParallelDSP::MatchSMLAD(Loop *L) {
       continue;
 
     Reduction R(&I);
-    if (!Search(&I, R))
+    if (!Search(&I, R) || !R.isValid())
       continue;
 
     if (!CreateParallelPairs(R))
@@ -572,10 +674,15 @@ bool ARMParallelDSP::MatchSMLAD(Loop *L) {
 }
 
 bool ARMParallelDSP::CreateParallelPairs(Reduction &R) {
+  CreateSubPairs(R);
+  CreateByteQuads(R);
+
+  bool Found = !R.getByteQuads().empty() ||
+    any_of(R.getSubs(), [](const SubChain &Sub) { return Sub.Paired; });
 
   // Not enough mul operations to make a pair.
   if (R.getMuls().size() < 2)
-    return false;
+    return Found;
 
   // Check that the muls operate directly upon sign extended loads.
   for (auto &MulChain : R.getMuls()) {
@@ -583,7 +690,7 @@ bool ARMParallelDSP::CreateParallelPairs(Reduction &R) {
     // we expect at least 4 items in this operand value list.
     if (MulChain->size() < 4) {
       LLVM_DEBUG(dbgs() << "Operand list too short.\n");
-      return false;
+      return Found;
     }
     MulChain->PopulateLoads();
     ValueList &LHS = static_cast<BinOpChain*>(MulChain.get())->LHS;
@@ -592,7 +699,7 @@ bool ARMParallelDSP::CreateParallelPairs(Reduction &R) {
     // Use +=2 to skip over the expected extend instructions.
     for (unsigned i = 0, e = LHS.size(); i < e; i += 2) {
       if (!isa<LoadInst>(LHS[i]) || !isa<LoadInst>(RHS[i]))
-        return false;
+        return Found;
     }
   }
 
@@ -647,10 +754,9 @@ bool ARMParallelDSP::CreateParallelPairs(Reduction &R) {
 
   OpChainList &Muls = R.getMuls();
   const unsigned Elems = Muls.size();
-  SmallPtrSet<const Instruction*, 4> Paired;
   for (unsigned i = 0; i < Elems; ++i) {
     BinOpChain *PMul0 = static_cast<BinOpChain*>(Muls[i].get());
-    if (Paired.count(PMul0->Root))
+    if (PMul0->Paired)
       continue;
 
     for (unsigned j = 0; j < Elems; ++j) {
@@ -658,7 +764,7 @@ bool ARMParallelDSP::CreateParallelPairs(Reduction &R) {
         continue;
 
       BinOpChain *PMul1 = static_cast<BinOpChain*>(Muls[j].get());
-      if (Paired.count(PMul1->Root))
+      if (PMul1->Paired)
         continue;
 
       const Instruction *Mul0 = PMul0->Root;
@@ -668,55 +774,194 @@ bool ARMParallelDSP::CreateParallelPairs(Reduction &R) {
 
       assert(PMul0 != PMul1 && "expected different chains");
 
-      if (CanPair(R, PMul0, PMul1)) {
-        Paired.insert(Mul0);
-        Paired.insert(Mul1);
+      if (CanPair(R, PMul0, PMul1))
         break;
+    }
+  }
+  return Found || !R.getMulPairs().empty();
+}
+
+
+// Try to pair the loads of the two muls of each sub, so that it can be
+// performed by a single smlsd, which computes Rn.lo * Rm.lo - Rn.hi * Rm.hi,
+// or by smlsdx which exchanges the halfwords of Rm.
+void ARMParallelDSP::CreateSubPairs(Reduction &R) {
+  for (auto &Sub : R.getSubs()) {
+    BinOpChain *PMul0 = Sub.Mul0.get();
+    BinOpChain *PMul1 = Sub.Mul1.get();
+
+    // Either operand of the muls may provide the halfwords of Rn.
+    for (unsigned Commute = 0; Commute < 2 && !Sub.Paired; ++Commute) {
+      ValueList &Rn0 = Commute ? PMul0->RHS : PMul0->LHS;
+      ValueList &Rn1 = Commute ? PMul1->RHS : PMul1->LHS;
+      ValueList &Rm0 = Commute ? PMul0->LHS : PMul0->RHS;
+      ValueList &Rm1 = Commute ? PMul1->LHS : PMul1->RHS;
+      auto *Ld0 = cast<LoadInst>(Rn0[0]);
+      auto *Ld1 = cast<LoadInst>(Rn1[0]);
+      auto *Ld2 = cast<LoadInst>(Rm0[0]);
+      auto *Ld3 = cast<LoadInst>(Rm1[0]);
+
+      if (!AreSequentialLoads(Ld0, Ld1, PMul0->VecLd))
+        continue;
+
+      if (AreSequentialLoads(Ld2, Ld3, PMul1->VecLd)) {
+        LLVM_DEBUG(dbgs() << "OK: found two pairs of parallel loads for sub "
+                          << *Sub.Root << "\n");
+        Sub.Paired = true;
+      } else if (AreSequentialLoads(Ld3, Ld2, PMul1->VecLd)) {
+        LLVM_DEBUG(dbgs() << "OK: found two pairs of parallel loads for sub "
+                          << *Sub.Root << "\n"
+                          << "    exchanging Ld2 and Ld3\n");
+        PMul1->Exchange = true;
+        Sub.Paired = true;
       }
     }
   }
-  return !R.getMulPairs().empty();
 }
 
+// Group the byte muls into fours whose operands are loaded from two sequences
+// of four consecutive bytes, so that each group can be computed from two word
+// loads, unpacked with sxtb16.
+void ARMParallelDSP::CreateByteQuads(Reduction &R) {
+  OpChainList &Muls = R.getByteMuls();
+  if (Muls.size() < 4)
+    return;
+
+  auto NextLoad = [&](LoadInst *Ld) -> LoadInst* {
+    auto It = LoadPairs.find(Ld);
+    return It == LoadPairs.end() ? nullptr : It->second;
+  };
 
-void ARMParallelDSP::InsertParallelMACs(Reduction &R) {
+  // Find an unpaired mul of LdA and LdB, in either order.
+  auto FindMul = [&](LoadInst *LdA, LoadInst *LdB) -> BinOpChain* {
+    for (auto &MulChain : Muls) {
+      auto *PMul = static_cast<BinOpChain*>(MulChain.get());
+      if (PMul->Paired)
+        continue;
+      Value *Op0 = PMul->LHS[0];
+      Value *Op1 = PMul->RHS[0];
+      if ((Op0 == LdA && Op1 == LdB) || (Op0 == LdB && Op1 == LdA))
+        return PMul;
+    }
+    return nullptr;
+  };
 
-  auto CreateSMLADCall = [&](SmallVectorImpl<LoadInst*> &VecLd0,
-                             SmallVectorImpl<LoadInst*> &VecLd1,
-                             Value *Acc, bool Exchange,
-                             Instruction *InsertAfter) {
-    // Replace the reduction chain with an intrinsic call
-    IntegerType *Ty = IntegerType::get(M->getContext(), 32);
-    LoadInst *WideLd0 = WideLoads.count(VecLd0[0]) ?
-      WideLoads[VecLd0[0]]->getLoad() : CreateWideLoad(VecLd0, Ty);
-    LoadInst *WideLd1 = WideLoads.count(VecLd1[0]) ?
-      WideLoads[VecLd1[0]]->getLoad() : CreateWideLoad(VecLd1, Ty);
-
-    Value* Args[] = { WideLd0, WideLd1, Acc };
-    Function *SMLAD = nullptr;
-    if (Exchange)
-      SMLAD = Acc->getType()->isIntegerTy(32) ?
-        Intrinsic::getDeclaration(M, Intrinsic::arm_smladx) :
-        Intrinsic::getDeclaration(M, Intrinsic::arm_smlaldx);
-    else
-      SMLAD = Acc->getType()->isIntegerTy(32) ?
-        Intrinsic::getDeclaration(M, Intrinsic::arm_smlad) :
-        Intrinsic::getDeclaration(M, Intrinsic::arm_smlald);
-
-    IRBuilder<NoFolder> Builder(InsertAfter->getParent(),
-                                ++BasicBlock::iterator(InsertAfter));
-    Instruction *Call = Builder.CreateCall(SMLAD, Args);
-    NumSMLAD++;
-    return Call;
+  // The word load replaces all four byte loads at the first of them, so no
+  // write after it may alias any of the bytes. Pairing only checked the writes
+  // between neighbouring loads.
+  auto SafeToWiden = [&](MemInstList &Loads) {
+    LoadInst *First = Loads[0];
+    for (auto *Ld : Loads)
+      if (DT->dominates(Ld, First))
+        First = Ld;
+
+    for (auto *Ld : Loads) {
+      auto It = RAWDeps.find(Ld);
+      if (It == RAWDeps.end())
+        continue;
+      for (auto *Write : It->second) {
+        if (DT->dominates(First, Write)) {
+          LLVM_DEBUG(dbgs() << "Byte loads are clobbered by: " << *Write
+                            << "\n");
+          return false;
+        }
+      }
+    }
+    return true;
   };
 
-  Instruction *InsertAfter = R.getRoot();
+  for (auto &MulChain : Muls) {
+    auto *PMul0 = static_cast<BinOpChain*>(MulChain.get());
+
+    for (unsigned Commute = 0; Commute < 2 && !PMul0->Paired; ++Commute) {
+      MemInstList LoadsA;
+      MemInstList LoadsB;
+      LoadsA.push_back(cast<LoadInst>(Commute ? PMul0->RHS[0] : PMul0->LHS[0]));
+      LoadsB.push_back(cast<LoadInst>(Commute ? PMul0->LHS[0] : PMul0->RHS[0]));
+      SmallVector<BinOpChain*, 4> Quad = { PMul0 };
+
+      while (Quad.size() < 4) {
+        LoadInst *LdA = NextLoad(LoadsA.back());
+        LoadInst *LdB = NextLoad(LoadsB.back());
+        BinOpChain *PMul = LdA && LdB ? FindMul(LdA, LdB) : nullptr;
+        if (!PMul || is_contained(Quad, PMul))
+          break;
+        LoadsA.push_back(LdA);
+        LoadsB.push_back(LdB);
+        Quad.push_back(PMul);
+      }
+
+      if (Quad.size() == 4 && SafeToWiden(LoadsA) && SafeToWiden(LoadsB)) {
+        LLVM_DEBUG(dbgs() << "OK: found four byte muls of consecutive loads:\n";
+                   for (auto *PMul : Quad)
+                     dbgs() << "- " << *PMul->Root << "\n");
+        R.AddByteQuad(Quad, LoadsA, LoadsB);
+      }
+    }
+  }
+}
+
+void ARMParallelDSP::InsertParallelMACs(Reduction &R) {
+  Instruction *Root = R.getRoot();
+  Type *Ty = Root->getType();
+  IntegerType *Ty32 = IntegerType::get(M->getContext(), 32);
   Value *Acc = R.getAccumulator();
-  if (!Acc)
-    Acc = ConstantInt::get(IntegerType::get(M->getContext(), 32), 0);
 
-  LLVM_DEBUG(dbgs() << "Root: " << *InsertAfter << "\n"
-             << "Acc: " << *Acc << "\n");
+  LLVM_DEBUG(dbgs() << "Root: " << *Root << "\n";
+             if (Acc)
+               dbgs() << "Acc: " << *Acc << "\n");
+
+  IRBuilder<NoFolder> Builder(Root->getParent(),
+                              ++BasicBlock::iterator(Root));
+
+  auto GetWideLoad = [&](MemInstList &VecLd) -> LoadInst* {
+    return WideLoads.count(VecLd[0]) ?
+      WideLoads[VecLd[0]]->getLoad() : CreateWideLoad(VecLd, Ty32);
+  };
+
+  // Accumulate the dual multiply of the halfwords in Rn and Rm. Without an
+  // accumulator a 32-bit reduction uses the non-accumulating smuad/smusd,
+  // while a 64-bit one starts accumulating from zero.
+  auto CreateDualMul = [&](Value *Rn, Value *Rm, bool Exchange,
+                           bool Subtract) {
+    Intrinsic::ID ID;
+    if (!Acc && Ty->isIntegerTy(32)) {
+      if (Subtract) {
+        ID = Exchange ? Intrinsic::arm_smusdx : Intrinsic::arm_smusd;
+        NumSMUSD++;
+      } else {
+        ID = Exchange ? Intrinsic::arm_smuadx : Intrinsic::arm_smuad;
+        NumSMUAD++;
+      }
+      Value* Args[] = { Rn, Rm };
+      Acc = Builder.CreateCall(Intrinsic::getDeclaration(M, ID), Args);
+      return;
+    }
+
+    if (!Acc)
+      Acc = ConstantInt::get(Ty, 0);
+
+    if (Subtract) {
+      if (Exchange)
+        ID = Ty->isIntegerTy(32) ? Intrinsic::arm_smlsdx :
+                                   Intrinsic::arm_smlsldx;
+      else
+        ID = Ty->isIntegerTy(32) ? Intrinsic::arm_smlsd :
+                                   Intrinsic::arm_smlsld;
+      NumSMLSD++;
+    } else {
+      if (Exchange)
+        ID = Ty->isIntegerTy(32) ? Intrinsic::arm_smladx :
+                                   Intrinsic::arm_smlaldx;
+      else
+        ID = Ty->isIntegerTy(32) ? Intrinsic::arm_smlad :
+                                   Intrinsic::arm_smlald;
+      NumSMLAD++;
+    }
+    Value* Args[] = { Rn, Rm, Acc };
+    Acc = Builder.CreateCall(Intrinsic::getDeclaration(M, ID), Args);
+  };
+
   for (auto &Pair : R.getMulPairs()) {
     BinOpChain *PMul0 = Pair.first;
     BinOpChain *PMul1 = Pair.second;
@@ -724,13 +969,117 @@ void ARMParallelDSP::InsertParallelMACs(Reduction &R) {
                << "- " << *PMul0->Root << "\n"
                << "- " << *PMul1->Root << "\n");
 
-    Acc = CreateSMLADCall(PMul0->VecLd, PMul1->VecLd, Acc, PMul1->Exchange,
-                          InsertAfter);
-    InsertAfter = cast<Instruction>(Acc);
+    LoadInst *WideLd0 = GetWideLoad(PMul0->VecLd);
+    LoadInst *WideLd1 = GetWideLoad(PMul1->VecLd);
+    CreateDualMul(WideLd0, WideLd1, PMul1->Exchange, false);
   }
+
+  for (auto &Sub : R.getSubs()) {
+    if (!Sub.Paired)
+      continue;
+    LLVM_DEBUG(dbgs() << "Sub: " << *Sub.Root << "\n");
+
+    LoadInst *WideLd0 = GetWideLoad(Sub.Mul0->VecLd);
+    LoadInst *WideLd1 = GetWideLoad(Sub.Mul1->VecLd);
+    CreateDualMul(WideLd0, WideLd1, Sub.Mul1->Exchange, true);
+  }
+
+  // sxtb16 sign extends bytes 0 and 2 of a word into two halfwords, and
+  // bytes 1 and 3 when the word is first rotated right by 8.
+  Function *SXTB16 = nullptr;
+  auto Unpack = [&](Value *V, bool Odd) -> Value* {
+    if (!SXTB16)
+      SXTB16 = Intrinsic::getDeclaration(M, Intrinsic::arm_sxtb16);
+    if (Odd) {
+      Value *Lo = Builder.CreateLShr(V, 8);
+      Value *Hi = Builder.CreateShl(V, 24);
+      V = Builder.CreateOr(Lo, Hi);
+    }
+    return Builder.CreateCall(SXTB16, V);
+  };
+
+  for (auto &Quad : R.getByteQuads()) {
+    LoadInst *WideLd0 = CreateWideByteLoad(Quad.first, Ty32);
+    LoadInst *WideLd1 = CreateWideByteLoad(Quad.second, Ty32);
+    for (bool Odd : { false, true }) {
+      Value *Rn = Unpack(WideLd0, Odd);
+      Value *Rm = Unpack(WideLd1, Odd);
+      CreateDualMul(Rn, Rm, false, false);
+    }
+    NumSXTB16++;
+  }
+
+  // The muls and subs that could not be paired still need to be accumulated.
+  auto AddTerm = [&](Instruction *Term) {
+    Value *V = Term;
+    if (V->getType() != Ty)
+      V = Builder.CreateSExt(V, Ty);
+    Acc = Builder.CreateAdd(Acc, V);
+  };
+
+  for (auto &MulChain : R.getMuls())
+    if (!static_cast<BinOpChain*>(MulChain.get())->Paired)
+      AddTerm(MulChain->Root);
+  for (auto &MulChain : R.getByteMuls())
+    if (!static_cast<BinOpChain*>(MulChain.get())->Paired)
+      AddTerm(MulChain->Root);
+  for (auto &Sub : R.getSubs())
+    if (!Sub.Paired)
+      AddTerm(Sub.Root);
+
   R.UpdateRoot(cast<Instruction>(Acc));
 }
 
+// Move A, and then its users, before B if it doesn't already dominate it.
+void ARMParallelDSP::MoveBefore(Value *A, Value *B) {
+  if (!isa<Instruction>(A) || !isa<Instruction>(B))
+    return;
+
+  auto *Source = cast<Instruction>(A);
+  auto *Sink = cast<Instruction>(B);
+
+  if (DT->dominates(Source, Sink) ||
+      Source->getParent() != Sink->getParent() ||
+      isa<PHINode>(Source) || isa<PHINode>(Sink))
+    return;
+
+  Source->moveBefore(Sink);
+  for (auto &U : Source->uses())
+    MoveBefore(Source, U.getUser());
+}
+
+// Create a word load of the four consecutive byte loads in Loads. The byte
+// loads are left in place, and the wide load is inserted at the first of them,
+// which CreateByteQuads has checked is not followed by an aliasing write.
+LoadInst* ARMParallelDSP::CreateWideByteLoad(MemInstList &Loads,
+                                             IntegerType *LoadTy) {
+  assert(Loads.size() == 4 && "expected four byte loads");
+
+  LoadInst *Base = Loads[0];
+  if (WideLoads.count(Base))
+    return WideLoads[Base]->getLoad();
+
+  LoadInst *DomLoad = Base;
+  for (auto *Ld : Loads)
+    if (DT->dominates(Ld, DomLoad))
+      DomLoad = Ld;
+
+  IRBuilder<NoFolder> IRB(DomLoad->getParent(),
+                          ++BasicBlock::iterator(DomLoad));
+  const unsigned AddrSpace = Base->getPointerAddressSpace();
+  Value *VecPtr = IRB.CreateBitCast(Base->getPointerOperand(),
+                                    LoadTy->getPointerTo(AddrSpace));
+  LoadInst *WideLoad = IRB.CreateAlignedLoad(LoadTy, VecPtr,
+                                             Base->getAlignment());
+
+  // The first byte's address may be computed after the dominating load.
+  MoveBefore(Base->getPointerOperand(), VecPtr);
+  MoveBefore(VecPtr, WideLoad);
+  WideLoads.emplace(std::make_pair(Base,
+                                   make_unique<WidenedLoad>(Loads, WideLoad)));
+  return WideLoad;
+}
+
 LoadInst* ARMParallelDSP::CreateWideLoad(SmallVectorImpl<LoadInst*> &Loads,
                                          IntegerType *LoadTy) {
   assert(Loads.size() == 2 && "currently only support widening two loads");
@@ -744,24 +1093,6 @@ LoadInst* ARMParallelDSP::CreateWideLoad(SmallVectorImpl<LoadInst*> &Loads,
   assert((BaseSExt && OffsetSExt)
          && "Loads should have a single, extending, user");
 
-  std::function<void(Value*, Value*)> MoveBefore =
-    [&](Value *A, Value *B) -> void {
-      if (!isa<Instruction>(A) || !isa<Instruction>(B))
-        return;
-
-      auto *Source = cast<Instruction>(A);
-      auto *Sink = cast<Instruction>(B);
-
-      if (DT->dominates(Source, Sink) ||
-          Source->getParent() != Sink->getParent() ||
-          isa<PHINode>(Source) || isa<PHINode>(Sink))
-        return;
-
-      Source->moveBefore(Sink);
-      for (auto &U : Source->uses())
-        MoveBefore(Source, U.getUser());
-    };
-
   // Insert the load at the point of the original dominating load.
   LoadInst *DomLoad = DT->dominates(Base, Offset) ? Base : Offset;
   IRBuilder<NoFolder> IRB(DomLoad->getParent(),
@@ -842,6 +1173,6 @@ Pass *llvm::createARMParallelDSPPass() {
 char ARMParallelDSP::ID = 0;
 
 INITIALIZE_PASS_BEGIN(ARMParallelDSP, "arm-parallel-dsp",
-                "Transform loops to use DSP intrinsics", false, false)
+                "Transform functions to use DSP intrinsics", false, false)
 INITIALIZE_PASS_END(ARMParallelDSP, "arm-parallel-dsp",
-                "Transform loops to use DSP intrinsics", false, false)
+                "Transform functions to use DSP intrinsics", false, false)
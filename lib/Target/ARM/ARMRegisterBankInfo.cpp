@@ -238,6 +238,7 @@ ARMRegisterBankInfo::getInstrMapping(const MachineInstr &MI) const {
     break;
   }
   case G_MUL:
+  case G_UMULH:
   case G_AND:
   case G_OR:
   case G_XOR:
@@ -443,9 +444,28 @@ ARMRegisterBankInfo::getInstrMapping(const MachineInstr &MI) const {
                             &ARM::ValueMappings[ARM::DPR3OpsIdx]});
     break;
   }
+  case G_UADDO:
+  case G_UADDE:
+  case G_USUBO:
+  case G_USUBE: {
+    // The 1-bit carries live in GPRs too, like the results of G_ICMP.
+    SmallVector<const ValueMapping *, 5> OperandBanks(
+        NumOperands, &ARM::ValueMappings[ARM::GPR3OpsIdx]);
+    OperandsMapping = getOperandsMapping(OperandBanks);
+    break;
+  }
   case G_BR:
     OperandsMapping = getOperandsMapping({nullptr});
     break;
+  case G_JUMP_TABLE:
+    OperandsMapping =
+        getOperandsMapping({&ARM::ValueMappings[ARM::GPR3OpsIdx], nullptr});
+    break;
+  case G_BRJT:
+    OperandsMapping =
+        getOperandsMapping({&ARM::ValueMappings[ARM::GPR3OpsIdx], nullptr,
+                            &ARM::ValueMappings[ARM::GPR3OpsIdx]});
+    break;
   case G_BRCOND:
     OperandsMapping =
         getOperandsMapping({&ARM::ValueMappings[ARM::GPR3OpsIdx], nullptr});
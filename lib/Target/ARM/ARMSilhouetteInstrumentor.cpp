@@ -19,17 +19,21 @@
 
 #include "ARM.h"
 #include "ARMBaseInstrInfo.h"
+#include "ARMMachineFunctionInfo.h"
 #include "ARMSilhouetteInstrumentor.h"
 #include "llvm/CodeGen/MachineFunction.h"
 #include "llvm/CodeGen/MachineBasicBlock.h"
 #include "llvm/CodeGen/MachineInstr.h"
 #include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/MC/MCContext.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include <deque>
 
 using namespace llvm;
 
+extern bool SilhouetteSiteTable;
+
 static DebugLoc DL;
 
 //
@@ -366,6 +370,64 @@ ARMSilhouetteInstrumentor::removeInst(MachineInstr & MI) {
   MI.eraseFromParent();
 }
 
+//
+// Method: recordSite()
+//
+// Description:
+//   This method records the instructions from First to Last (both inclusive)
+//   as an instrumentation site of a given kind, so that the ARM asm printer
+//   can list it in the Silhouette site table.  The site is delimited by a
+//   symbol emitted before First and one emitted after Last; existing symbols
+//   are reused.  Nothing is recorded unless the site table is enabled.
+//
+// Inputs:
+//   First - A reference to the first instruction of the site.
+//   Last  - A reference to the last instruction of the site.
+//   Kind  - The kind of the site.
+//
+void
+ARMSilhouetteInstrumentor::recordSite(MachineInstr & First, MachineInstr & Last,
+                                      silhouette::SiteKind Kind) {
+  if (!SilhouetteSiteTable) {
+    return;
+  }
+
+  MachineFunction & MF = *First.getMF();
+  MCContext & Ctx = MF.getContext();
+
+  MCSymbol * Begin = First.getPreInstrSymbol();
+  if (Begin == nullptr) {
+    Begin = Ctx.createTempSymbol();
+    First.setPreInstrSymbol(MF, Begin);
+  }
+  MCSymbol * End = Last.getPostInstrSymbol();
+  if (End == nullptr) {
+    End = Ctx.createTempSymbol();
+    Last.setPostInstrSymbol(MF, End);
+  }
+
+  MF.getInfo<ARMFunctionInfo>()->addSilhouetteSite(Begin, End, Kind);
+}
+
+//
+// Method: recordSite()
+//
+// Description:
+//   This method records a group of newly inserted instructions contained in a
+//   deque as an instrumentation site of a given kind.
+//
+// Inputs:
+//   Insts - A reference to a deque containing the instructions.
+//   Kind  - The kind of the site.
+//
+void
+ARMSilhouetteInstrumentor::recordSite(std::deque<MachineInstr *> & Insts,
+                                      silhouette::SiteKind Kind) {
+  if (!Insts.empty()) {
+    recordSite(*Insts.front(), *Insts.back(), Kind);
+  }
+}
+
 //
 // Method: decodeITMask()
 //
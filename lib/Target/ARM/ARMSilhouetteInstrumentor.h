@@ -20,6 +20,7 @@
 #define ARM_SILHOUETTE_INSTRUMENTOR
 
 #include "ARMBaseInstrInfo.h"
+#include "llvm/BinaryFormat/SilhouetteSites.h"
 #include "llvm/CodeGen/LivePhysRegs.h"
 #include "llvm/CodeGen/MachineFunction.h"
 #include "llvm/CodeGen/MachineInstr.h"
@@ -195,6 +196,12 @@ namespace llvm {
 
     void removeInst(MachineInstr & MI);
 
+    void recordSite(MachineInstr & First, MachineInstr & Last,
+                    silhouette::SiteKind Kind);
+
+    void recordSite(std::deque<MachineInstr *> & Insts,
+                    silhouette::SiteKind Kind);
+
   private:
     unsigned getITBlockSize(const MachineInstr & IT);
     MachineInstr * findIT(MachineInstr & MI, unsigned & distance);
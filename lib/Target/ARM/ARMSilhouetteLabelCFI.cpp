@@ -82,7 +82,8 @@ BackupRegister(MachineInstr & MI, unsigned Reg) {
     BuildMI(MBB, &MI, DL, TII->get(ARM::t2STRT))
     .addReg(Reg)
     .addReg(ARM::SP)
-    .addImm(0);
+    .addImm(0)
+    .add(predOps(ARMCC::AL));
   }
 }
 
@@ -123,8 +124,10 @@ ARMSilhouetteLabelCFI::insertCFILabelForCall(MachineFunction & MF) {
   const TargetInstrInfo * TII = MF.getSubtarget().getInstrInfo();
 
   // Use "mov r0, r0" as our CFI label
-  BuildMI(MBB, MBB.begin(), DL, TII->get(ARM::tMOVr), ARM::R0)
-  .addReg(ARM::R0);
+  MachineInstr * Label = BuildMI(MBB, MBB.begin(), DL, TII->get(ARM::tMOVr),
+                                 ARM::R0)
+                         .addReg(ARM::R0);
+  recordSite(*Label, *Label, silhouette::SK_CFILabel);
 }
 
 //
@@ -141,8 +144,10 @@ ARMSilhouetteLabelCFI::insertCFILabelForJump(MachineBasicBlock & MBB) {
   const TargetInstrInfo * TII = MBB.getParent()->getSubtarget().getInstrInfo();
 
   // Use "mov r0, r0" as our CFI label
-  BuildMI(MBB, MBB.begin(), DL, TII->get(ARM::tMOVr), ARM::R0)
-  .addReg(ARM::R0);
+  MachineInstr * Label = BuildMI(MBB, MBB.begin(), DL, TII->get(ARM::tMOVr),
+                                 ARM::R0)
+                         .addReg(ARM::R0);
+  recordSite(*Label, *Label, silhouette::SK_CFILabel);
 }
 
 //
@@ -163,6 +168,7 @@ ARMSilhouetteLabelCFI::insertCFICheck(MachineInstr & MI, unsigned Reg,
                                       uint16_t Label) {
   MachineBasicBlock & MBB = *MI.getParent();
   const TargetInstrInfo * TII = MBB.getParent()->getSubtarget().getInstrInfo();
+  MachineInstr * Prev = MI.getPrevNode();
 
   //
   // Try to find a free register first.  If we are unlucky, spill and (later)
@@ -229,6 +235,10 @@ ARMSilhouetteLabelCFI::insertCFICheck(MachineInstr & MI, unsigned Reg,
   if (FreeRegs.empty()) {
     RestoreRegister(MI, ScratchReg);
   }
+
+  // Everything between the old predecessor of @MI and @MI is the check
+  MachineInstr & First = Prev != nullptr ? *Prev->getNextNode() : MBB.front();
+  recordSite(First, *MI.getPrevNode(), silhouette::SK_CFICheck);
 }
 
 //
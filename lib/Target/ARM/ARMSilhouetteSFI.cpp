@@ -614,9 +614,11 @@ ARMSilhouetteSFI::runOnMachineFunction(MachineFunction & MF) {
 
     if (!InstsBefore.empty()) {
       insertInstsBefore(MI, InstsBefore);
+      recordSite(InstsBefore, silhouette::SK_SFI);
     }
     if (!InstsAfter.empty()) {
       insertInstsAfter(MI, InstsAfter);
+      recordSite(InstsAfter, silhouette::SK_SFI);
     }
   }
 
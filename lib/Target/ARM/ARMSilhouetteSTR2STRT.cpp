@@ -98,14 +98,16 @@ backupRegisters(MachineInstr & MI, unsigned Reg1, unsigned Reg2,
       Insts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRT))
                       .addReg(Reg1)
                       .addReg(ARM::SP)
-                      .addImm(offset));
+                      .addImm(offset)
+                      .add(predOps(Pred, PredReg)));
       offset += 4;
     }
     if (Reg2 != ARM::NoRegister) {
       Insts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRT))
                       .addReg(Reg2)
                       .addReg(ARM::SP)
-                      .addImm(offset));
+                      .addImm(offset)
+                      .add(predOps(Pred, PredReg)));
       offset += 4;
     }
   }
@@ -470,7 +472,8 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
       NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRT))
                          .addReg(SrcReg)
                          .addReg(BaseReg)
-                         .addImm(Imm));
+                         .addImm(Imm)
+                         .add(predOps(Pred, PredReg)));
       break;
 
     // A7.7.158 Encoding T2: STR<c> <Rt>,[SP,#<imm8>]
@@ -488,7 +491,8 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
       NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRT))
                          .addReg(SrcReg)
                          .addReg(BaseReg)
-                         .addImm(Imm));
+                         .addImm(Imm)
+                         .add(predOps(Pred, PredReg)));
       break;
 
     // A7.7.158 Encoding T3: STR<c>.W <Rt>,[<Rn>,#<imm12>]
@@ -509,7 +513,8 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
       NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRT))
                          .addReg(SrcReg)
                          .addReg(BaseReg)
-                         .addImm(Imm > 255 ? 0 : Imm));
+                         .addImm(Imm > 255 ? 0 : Imm)
+                         .add(predOps(Pred, PredReg)));
       if (Imm > 255) {
         subtractImmediateFromRegister(MI, BaseReg, Imm, NewInsts);
       }
@@ -536,7 +541,8 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
       NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRT))
                          .addReg(SrcReg)
                          .addReg(BaseReg)
-                         .addImm(0));
+                         .addImm(0)
+                         .add(predOps(Pred, PredReg)));
       if (Imm != -256) {
         subtractImmediateFromRegister(MI, BaseReg, Imm, NewInsts);
       }
@@ -555,7 +561,8 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
       NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRHT))
                          .addReg(SrcReg)
                          .addReg(BaseReg)
-                         .addImm(Imm));
+                         .addImm(Imm)
+                         .add(predOps(Pred, PredReg)));
       break;
 
     // A7.7.167 Encoding T2: STRH<c>.W <Rt>,[<Rn>,#<imm12>]
@@ -578,7 +585,8 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
       NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRHT))
                          .addReg(SrcReg)
                          .addReg(BaseReg)
-                         .addImm(Imm > 255 ? 0 : Imm));
+                         .addImm(Imm > 255 ? 0 : Imm)
+                         .add(predOps(Pred, PredReg)));
       if (Imm > 255) {
         subtractImmediateFromRegister(MI, BaseReg, Imm, NewInsts);
       }
@@ -605,7 +613,8 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
       NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRHT))
                          .addReg(SrcReg)
                          .addReg(BaseReg)
-                         .addImm(0));
+                         .addImm(0)
+                         .add(predOps(Pred, PredReg)));
       if (Imm != -256) {
         subtractImmediateFromRegister(MI, BaseReg, Imm, NewInsts);
       }
@@ -624,7 +633,8 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
       NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRBT))
                          .addReg(SrcReg)
                          .addReg(BaseReg)
-                         .addImm(Imm));
+                         .addImm(Imm)
+                         .add(predOps(Pred, PredReg)));
       break;
 
     // A7.7.160 Encoding T2: STRB<c>.W <Rt>,[<Rn>,#<imm12>]
@@ -645,7 +655,8 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
       NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRBT))
                          .addReg(SrcReg)
                          .addReg(BaseReg)
-                         .addImm(Imm > 255 ? 0 : Imm));
+                         .addImm(Imm > 255 ? 0 : Imm)
+                         .add(predOps(Pred, PredReg)));
       if (Imm > 255) {
         subtractImmediateFromRegister(MI, BaseReg, Imm, NewInsts);
       }
@@ -672,7 +683,8 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
       NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRBT))
                          .addReg(SrcReg)
                          .addReg(BaseReg)
-                         .addImm(0));
+                         .addImm(0)
+                         .add(predOps(Pred, PredReg)));
       if (Imm != -256) {
         subtractImmediateFromRegister(MI, BaseReg, Imm, NewInsts);
       }
@@ -702,7 +714,8 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
       NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRT))
                          .addReg(SrcReg)
                          .addReg(BaseReg)
-                         .addImm(0));
+                         .addImm(0)
+                         .add(predOps(Pred, PredReg)));
       break;
 
     // A7.7.158 Encoding T4: STR<c> <Rt>,[<Rn>],#+/-<imm8>
@@ -714,7 +727,8 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
       NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRT))
                          .addReg(SrcReg)
                          .addReg(BaseReg)
-                         .addImm(0));
+                         .addImm(0)
+                         .add(predOps(Pred, PredReg)));
       addImmediateToRegister(MI, BaseReg, Imm, NewInsts);
       break;
 
@@ -739,7 +753,8 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
       NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRHT))
                          .addReg(SrcReg)
                          .addReg(BaseReg)
-                         .addImm(0));
+                         .addImm(0)
+                         .add(predOps(Pred, PredReg)));
       break;
 
     // A7.7.167 Encoding T3: STRH<c> <Rt>,[<Rn>],#+/-<imm8>
@@ -751,7 +766,8 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
       NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRHT))
                          .addReg(SrcReg)
                          .addReg(BaseReg)
-                         .addImm(0));
+                         .addImm(0)
+                         .add(predOps(Pred, PredReg)));
       addImmediateToRegister(MI, BaseReg, Imm, NewInsts);
       break;
 
@@ -776,7 +792,8 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
       NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRBT))
                          .addReg(SrcReg)
                          .addReg(BaseReg)
-                         .addImm(0));
+                         .addImm(0)
+                         .add(predOps(Pred, PredReg)));
       break;
 
     // A7.7.160 Encoding T3: STRB<c> <Rt>,[<Rn>],#+/-<imm8>
@@ -788,7 +805,8 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
       NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRBT))
                          .addReg(SrcReg)
                          .addReg(BaseReg)
-                         .addImm(0));
+                         .addImm(0)
+                         .add(predOps(Pred, PredReg)));
       addImmediateToRegister(MI, BaseReg, Imm, NewInsts);
       break;
 
@@ -816,7 +834,8 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
       NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRT))
                          .addReg(SrcReg)
                          .addReg(BaseReg)
-                         .addImm(0));
+                         .addImm(0)
+                         .add(predOps(Pred, PredReg)));
       NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2SUBrr), BaseReg)
                          .addReg(BaseReg)
                          .addReg(OffsetReg)
@@ -847,7 +866,8 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
       NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRT))
                          .addReg(SrcReg)
                          .addReg(BaseReg)
-                         .addImm(0));
+                         .addImm(0)
+                         .add(predOps(Pred, PredReg)));
       NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2SUBrs), BaseReg)
                          .addReg(BaseReg)
                          .addReg(OffsetReg)
@@ -880,7 +900,8 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
       NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRHT))
                          .addReg(SrcReg)
                          .addReg(BaseReg)
-                         .addImm(0));
+                         .addImm(0)
+                         .add(predOps(Pred, PredReg)));
       NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2SUBrr), BaseReg)
                          .addReg(BaseReg)
                          .addReg(OffsetReg)
@@ -911,7 +932,8 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
       NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRHT))
                          .addReg(SrcReg)
                          .addReg(BaseReg)
-                         .addImm(0));
+                         .addImm(0)
+                         .add(predOps(Pred, PredReg)));
       NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2SUBrs), BaseReg)
                          .addReg(BaseReg)
                          .addReg(OffsetReg)
@@ -944,7 +966,8 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
       NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRBT))
                          .addReg(SrcReg)
                          .addReg(BaseReg)
-                         .addImm(0));
+                         .addImm(0)
+                         .add(predOps(Pred, PredReg)));
       NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2SUBrr), BaseReg)
                          .addReg(BaseReg)
                          .addReg(OffsetReg)
@@ -975,7 +998,8 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
       NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRBT))
                          .addReg(SrcReg)
                          .addReg(BaseReg)
-                         .addImm(0));
+                         .addImm(0)
+                         .add(predOps(Pred, PredReg)));
       NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2SUBrs), BaseReg)
                          .addReg(BaseReg)
                          .addReg(OffsetReg)
@@ -1011,11 +1035,13 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
       NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRT))
                          .addReg(SrcReg)
                          .addReg(BaseReg)
-                         .addImm(Imm2));
+                         .addImm(Imm2)
+                         .add(predOps(Pred, PredReg)));
       NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRT))
                          .addReg(SrcReg2)
                          .addReg(BaseReg)
-                         .addImm(Imm2 + 4));
+                         .addImm(Imm2 + 4)
+                         .add(predOps(Pred, PredReg)));
       if (Imm < 0 || Imm > 251) {
         subtractImmediateFromRegister(MI, BaseReg, Imm, NewInsts);
       }
@@ -1043,11 +1069,13 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
       NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRT))
                          .addReg(SrcReg)
                          .addReg(BaseReg)
-                         .addImm(0));
+                         .addImm(0)
+                         .add(predOps(Pred, PredReg)));
       NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRT))
                          .addReg(SrcReg2)
                          .addReg(BaseReg)
-                         .addImm(4));
+                         .addImm(4)
+                         .add(predOps(Pred, PredReg)));
       break;
 
     // A7.7.163 Encoding T1: STRD<c> <Rt>,<Rt2>,[<Rn>],#+/-<imm8>
@@ -1060,11 +1088,13 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
       NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRT))
                          .addReg(SrcReg)
                          .addReg(BaseReg)
-                         .addImm(0));
+                         .addImm(0)
+                         .add(predOps(Pred, PredReg)));
       NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRT))
                          .addReg(SrcReg2)
                          .addReg(BaseReg)
-                         .addImm(4));
+                         .addImm(4)
+                         .add(predOps(Pred, PredReg)));
       addImmediateToRegister(MI, BaseReg, Imm, NewInsts);
       break;
 
@@ -1124,11 +1154,13 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
         NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRT))
                            .addReg(ScratchReg)
                            .addReg(BaseReg)
-                           .addImm(Imm2));
+                           .addImm(Imm2)
+                           .add(predOps(Pred, PredReg)));
         NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRT))
                            .addReg(ScratchReg2)
                            .addReg(BaseReg)
-                           .addImm(Imm2 + 4));
+                           .addImm(Imm2 + 4)
+                           .add(predOps(Pred, PredReg)));
         if (Imm < 0 || Imm > 251) {
           subtractImmediateFromRegister(MI, BaseReg, Imm, NewInsts);
         }
@@ -1186,7 +1218,8 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
         NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRT))
                            .addReg(ScratchReg)
                            .addReg(BaseReg)
-                           .addImm(Imm2));
+                           .addImm(Imm2)
+                           .add(predOps(Pred, PredReg)));
         if (Imm < 0 || Imm > 255) {
           subtractImmediateFromRegister(MI, BaseReg, Imm, NewInsts);
         }
@@ -1217,7 +1250,8 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
         NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRT))
                            .addReg(RegList[i])
                            .addReg(BaseReg)
-                           .addImm(i * 4));
+                           .addImm(i * 4)
+                           .add(predOps(Pred, PredReg)));
       }
       // Increment the base register
       addImmediateToRegister(MI, BaseReg, RegList.size() * 4, NewInsts);
@@ -1237,7 +1271,8 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
         NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRT))
                            .addReg(RegList[i])
                            .addReg(BaseReg)
-                           .addImm(i * 4));
+                           .addImm(i * 4)
+                           .add(predOps(Pred, PredReg)));
       }
       break;
 
@@ -1257,7 +1292,8 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
         NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRT))
                            .addReg(RegList[i])
                            .addReg(BaseReg)
-                           .addImm(i * 4));
+                           .addImm(i * 4)
+                           .add(predOps(Pred, PredReg)));
       }
       // Restore the incremented base register
       addImmediateToRegister(MI, BaseReg, RegList.size() * 4, NewInsts);
@@ -1279,7 +1315,8 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
         NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRT))
                            .addReg(RegList[i])
                            .addReg(BaseReg)
-                           .addImm(i * 4));
+                           .addImm(i * 4)
+                           .add(predOps(Pred, PredReg)));
       }
       break;
 
@@ -1307,7 +1344,8 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
         NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRT))
                            .addReg(RegList[i])
                            .addReg(BaseReg)
-                           .addImm(i * 4));
+                           .addImm(i * 4)
+                           .add(predOps(Pred, PredReg)));
       }
       break;
 
@@ -1358,11 +1396,13 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
         NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRT))
                            .addReg(ScratchReg)
                            .addReg(BaseReg)
-                           .addImm(Imm));
+                           .addImm(Imm)
+                           .add(predOps(Pred, PredReg)));
         NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRT))
                            .addReg(ScratchReg2)
                            .addReg(BaseReg)
-                           .addImm(Imm + 4));
+                           .addImm(Imm + 4)
+                           .add(predOps(Pred, PredReg)));
       }
       if (FreeRegs.size() < 2) {
         // Restore scratch registers from the stack
@@ -1413,11 +1453,13 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
         NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRT))
                            .addReg(ScratchReg)
                            .addReg(BaseReg)
-                           .addImm(Imm));
+                           .addImm(Imm)
+                           .add(predOps(Pred, PredReg)));
         NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRT))
                            .addReg(ScratchReg2)
                            .addReg(BaseReg)
-                           .addImm(Imm + 4));
+                           .addImm(Imm + 4)
+                           .add(predOps(Pred, PredReg)));
       }
       if (FreeRegs.size() < 2) {
         // Restore scratch registers from the stack
@@ -1472,11 +1514,13 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
         NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRT))
                            .addReg(ScratchReg)
                            .addReg(BaseReg)
-                           .addImm(Imm));
+                           .addImm(Imm)
+                           .add(predOps(Pred, PredReg)));
         NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRT))
                            .addReg(ScratchReg2)
                            .addReg(BaseReg)
-                           .addImm(Imm + 4));
+                           .addImm(Imm + 4)
+                           .add(predOps(Pred, PredReg)));
       }
       if (FreeRegs.size() < 2) {
         // Restore scratch registers from the stack
@@ -1523,7 +1567,8 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
         NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRT))
                            .addReg(ScratchReg)
                            .addReg(BaseReg)
-                           .addImm(Imm));
+                           .addImm(Imm)
+                           .add(predOps(Pred, PredReg)));
       }
       if (FreeRegs.empty()) {
         // Restore the scratch register from the stack
@@ -1570,7 +1615,8 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
         NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRT))
                            .addReg(ScratchReg)
                            .addReg(BaseReg)
-                           .addImm(Imm));
+                           .addImm(Imm)
+                           .add(predOps(Pred, PredReg)));
       }
       if (FreeRegs.empty()) {
         // Restore the scratch register from the stack
@@ -1621,7 +1667,8 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
         NewInsts.push_back(BuildMI(MF, DL, TII->get(ARM::t2STRT))
                            .addReg(ScratchReg)
                            .addReg(BaseReg)
-                           .addImm(Imm));
+                           .addImm(Imm)
+                           .add(predOps(Pred, PredReg)));
       }
       if (FreeRegs.empty()) {
         // Restore the scratch register from the stack
@@ -1634,7 +1681,28 @@ ARMSilhouetteSTR2STRT::runOnMachineFunction(MachineFunction & MF) {
     }
 
     if (!NewInsts.empty()) {
+      // A push in the prologue is replaced by an SP update followed by the
+      // STRTs.  Keep the update marked as part of the frame, so that the
+      // stack usage pass doesn't count it on top of the frame size; the
+      // STRTs and any register backups around them stay unmarked, as the
+      // unwinding information can't describe them.
+      MachineInstr * FrameUpdate = NewInsts.front();
+      unsigned FrameFlags = MI.getFlags() & (MachineInstr::FrameSetup |
+                                             MachineInstr::FrameDestroy);
+      if (FrameFlags != 0 && MI.definesRegister(ARM::SP) &&
+          FrameUpdate->getOperand(0).isReg() &&
+          FrameUpdate->getOperand(0).getReg() == ARM::SP) {
+        switch (FrameUpdate->getOpcode()) {
+        case ARM::tSUBspi:
+        case ARM::tADDspi:
+          FrameUpdate->setFlags(FrameUpdate->getFlags() | FrameFlags);
+          break;
+        default:
+          break;
+        }
+      }
       insertInstsBefore(MI, NewInsts);
+      recordSite(NewInsts, silhouette::SK_STRT);
       removeInst(MI);
     }
   }
@@ -169,6 +169,7 @@ ARMSilhouetteShadowStack::setupShadowStack(MachineInstr & MI) {
 
   // Now insert these new instructions into the basic block
   insertInstsBefore(MI, NewMIs);
+  recordSite(NewMIs, silhouette::SK_ShadowStackPush);
 }
 
 //
@@ -245,6 +246,7 @@ ARMSilhouetteShadowStack::popFromShadowStack(MachineInstr & MI,
 
   // Now insert these new instructions into the basic block
   insertInstsAfter(MI, NewMIs);
+  recordSite(NewMIs, silhouette::SK_ShadowStackPop);
 
   // At last, replace the old POP with a new one that doesn't write to PC/LR
   switch (MI.getOpcode()) {
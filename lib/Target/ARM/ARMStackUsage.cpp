@@ -0,0 +1,255 @@
+//===- ARMStackUsage.cpp - Record stack usage for whole-program analysis --===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file
+/// This pass records the final stack usage and the callees of each function,
+/// so that llvm-stack-depth can compute the worst-case stack depth of each
+/// entry point of a program from the records of all of its modules.
+///
+/// It runs after all the passes that change the stack, including the
+/// Silhouette passes, and the stack usage of a function is its frame size
+/// plus the largest temporary adjustment of SP in its body, such as the
+/// registers that the Silhouette store promotion backs up on the stack around
+/// a store. Calls to unknown functions through pointers, and dynamic stack
+/// allocations, are recorded so that the depths depending on them are flagged.
+///
+/// The records are written to the file given by -arm-stack-usage, one line per
+/// fact, each function followed by its calls. The file is truncated by the
+/// first module to finish and appended to by the others, so that the
+/// partitions of a module split for parallel code generation all keep their
+/// records:
+///
+///   function <name> frame <bytes> [dynamic] [shadow-stack] [interrupt]
+///   call <callee>
+///   tail-call <callee>
+///   unknown-indirect-call
+//
+//===----------------------------------------------------------------------===//
+
+#include "ARM.h"
+#include "ARMBaseInstrInfo.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/CodeGen/MachineFrameInfo.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/IR/CallSite.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Metadata.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <mutex>
+
+using namespace llvm;
+
+#define DEBUG_TYPE "arm-record-stack-usage"
+
+extern std::string ARMStackUsageFile;
+
+// Serialize the writes of concurrent code generators, and remember whether
+// the file has been truncated yet.
+static std::mutex StackUsageFileMutex;
+static bool StackUsageFileStarted = false;
+
+namespace {
+
+class ARMStackUsage : public MachineFunctionPass {
+  // The records of the functions in the module, written out at the end.
+  std::string Records;
+
+public:
+  static char ID;
+
+  ARMStackUsage() : MachineFunctionPass(ID) {}
+
+  bool runOnMachineFunction(MachineFunction &MF) override;
+  bool doFinalization(Module &M) override;
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.setPreservesAll();
+    MachineFunctionPass::getAnalysisUsage(AU);
+  }
+
+  MachineFunctionProperties getRequiredProperties() const override {
+    return MachineFunctionProperties().set(
+        MachineFunctionProperties::Property::NoVRegs);
+  }
+
+  StringRef getPassName() const override { return "ARM Stack Usage"; }
+};
+
+} // end anonymous namespace
+
+char ARMStackUsage::ID = 0;
+
+INITIALIZE_PASS(ARMStackUsage, DEBUG_TYPE, "ARM Stack Usage", false, false)
+
+FunctionPass *llvm::createARMStackUsagePass() { return new ARMStackUsage(); }
+
+// Return the number of registers in the register list of a push or pop,
+// which starts at operand Start.
+static unsigned getNumListedRegs(const MachineInstr &MI, unsigned Start) {
+  unsigned NumRegs = 0;
+  for (unsigned i = Start, e = MI.getNumOperands(); i != e; ++i) {
+    const MachineOperand &MO = MI.getOperand(i);
+    if (MO.isReg() && !MO.isImplicit())
+      ++NumRegs;
+  }
+  return NumRegs;
+}
+
+// Return the number of bytes that MI moves SP down by, or a negative number
+// if it moves SP up.
+static int getSPAdjustment(const MachineInstr &MI) {
+  switch (MI.getOpcode()) {
+  default:
+    return 0;
+  case ARM::tSUBspi:
+    return MI.getOperand(2).getImm() * 4;
+  case ARM::tADDspi:
+    return -MI.getOperand(2).getImm() * 4;
+  case ARM::t2SUBri:
+  case ARM::t2SUBri12:
+  case ARM::t2ADDri:
+  case ARM::t2ADDri12: {
+    if (MI.getOperand(0).getReg() != ARM::SP ||
+        MI.getOperand(1).getReg() != ARM::SP)
+      return 0;
+    int Bytes = MI.getOperand(2).getImm();
+    bool IsSub = MI.getOpcode() == ARM::t2SUBri ||
+                 MI.getOpcode() == ARM::t2SUBri12;
+    return IsSub ? Bytes : -Bytes;
+  }
+  case ARM::tPUSH:
+    return getNumListedRegs(MI, 2) * 4;
+  case ARM::tPOP:
+    return -(int)getNumListedRegs(MI, 2) * 4;
+  case ARM::t2STMDB_UPD:
+  case ARM::t2LDMIA_UPD:
+  case ARM::VSTMDDB_UPD:
+  case ARM::VLDMDIA_UPD: {
+    if (MI.getOperand(0).getReg() != ARM::SP)
+      return 0;
+    unsigned RegBytes = (MI.getOpcode() == ARM::VSTMDDB_UPD ||
+                         MI.getOpcode() == ARM::VLDMDIA_UPD) ? 8 : 4;
+    int Bytes = getNumListedRegs(MI, 4) * RegBytes;
+    bool IsPush = MI.getOpcode() == ARM::t2STMDB_UPD ||
+                  MI.getOpcode() == ARM::VSTMDDB_UPD;
+    return IsPush ? Bytes : -Bytes;
+  }
+  case ARM::t2STR_PRE:
+    if (MI.getOperand(0).getReg() != ARM::SP)
+      return 0;
+    return -MI.getOperand(3).getImm();
+  case ARM::t2LDR_POST:
+    if (MI.getOperand(1).getReg() != ARM::SP)
+      return 0;
+    return -MI.getOperand(3).getImm();
+  }
+}
+
+bool ARMStackUsage::runOnMachineFunction(MachineFunction &MF) {
+  const Function &F = MF.getFunction();
+  const MachineFrameInfo &MFI = MF.getFrameInfo();
+
+  // The prologue and the epilogue are accounted for by the frame size, so
+  // only look for the adjustments of SP in the body. They are expected to be
+  // undone in the block that makes them.
+  int MaxExtra = 0;
+  bool ShadowStack = false;
+  bool HasIndirectCall = false;
+  SetVector<StringRef> Calls, TailCalls;
+  for (const MachineBasicBlock &MBB : MF) {
+    int Extra = 0;
+    for (const MachineInstr &MI : MBB) {
+      if (MI.getFlag(MachineInstr::ShadowStack))
+        ShadowStack = true;
+      if (!MI.getFlag(MachineInstr::FrameSetup) &&
+          !MI.getFlag(MachineInstr::FrameDestroy)) {
+        Extra += getSPAdjustment(MI);
+        MaxExtra = std::max(MaxExtra, Extra);
+      }
+
+      if (!MI.isCall())
+        continue;
+      auto &Callees = MI.isReturn() ? TailCalls : Calls;
+      auto Target = llvm::find_if(MI.operands(), [](const MachineOperand &MO) {
+        return MO.isGlobal() || MO.isSymbol();
+      });
+      if (Target == MI.operands_end())
+        HasIndirectCall = true;
+      else if (Target->isGlobal())
+        Callees.insert(Target->getGlobal()->getName());
+      else
+        Callees.insert(Target->getSymbolName());
+    }
+  }
+
+  // The targets of indirect calls can only be known from the IR, if the
+  // front end or an analysis annotated the calls with their possible callees.
+  bool UnknownIndirectCall = false;
+  if (HasIndirectCall) {
+    bool Annotated = false;
+    for (const Instruction &I : instructions(F)) {
+      ImmutableCallSite CS(&I);
+      if (!CS || CS.isInlineAsm() ||
+          isa<Function>(CS.getCalledValue()->stripPointerCasts()))
+        continue;
+      MDNode *CalleesMD = I.getMetadata(LLVMContext::MD_callees);
+      if (!CalleesMD) {
+        UnknownIndirectCall = true;
+        break;
+      }
+      Annotated = true;
+      for (const MDOperand &Op : CalleesMD->operands())
+        if (auto *Callee = mdconst::extract_or_null<Function>(Op))
+          Calls.insert(Callee->getName());
+    }
+    // The indirect call was not in the IR, so nothing is known of it.
+    if (!Annotated)
+      UnknownIndirectCall = true;
+  }
+
+  raw_string_ostream OS(Records);
+  OS << "function " << MF.getName() << " frame "
+     << MFI.getStackSize() + MaxExtra;
+  if (MFI.hasVarSizedObjects())
+    OS << " dynamic";
+  if (ShadowStack)
+    OS << " shadow-stack";
+  if (F.hasFnAttribute("interrupt"))
+    OS << " interrupt";
+  OS << "\n";
+  for (StringRef Callee : Calls)
+    OS << "call " << Callee << "\n";
+  for (StringRef Callee : TailCalls)
+    OS << "tail-call " << Callee << "\n";
+  if (UnknownIndirectCall)
+    OS << "unknown-indirect-call\n";
+  OS.flush();
+  return false;
+}
+
+bool ARMStackUsage::doFinalization(Module &M) {
+  std::lock_guard<std::mutex> Lock(StackUsageFileMutex);
+  sys::fs::OpenFlags Flags = sys::fs::F_Text;
+  if (StackUsageFileStarted)
+    Flags |= sys::fs::F_Append;
+  StackUsageFileStarted = true;
+  std::error_code EC;
+  raw_fd_ostream OS(ARMStackUsageFile, EC, Flags);
+  if (EC) {
+    M.getContext().emitError("could not open stack usage file '" +
+                             ARMStackUsageFile + "': " + EC.message());
+    return false;
+  }
+  OS << Records;
+  Records.clear();
+  return false;
+}
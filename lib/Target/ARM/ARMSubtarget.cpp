@@ -138,8 +138,8 @@ const RegisterBankInfo *ARMSubtarget::getRegBankInfo() const {
 }
 
 bool ARMSubtarget::isXRaySupported() const {
-  // We don't currently suppport Thumb, but Windows requires Thumb.
-  return hasV6Ops() && hasARMOps() && !isTargetWindows();
+  // Sleds need ARM or Thumb2 code; Windows is not supported.
+  return hasV6Ops() && (hasARMOps() || hasThumb2()) && !isTargetWindows();
 }
 
 void ARMSubtarget::initializeEnvironment() {
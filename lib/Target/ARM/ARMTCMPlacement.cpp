@@ -0,0 +1,516 @@
+//===- ARMTCMPlacement.cpp - Place hot code in tightly-coupled memory -----===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file
+/// On M-profile cores with tightly-coupled memory, code executed from the
+/// instruction TCM is fetched without the wait states of flash, and data in
+/// the data TCM is accessed without the wait states of SRAM or flash, but both
+/// TCMs are small. This pass uses the profile to choose the functions and
+/// globals that gain the most from being in a TCM, and moves them into the TCM
+/// sections as long as they fit in the given budgets.
+///
+/// Functions are ranked by the number of instructions they are expected to
+/// execute, from their entry count and block frequencies, per byte of code.
+/// The ITCM is out of branch range of flash, so each call between a function
+/// in the ITCM and one in flash goes through a long branch veneer, unless the
+/// caller already makes long calls. The cost of executing those veneers is
+/// taken from the gain of a function, and the veneers for its calls into
+/// flash, which the linker places next to it, are counted in its size.
+///
+/// Globals are ranked by their profile-weighted number of loads and stores per
+/// byte. Read-only globals, such as lookup tables, go in a section of their own
+/// with a budget of their own, as they are often copied from flash at startup
+/// separately from the writable data.
+///
+/// Each decision is reported as an optimization remark, and a summary of the
+/// placement can be written to a file with -arm-tcm-report.
+//
+//===----------------------------------------------------------------------===//
+
+#include "ARM.h"
+#include "ARMSubtarget.h"
+#include "ARMTargetMachine.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/BlockFrequencyInfo.h"
+#include "llvm/Analysis/OptimizationRemarkEmitter.h"
+#include "llvm/Analysis/ProfileSummaryInfo.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/CodeGen/TargetPassConfig.h"
+#include "llvm/IR/CallSite.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+
+using namespace llvm;
+
+#define DEBUG_TYPE "arm-tcm-placement"
+
+STATISTIC(NumITCMFunctions, "Number of functions placed in the ITCM");
+STATISTIC(ITCMBytes, "Estimated bytes of code placed in the ITCM");
+STATISTIC(NumDTCMGlobals, "Number of globals placed in the DTCM");
+STATISTIC(DTCMBytes, "Bytes of data placed in the DTCM");
+
+extern unsigned ARMITCMBudget;
+extern unsigned ARMDTCMBudget;
+extern unsigned ARMDTCMROBudget;
+
+static cl::opt<std::string>
+ITCMSection("arm-itcm-section", cl::Hidden, cl::init(".itcm"),
+            cl::desc("Name of the section of the ITCM"));
+
+static cl::opt<std::string>
+DTCMSection("arm-dtcm-section", cl::Hidden, cl::init(".dtcm"),
+            cl::desc("Name of the section of writable data in the DTCM"));
+
+static cl::opt<std::string>
+DTCMROSection("arm-dtcm-ro-section", cl::Hidden, cl::init(".dtcm.rodata"),
+              cl::desc("Name of the section of read-only data in the DTCM"));
+
+static cl::opt<std::string>
+TCMReport("arm-tcm-report", cl::Hidden, cl::value_desc("filename"),
+          cl::desc("Write a report of the TCM placement to a file"));
+
+// Estimated size of an instruction, in bytes, for the IR code size cost.
+// Thumb2 instructions are 2 or 4 bytes; round up so that a placement does not
+// overflow the ITCM.
+static const unsigned BytesPerInst = 4;
+
+// A Thumb2 long branch veneer is a load of the target into the PC, followed
+// by the target address.
+static const unsigned VeneerBytes = 8;
+static const unsigned VeneerInsts = 2;
+
+namespace {
+
+struct FunctionCandidate {
+  Function *F = nullptr;
+  uint64_t EntryCount = 0;
+  // Estimated size in bytes, including the veneers of calls into flash.
+  uint64_t Size = 0;
+  // Expected number of instructions executed by the function.
+  uint64_t DynInsts = 0;
+  // Expected number of instructions executed in veneers, if placed.
+  uint64_t VeneerCost = 0;
+  bool Hot = false;
+
+  int64_t getGain() const {
+    return (int64_t)DynInsts - (int64_t)VeneerCost;
+  }
+  double getDensity() const {
+    return Size ? (double)getGain() / Size : 0.0;
+  }
+};
+
+struct GlobalCandidate {
+  GlobalVariable *GV = nullptr;
+  // Profile-weighted number of loads and stores of the global.
+  uint64_t Loads = 0;
+  uint64_t Stores = 0;
+  // Size in bytes, padded to the alignment of the global.
+  uint64_t Size = 0;
+  // The most frequently executed access, which remarks are attached to.
+  const Instruction *HottestAccess = nullptr;
+  uint64_t HottestCount = 0;
+
+  uint64_t getAccesses() const { return Loads + Stores; }
+  double getDensity() const {
+    return Size ? (double)getAccesses() / Size : 0.0;
+  }
+};
+
+class ARMTCMPlacement : public ModulePass {
+  const TargetMachine *TM = nullptr;
+  ProfileSummaryInfo *PSI = nullptr;
+
+public:
+  static char ID;
+
+  ARMTCMPlacement() : ModulePass(ID) {}
+
+  bool runOnModule(Module &M) override;
+
+  StringRef getPassName() const override { return "ARM TCM Placement"; }
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.addRequired<TargetPassConfig>();
+    AU.addRequired<ProfileSummaryInfoWrapperPass>();
+    AU.addRequired<BlockFrequencyInfoWrapperPass>();
+    AU.addRequired<TargetTransformInfoWrapperPass>();
+    AU.setPreservesAll();
+  }
+
+private:
+  bool makesLongCalls(const Function &F) const {
+    return TM->getSubtarget<ARMSubtarget>(F).genLongCalls();
+  }
+
+  bool placeCode(Module &M, raw_ostream *Report);
+  bool placeData(Module &M, raw_ostream *Report);
+};
+
+} // end anonymous namespace
+
+char ARMTCMPlacement::ID = 0;
+
+INITIALIZE_PASS_BEGIN(ARMTCMPlacement, DEBUG_TYPE, "ARM TCM Placement",
+                      false, false)
+INITIALIZE_PASS_DEPENDENCY(ProfileSummaryInfoWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(BlockFrequencyInfoWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(TargetTransformInfoWrapperPass)
+INITIALIZE_PASS_END(ARMTCMPlacement, DEBUG_TYPE, "ARM TCM Placement",
+                    false, false)
+
+ModulePass *llvm::createARMTCMPlacementPass() { return new ARMTCMPlacement(); }
+
+bool ARMTCMPlacement::runOnModule(Module &M) {
+  if (skipModule(M))
+    return false;
+
+  TM = &getAnalysis<TargetPassConfig>().getTM<TargetMachine>();
+  PSI = &getAnalysis<ProfileSummaryInfoWrapperPass>().getPSI();
+
+  std::unique_ptr<raw_fd_ostream> ReportFile;
+  if (!TCMReport.empty()) {
+    std::error_code EC;
+    ReportFile.reset(new raw_fd_ostream(TCMReport, EC, sys::fs::F_Text));
+    if (EC) {
+      M.getContext().emitError("could not open TCM report file '" +
+                               TCMReport + "': " + EC.message());
+      ReportFile.reset();
+    }
+  }
+
+  bool Changed = false;
+  if (ARMITCMBudget)
+    Changed |= placeCode(M, ReportFile.get());
+  if (ARMDTCMBudget || ARMDTCMROBudget)
+    Changed |= placeData(M, ReportFile.get());
+  return Changed;
+}
+
+bool ARMTCMPlacement::placeCode(Module &M, raw_ostream *Report) {
+  if (!PSI->hasProfileSummary()) {
+    LLVM_DEBUG(dbgs() << "TCM: No profile, not placing code.\n");
+    return false;
+  }
+
+  // Calls into each function from the other functions that would need a
+  // veneer, weighted by the profile.
+  DenseMap<const Function *, uint64_t> IncomingCalls;
+  DenseMap<const Function *, FunctionCandidate> Candidates;
+  uint64_t Used = 0;
+
+  for (Function &F : M) {
+    if (F.isDeclaration())
+      continue;
+
+    auto &BFI = getAnalysis<BlockFrequencyInfoWrapperPass>(F).getBFI();
+    auto &TTI = getAnalysis<TargetTransformInfoWrapperPass>().getTTI(F);
+    FunctionCandidate &C = Candidates[&F];
+    C.F = &F;
+    if (auto Count = F.getEntryCount())
+      C.EntryCount = Count.getCount();
+    C.Hot = PSI->isFunctionHotInCallGraph(&F, BFI);
+
+    bool LongCalls = makesLongCalls(F);
+    SmallPtrSet<const Function *, 8> Callees;
+    for (BasicBlock &BB : F) {
+      uint64_t BBSize = 0;
+      for (Instruction &I : BB)
+        BBSize += TTI.getInstructionCost(&I, TargetTransformInfo::TCK_CodeSize);
+      C.Size += BBSize * BytesPerInst;
+
+      Optional<uint64_t> BBCount = BFI.getBlockProfileCount(&BB);
+      uint64_t Count = BBCount ? *BBCount : 0;
+      C.DynInsts += BBSize * Count;
+
+      for (Instruction &I : BB) {
+        ImmutableCallSite CS(&I);
+        if (!CS)
+          continue;
+        const Function *Callee = CS.getCalledFunction();
+        if (!Callee || Callee->isIntrinsic() || Callee == &F)
+          continue;
+        if (LongCalls)
+          continue;
+
+        // Assume that the other end of the call stays in flash.
+        C.VeneerCost += VeneerInsts * Count;
+        if (Callees.insert(Callee).second)
+          C.Size += VeneerBytes;
+        IncomingCalls[Callee] += Count;
+      }
+    }
+
+    // Code that was placed in the ITCM by hand takes its space first.
+    if (F.getSection() == ITCMSection)
+      Used += C.Size;
+  }
+
+  for (auto &Entry : IncomingCalls) {
+    auto It = Candidates.find(Entry.first);
+    if (It != Candidates.end())
+      It->second.VeneerCost += VeneerInsts * Entry.second;
+  }
+
+  // Most gain per byte first.
+  std::vector<FunctionCandidate *> Order;
+  for (Function &F : M) {
+    auto It = Candidates.find(&F);
+    if (It != Candidates.end())
+      Order.push_back(&It->second);
+  }
+  std::stable_sort(Order.begin(), Order.end(),
+                   [](const FunctionCandidate *A, const FunctionCandidate *B) {
+                     return A->getDensity() > B->getDensity();
+                   });
+
+  if (Report)
+    *Report << "itcm-section " << ITCMSection << " budget " << ARMITCMBudget
+            << " preplaced " << Used << "\n";
+
+  bool Changed = false;
+  for (FunctionCandidate *C : Order) {
+    Function &F = *C->F;
+    auto &BFI = getAnalysis<BlockFrequencyInfoWrapperPass>(F).getBFI();
+    OptimizationRemarkEmitter ORE(&F, &BFI);
+
+    StringRef Reason;
+    if (F.getSection() == ITCMSection)
+      continue;
+    if (F.hasSection())
+      Reason = "has an explicit section";
+    else if (F.hasComdat() || !F.isStrongDefinitionForLinker())
+      Reason = "may be replaced at link time";
+    else if (!C->Hot)
+      Reason = "is not hot";
+    else if (C->getGain() <= 0)
+      Reason = "would spend more time in veneers than it saves";
+    else if (Used + C->Size > ARMITCMBudget)
+      Reason = "does not fit in the remaining ITCM budget";
+
+    if (!Reason.empty()) {
+      // Only report on the functions that were run.
+      if (C->EntryCount) {
+        ORE.emit([&]() {
+          return OptimizationRemarkMissed(DEBUG_TYPE, "NotPlaced",
+                                          F.getSubprogram(),
+                                          &F.getEntryBlock())
+                 << "not placing " << ore::NV("Function", &F)
+                 << " in the ITCM, as it " << Reason;
+        });
+        if (Report)
+          *Report << "skipped " << F.getName() << " size " << C->Size
+                  << " entry-count " << C->EntryCount << " gain "
+                  << C->getGain() << " reason " << Reason << "\n";
+      }
+      continue;
+    }
+
+    F.setSection(ITCMSection);
+    Used += C->Size;
+    ++NumITCMFunctions;
+    ITCMBytes += C->Size;
+    Changed = true;
+
+    ORE.emit([&]() {
+      return OptimizationRemark(DEBUG_TYPE, "Placed", F.getSubprogram(),
+                                &F.getEntryBlock())
+             << "placed " << ore::NV("Function", &F) << " in the ITCM: "
+             << ore::NV("Size", C->Size) << " bytes, entry count "
+             << ore::NV("EntryCount", C->EntryCount) << ", "
+             << ore::NV("Gain", C->getGain())
+             << " instructions executed from the ITCM";
+    });
+    if (Report)
+      *Report << "placed " << F.getName() << " size " << C->Size
+              << " entry-count " << C->EntryCount << " gain " << C->getGain()
+              << "\n";
+  }
+
+  if (Report)
+    *Report << "itcm-used " << Used << "\n";
+  return Changed;
+}
+
+// Add Count accesses of the global that Ptr points into, if any, by I.
+static void addAccess(DenseMap<const GlobalVariable *, GlobalCandidate> &Globals,
+                      const DataLayout &DL, const Value *Ptr,
+                      const Instruction &I, uint64_t Count, bool IsStore) {
+  auto *GV = dyn_cast<GlobalVariable>(GetUnderlyingObject(Ptr, DL));
+  if (!GV)
+    return;
+
+  GlobalCandidate &C = Globals[GV];
+  if (IsStore)
+    C.Stores += Count;
+  else
+    C.Loads += Count;
+  if (!C.HottestAccess || Count > C.HottestCount) {
+    C.HottestAccess = &I;
+    C.HottestCount = Count;
+  }
+}
+
+bool ARMTCMPlacement::placeData(Module &M, raw_ostream *Report) {
+  if (!PSI->hasProfileSummary()) {
+    LLVM_DEBUG(dbgs() << "TCM: No profile, not placing data.\n");
+    return false;
+  }
+
+  const DataLayout &DL = M.getDataLayout();
+  DenseMap<const GlobalVariable *, GlobalCandidate> Globals;
+  for (Function &F : M) {
+    if (F.isDeclaration())
+      continue;
+
+    auto &BFI = getAnalysis<BlockFrequencyInfoWrapperPass>(F).getBFI();
+    for (BasicBlock &BB : F) {
+      Optional<uint64_t> BBCount = BFI.getBlockProfileCount(&BB);
+      uint64_t Count = BBCount ? *BBCount : 0;
+      for (Instruction &I : BB) {
+        if (auto *LI = dyn_cast<LoadInst>(&I)) {
+          addAccess(Globals, DL, LI->getPointerOperand(), I, Count, false);
+        } else if (auto *SI = dyn_cast<StoreInst>(&I)) {
+          addAccess(Globals, DL, SI->getPointerOperand(), I, Count, true);
+        } else if (auto *RMW = dyn_cast<AtomicRMWInst>(&I)) {
+          addAccess(Globals, DL, RMW->getPointerOperand(), I, Count, false);
+          addAccess(Globals, DL, RMW->getPointerOperand(), I, Count, true);
+        } else if (auto *CX = dyn_cast<AtomicCmpXchgInst>(&I)) {
+          addAccess(Globals, DL, CX->getPointerOperand(), I, Count, false);
+          addAccess(Globals, DL, CX->getPointerOperand(), I, Count, true);
+        } else if (auto *MI = dyn_cast<MemIntrinsic>(&I)) {
+          // The length is not known in general, so count a single access.
+          if (auto *MTI = dyn_cast<MemTransferInst>(MI))
+            addAccess(Globals, DL, MTI->getSource(), I, Count, false);
+          addAccess(Globals, DL, MI->getDest(), I, Count, true);
+        }
+      }
+    }
+  }
+
+  for (GlobalVariable &GV : M.globals()) {
+    if (!GV.hasInitializer())
+      continue;
+
+    GlobalCandidate &C = Globals[&GV];
+    C.GV = &GV;
+    uint64_t AllocSize = DL.getTypeAllocSize(GV.getValueType());
+    C.Size = alignTo(AllocSize, DL.getPreferredAlignment(&GV));
+  }
+
+  // Data that was placed in the DTCM by hand takes its space first.
+  uint64_t Used = 0, ROUsed = 0;
+  std::vector<GlobalCandidate *> Order;
+  for (GlobalVariable &GV : M.globals()) {
+    auto It = Globals.find(&GV);
+    if (It == Globals.end() || !It->second.GV)
+      continue;
+    GlobalCandidate &C = It->second;
+    if (GV.getSection() == DTCMSection)
+      Used += C.Size;
+    else if (GV.getSection() == DTCMROSection)
+      ROUsed += C.Size;
+    else
+      Order.push_back(&C);
+  }
+
+  // Most accesses per byte first.
+  std::stable_sort(Order.begin(), Order.end(),
+                   [](const GlobalCandidate *A, const GlobalCandidate *B) {
+                     return A->getDensity() > B->getDensity();
+                   });
+
+  if (Report) {
+    *Report << "dtcm-section " << DTCMSection << " budget " << ARMDTCMBudget
+            << " preplaced " << Used << "\n";
+    *Report << "dtcm-ro-section " << DTCMROSection << " budget "
+            << ARMDTCMROBudget << " preplaced " << ROUsed << "\n";
+  }
+
+  bool Changed = false;
+  for (GlobalCandidate *C : Order) {
+    GlobalVariable &GV = *C->GV;
+    bool ReadOnly = GV.isConstant();
+    uint64_t &SectionUsed = ReadOnly ? ROUsed : Used;
+    uint64_t Budget = ReadOnly ? ARMDTCMROBudget : ARMDTCMBudget;
+    StringRef Section = ReadOnly ? DTCMROSection : DTCMSection;
+
+    StringRef Reason;
+    if (GV.hasSection())
+      Reason = "has an explicit section";
+    else if (GV.isThreadLocal())
+      Reason = "is thread-local";
+    else if (GV.getName().startswith("llvm."))
+      Reason = "is reserved";
+    else if (GV.hasComdat() || !GV.isStrongDefinitionForLinker())
+      Reason = "may be replaced at link time";
+    else if (!PSI->isHotCount(C->getAccesses()))
+      Reason = "is not hot";
+    else if (SectionUsed + C->Size > Budget)
+      Reason = "does not fit in the remaining DTCM budget";
+
+    if (!Reason.empty()) {
+      // Only report on the globals that were accessed.
+      if (C->getAccesses()) {
+        Function &F = *const_cast<Function *>(C->HottestAccess->getFunction());
+        auto &BFI = getAnalysis<BlockFrequencyInfoWrapperPass>(F).getBFI();
+        OptimizationRemarkEmitter ORE(&F, &BFI);
+        ORE.emit([&]() {
+          return OptimizationRemarkMissed(DEBUG_TYPE, "DataNotPlaced",
+                                          C->HottestAccess)
+                 << "not placing " << ore::NV("Global", &GV)
+                 << " in the DTCM, as it " << Reason;
+        });
+        if (Report)
+          *Report << "skipped " << GV.getName() << " size " << C->Size
+                  << " loads " << C->Loads << " stores " << C->Stores
+                  << " reason " << Reason << "\n";
+      }
+      continue;
+    }
+
+    // Constants with unnamed_addr are emitted in mergeable sections, whose
+    // entry size would conflict between the globals sharing the section.
+    if (ReadOnly)
+      GV.setUnnamedAddr(GlobalValue::UnnamedAddr::None);
+    GV.setSection(Section);
+    SectionUsed += C->Size;
+    ++NumDTCMGlobals;
+    DTCMBytes += C->Size;
+    Changed = true;
+
+    Function &F = *const_cast<Function *>(C->HottestAccess->getFunction());
+    auto &BFI = getAnalysis<BlockFrequencyInfoWrapperPass>(F).getBFI();
+    OptimizationRemarkEmitter ORE(&F, &BFI);
+    ORE.emit([&]() {
+      return OptimizationRemark(DEBUG_TYPE, "DataPlaced", C->HottestAccess)
+             << "placed " << ore::NV("Global", &GV) << " in "
+             << ore::NV("Section", Section) << ": "
+             << ore::NV("Size", C->Size) << " bytes, "
+             << ore::NV("Loads", C->Loads) << " loads and "
+             << ore::NV("Stores", C->Stores) << " stores";
+    });
+    if (Report)
+      *Report << "placed " << GV.getName() << " section " << Section
+              << " size " << C->Size << " loads " << C->Loads << " stores "
+              << C->Stores << "\n";
+  }
+
+  if (Report)
+    *Report << "dtcm-used " << Used << "\ndtcm-ro-used " << ROUsed << "\n";
+  return Changed;
+}
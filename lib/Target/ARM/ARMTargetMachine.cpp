@@ -111,6 +111,13 @@ EnableSilhouetteInvert("enable-arm-silhouette-invert",
                        cl::location(SilhouetteInvert),
                        cl::init(false), cl::Hidden);
 
+bool SilhouetteSiteTable;
+static cl::opt<bool, true>
+EnableSilhouetteSiteTable("enable-arm-silhouette-site-table",
+                          cl::desc("Emit a table of the Silhouette instrumentation sites"),
+                          cl::location(SilhouetteSiteTable),
+                          cl::init(false), cl::Hidden);
+
 SilhouetteSFIOption SilhouetteSFI;
 static cl::opt<SilhouetteSFIOption, true>
 EnableSilhouetteSFI("enable-arm-silhouette-sfi",
@@ -121,6 +128,37 @@ EnableSilhouetteSFI("enable-arm-silhouette-sfi",
                                clEnumValN(SelSFI, "selective", "Selective SFI"),
                                clEnumValN(FullSFI, "full", "Full SFI")));
 
+// Tightly-coupled memory placement options
+unsigned ARMITCMBudget;
+static cl::opt<unsigned, true>
+ITCMBudget("arm-itcm-budget",
+           cl::desc("Place the hottest functions in the ITCM, up to this "
+                    "many bytes of code (0 disables)"),
+           cl::location(ARMITCMBudget), cl::init(0), cl::Hidden);
+
+unsigned ARMDTCMBudget;
+static cl::opt<unsigned, true>
+DTCMBudget("arm-dtcm-budget",
+           cl::desc("Place the most accessed writable globals in the DTCM, "
+                    "up to this many bytes (0 disables)"),
+           cl::location(ARMDTCMBudget), cl::init(0), cl::Hidden);
+
+unsigned ARMDTCMROBudget;
+static cl::opt<unsigned, true>
+DTCMROBudget("arm-dtcm-ro-budget",
+             cl::desc("Place the most accessed read-only globals in the DTCM, "
+                      "up to this many bytes (0 disables)"),
+             cl::location(ARMDTCMROBudget), cl::init(0), cl::Hidden);
+
+// Stack usage records for whole-program stack depth analysis
+std::string ARMStackUsageFile;
+static cl::opt<std::string, true>
+StackUsageFile("arm-stack-usage",
+               cl::desc("Write the stack usage and callees of each function "
+                        "to a file, for llvm-stack-depth"),
+               cl::value_desc("filename"), cl::location(ARMStackUsageFile),
+               cl::Hidden);
+
 // FIXME: Unify control over GlobalMerge.
 static cl::opt<cl::boolOrDefault>
 EnableGlobalMerge("arm-global-merge", cl::Hidden,
@@ -148,7 +186,10 @@ extern "C" void LLVMInitializeARMTarget() {
   initializeARMExpandPseudoPass(Registry);
   initializeThumb2SizeReducePass(Registry);
   initializeMVEVPTBlockPass(Registry);
+  initializeMVETailPredicationPass(Registry);
   initializeARMLowOverheadLoopsPass(Registry);
+  initializeARMTCMPlacementPass(Registry);
+  initializeARMStackUsagePass(Registry);
 }
 
 static std::unique_ptr<TargetLoweringObjectFile> createTLOF(const Triple &TT) {
@@ -475,6 +516,11 @@ void ARMPassConfig::addIRPasses() {
   if (EnableSilhouetteCFI) {
     addPass(createIndirectBrExpandPass());
   }
+
+  // Move the hottest code and data into tightly-coupled memory.
+  if (TM->getOptLevel() != CodeGenOpt::None &&
+      (ITCMBudget || DTCMBudget || DTCMROBudget))
+    addPass(createARMTCMPlacementPass());
 }
 
 void ARMPassConfig::addCodeGenPrepare() {
@@ -503,8 +549,10 @@ bool ARMPassConfig::addPreISel() {
                                   MergeExternalByDefault));
   }
 
-  if (TM->getOptLevel() != CodeGenOpt::None)
+  if (TM->getOptLevel() != CodeGenOpt::None) {
     addPass(createHardwareLoopsPass());
+    addPass(createMVETailPredicationPass());
+  }
 
   return false;
 }
@@ -605,5 +653,9 @@ void ARMPassConfig::addPreEmitPass() {
     addPass(createARMSilhouetteLabelCFI());
   }
 
+  // Record the final stack usage, after all the passes that change it.
+  if (!ARMStackUsageFile.empty())
+    addPass(createARMStackUsagePass());
+
   addPass(createARMConstantIslandPass());
 }
@@ -40,6 +40,10 @@ static cl::opt<bool> DisableLowOverheadLoops(
   "disable-arm-loloops", cl::Hidden, cl::init(true),
   cl::desc("Disable the generation of low-overhead loops"));
 
+static cl::opt<bool> EnableMaskedLoadStores(
+  "enable-arm-maskedldst", cl::Hidden, cl::init(false),
+  cl::desc("Enable the generation of masked loads and stores"));
+
 bool ARMTTIImpl::areInlineCompatible(const Function *Caller,
                                      const Function *Callee) const {
   const TargetMachine &TM = getTLI()->getTargetMachine();
@@ -406,6 +410,22 @@ int ARMTTIImpl::getAddressComputationCost(Type *Ty, ScalarEvolution *SE,
   return 1;
 }
 
+bool ARMTTIImpl::isLegalMaskedLoad(Type *DataTy) {
+  if (!EnableMaskedLoadStores || !ST->hasMVEIntegerOps())
+    return false;
+
+  // MVE loads and stores whole 128-bit vectors of 8, 16 or 32-bit elements.
+  if (auto *VecTy = dyn_cast<VectorType>(DataTy)) {
+    if (VecTy->getBitWidth() != 128)
+      return false;
+    DataTy = VecTy->getElementType();
+  }
+  unsigned EltWidth = DataTy->getScalarSizeInBits();
+  return (DataTy->isIntegerTy() || DataTy->isFloatTy() ||
+          DataTy->isHalfTy()) &&
+         (EltWidth == 8 || EltWidth == 16 || EltWidth == 32);
+}
+
 int ARMTTIImpl::getMemcpyCost(const Instruction *I) {
   const MemCpyInst *MI = dyn_cast<MemCpyInst>(I);
   assert(MI && "MemcpyInst expected");
@@ -621,9 +641,10 @@ int ARMTTIImpl::getInterleavedMemoryOpCost(unsigned Opcode, Type *VecTy,
 
     // vldN/vstN only support legal vector types of size 64 or 128 in bits.
     // Accesses having vector types that are a multiple of 128 bits can be
-    // matched to more than one vldN/vstN instruction.
+    // matched to more than one vldN/vstN instruction. MVE has no 64-bit
+    // vectors, nor VLD3/VST3.
     if (NumElts % Factor == 0 &&
-        TLI->isLegalInterleavedAccessType(SubVecTy, DL))
+        TLI->isLegalInterleavedAccessType(Factor, SubVecTy, DL))
       return Factor * TLI->getNumInterleavedAccesses(SubVecTy, DL);
   }
 
@@ -632,6 +653,53 @@ int ARMTTIImpl::getInterleavedMemoryOpCost(unsigned Opcode, Type *VecTy,
                                            UseMaskForCond, UseMaskForGaps);
 }
 
+int ARMTTIImpl::getArithmeticReductionCost(unsigned Opcode, Type *ValTy,
+                                           bool IsPairwiseForm) {
+  EVT ValVT = TLI->getValueType(DL, ValTy);
+  int ISDOpcode = TLI->InstructionOpcodeToISD(Opcode);
+  if (!ST->hasMVEIntegerOps() || !ValVT.isSimple() || ISDOpcode != ISD::ADD)
+    return BaseT::getArithmeticReductionCost(Opcode, ValTy, IsPairwiseForm);
+
+  std::pair<int, MVT> LT = TLI->getTypeLegalizationCost(DL, ValTy);
+
+  // A legal add reduction is a single VADDV. Wider vectors are first added
+  // together, one VADD for each extra legal vector.
+  static const CostTblEntry CostTblAdd[] = {
+    { ISD::ADD, MVT::v16i8, 1 },
+    { ISD::ADD, MVT::v8i16, 1 },
+    { ISD::ADD, MVT::v4i32, 1 },
+  };
+  if (const auto *Entry = CostTableLookup(CostTblAdd, ISDOpcode, LT.second))
+    return Entry->Cost * LT.first;
+
+  return BaseT::getArithmeticReductionCost(Opcode, ValTy, IsPairwiseForm);
+}
+
+bool ARMTTIImpl::useReductionIntrinsic(unsigned Opcode, Type *Ty,
+                                       TTI::ReductionFlags Flags) const {
+  assert(isa<VectorType>(Ty) && "Expected Ty to be a vector type");
+  if (!ST->hasMVEIntegerOps())
+    return false;
+
+  // Add reductions of lanes of up to 32 bits are selected to VADDV (or to
+  // VMLADAV when the lanes are products), which beats a tree of shuffles.
+  unsigned ScalarBits = Ty->getScalarSizeInBits();
+  switch (Opcode) {
+  case Instruction::Add:
+    return Ty->isIntOrIntVectorTy() && ScalarBits <= 32;
+  default:
+    return false;
+  }
+}
+
+bool ARMTTIImpl::shouldExpandReduction(const IntrinsicInst *II) const {
+  // Leave the reductions that MVE can select to instruction selection.
+  if (ST->hasMVEIntegerOps() &&
+      II->getIntrinsicID() == Intrinsic::experimental_vector_reduce_add)
+    return II->getType()->getScalarSizeInBits() > 32;
+  return true;
+}
+
 bool ARMTTIImpl::isLoweredToCall(const Function *F) {
   if (!F->isIntrinsic())
     BaseT::isLoweredToCall(F);
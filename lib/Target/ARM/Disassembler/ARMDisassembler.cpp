@@ -81,6 +81,25 @@ namespace {
         ITStates.push_back(CCBits);
       }
 
+      // Appends the conditions of the rest of the IT block to State, prefixed
+      // by their number.
+      void saveState(std::string &State) const {
+        State.push_back(ITStates.size());
+        State.append(ITStates.begin(), ITStates.end());
+      }
+
+      // Restores the conditions saved by saveState from the front of State,
+      // and drops them from it.
+      void restoreState(StringRef &State) {
+        ITStates.clear();
+        if (State.empty())
+          return;
+        unsigned Size = State.front();
+        ITStates.assign(State.bytes_begin() + 1,
+                        State.bytes_begin() + 1 + Size);
+        State = State.drop_front(Size + 1);
+      }
+
     private:
       std::vector<unsigned char> ITStates;
   };
@@ -122,6 +141,21 @@ namespace {
         VPTStates.push_back(ARMVCC::Then);
       }
 
+      void saveState(std::string &State) const {
+        State.push_back(VPTStates.size());
+        State.append(VPTStates.begin(), VPTStates.end());
+      }
+
+      void restoreState(StringRef &State) {
+        VPTStates.clear();
+        if (State.empty())
+          return;
+        unsigned Size = State.front();
+        VPTStates.assign(State.bytes_begin() + 1,
+                         State.bytes_begin() + 1 + Size);
+        State = State.drop_front(Size + 1);
+      }
+
     private:
       SmallVector<unsigned char, 4> VPTStates;
   };
@@ -140,6 +174,9 @@ public:
                               raw_ostream &VStream,
                               raw_ostream &CStream) const override;
 
+  std::string getDecoderState() const override;
+  void setDecoderState(StringRef State) override;
+
 private:
   DecodeStatus getARMInstruction(MCInst &Instr, uint64_t &Size,
                                  ArrayRef<uint8_t> Bytes, uint64_t Address,
@@ -605,6 +642,20 @@ static DecodeStatus checkDecodedInstruction(MCInst &MI, uint64_t &Size,
   }
 }
 
+// The state is the rest of the IT block followed by the rest of the VPT
+// block.
+std::string ARMDisassembler::getDecoderState() const {
+  std::string State;
+  ITBlock.saveState(State);
+  VPTBlock.saveState(State);
+  return State;
+}
+
+void ARMDisassembler::setDecoderState(StringRef State) {
+  ITBlock.restoreState(State);
+  VPTBlock.restoreState(State);
+}
+
 DecodeStatus ARMDisassembler::getInstruction(MCInst &MI, uint64_t &Size,
                                              ArrayRef<uint8_t> Bytes,
                                              uint64_t Address, raw_ostream &OS,
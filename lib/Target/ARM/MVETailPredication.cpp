@@ -0,0 +1,308 @@
+//===- MVETailPredication.cpp - MVE Tail Predication ----------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file
+/// Armv8.1m introduced MVE, M-Profile Vector Extension, and low-overhead
+/// branches to help accelerate DSP applications. These two extensions can be
+/// combined to provide implicit vector predication within a low-overhead loop.
+///
+/// The vectorizer folds the remainder of a loop into its vector body by
+/// masking the memory operations with a compare of the induction against the
+/// backedge-taken count, and the HardwareLoops pass then marks the loop with
+/// the set.loop.iterations and loop.decrement.reg intrinsics. This pass
+/// replaces that mask with a VCTP of the number of elements left to process,
+/// which is decremented by the vector width each iteration, and sets the
+/// iteration count to the element count rounded up to a whole number of
+/// vectors. ARMLowOverheadLoops can then turn the VCTP into the implicit
+/// predicate of DLSTP/LETP.
+///
+//===----------------------------------------------------------------------===//
+
+#include "ARM.h"
+#include "ARMSubtarget.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/ScalarEvolutionExpander.h"
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
+#include "llvm/Analysis/VectorUtils.h"
+#include "llvm/CodeGen/TargetPassConfig.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/Intrinsics.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Transforms/Utils/Local.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "mve-tail-predication"
+#define DESC "Transform predicated vector loops to use MVE tail predication"
+
+STATISTIC(NumTailPredicated, "Number of loops given a VCTP");
+
+static cl::opt<bool>
+DisableTailPredication("disable-mve-tail-predication", cl::Hidden,
+                       cl::init(false),
+                       cl::desc("Disable MVE Tail Predication"));
+
+namespace {
+
+  class MVETailPredication : public FunctionPass {
+    ScalarEvolution *SE = nullptr;
+
+  public:
+    static char ID;
+
+    MVETailPredication() : FunctionPass(ID) { }
+
+    void getAnalysisUsage(AnalysisUsage &AU) const override {
+      AU.addRequired<ScalarEvolutionWrapperPass>();
+      AU.addRequired<LoopInfoWrapperPass>();
+      AU.addRequired<TargetPassConfig>();
+      AU.addPreserved<LoopInfoWrapperPass>();
+      AU.setPreservesCFG();
+    }
+
+    bool runOnFunction(Function &F) override;
+
+    StringRef getPassName() const override { return DESC; }
+
+  private:
+    bool TryConvert(Loop *L);
+
+    Value *MatchMask(Loop *L, Value *Mask, unsigned Lanes) const;
+
+    bool IsTailFoldedCount(Value *TripCount, Value *BTC,
+                           unsigned Lanes) const;
+  };
+
+} // end anonymous namespace
+
+static IntrinsicInst *FindLoopIterations(BasicBlock *BB) {
+  for (auto &I : *BB) {
+    auto *Call = dyn_cast<IntrinsicInst>(&I);
+    if (Call && Call->getIntrinsicID() == Intrinsic::set_loop_iterations)
+      return Call;
+  }
+  return nullptr;
+}
+
+static bool IsMasked(Instruction *I) {
+  auto *Call = dyn_cast<IntrinsicInst>(I);
+  return Call && (Call->getIntrinsicID() == Intrinsic::masked_load ||
+                  Call->getIntrinsicID() == Intrinsic::masked_store);
+}
+
+static unsigned getMaskOperandIdx(IntrinsicInst *Call) {
+  return Call->getIntrinsicID() == Intrinsic::masked_load ? 2 : 3;
+}
+
+bool MVETailPredication::runOnFunction(Function &F) {
+  if (skipFunction(F) || DisableTailPredication)
+    return false;
+
+  auto &TPC = getAnalysis<TargetPassConfig>();
+  auto &TM = TPC.getTM<TargetMachine>();
+  if (!TM.getSubtarget<ARMSubtarget>(F).hasMVEIntegerOps())
+    return false;
+
+  SE = &getAnalysis<ScalarEvolutionWrapperPass>().getSE();
+  auto &LI = getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
+
+  bool Changed = false;
+  for (auto *L : LI.getLoopsInPreorder())
+    Changed |= TryConvert(L);
+  return Changed;
+}
+
+// Match the mask that the vectorizer builds for a folded tail:
+//   icmp ule (add (splat %index), <0, 1, ..., Lanes-1>), (splat %btc)
+// where %index counts up from zero by Lanes. Return %btc.
+Value *MVETailPredication::MatchMask(Loop *L, Value *Mask,
+                                     unsigned Lanes) const {
+  auto *Cmp = dyn_cast<ICmpInst>(Mask);
+  if (!Cmp || Cmp->getPredicate() != ICmpInst::ICMP_ULE ||
+      !L->contains(Cmp))
+    return nullptr;
+
+  auto *Induction = dyn_cast<BinaryOperator>(Cmp->getOperand(0));
+  if (!Induction || Induction->getOpcode() != Instruction::Add)
+    return nullptr;
+
+  Value *Index = nullptr;
+  for (unsigned i = 0; i < 2 && !Index; ++i) {
+    auto *Steps = dyn_cast<ConstantDataVector>(Induction->getOperand(i));
+    if (!Steps)
+      continue;
+    bool IsStepVector = true;
+    for (unsigned Lane = 0; Lane < Lanes; ++Lane)
+      IsStepVector &= Steps->getElementAsInteger(Lane) == Lane;
+    if (IsStepVector)
+      Index = const_cast<Value*>(getSplatValue(Induction->getOperand(1 - i)));
+  }
+  if (!Index)
+    return nullptr;
+
+  auto *IV = dyn_cast<SCEVAddRecExpr>(SE->getSCEV(Index));
+  if (!IV || IV->getLoop() != L || !IV->isAffine() ||
+      !IV->getStart()->isZero() ||
+      IV->getStepRecurrence(*SE) != SE->getConstant(Index->getType(), Lanes))
+    return nullptr;
+
+  auto *BTC = const_cast<Value*>(getSplatValue(Cmp->getOperand(1)));
+  if (!BTC || !L->isLoopInvariant(BTC))
+    return nullptr;
+  return BTC;
+}
+
+// The VCTP predicates the same lanes as the mask for as long as the element
+// count hasn't run out, so the loop must iterate ceil((btc + 1) / Lanes)
+// times. Accept that count, or the one HardwareLoops computes from the
+// vectorizer's own rounding: ((Lanes * ceil) - Lanes) / Lanes + 1.
+bool MVETailPredication::IsTailFoldedCount(Value *TripCount, Value *BTC,
+                                           unsigned Lanes) const {
+  Type *Ty = BTC->getType();
+  if (TripCount->getType() != Ty)
+    return false;
+
+  const SCEV *VF = SE->getConstant(Ty, Lanes);
+  const SCEV *Ceil = SE->getUDivExpr(SE->getAddExpr(SE->getSCEV(BTC), VF), VF);
+  const SCEV *Rounded =
+    SE->getAddExpr(SE->getUDivExpr(SE->getMinusSCEV(SE->getMulExpr(VF, Ceil),
+                                                    VF), VF),
+                   SE->getOne(Ty));
+  const SCEV *Count = SE->getSCEV(TripCount);
+  return Count == Ceil || Count == Rounded;
+}
+
+bool MVETailPredication::TryConvert(Loop *L) {
+  if (!L->empty() || L->getNumBlocks() != 1)
+    return false;
+
+  BasicBlock *Preheader = L->getLoopPreheader();
+  if (!Preheader)
+    return false;
+
+  IntrinsicInst *Setup = FindLoopIterations(Preheader);
+  if (!Setup && Preheader->getSinglePredecessor())
+    Setup = FindLoopIterations(Preheader->getSinglePredecessor());
+  if (!Setup)
+    return false;
+
+  BasicBlock *Header = L->getHeader();
+  bool FoundDec = any_of(*Header, [](Instruction &I) {
+    auto *Call = dyn_cast<IntrinsicInst>(&I);
+    return Call && Call->getIntrinsicID() == Intrinsic::loop_decrement_reg;
+  });
+  if (!FoundDec)
+    return false;
+
+  // Only a single predicate can be implied by the loop, so every masked
+  // memory operation must share it.
+  SmallVector<IntrinsicInst*, 4> Masked;
+  Value *Mask = nullptr;
+  for (auto &I : *Header) {
+    if (!IsMasked(&I))
+      continue;
+    auto *Call = cast<IntrinsicInst>(&I);
+    Value *M = Call->getArgOperand(getMaskOperandIdx(Call));
+    if (Mask && M != Mask)
+      return false;
+    Mask = M;
+    Masked.push_back(Call);
+  }
+  if (!Mask)
+    return false;
+
+  Intrinsic::ID VCTPID;
+  unsigned Lanes = Mask->getType()->getVectorNumElements();
+  switch (Lanes) {
+  default:
+    return false;
+  case 4:  VCTPID = Intrinsic::arm_mve_vctp32; break;
+  case 8:  VCTPID = Intrinsic::arm_mve_vctp16; break;
+  case 16: VCTPID = Intrinsic::arm_mve_vctp8;  break;
+  }
+
+  Value *BTC = MatchMask(L, Mask, Lanes);
+  if (!BTC) {
+    LLVM_DEBUG(dbgs() << "TP: Mask isn't from a folded tail: " << *Mask
+                      << "\n");
+    return false;
+  }
+
+  Value *TripCount = Setup->getArgOperand(0);
+  if (!IsTailFoldedCount(TripCount, BTC, Lanes)) {
+    LLVM_DEBUG(dbgs() << "TP: Trip count " << *TripCount << " doesn't "
+                      << "cover the elements of the folded tail.\n");
+    return false;
+  }
+
+  // Compute the element count, and the iteration count from it, before the
+  // loop start so that ARMLowOverheadLoops can find them.
+  Type *Ty = BTC->getType();
+  const SCEV *NumElts = SE->getAddExpr(SE->getSCEV(BTC), SE->getOne(Ty));
+  if (!isSafeToExpandAt(NumElts, Setup, *SE)) {
+    LLVM_DEBUG(dbgs() << "TP: Can't compute the element count at the loop "
+                      << "start.\n");
+    return false;
+  }
+
+  LLVM_DEBUG(dbgs() << "TP: Tail predicating " << *L);
+
+  SCEVExpander Expander(*SE, Header->getModule()->getDataLayout(),
+                        "elements");
+  Value *Elts = Expander.expandCodeFor(NumElts, Ty, Setup);
+  IRBuilder<> Builder(Setup);
+  Value *RoundUp = Builder.CreateAdd(Elts, ConstantInt::get(Ty, Lanes - 1));
+  Value *Iterations = Builder.CreateLShr(RoundUp, Log2_32(Lanes));
+  // The count is also the start of the counter that loop.decrement.reg counts
+  // down in the header.
+  for (auto UI = TripCount->use_begin(), E = TripCount->use_end(); UI != E;) {
+    Use &U = *UI++;
+    auto *User = cast<Instruction>(U.getUser());
+    if (User == Setup || (isa<PHINode>(User) && User->getParent() == Header))
+      U.set(Iterations);
+  }
+  RecursivelyDeleteTriviallyDeadInstructions(TripCount);
+
+  // Count the remaining elements down by the vector width, and predicate the
+  // memory operations upon them.
+  Builder.SetInsertPoint(&*Header->getFirstInsertionPt());
+  PHINode *Remaining = Builder.CreatePHI(Ty, 2, "elts.rem");
+  Remaining->addIncoming(Elts, Preheader);
+  Function *VCTP = Intrinsic::getDeclaration(Header->getModule(), VCTPID);
+  Value *Pred = Builder.CreateCall(VCTP, Remaining);
+  Value *Next = Builder.CreateSub(Remaining, ConstantInt::get(Ty, Lanes));
+  Remaining->addIncoming(Next, L->getLoopLatch());
+
+  for (auto *Call : Masked)
+    Call->setArgOperand(getMaskOperandIdx(Call), Pred);
+  RecursivelyDeleteTriviallyDeadInstructions(Mask);
+
+  // The induction may only have been used by the mask.
+  SmallVector<PHINode*, 4> Phis;
+  for (PHINode &Phi : Header->phis())
+    Phis.push_back(&Phi);
+  for (PHINode *Phi : Phis)
+    RecursivelyDeleteDeadPHINode(Phi);
+
+  ++NumTailPredicated;
+  return true;
+}
+
+Pass *llvm::createMVETailPredicationPass() {
+  return new MVETailPredication();
+}
+
+char MVETailPredication::ID = 0;
+
+INITIALIZE_PASS_BEGIN(MVETailPredication, DEBUG_TYPE, DESC, false, false)
+INITIALIZE_PASS_END(MVETailPredication, DEBUG_TYPE, DESC, false, false)
@@ -388,26 +388,30 @@ bool MVEVPTBlock::InsertVPTBlocks(MachineBasicBlock &Block) {
 
     MachineInstrBuilder MIBuilder =
         BuildMI(Block, MBIter, dl, TII->get(ARM::MVE_VPST));
-    // The mask value for the VPST instruction is T = 0b1000 = 8
-    MIBuilder.addImm(VPTMaskValue::T);
-
     MachineBasicBlock::iterator VPSTInsertPos = MIBuilder.getInstr();
-    int VPTInstCnt = 1;
-    ARMVCC::VPTCodes NextPred;
 
-    do {
+    // Gather the instructions that follow with the same predicate, up to the
+    // four that a block can hold.
+    int VPTInstCnt = 1;
+    ++MBIter;
+    while (MBIter != EndIter && VPTInstCnt < 4) {
+      ARMVCC::VPTCodes NextPred = getVPTInstrPredicate(*MBIter, PredReg);
+      if (NextPred != Pred)
+        break;
+      ++VPTInstCnt;
       ++MBIter;
-      NextPred = getVPTInstrPredicate(*MBIter, PredReg);
-    } while (NextPred != ARMVCC::None && NextPred == Pred && ++VPTInstCnt < 4);
+    }
+
+    // Every instruction of the block is a Then, so the mask only has to record
+    // how many there are.
+    static const VPTMaskValue Masks[] = { T, TT, TTT, TTTT };
+    MIBuilder.addImm(Masks[VPTInstCnt - 1]);
 
-    MachineInstr *LastMI = &*MBIter;
     finalizeBundle(Block, VPSTInsertPos.getInstrIterator(),
-                   ++LastMI->getIterator());
+                   MBIter.getInstrIterator());
 
     Modified = true;
     LLVM_DEBUG(dbgs() << "VPT block created for: "; MI->dump(););
-
-    ++MBIter;
   }
   return Modified;
 }
@@ -1564,7 +1564,10 @@ bool SampleProfileLoader::doInitialization(Module &M) {
     return false;
   }
   Reader = std::move(ReaderOrErr.get());
-  Reader->collectFuncsToUse(M);
+  // The remapper needs every profile up front to index their names, so only
+  // decode profiles on demand when no remapping is requested.
+  if (RemappingFilename.empty())
+    Reader->collectFuncsToUse(M);
   ProfileIsValid = (Reader->read() == sampleprof_error::success);
 
   if (!RemappingFilename.empty()) {
@@ -43,6 +43,7 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/Transforms/Utils/BasicBlockUtils.h"
 #include "llvm/Transforms/Utils/ModuleUtils.h"
 #include "llvm/Transforms/Utils/SSAUpdater.h"
@@ -108,6 +109,12 @@ cl::opt<bool> AtomicCounterUpdatePromoted(
              " for promoted counters only"),
     cl::init(false));
 
+cl::opt<unsigned> CounterWidth(
+    "instrprof-counter-width", cl::ZeroOrMore,
+    cl::desc("Width in bits of the profile counters (8, 16, 32 or 64). "
+             "Counters narrower than 64 bits saturate."),
+    cl::init(64));
+
 // If the option is not specified, the default behavior about whether
 // counter promotion is done depends on how instrumentaiton lowering
 // pipeline is setup, i.e., the default value of true of this option
@@ -424,12 +431,25 @@ bool InstrProfiling::lowerIntrinsics(Function *F) {
 }
 
 bool InstrProfiling::isCounterPromotionEnabled() const {
+  // A promoted counter accumulates in a register of the counter's type and
+  // is added to memory on loop exit, so a narrow counter could wrap.
+  if (getCounterWidth() != 64)
+    return false;
+
   if (DoCounterPromotion.getNumOccurrences() > 0)
     return DoCounterPromotion;
 
   return Options.DoCounterPromotion;
 }
 
+unsigned InstrProfiling::getCounterWidth() const {
+  unsigned Width = CounterWidth.getNumOccurrences() > 0 ? CounterWidth
+                                                        : Options.CounterWidth;
+  if (Width != 8 && Width != 16 && Width != 32 && Width != 64)
+    report_fatal_error("unsupported profile counter width " + Twine(Width));
+  return Width;
+}
+
 void InstrProfiling::promoteCounterLoadStores(Function *F) {
   if (!isCounterPromotionEnabled())
     return;
@@ -534,6 +554,7 @@ bool InstrProfiling::run(Module &M, const TargetLibraryInfo &TLI) {
   emitVNodes();
   emitNameData();
   emitRegistration();
+  emitCounterWidthVariant();
   emitUses();
   emitInitialization();
   return true;
@@ -631,7 +652,23 @@ void InstrProfiling::lowerIncrement(InstrProfIncrementInst *Inc) {
   Value *Addr = Builder.CreateConstInBoundsGEP2_64(Counters->getValueType(),
                                                    Counters, 0, Index);
 
-  if (Options.Atomic || AtomicCounterUpdateAll) {
+  unsigned Width = getCounterWidth();
+  if (Width != 64) {
+    if (Options.Atomic || AtomicCounterUpdateAll)
+      report_fatal_error("atomic profile counter updates require 64-bit "
+                         "counters");
+    // Narrow counters saturate at their maximum value rather than wrap. The
+    // step is clamped before truncation for the same reason.
+    Type *CounterTy = Builder.getIntNTy(Width);
+    Value *Step = Inc->getStep();
+    Value *Max = ConstantInt::get(Step->getType(), maxUIntN(Width));
+    Step = Builder.CreateSelect(Builder.CreateICmpUGT(Step, Max), Max, Step);
+    Step = Builder.CreateTrunc(Step, CounterTy);
+    Value *Load = Builder.CreateLoad(CounterTy, Addr, "pgocount");
+    Value *Count = Builder.CreateBinaryIntrinsic(Intrinsic::uadd_sat, Load,
+                                                 Step);
+    Builder.CreateStore(Count, Addr);
+  } else if (Options.Atomic || AtomicCounterUpdateAll) {
     Builder.CreateAtomicRMW(AtomicRMWInst::Add, Addr, Inc->getStep(),
                             AtomicOrdering::Monotonic);
   } else {
@@ -765,7 +802,12 @@ InstrProfiling::getOrCreateRegionCounters(InstrProfIncrementInst *Inc) {
 
   uint64_t NumCounters = Inc->getNumCounters()->getZExtValue();
   LLVMContext &Ctx = M->getContext();
-  ArrayType *CounterTy = ArrayType::get(Type::getInt64Ty(Ctx), NumCounters);
+  // Narrow counter arrays are padded to a multiple of 8 bytes, which keeps the
+  // counters section size a whole number of uint64_t units for the runtime.
+  unsigned Width = getCounterWidth();
+  uint64_t NumCounterSlots = alignTo(NumCounters, 64 / Width);
+  ArrayType *CounterTy =
+      ArrayType::get(Type::getIntNTy(Ctx, Width), NumCounterSlots);
 
   // Create the counters variable.
   auto *CounterPtr =
@@ -966,6 +1008,52 @@ void InstrProfiling::emitRegistration() {
   IRB.CreateRetVoid();
 }
 
+void InstrProfiling::emitCounterWidthVariant() {
+  unsigned Width = getCounterWidth();
+  if (Width == 64)
+    return;
+
+  uint64_t WidthBits = uint64_t(Log2_32(64 / Width))
+                       << VARIANT_SHIFT_COUNTER_WIDTH;
+  StringRef VarName(INSTR_PROF_QUOTE(INSTR_PROF_RAW_VERSION_VAR));
+  Type *Int64Ty = Type::getInt64Ty(M->getContext());
+  // Units with the same width share one definition of the version variable
+  // through a COMDAT group named after the width. Units with different widths,
+  // including IR-level instrumented units with 64-bit counters, keep groups of
+  // their own, so the variable is defined several times and the link fails
+  // rather than keeping one of the widths. A COFF comdat needs a global of the
+  // same name to lead it, so there the variable keeps its usual linkage.
+  Comdat *WidthComdat =
+      TT.supportsCOMDAT() && !TT.isOSBinFormatCOFF()
+          ? M->getOrInsertComdat((VarName + "_w" + Twine(Width)).str())
+          : nullptr;
+  // IR-level instrumentation has already created the version variable; add
+  // the width to its variant bits. Otherwise define it here, overriding the
+  // runtime's default.
+  GlobalVariable *VersionVar = M->getNamedGlobal(VarName);
+  if (VersionVar && VersionVar->hasInitializer()) {
+    auto *Init = cast<ConstantInt>(VersionVar->getInitializer());
+    VersionVar->setInitializer(
+        ConstantInt::get(Int64Ty, Init->getZExtValue() | WidthBits));
+    if (VersionVar->hasComdat() && WidthComdat)
+      VersionVar->setComdat(WidthComdat);
+    return;
+  }
+  Constant *Init =
+      ConstantInt::get(Int64Ty, INSTR_PROF_RAW_VERSION | WidthBits);
+  if (!VersionVar)
+    VersionVar = new GlobalVariable(*M, Int64Ty, true,
+                                    GlobalValue::WeakAnyLinkage, Init, VarName);
+  VersionVar->setInitializer(Init);
+  VersionVar->setConstant(true);
+  VersionVar->setLinkage(GlobalValue::WeakAnyLinkage);
+  VersionVar->setVisibility(GlobalValue::DefaultVisibility);
+  if (WidthComdat) {
+    VersionVar->setLinkage(GlobalValue::ExternalLinkage);
+    VersionVar->setComdat(WidthComdat);
+  }
+}
+
 bool InstrProfiling::emitRuntimeHook() {
   // We expect the linker to be invoked with -u<hook_var> flag for linux,
   // for which case there is no need to emit the user function.
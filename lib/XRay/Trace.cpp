@@ -340,6 +340,89 @@ Error loadFDRLog(StringRef Data, bool IsLittleEndian,
   return Error::success();
 }
 
+/// Reads a log in the compact format, meant for devices that keep a small
+/// ring buffer of events in RAM and dump it for decoding on the host.  The log
+/// is the familiar 32 byte XRayHeader (type 2), whose free-form data starts
+/// with the index of the oldest record in the ring:
+///
+///   (4)   uint32 : index of the oldest record
+///   (12)  -      : padding
+///
+/// followed by the ring buffer itself, made of 8 byte records:
+///
+///   (4)   uint32 : bits 0-1  : record type (0 enter, 1 exit, 2 tail exit)
+///                  bits 2-7  : thread id
+///                  bits 8-31 : function id
+///   (4)   uint32 : low 32 bits of the cycle counter
+///
+/// Records that were never written are all zero, and are skipped since
+/// function ids start at 1.  The full TSC is rebuilt by assuming that less
+/// than 2^32 cycles elapse between two consecutive records.
+Error loadCompactLog(StringRef Data, bool IsLittleEndian,
+                     XRayFileHeader &FileHeader,
+                     std::vector<XRayRecord> &Records) {
+  if (Data.size() < 32)
+    return createStringError(std::make_error_code(std::errc::invalid_argument),
+                             "Not enough bytes for an XRay compact log.");
+  if ((Data.size() - 32) % 8 != 0)
+    return createStringError(std::make_error_code(std::errc::invalid_argument),
+                             "Invalid-sized XRay compact log data.");
+
+  DataExtractor Reader(Data, IsLittleEndian, 8);
+  uint32_t OffsetPtr = 0;
+  auto FileHeaderOrError = readBinaryFormatHeader(Reader, OffsetPtr);
+  if (!FileHeaderOrError)
+    return FileHeaderOrError.takeError();
+  FileHeader = std::move(FileHeaderOrError.get());
+
+  uint32_t HeadOffset = 16;
+  uint32_t Head = Reader.getU32(&HeadOffset);
+  uint32_t NumRecords = (Data.size() - 32) / 8;
+  if (NumRecords != 0 && Head >= NumRecords)
+    return createStringError(
+        std::make_error_code(std::errc::executable_format_error),
+        "Oldest record index %u is beyond the %u records of the log.", Head,
+        NumRecords);
+
+  uint64_t TSC = 0;
+  bool First = true;
+  for (uint32_t I = 0; I != NumRecords; ++I) {
+    OffsetPtr = 32 + ((Head + I) % NumRecords) * 8;
+    uint32_t Word = Reader.getU32(&OffsetPtr);
+    uint32_t Cycles = Reader.getU32(&OffsetPtr);
+    if (Word == 0 && Cycles == 0)
+      continue;
+
+    XRayRecord Record{};
+    switch (Word & 0x3) {
+    case 0:
+      Record.Type = RecordTypes::ENTER;
+      break;
+    case 1:
+      Record.Type = RecordTypes::EXIT;
+      break;
+    case 2:
+      Record.Type = RecordTypes::TAIL_EXIT;
+      break;
+    default:
+      return createStringError(
+          std::make_error_code(std::errc::executable_format_error),
+          "Unknown record type '%u' at offset %u.", Word & 0x3, OffsetPtr - 8);
+    }
+    Record.TId = (Word >> 2) & 0x3f;
+    Record.FuncId = Word >> 8;
+
+    // Carry into the upper half of the TSC whenever the counter wraps.
+    if (!First && Cycles < static_cast<uint32_t>(TSC))
+      TSC += uint64_t(1) << 32;
+    TSC = (TSC & ~uint64_t(0xffffffff)) | Cycles;
+    First = false;
+    Record.TSC = TSC;
+    Records.push_back(std::move(Record));
+  }
+  return Error::success();
+}
+
 Error loadYAMLLog(StringRef Data, XRayFileHeader &FileHeader,
                   std::vector<XRayRecord> &Records) {
   YAMLXRayTrace Trace;
@@ -417,6 +500,7 @@ Expected<Trace> llvm::xray::loadTrace(const DataExtractor &DE, bool Sort) {
   //   0x01 0x00 0x00 0x00 - version 1, "naive" format
   //   0x01 0x00 0x01 0x00 - version 1, "flight data recorder" format
   //   0x02 0x00 0x01 0x00 - version 2, "flight data recorder" format
+  //   0x01 0x00 0x02 0x00 - version 1, compact format
   //
   // YAML files don't typically have those first four bytes as valid text so we
   // try loading assuming YAML if we don't find these bytes.
@@ -428,7 +512,11 @@ Expected<Trace> llvm::xray::loadTrace(const DataExtractor &DE, bool Sort) {
   uint16_t Version = HeaderExtractor.getU16(&OffsetPtr);
   uint16_t Type = HeaderExtractor.getU16(&OffsetPtr);
 
-  enum BinaryFormatType { NAIVE_FORMAT = 0, FLIGHT_DATA_RECORDER_FORMAT = 1 };
+  enum BinaryFormatType {
+    NAIVE_FORMAT = 0,
+    FLIGHT_DATA_RECORDER_FORMAT = 1,
+    COMPACT_FORMAT = 2
+  };
 
   Trace T;
   switch (Type) {
@@ -455,6 +543,17 @@ Expected<Trace> llvm::xray::loadTrace(const DataExtractor &DE, bool Sort) {
           std::make_error_code(std::errc::executable_format_error));
     }
     break;
+  case COMPACT_FORMAT:
+    if (Version == 1) {
+      if (auto E = loadCompactLog(DE.getData(), DE.isLittleEndian(),
+                                  T.FileHeader, T.Records))
+        return std::move(E);
+    } else {
+      return make_error<StringError>(
+          Twine("Unsupported version for compact logging: ") + Twine(Version),
+          std::make_error_code(std::errc::executable_format_error));
+    }
+    break;
   default:
     if (auto E = loadYAMLLog(DE.getData(), T.FileHeader, T.Records))
       return std::move(E);
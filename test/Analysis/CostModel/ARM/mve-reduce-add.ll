@@ -0,0 +1,19 @@
+; RUN: opt < %s -cost-model -analyze -mtriple=thumbv8.1m.main-none-eabi -mattr=+mve | FileCheck %s
+target datalayout = "e-m:e-p:32:32-Fi8-i64:64-v128:64:128-a:0:32-n32-S64"
+
+define i32 @reduce_add() {
+  ; CHECK: Found an estimated cost of 1 for instruction:   %r0 = call i32 @llvm.experimental.vector.reduce.add.v4i32(<4 x i32> undef)
+  %r0 = call i32 @llvm.experimental.vector.reduce.add.v4i32(<4 x i32> undef)
+  ; CHECK: Found an estimated cost of 1 for instruction:   %r1 = call i16 @llvm.experimental.vector.reduce.add.v8i16(<8 x i16> undef)
+  %r1 = call i16 @llvm.experimental.vector.reduce.add.v8i16(<8 x i16> undef)
+  ; CHECK: Found an estimated cost of 1 for instruction:   %r2 = call i8 @llvm.experimental.vector.reduce.add.v16i8(<16 x i8> undef)
+  %r2 = call i8 @llvm.experimental.vector.reduce.add.v16i8(<16 x i8> undef)
+  ; CHECK: Found an estimated cost of 2 for instruction:   %r3 = call i32 @llvm.experimental.vector.reduce.add.v8i32(<8 x i32> undef)
+  %r3 = call i32 @llvm.experimental.vector.reduce.add.v8i32(<8 x i32> undef)
+  ret i32 %r0
+}
+
+declare i32 @llvm.experimental.vector.reduce.add.v4i32(<4 x i32>)
+declare i16 @llvm.experimental.vector.reduce.add.v8i16(<8 x i16>)
+declare i8 @llvm.experimental.vector.reduce.add.v16i8(<16 x i8>)
+declare i32 @llvm.experimental.vector.reduce.add.v8i32(<8 x i32>)
@@ -0,0 +1,86 @@
+; RUN: llc -mtriple thumbv7m-none-eabi -verify-machineinstrs -global-isel -global-isel-abort=2 -pass-remarks-missed='gisel*' %s -o - 2>&1 | FileCheck %s -check-prefixes=CHECK,THUMB
+; RUN: llc -mtriple armv7-none-eabi -verify-machineinstrs -global-isel -global-isel-abort=2 -pass-remarks-missed='gisel*' %s -o - 2>&1 | FileCheck %s -check-prefixes=CHECK,ARM
+
+; This file checks the 64-bit operations and control flow that still use the
+; fallback path after the Cortex-M GlobalISel work in thumb-isel-cortex-m.ll.
+; It should progressively shrink in size.
+
+define i64 @test_i64_args(i64 %a, i64 %b) {
+; CHECK: remark: {{.*}} unable to lower arguments: i64 (i64, i64)*
+; CHECK-LABEL: warning: Instruction selection used fallback path for test_i64_args
+  %res = add i64 %a, %b
+  ret i64 %res
+}
+
+declare i64 @i64_ret_target()
+
+define void @test_i64_ret(i64* %p) {
+; CHECK: remark: {{.*}} unable to translate instruction: call: '  %v = call i64 @i64_ret_target()'
+; CHECK-LABEL: warning: Instruction selection used fallback path for test_i64_ret
+  %v = call i64 @i64_ret_target()
+  store i64 %v, i64* %p
+  ret void
+}
+
+declare void @i64_arg_target(i64)
+
+define void @test_i64_call(i64* %p) {
+; CHECK: remark: {{.*}} unable to translate instruction: call: '  call void @i64_arg_target(i64 %v)'
+; CHECK-LABEL: warning: Instruction selection used fallback path for test_i64_call
+  %v = load i64, i64* %p
+  call void @i64_arg_target(i64 %v)
+  ret void
+}
+
+define void @test_sdiv_i64(i64* %p, i64* %q) {
+; CHECK: remark: {{.*}} unable to legalize instruction: {{.*}}:_(s64) = G_SDIV
+; CHECK-LABEL: warning: Instruction selection used fallback path for test_sdiv_i64
+  %a = load i64, i64* %p
+  %b = load i64, i64* %q
+  %r = sdiv i64 %a, %b
+  store i64 %r, i64* %p
+  ret void
+}
+
+define void @test_udiv_i64(i64* %p, i64* %q) {
+; CHECK: remark: {{.*}} unable to legalize instruction: {{.*}}:_(s64) = G_UDIV
+; CHECK-LABEL: warning: Instruction selection used fallback path for test_udiv_i64
+  %a = load i64, i64* %p
+  %b = load i64, i64* %q
+  %r = udiv i64 %a, %b
+  store i64 %r, i64* %p
+  ret void
+}
+
+; Jump tables are only selected in Thumb mode.
+define i32 @test_jump_table(i32 %x) {
+; ARM: remark: {{.*}} unable to legalize instruction: G_BRJT
+; ARM-LABEL: warning: Instruction selection used fallback path for test_jump_table
+; THUMB-NOT: fallback path for test_jump_table
+entry:
+  switch i32 %x, label %default [
+    i32 0, label %bb0
+    i32 1, label %bb1
+    i32 2, label %bb2
+    i32 3, label %bb3
+    i32 4, label %bb4
+  ]
+
+bb0:
+  ret i32 10
+
+bb1:
+  ret i32 20
+
+bb2:
+  ret i32 30
+
+bb3:
+  ret i32 40
+
+bb4:
+  ret i32 50
+
+default:
+  ret i32 0
+}
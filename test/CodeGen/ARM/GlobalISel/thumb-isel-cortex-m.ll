@@ -0,0 +1,148 @@
+; RUN: llc -mtriple thumbv7m-none-eabi -global-isel -global-isel-abort=1 %s -o - | FileCheck %s
+
+; Cortex-M has neither NEON nor a double precision FPU, so 64-bit integers have
+; to be split into 32-bit halves.
+
+define void @test_add_i64(i64* %p, i64* %q) {
+; CHECK-LABEL: test_add_i64:
+; CHECK: adds{{(.w)?}}
+; CHECK-NOT: cmp
+; CHECK: adc{{s?(.w)?}}
+entry:
+  %a = load i64, i64* %p
+  %b = load i64, i64* %q
+  %sum = add i64 %a, %b
+  store i64 %sum, i64* %p
+  ret void
+}
+
+define void @test_sub_i64(i64* %p, i64* %q) {
+; CHECK-LABEL: test_sub_i64:
+; CHECK: subs{{(.w)?}}
+; CHECK-NOT: cmp
+; CHECK: sbc{{s?(.w)?}}
+entry:
+  %a = load i64, i64* %p
+  %b = load i64, i64* %q
+  %diff = sub i64 %a, %b
+  store i64 %diff, i64* %p
+  ret void
+}
+
+define zeroext i1 @test_icmp_i64(i64* %p, i64* %q) {
+; CHECK-LABEL: test_icmp_i64:
+; CHECK: cmp
+entry:
+  %a = load i64, i64* %p
+  %b = load i64, i64* %q
+  %cmp = icmp ult i64 %a, %b
+  ret i1 %cmp
+}
+
+define void @test_mul_i64(i64* %p, i64* %q) {
+; CHECK-LABEL: test_mul_i64:
+; CHECK: umull
+; CHECK: mla
+; CHECK: pop
+entry:
+  %a = load i64, i64* %p
+  %b = load i64, i64* %q
+  %prod = mul i64 %a, %b
+  store i64 %prod, i64* %p
+  ret void
+}
+
+define void @test_shl_i64(i64* %p, i32 %amt) {
+; CHECK-LABEL: test_shl_i64:
+; CHECK: lsl{{s?(.w)?}}
+; CHECK: pop
+entry:
+  %a = load i64, i64* %p
+  %amt.wide = zext i32 %amt to i64
+  %res = shl i64 %a, %amt.wide
+  store i64 %res, i64* %p
+  ret void
+}
+
+define void @test_lshr_i64(i64* %p, i32 %amt) {
+; CHECK-LABEL: test_lshr_i64:
+; CHECK: lsr{{s?(.w)?}}
+; CHECK: pop
+entry:
+  %a = load i64, i64* %p
+  %amt.wide = zext i32 %amt to i64
+  %res = lshr i64 %a, %amt.wide
+  store i64 %res, i64* %p
+  ret void
+}
+
+define void @test_ashr_i64(i64* %p, i32 %amt) {
+; CHECK-LABEL: test_ashr_i64:
+; CHECK: asr{{s?(.w)?}}
+; CHECK: pop
+entry:
+  %a = load i64, i64* %p
+  %amt.wide = zext i32 %amt to i64
+  %res = ashr i64 %a, %amt.wide
+  store i64 %res, i64* %p
+  ret void
+}
+
+define i32 @test_trunc_i64(i64* %p) {
+; CHECK-LABEL: test_trunc_i64:
+; CHECK: ldr{{(.w)?}} r0, [r0]
+; CHECK: bx lr
+entry:
+  %a = load i64, i64* %p
+  %t = trunc i64 %a to i32
+  ret i32 %t
+}
+
+define void @test_accumulate(i32* %data, i32 %n, i64* %out) {
+; CHECK-LABEL: test_accumulate:
+; CHECK: adds{{(.w)?}}
+; CHECK: adc{{s?(.w)?}}
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %acc = phi i64 [ 0, %entry ], [ %acc.next, %loop ]
+  %addr = getelementptr i32, i32* %data, i32 %i
+  %v = load i32, i32* %addr
+  %v.wide = zext i32 %v to i64
+  %acc.next = add i64 %acc, %v.wide
+  %i.next = add i32 %i, 1
+  %done = icmp eq i32 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  store i64 %acc.next, i64* %out
+  ret void
+}
+
+define i32 @test_jump_table(i32 %x) {
+; CHECK-LABEL: test_jump_table:
+; CHECK: .LJTI{{[0-9]+}}_0:
+entry:
+  switch i32 %x, label %default [
+    i32 0, label %bb0
+    i32 1, label %bb1
+    i32 2, label %bb2
+    i32 3, label %bb3
+    i32 4, label %bb4
+  ]
+
+bb0:
+  ret i32 12
+bb1:
+  ret i32 7
+bb2:
+  ret i32 42
+bb3:
+  ret i32 19
+bb4:
+  ret i32 3
+default:
+  ret i32 0
+}
@@ -1,8 +1,15 @@
 ; RUN: opt -mtriple=arm-arm-eabi -mcpu=cortex-m33 < %s -arm-parallel-dsp -S | FileCheck %s
 ;
-; The loop header is not the loop latch.
+; The loop header is not the loop latch, which doesn't matter as the
+; reduction is found within the header block.
 ;
-; CHECK-NOT:  call i32 @llvm.arm.smlad
+; CHECK-LABEL: for.body:
+; CHECK:  [[CAST0:%[^ ]+]] = bitcast i16* %arrayidx to i32*
+; CHECK:  [[LD0:%[^ ]+]] = load i32, i32* [[CAST0]], align 2
+; CHECK:  [[CAST1:%[^ ]+]] = bitcast i16* %arrayidx3 to i32*
+; CHECK:  [[LD1:%[^ ]+]] = load i32, i32* [[CAST1]], align 2
+; CHECK:  [[SMLAD:%[^ ]+]] = call i32 @llvm.arm.smlad(i32 [[LD1]], i32 [[LD0]], i32 %mac1{{\.}}026)
+; CHECK:  br i1 %exitcond
 ;
 define dso_local i32 @test(i32 %arg, i32* nocapture readnone %arg1, i16* nocapture readonly %arg2, i16* nocapture readonly %arg3) {
 entry:
@@ -0,0 +1,173 @@
+; RUN: opt -mtriple=arm-arm-eabi -mcpu=cortex-m33 < %s -arm-parallel-dsp -S | FileCheck %s
+;
+; Subs of two muls are selected to the subtracting dual multiplies.
+
+; CHECK-LABEL: @smusd
+; CHECK: [[CAST_A:%[^ ]+]] = bitcast i16* %a to i32*
+; CHECK: [[LD_A:%[^ ]+]] = load i32, i32* [[CAST_A]], align 2
+; CHECK: [[CAST_B:%[^ ]+]] = bitcast i16* %b to i32*
+; CHECK: [[LD_B:%[^ ]+]] = load i32, i32* [[CAST_B]], align 2
+; CHECK: [[SMUSD:%[^ ]+]] = call i32 @llvm.arm.smusd(i32 [[LD_A]], i32 [[LD_B]])
+; CHECK: ret i32 [[SMUSD]]
+define i32 @smusd(i16* %a, i16* %b) {
+entry:
+  %a.1 = getelementptr inbounds i16, i16* %a, i32 1
+  %b.1 = getelementptr inbounds i16, i16* %b, i32 1
+  %ld.a.0 = load i16, i16* %a, align 2
+  %sext.a.0 = sext i16 %ld.a.0 to i32
+  %ld.b.0 = load i16, i16* %b, align 2
+  %sext.b.0 = sext i16 %ld.b.0 to i32
+  %ld.a.1 = load i16, i16* %a.1, align 2
+  %sext.a.1 = sext i16 %ld.a.1 to i32
+  %ld.b.1 = load i16, i16* %b.1, align 2
+  %sext.b.1 = sext i16 %ld.b.1 to i32
+  %mul.0 = mul nsw i32 %sext.a.0, %sext.b.0
+  %mul.1 = mul nsw i32 %sext.a.1, %sext.b.1
+  %sub = sub i32 %mul.0, %mul.1
+  ret i32 %sub
+}
+
+; CHECK-LABEL: @smlsd
+; CHECK: [[CAST_A:%[^ ]+]] = bitcast i16* %a to i32*
+; CHECK: [[LD_A:%[^ ]+]] = load i32, i32* [[CAST_A]], align 2
+; CHECK: [[CAST_B:%[^ ]+]] = bitcast i16* %b to i32*
+; CHECK: [[LD_B:%[^ ]+]] = load i32, i32* [[CAST_B]], align 2
+; CHECK: [[SMLSD:%[^ ]+]] = call i32 @llvm.arm.smlsd(i32 [[LD_A]], i32 [[LD_B]], i32 %acc)
+; CHECK: ret i32 [[SMLSD]]
+define i32 @smlsd(i16* %a, i16* %b, i32 %acc) {
+entry:
+  %a.1 = getelementptr inbounds i16, i16* %a, i32 1
+  %b.1 = getelementptr inbounds i16, i16* %b, i32 1
+  %ld.a.0 = load i16, i16* %a, align 2
+  %sext.a.0 = sext i16 %ld.a.0 to i32
+  %ld.b.0 = load i16, i16* %b, align 2
+  %sext.b.0 = sext i16 %ld.b.0 to i32
+  %ld.a.1 = load i16, i16* %a.1, align 2
+  %sext.a.1 = sext i16 %ld.a.1 to i32
+  %ld.b.1 = load i16, i16* %b.1, align 2
+  %sext.b.1 = sext i16 %ld.b.1 to i32
+  %mul.0 = mul nsw i32 %sext.a.0, %sext.b.0
+  %mul.1 = mul nsw i32 %sext.a.1, %sext.b.1
+  %sub = sub i32 %mul.0, %mul.1
+  %res = add i32 %acc, %sub
+  ret i32 %res
+}
+
+; CHECK-LABEL: @smlsdx
+; CHECK: [[CAST_A:%[^ ]+]] = bitcast i16* %a to i32*
+; CHECK: [[LD_A:%[^ ]+]] = load i32, i32* [[CAST_A]], align 2
+; CHECK: [[CAST_B:%[^ ]+]] = bitcast i16* %b to i32*
+; CHECK: [[LD_B:%[^ ]+]] = load i32, i32* [[CAST_B]], align 2
+; CHECK: [[SMLSDX:%[^ ]+]] = call i32 @llvm.arm.smlsdx(i32 [[LD_A]], i32 [[LD_B]], i32 %acc)
+; CHECK: ret i32 [[SMLSDX]]
+define i32 @smlsdx(i16* %a, i16* %b, i32 %acc) {
+entry:
+  %a.1 = getelementptr inbounds i16, i16* %a, i32 1
+  %b.1 = getelementptr inbounds i16, i16* %b, i32 1
+  %ld.a.0 = load i16, i16* %a, align 2
+  %sext.a.0 = sext i16 %ld.a.0 to i32
+  %ld.b.0 = load i16, i16* %b, align 2
+  %sext.b.0 = sext i16 %ld.b.0 to i32
+  %ld.a.1 = load i16, i16* %a.1, align 2
+  %sext.a.1 = sext i16 %ld.a.1 to i32
+  %ld.b.1 = load i16, i16* %b.1, align 2
+  %sext.b.1 = sext i16 %ld.b.1 to i32
+  %mul.0 = mul nsw i32 %sext.a.0, %sext.b.1
+  %mul.1 = mul nsw i32 %sext.a.1, %sext.b.0
+  %sub = sub i32 %mul.0, %mul.1
+  %res = add i32 %sub, %acc
+  ret i32 %res
+}
+
+; CHECK-LABEL: @smlsld
+; CHECK: [[CAST_A:%[^ ]+]] = bitcast i16* %a to i32*
+; CHECK: [[LD_A:%[^ ]+]] = load i32, i32* [[CAST_A]], align 2
+; CHECK: [[CAST_B:%[^ ]+]] = bitcast i16* %b to i32*
+; CHECK: [[LD_B:%[^ ]+]] = load i32, i32* [[CAST_B]], align 2
+; CHECK: [[SMLSLD:%[^ ]+]] = call i64 @llvm.arm.smlsld(i32 [[LD_A]], i32 [[LD_B]], i64 %acc)
+; CHECK: ret i64 [[SMLSLD]]
+define i64 @smlsld(i16* %a, i16* %b, i64 %acc) {
+entry:
+  %a.1 = getelementptr inbounds i16, i16* %a, i32 1
+  %b.1 = getelementptr inbounds i16, i16* %b, i32 1
+  %ld.a.0 = load i16, i16* %a, align 2
+  %sext.a.0 = sext i16 %ld.a.0 to i32
+  %ld.b.0 = load i16, i16* %b, align 2
+  %sext.b.0 = sext i16 %ld.b.0 to i32
+  %ld.a.1 = load i16, i16* %a.1, align 2
+  %sext.a.1 = sext i16 %ld.a.1 to i32
+  %ld.b.1 = load i16, i16* %b.1, align 2
+  %sext.b.1 = sext i16 %ld.b.1 to i32
+  %mul.0 = mul nsw i32 %sext.a.0, %sext.b.0
+  %mul.1 = mul nsw i32 %sext.a.1, %sext.b.1
+  %sub = sub nsw i32 %mul.0, %mul.1
+  %sext.sub = sext i32 %sub to i64
+  %res = add i64 %acc, %sext.sub
+  ret i64 %res
+}
+
+; A sum and a difference of products in the same reduction.
+; CHECK-LABEL: @smuad_smlsd
+; CHECK: [[SMUAD:%[^ ]+]] = call i32 @llvm.arm.smuad(i32 %{{[^ ]+}}, i32 %{{[^ ]+}})
+; CHECK: [[SMLSD:%[^ ]+]] = call i32 @llvm.arm.smlsd(i32 %{{[^ ]+}}, i32 %{{[^ ]+}}, i32 [[SMUAD]])
+; CHECK: ret i32 [[SMLSD]]
+define i32 @smuad_smlsd(i16* %a, i16* %b) {
+entry:
+  %a.1 = getelementptr inbounds i16, i16* %a, i32 1
+  %a.2 = getelementptr inbounds i16, i16* %a, i32 2
+  %a.3 = getelementptr inbounds i16, i16* %a, i32 3
+  %b.1 = getelementptr inbounds i16, i16* %b, i32 1
+  %b.2 = getelementptr inbounds i16, i16* %b, i32 2
+  %b.3 = getelementptr inbounds i16, i16* %b, i32 3
+  %ld.a.0 = load i16, i16* %a, align 2
+  %sext.a.0 = sext i16 %ld.a.0 to i32
+  %ld.b.0 = load i16, i16* %b, align 2
+  %sext.b.0 = sext i16 %ld.b.0 to i32
+  %ld.a.1 = load i16, i16* %a.1, align 2
+  %sext.a.1 = sext i16 %ld.a.1 to i32
+  %ld.b.1 = load i16, i16* %b.1, align 2
+  %sext.b.1 = sext i16 %ld.b.1 to i32
+  %ld.a.2 = load i16, i16* %a.2, align 2
+  %sext.a.2 = sext i16 %ld.a.2 to i32
+  %ld.b.2 = load i16, i16* %b.2, align 2
+  %sext.b.2 = sext i16 %ld.b.2 to i32
+  %ld.a.3 = load i16, i16* %a.3, align 2
+  %sext.a.3 = sext i16 %ld.a.3 to i32
+  %ld.b.3 = load i16, i16* %b.3, align 2
+  %sext.b.3 = sext i16 %ld.b.3 to i32
+  %mul.0 = mul nsw i32 %sext.a.0, %sext.b.0
+  %mul.1 = mul nsw i32 %sext.a.1, %sext.b.1
+  %mul.2 = mul nsw i32 %sext.a.2, %sext.b.2
+  %mul.3 = mul nsw i32 %sext.a.3, %sext.b.3
+  %add = add i32 %mul.0, %mul.1
+  %sub = sub i32 %mul.2, %mul.3
+  %res = add i32 %add, %sub
+  ret i32 %res
+}
+
+; The loads of the muls are not consecutive.
+; CHECK-LABEL: @sub_not_consecutive
+; CHECK-NOT: call i32 @llvm.arm.sm
+define i32 @sub_not_consecutive(i16* %a, i16* %b) {
+entry:
+  %a.1 = getelementptr inbounds i16, i16* %a, i32 1
+  %a.2 = getelementptr inbounds i16, i16* %a, i32 2
+  %b.1 = getelementptr inbounds i16, i16* %b, i32 1
+  %b.2 = getelementptr inbounds i16, i16* %b, i32 2
+  %ld.a.0 = load i16, i16* %a, align 2
+  %sext.a.0 = sext i16 %ld.a.0 to i32
+  %ld.b.0 = load i16, i16* %b, align 2
+  %sext.b.0 = sext i16 %ld.b.0 to i32
+  %ld.a.1 = load i16, i16* %a.1, align 2
+  %sext.a.1 = sext i16 %ld.a.1 to i32
+  %ld.b.1 = load i16, i16* %b.1, align 2
+  %sext.b.1 = sext i16 %ld.b.1 to i32
+  %ld.a.2 = load i16, i16* %a.2, align 2
+  %sext.a.2 = sext i16 %ld.a.2 to i32
+  %ld.b.2 = load i16, i16* %b.2, align 2
+  %sext.b.2 = sext i16 %ld.b.2 to i32
+  %mul.0 = mul nsw i32 %sext.a.0, %sext.b.0
+  %mul.2 = mul nsw i32 %sext.a.2, %sext.b.2
+  %sub = sub i32 %mul.0, %mul.2
+  ret i32 %sub
+}
@@ -0,0 +1,114 @@
+; RUN: opt -mtriple=arm-arm-eabi -mcpu=cortex-m33 < %s -arm-parallel-dsp -S | FileCheck %s
+;
+; Dual multiplies in straight-line code. Without an accumulator, smuad is used
+; for the first pair of muls.
+
+; CHECK-LABEL: @smuad
+; CHECK: [[CAST_A:%[^ ]+]] = bitcast i16* %a to i32*
+; CHECK: [[LD_A:%[^ ]+]] = load i32, i32* [[CAST_A]], align 2
+; CHECK: [[CAST_B:%[^ ]+]] = bitcast i16* %b to i32*
+; CHECK: [[LD_B:%[^ ]+]] = load i32, i32* [[CAST_B]], align 2
+; CHECK: [[SMUAD:%[^ ]+]] = call i32 @llvm.arm.smuad(i32 [[LD_A]], i32 [[LD_B]])
+; CHECK: ret i32 [[SMUAD]]
+define i32 @smuad(i16* %a, i16* %b) {
+entry:
+  %a.1 = getelementptr inbounds i16, i16* %a, i32 1
+  %b.1 = getelementptr inbounds i16, i16* %b, i32 1
+  %ld.a.0 = load i16, i16* %a, align 2
+  %sext.a.0 = sext i16 %ld.a.0 to i32
+  %ld.b.0 = load i16, i16* %b, align 2
+  %sext.b.0 = sext i16 %ld.b.0 to i32
+  %ld.a.1 = load i16, i16* %a.1, align 2
+  %sext.a.1 = sext i16 %ld.a.1 to i32
+  %ld.b.1 = load i16, i16* %b.1, align 2
+  %sext.b.1 = sext i16 %ld.b.1 to i32
+  %mul.0 = mul nsw i32 %sext.a.0, %sext.b.0
+  %mul.1 = mul nsw i32 %sext.a.1, %sext.b.1
+  %add = add i32 %mul.0, %mul.1
+  ret i32 %add
+}
+
+; CHECK-LABEL: @smuadx
+; CHECK: [[CAST_A:%[^ ]+]] = bitcast i16* %a to i32*
+; CHECK: [[LD_A:%[^ ]+]] = load i32, i32* [[CAST_A]], align 2
+; CHECK: [[CAST_B:%[^ ]+]] = bitcast i16* %b to i32*
+; CHECK: [[LD_B:%[^ ]+]] = load i32, i32* [[CAST_B]], align 2
+; CHECK: [[SMUADX:%[^ ]+]] = call i32 @llvm.arm.smuadx(i32 [[LD_A]], i32 [[LD_B]])
+; CHECK: ret i32 [[SMUADX]]
+define i32 @smuadx(i16* %a, i16* %b) {
+entry:
+  %a.1 = getelementptr inbounds i16, i16* %a, i32 1
+  %b.1 = getelementptr inbounds i16, i16* %b, i32 1
+  %ld.a.0 = load i16, i16* %a, align 2
+  %sext.a.0 = sext i16 %ld.a.0 to i32
+  %ld.b.0 = load i16, i16* %b, align 2
+  %sext.b.0 = sext i16 %ld.b.0 to i32
+  %ld.a.1 = load i16, i16* %a.1, align 2
+  %sext.a.1 = sext i16 %ld.a.1 to i32
+  %ld.b.1 = load i16, i16* %b.1, align 2
+  %sext.b.1 = sext i16 %ld.b.1 to i32
+  %mul.0 = mul nsw i32 %sext.a.0, %sext.b.1
+  %mul.1 = mul nsw i32 %sext.a.1, %sext.b.0
+  %add = add i32 %mul.0, %mul.1
+  ret i32 %add
+}
+
+; An argument is used as the accumulator, and the mul that can't be paired is
+; added to the result.
+; CHECK-LABEL: @smlad_unpaired
+; CHECK: [[CAST_A:%[^ ]+]] = bitcast i16* %a to i32*
+; CHECK: [[LD_A:%[^ ]+]] = load i32, i32* [[CAST_A]], align 2
+; CHECK: [[CAST_B:%[^ ]+]] = bitcast i16* %b to i32*
+; CHECK: [[LD_B:%[^ ]+]] = load i32, i32* [[CAST_B]], align 2
+; CHECK: [[SMLAD:%[^ ]+]] = call i32 @llvm.arm.smlad(i32 [[LD_A]], i32 [[LD_B]], i32 %acc)
+; CHECK: [[ADD:%[^ ]+]] = add i32 [[SMLAD]], %mul.2
+; CHECK: ret i32 [[ADD]]
+define i32 @smlad_unpaired(i16* %a, i16* %b, i32 %acc) {
+entry:
+  %a.1 = getelementptr inbounds i16, i16* %a, i32 1
+  %a.2 = getelementptr inbounds i16, i16* %a, i32 2
+  %b.1 = getelementptr inbounds i16, i16* %b, i32 1
+  %b.2 = getelementptr inbounds i16, i16* %b, i32 2
+  %ld.a.0 = load i16, i16* %a, align 2
+  %sext.a.0 = sext i16 %ld.a.0 to i32
+  %ld.b.0 = load i16, i16* %b, align 2
+  %sext.b.0 = sext i16 %ld.b.0 to i32
+  %ld.a.1 = load i16, i16* %a.1, align 2
+  %sext.a.1 = sext i16 %ld.a.1 to i32
+  %ld.b.1 = load i16, i16* %b.1, align 2
+  %sext.b.1 = sext i16 %ld.b.1 to i32
+  %ld.a.2 = load i16, i16* %a.2, align 2
+  %sext.a.2 = sext i16 %ld.a.2 to i32
+  %ld.b.2 = load i16, i16* %b.2, align 2
+  %sext.b.2 = sext i16 %ld.b.2 to i32
+  %mul.0 = mul nsw i32 %sext.a.0, %sext.b.0
+  %mul.1 = mul nsw i32 %sext.a.1, %sext.b.1
+  %mul.2 = mul nsw i32 %sext.a.2, %sext.b.2
+  %add.0 = add i32 %mul.0, %acc
+  %add.1 = add i32 %add.0, %mul.1
+  %add.2 = add i32 %add.1, %mul.2
+  ret i32 %add.2
+}
+
+; Two values that could each be the accumulator: not a reduction.
+; CHECK-LABEL: @two_accumulators
+; CHECK-NOT: call i32 @llvm.arm.sm
+define i32 @two_accumulators(i16* %a, i16* %b, i32 %acc0, i32 %acc1) {
+entry:
+  %a.1 = getelementptr inbounds i16, i16* %a, i32 1
+  %b.1 = getelementptr inbounds i16, i16* %b, i32 1
+  %ld.a.0 = load i16, i16* %a, align 2
+  %sext.a.0 = sext i16 %ld.a.0 to i32
+  %ld.b.0 = load i16, i16* %b, align 2
+  %sext.b.0 = sext i16 %ld.b.0 to i32
+  %ld.a.1 = load i16, i16* %a.1, align 2
+  %sext.a.1 = sext i16 %ld.a.1 to i32
+  %ld.b.1 = load i16, i16* %b.1, align 2
+  %sext.b.1 = sext i16 %ld.b.1 to i32
+  %mul.0 = mul nsw i32 %sext.a.0, %sext.b.0
+  %mul.1 = mul nsw i32 %sext.a.1, %sext.b.1
+  %add.0 = add i32 %mul.0, %acc0
+  %add.1 = add i32 %mul.1, %acc1
+  %add.2 = add i32 %add.0, %add.1
+  ret i32 %add.2
+}
@@ -0,0 +1,196 @@
+; REQUIRES: asserts
+; RUN: opt -mtriple=arm-arm-eabi -mcpu=cortex-m33 < %s -arm-parallel-dsp -S | FileCheck %s
+; RUN: opt -mtriple=arm-arm-eabi -mcpu=cortex-m33 < %s -arm-parallel-dsp -S -stats 2>&1 | FileCheck %s --check-prefix=STATS
+;
+; Four products of sign-extended, consecutive bytes are computed from two word
+; loads: sxtb16 extracts the even bytes, and the odd ones after a rotate.
+
+; CHECK-LABEL: @sxtb16
+; CHECK: [[CAST_A:%[^ ]+]] = bitcast i8* %a to i32*
+; CHECK: [[WIDE_A:%[^ ]+]] = load i32, i32* [[CAST_A]], align 1
+; CHECK: [[CAST_B:%[^ ]+]] = bitcast i8* %b to i32*
+; CHECK: [[WIDE_B:%[^ ]+]] = load i32, i32* [[CAST_B]], align 1
+; CHECK: [[EVEN_A:%[^ ]+]] = call i32 @llvm.arm.sxtb16(i32 [[WIDE_A]])
+; CHECK: [[EVEN_B:%[^ ]+]] = call i32 @llvm.arm.sxtb16(i32 [[WIDE_B]])
+; CHECK: [[SMLAD0:%[^ ]+]] = call i32 @llvm.arm.smlad(i32 [[EVEN_A]], i32 [[EVEN_B]], i32 %acc)
+; CHECK: [[SHR_A:%[^ ]+]] = lshr i32 [[WIDE_A]], 8
+; CHECK: [[SHL_A:%[^ ]+]] = shl i32 [[WIDE_A]], 24
+; CHECK: [[ROR_A:%[^ ]+]] = or i32 [[SHR_A]], [[SHL_A]]
+; CHECK: [[ODD_A:%[^ ]+]] = call i32 @llvm.arm.sxtb16(i32 [[ROR_A]])
+; CHECK: [[SHR_B:%[^ ]+]] = lshr i32 [[WIDE_B]], 8
+; CHECK: [[SHL_B:%[^ ]+]] = shl i32 [[WIDE_B]], 24
+; CHECK: [[ROR_B:%[^ ]+]] = or i32 [[SHR_B]], [[SHL_B]]
+; CHECK: [[ODD_B:%[^ ]+]] = call i32 @llvm.arm.sxtb16(i32 [[ROR_B]])
+; CHECK: [[SMLAD1:%[^ ]+]] = call i32 @llvm.arm.smlad(i32 [[ODD_A]], i32 [[ODD_B]], i32 [[SMLAD0]])
+; CHECK: ret i32 [[SMLAD1]]
+define i32 @sxtb16(i8* %a, i8* %b, i32 %acc) {
+entry:
+  %a.1 = getelementptr inbounds i8, i8* %a, i32 1
+  %a.2 = getelementptr inbounds i8, i8* %a, i32 2
+  %a.3 = getelementptr inbounds i8, i8* %a, i32 3
+  %b.1 = getelementptr inbounds i8, i8* %b, i32 1
+  %b.2 = getelementptr inbounds i8, i8* %b, i32 2
+  %b.3 = getelementptr inbounds i8, i8* %b, i32 3
+  %ld.a.0 = load i8, i8* %a, align 1
+  %sext.a.0 = sext i8 %ld.a.0 to i32
+  %ld.a.1 = load i8, i8* %a.1, align 1
+  %sext.a.1 = sext i8 %ld.a.1 to i32
+  %ld.a.2 = load i8, i8* %a.2, align 1
+  %sext.a.2 = sext i8 %ld.a.2 to i32
+  %ld.a.3 = load i8, i8* %a.3, align 1
+  %sext.a.3 = sext i8 %ld.a.3 to i32
+  %ld.b.0 = load i8, i8* %b, align 1
+  %sext.b.0 = sext i8 %ld.b.0 to i32
+  %ld.b.1 = load i8, i8* %b.1, align 1
+  %sext.b.1 = sext i8 %ld.b.1 to i32
+  %ld.b.2 = load i8, i8* %b.2, align 1
+  %sext.b.2 = sext i8 %ld.b.2 to i32
+  %ld.b.3 = load i8, i8* %b.3, align 1
+  %sext.b.3 = sext i8 %ld.b.3 to i32
+  %mul.0 = mul nsw i32 %sext.a.0, %sext.b.0
+  %mul.1 = mul nsw i32 %sext.b.1, %sext.a.1
+  %mul.2 = mul nsw i32 %sext.a.2, %sext.b.2
+  %mul.3 = mul nsw i32 %sext.a.3, %sext.b.3
+  %add.0 = add i32 %mul.0, %acc
+  %add.1 = add i32 %add.0, %mul.1
+  %add.2 = add i32 %mul.2, %add.1
+  %add.3 = add i32 %add.2, %mul.3
+  ret i32 %add.3
+}
+
+; A fifth product is added to the result, and without an accumulator the
+; first dual multiply is a smuad.
+; CHECK-LABEL: @sxtb16_unpaired
+; CHECK: [[SMUAD:%[^ ]+]] = call i32 @llvm.arm.smuad(i32 %{{[^ ]+}}, i32 %{{[^ ]+}})
+; CHECK: [[SMLAD:%[^ ]+]] = call i32 @llvm.arm.smlad(i32 %{{[^ ]+}}, i32 %{{[^ ]+}}, i32 [[SMUAD]])
+; CHECK: [[ADD:%[^ ]+]] = add i32 [[SMLAD]], %mul.4
+; CHECK: ret i32 [[ADD]]
+define i32 @sxtb16_unpaired(i8* %a, i8* %b) {
+entry:
+  %a.1 = getelementptr inbounds i8, i8* %a, i32 1
+  %a.2 = getelementptr inbounds i8, i8* %a, i32 2
+  %a.3 = getelementptr inbounds i8, i8* %a, i32 3
+  %a.4 = getelementptr inbounds i8, i8* %a, i32 4
+  %b.1 = getelementptr inbounds i8, i8* %b, i32 1
+  %b.2 = getelementptr inbounds i8, i8* %b, i32 2
+  %b.3 = getelementptr inbounds i8, i8* %b, i32 3
+  %b.4 = getelementptr inbounds i8, i8* %b, i32 4
+  %ld.a.0 = load i8, i8* %a, align 1
+  %sext.a.0 = sext i8 %ld.a.0 to i32
+  %ld.a.1 = load i8, i8* %a.1, align 1
+  %sext.a.1 = sext i8 %ld.a.1 to i32
+  %ld.a.2 = load i8, i8* %a.2, align 1
+  %sext.a.2 = sext i8 %ld.a.2 to i32
+  %ld.a.3 = load i8, i8* %a.3, align 1
+  %sext.a.3 = sext i8 %ld.a.3 to i32
+  %ld.a.4 = load i8, i8* %a.4, align 1
+  %sext.a.4 = sext i8 %ld.a.4 to i32
+  %ld.b.0 = load i8, i8* %b, align 1
+  %sext.b.0 = sext i8 %ld.b.0 to i32
+  %ld.b.1 = load i8, i8* %b.1, align 1
+  %sext.b.1 = sext i8 %ld.b.1 to i32
+  %ld.b.2 = load i8, i8* %b.2, align 1
+  %sext.b.2 = sext i8 %ld.b.2 to i32
+  %ld.b.3 = load i8, i8* %b.3, align 1
+  %sext.b.3 = sext i8 %ld.b.3 to i32
+  %ld.b.4 = load i8, i8* %b.4, align 1
+  %sext.b.4 = sext i8 %ld.b.4 to i32
+  %mul.0 = mul nsw i32 %sext.a.0, %sext.b.0
+  %mul.1 = mul nsw i32 %sext.a.1, %sext.b.1
+  %mul.2 = mul nsw i32 %sext.a.2, %sext.b.2
+  %mul.3 = mul nsw i32 %sext.a.3, %sext.b.3
+  %mul.4 = mul nsw i32 %sext.a.4, %sext.b.4
+  %add.0 = add i32 %mul.0, %mul.1
+  %add.1 = add i32 %add.0, %mul.2
+  %add.2 = add i32 %add.1, %mul.3
+  %add.3 = add i32 %add.2, %mul.4
+  ret i32 %add.3
+}
+
+; A store between the loads may alias them.
+; CHECK-LABEL: @sxtb16_aliasing
+; CHECK-NOT: call i32 @llvm.arm.sxtb16
+define i32 @sxtb16_aliasing(i8* %a, i8* %b, i32 %acc) {
+entry:
+  %a.1 = getelementptr inbounds i8, i8* %a, i32 1
+  %a.2 = getelementptr inbounds i8, i8* %a, i32 2
+  %a.3 = getelementptr inbounds i8, i8* %a, i32 3
+  %b.1 = getelementptr inbounds i8, i8* %b, i32 1
+  %b.2 = getelementptr inbounds i8, i8* %b, i32 2
+  %b.3 = getelementptr inbounds i8, i8* %b, i32 3
+  %ld.a.0 = load i8, i8* %a, align 1
+  %ld.a.1 = load i8, i8* %a.1, align 1
+  store i8 0, i8* %b.2, align 1
+  %ld.a.2 = load i8, i8* %a.2, align 1
+  %ld.a.3 = load i8, i8* %a.3, align 1
+  %ld.b.0 = load i8, i8* %b, align 1
+  %ld.b.1 = load i8, i8* %b.1, align 1
+  %ld.b.2 = load i8, i8* %b.2, align 1
+  %ld.b.3 = load i8, i8* %b.3, align 1
+  %sext.a.0 = sext i8 %ld.a.0 to i32
+  %sext.a.1 = sext i8 %ld.a.1 to i32
+  %sext.a.2 = sext i8 %ld.a.2 to i32
+  %sext.a.3 = sext i8 %ld.a.3 to i32
+  %sext.b.0 = sext i8 %ld.b.0 to i32
+  %sext.b.1 = sext i8 %ld.b.1 to i32
+  %sext.b.2 = sext i8 %ld.b.2 to i32
+  %sext.b.3 = sext i8 %ld.b.3 to i32
+  %mul.0 = mul nsw i32 %sext.a.0, %sext.b.0
+  %mul.1 = mul nsw i32 %sext.a.1, %sext.b.1
+  %mul.2 = mul nsw i32 %sext.a.2, %sext.b.2
+  %mul.3 = mul nsw i32 %sext.a.3, %sext.b.3
+  %add.0 = add i32 %mul.0, %acc
+  %add.1 = add i32 %add.0, %mul.1
+  %add.2 = add i32 %add.1, %mul.2
+  %add.3 = add i32 %add.2, %mul.3
+  ret i32 %add.3
+}
+
+; A store to the first byte, after it is loaded, doesn't alias the other three
+; loads, so the word load must be created at the first byte load, before the
+; store, and not after the last one.
+; CHECK-LABEL: @sxtb16_store_first
+; CHECK: %ld.a.0 = load i8, i8* %a, align 1
+; CHECK-NEXT: [[CAST_A:%[^ ]+]] = bitcast i8* %a to i32*
+; CHECK-NEXT: [[WIDE_A:%[^ ]+]] = load i32, i32* [[CAST_A]], align 1
+; CHECK-NEXT: store i8 0, i8* %a, align 1
+; CHECK: call i32 @llvm.arm.sxtb16(i32 [[WIDE_A]])
+define i32 @sxtb16_store_first(i8* %a, i8* %b, i32 %acc) {
+entry:
+  %a.1 = getelementptr inbounds i8, i8* %a, i32 1
+  %a.2 = getelementptr inbounds i8, i8* %a, i32 2
+  %a.3 = getelementptr inbounds i8, i8* %a, i32 3
+  %b.1 = getelementptr inbounds i8, i8* %b, i32 1
+  %b.2 = getelementptr inbounds i8, i8* %b, i32 2
+  %b.3 = getelementptr inbounds i8, i8* %b, i32 3
+  %ld.a.0 = load i8, i8* %a, align 1
+  store i8 0, i8* %a, align 1
+  %ld.a.1 = load i8, i8* %a.1, align 1
+  %ld.a.2 = load i8, i8* %a.2, align 1
+  %ld.a.3 = load i8, i8* %a.3, align 1
+  %ld.b.0 = load i8, i8* %b, align 1
+  %ld.b.1 = load i8, i8* %b.1, align 1
+  %ld.b.2 = load i8, i8* %b.2, align 1
+  %ld.b.3 = load i8, i8* %b.3, align 1
+  %sext.a.0 = sext i8 %ld.a.0 to i32
+  %sext.a.1 = sext i8 %ld.a.1 to i32
+  %sext.a.2 = sext i8 %ld.a.2 to i32
+  %sext.a.3 = sext i8 %ld.a.3 to i32
+  %sext.b.0 = sext i8 %ld.b.0 to i32
+  %sext.b.1 = sext i8 %ld.b.1 to i32
+  %sext.b.2 = sext i8 %ld.b.2 to i32
+  %sext.b.3 = sext i8 %ld.b.3 to i32
+  %mul.0 = mul nsw i32 %sext.a.0, %sext.b.0
+  %mul.1 = mul nsw i32 %sext.a.1, %sext.b.1
+  %mul.2 = mul nsw i32 %sext.a.2, %sext.b.2
+  %mul.3 = mul nsw i32 %sext.a.3, %sext.b.3
+  %add.0 = add i32 %mul.0, %acc
+  %add.1 = add i32 %add.0, %mul.1
+  %add.2 = add i32 %add.1, %mul.2
+  %add.3 = add i32 %add.2, %mul.3
+  ret i32 %add.3
+}
+
+; STATS: 5 arm-parallel-dsp - Number of smlad instructions generated
+; STATS: 1 arm-parallel-dsp - Number of smuad instructions generated
+; STATS: 3 arm-parallel-dsp - Number of sxtb16 byte multiply-accumulates generated
@@ -0,0 +1,41 @@
+; The partitions are left as separate objects, and no object is written to
+; the output file itself.
+; RUN: rm -f %t.o %t.o.2
+; RUN: llc -mtriple=thumbv7m-none-eabi -filetype=obj -codegen-threads=2 -o %t.o %s
+; RUN: not test -e %t.o
+; RUN: not test -e %t.o.2
+; RUN: llvm-nm %t.o.0 | FileCheck --check-prefix=CHECK0 %s
+; RUN: llvm-nm %t.o.1 | FileCheck --check-prefix=CHECK1 %s
+
+; Partitioning must not depend on anything but the module, so a second run
+; produces identical partitions.
+; RUN: llc -mtriple=thumbv7m-none-eabi -filetype=obj -codegen-threads=2 -o %t2.o %s
+; RUN: cmp %t.o.0 %t2.o.0
+; RUN: cmp %t.o.1 %t2.o.1
+
+; RUN: not llc -mtriple=thumbv7m-none-eabi -codegen-threads=2 %s -o - 2>&1 \
+; RUN:   | FileCheck --check-prefix=STDOUT %s
+; STDOUT: -codegen-threads must be specified together with -o
+
+; The local helper stays local and lives with its only user. foo and bar call
+; each other, so each partition refers to the function defined in the other.
+; CHECK0: U bar
+; CHECK0-NEXT: T foo
+; CHECK0-NEXT: t helper
+define void @foo() {
+  call void @helper()
+  call void @bar()
+  ret void
+}
+
+define internal void @helper() noinline {
+  ret void
+}
+
+; CHECK1: T bar
+; CHECK1-NEXT: U foo
+; CHECK1-NOT: helper
+define void @bar() {
+  call void @foo()
+  ret void
+}
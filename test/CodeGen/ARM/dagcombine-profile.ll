@@ -0,0 +1,52 @@
+; RUN: llc -mtriple=thumbv7m-none-eabi -combiner-profile-file=%t.json %s -o /dev/null
+; RUN: FileCheck %s < %t.json
+; RUN: FileCheck %s --check-prefix=COUNTS < %t.json
+
+; Both the generic visit routines and the target combines are profiled, per
+; function.
+
+; CHECK:      "functions": [
+; CHECK:          "name": "f",
+; CHECK-NEXT:     "rules": [
+; CHECK-DAG:        "rule": "visit add",
+; CHECK-DAG:        "rule": "visit sub",
+; CHECK-DAG:        "rule": "visit mul",
+; CHECK-DAG:        "rule": "target mul",
+; CHECK:          "name": "g",
+; CHECK-NEXT:     "rules": [
+; CHECK-NEXT:       {
+; CHECK-NEXT:         "rule": "{{.*}}",
+; CHECK-NEXT:         "attempts": {{[0-9]+}},
+; CHECK-NEXT:         "hits": {{[0-9]+}},
+; CHECK-NEXT:         "nodes-created": {{[0-9]+}},
+; CHECK-NEXT:         "nodes-deleted": {{[0-9]+}},
+; CHECK-NEXT:         "seconds": {{[0-9.e+-]+}}
+; CHECK-NEXT:       },
+
+; visitADD folds (add (sub 0, a), b) in @f into (sub b, a) on its first
+; attempt, which creates the new SUB and deletes the old nodes. The combiner
+; does not revisit the ADD once it is gone.
+
+; COUNTS:      "name": "f",
+; COUNTS:        "rule": "visit add",
+; COUNTS-NEXT:   "attempts": 1,
+; COUNTS-NEXT:   "hits": 1,
+; COUNTS-NEXT:   "nodes-created": 1,
+; COUNTS-NEXT:   "nodes-deleted": {{[1-9][0-9]*}},
+; COUNTS:      "name": "g",
+; COUNTS:        "rule": "visit shl",
+; COUNTS-NEXT:   "attempts": {{[1-9][0-9]*}},
+; COUNTS-NEXT:   "hits": 0,
+
+define i32 @f(i32 %a, i32 %b) {
+  %n = sub i32 0, %a
+  %z = add i32 %n, %b
+  %m = mul i32 %z, %b
+  ret i32 %m
+}
+
+define i32 @g(i32 %a) {
+  %s = shl i32 %a, 2
+  %t = add i32 %s, %a
+  ret i32 %t
+}
@@ -0,0 +1,79 @@
+; RUN: llc < %s -mtriple=thumbv7em-none-eabi -arm-dtcm-budget=16 \
+; RUN:   -arm-dtcm-ro-budget=128 -pass-remarks=arm-tcm-placement \
+; RUN:   -pass-remarks-missed=arm-tcm-placement -arm-tcm-report=%t.report \
+; RUN:   2>%t.remarks | FileCheck %s
+; RUN: FileCheck %s --check-prefix=REMARK < %t.remarks
+; RUN: FileCheck %s --check-prefix=REPORT < %t.report
+; RUN: llc < %s -mtriple=thumbv7em-none-eabi | FileCheck %s --check-prefix=NOBUDGET
+
+; The hot writable global and the hot table fit in their budgets, the large
+; table does not, and the global that is only accessed by cold code stays
+; where it is.
+
+; CHECK:       .section .dtcm,"aw",%progbits
+; CHECK-LABEL: state:
+; CHECK:       .section .dtcm.rodata,"a",%progbits
+; CHECK-LABEL: table:
+; CHECK-NOT:   .dtcm
+; CHECK-LABEL: big_table:
+; CHECK-NOT:   .dtcm
+; CHECK-LABEL: cold_var:
+
+; NOBUDGET-NOT: .dtcm
+
+; REMARK-DAG: remark: <unknown>:0:0: placed state in .dtcm: 4 bytes, 1000 loads and 1000 stores
+; REMARK-DAG: remark: <unknown>:0:0: placed table in .dtcm.rodata: 64 bytes, 1000 loads and 0 stores
+; REMARK-DAG: remark: <unknown>:0:0: not placing big_table in the DTCM, as it does not fit in the remaining DTCM budget
+; REMARK-DAG: remark: <unknown>:0:0: not placing cold_var in the DTCM, as it is not hot
+
+; REPORT:      dtcm-section .dtcm budget 16 preplaced 0
+; REPORT-NEXT: dtcm-ro-section .dtcm.rodata budget 128 preplaced 0
+; REPORT-NEXT: placed state section .dtcm size 4 loads 1000 stores 1000
+; REPORT-NEXT: placed table section .dtcm.rodata size 64 loads 1000 stores 0
+; REPORT-NEXT: skipped big_table size 1024 loads 1000 stores 0 reason does not fit in the remaining DTCM budget
+; REPORT-NEXT: skipped cold_var size 4 loads 1 stores 0 reason is not hot
+; REPORT-NEXT: dtcm-used 4
+; REPORT-NEXT: dtcm-ro-used 64
+
+@state = global i32 0, align 4
+@table = constant [64 x i8] zeroinitializer, align 1
+@big_table = constant [256 x i32] zeroinitializer, align 4
+@cold_var = global i32 1, align 4
+
+define i32 @hot(i32 %i) !prof !15 {
+entry:
+  %s = load i32, i32* @state, align 4
+  %p = getelementptr inbounds [64 x i8], [64 x i8]* @table, i32 0, i32 %i
+  %t = load i8, i8* %p, align 1
+  %t.ext = zext i8 %t to i32
+  %q = getelementptr inbounds [256 x i32], [256 x i32]* @big_table, i32 0, i32 %i
+  %b = load i32, i32* %q, align 4
+  %sum = add i32 %s, %t.ext
+  %sum2 = add i32 %sum, %b
+  store i32 %sum2, i32* @state, align 4
+  ret i32 %sum2
+}
+
+define i32 @cold() !prof !16 {
+entry:
+  %v = load i32, i32* @cold_var, align 4
+  ret i32 %v
+}
+
+!llvm.module.flags = !{!1}
+!1 = !{i32 1, !"ProfileSummary", !2}
+!2 = !{!3, !4, !5, !6, !7, !8, !9, !10}
+!3 = !{!"ProfileFormat", !"InstrProf"}
+!4 = !{!"TotalCount", i64 10000}
+!5 = !{!"MaxCount", i64 1000}
+!6 = !{!"MaxInternalCount", i64 1}
+!7 = !{!"MaxFunctionCount", i64 1000}
+!8 = !{!"NumCounts", i64 2}
+!9 = !{!"NumFunctions", i64 2}
+!10 = !{!"DetailedSummary", !11}
+!11 = !{!12, !13, !14}
+!12 = !{i32 10000, i64 1000, i32 1}
+!13 = !{i32 999000, i64 1000, i32 1}
+!14 = !{i32 999999, i64 1, i32 2}
+!15 = !{!"function_entry_count", i64 1000}
+!16 = !{!"function_entry_count", i64 1}
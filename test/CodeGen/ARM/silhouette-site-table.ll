@@ -0,0 +1,54 @@
+; RUN: llc -mtriple=thumbv7m-none-eabi -enable-arm-silhouette-shadowstack \
+; RUN:   -enable-arm-silhouette-site-table %s -o - \
+; RUN:   | FileCheck %s --check-prefix=ASM
+; RUN: llc -mtriple=thumbv7m-none-eabi -enable-arm-silhouette-shadowstack \
+; RUN:   -enable-arm-silhouette-site-table %s -filetype=obj -o - \
+; RUN:   | llvm-readobj --silhouette-sites - | FileCheck %s
+
+; The table takes up space in the image, so it is only emitted on request.
+; RUN: llc -mtriple=thumbv7m-none-eabi -enable-arm-silhouette-shadowstack %s \
+; RUN:   -o - | FileCheck %s --check-prefix=NOTABLE
+; NOTABLE-NOT: .silhouette_sites
+
+; The shadow stack pass records the save of LR before the prologue PUSH and
+; the reload of the return address after the epilogue POP.
+
+; ASM:      .section .silhouette_sites,"ao",%progbits,foo,unique,1
+; ASM-NEXT: .p2align 2
+; ASM-NEXT: .long foo
+; ASM-NEXT: .long 2
+; ASM-NEXT: .long [[PUSH:.Ltmp[0-9]+]]
+; ASM-NEXT: .short .Ltmp{{[0-9]+}}-[[PUSH]]
+; ASM-NEXT: .byte 1
+; ASM-NEXT: .byte 0
+; ASM-NEXT: .long [[POP:.Ltmp[0-9]+]]
+; ASM-NEXT: .short .Ltmp{{[0-9]+}}-[[POP]]
+; ASM-NEXT: .byte 2
+; ASM-NEXT: .byte 0
+
+; CHECK:      SilhouetteSites [
+; CHECK-NEXT:   Function {
+; CHECK-NEXT:     Address: 0x0
+; CHECK-NEXT:     NumSites: 2
+; CHECK-NEXT:     Sites [
+; CHECK-NEXT:       Site {
+; CHECK-NEXT:         Address: 0x0
+; CHECK-NEXT:         Length: 8
+; CHECK-NEXT:         Kind: ShadowStackPush
+; CHECK-NEXT:       }
+; CHECK-NEXT:       Site {
+; CHECK-NEXT:         Address: 0x10
+; CHECK-NEXT:         Length: 10
+; CHECK-NEXT:         Kind: ShadowStackPop
+; CHECK-NEXT:       }
+; CHECK-NEXT:     ]
+; CHECK-NEXT:   }
+; CHECK-NEXT: ]
+
+declare void @bar()
+
+define void @foo() nounwind {
+entry:
+  call void @bar()
+  ret void
+}
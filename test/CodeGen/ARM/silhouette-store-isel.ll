@@ -0,0 +1,99 @@
+; RUN: llc -mtriple=thumbv7em-none-eabi -mcpu=cortex-m7 -float-abi=hard \
+; RUN:   -enable-arm-silhouette-str2strt %s -o - | FileCheck %s
+
+; With Silhouette, stores are selected in the forms that turn into a single
+; unprivileged store: addresses that do not fit an immediate offset of 0 to
+; 255 are computed into a register, and FP values are stored from core
+; registers.
+
+; CHECK-LABEL: small_offset:
+; CHECK:       strt r1, [r0, #16]
+; CHECK-NEXT:  bx lr
+define void @small_offset(i32* %p, i32 %v) {
+  %a = getelementptr i32, i32* %p, i32 4
+  store i32 %v, i32* %a
+  ret void
+}
+
+; CHECK-LABEL: large_offset:
+; CHECK:       add{{(\.w|w)}} [[ADDR:r[0-9]+]], r0, #1024
+; CHECK-NEXT:  strt r1, {{\[}}[[ADDR]]{{\]}}
+; CHECK-NEXT:  bx lr
+define void @large_offset(i32* %p, i32 %v) {
+  %a = getelementptr i32, i32* %p, i32 256
+  store i32 %v, i32* %a
+  ret void
+}
+
+; CHECK-LABEL: negative_offset:
+; CHECK:       sub{{(\.w|s)?}} [[ADDR:r[0-9]+]], {{(r0, )?}}#8
+; CHECK-NEXT:  strbt r1, {{\[}}[[ADDR]]{{\]}}
+; CHECK-NEXT:  bx lr
+define void @negative_offset(i8* %p, i8 %v) {
+  %a = getelementptr i8, i8* %p, i32 -8
+  store i8 %v, i8* %a
+  ret void
+}
+
+; CHECK-LABEL: register_offset:
+; CHECK:       add.w [[ADDR:r[0-9]+]], r0, r2, lsl #1
+; CHECK-NEXT:  strht r1, {{\[}}[[ADDR]]{{\]}}
+; CHECK-NEXT:  bx lr
+define void @register_offset(i16* %p, i16 %v, i32 %i) {
+  %a = getelementptr i16, i16* %p, i32 %i
+  store i16 %v, i16* %a
+  ret void
+}
+
+; CHECK-LABEL: store_float:
+; CHECK-NOT:   vstr
+; CHECK:       vmov [[R:r[0-9]+]], s0
+; CHECK-NOT:   vstr
+; CHECK:       strt [[R]], [r0]
+define void @store_float(float* %p, float %x) {
+  %y = fadd float %x, %x
+  store float %y, float* %p
+  ret void
+}
+
+; CHECK-LABEL: store_double:
+; CHECK-NOT:   vstr
+; CHECK:       vmov [[LO:r[0-9]+]], [[HI:r[0-9]+]], d0
+; CHECK-NOT:   vstr
+; CHECK-DAG:   strt [[LO]], [r0]
+; CHECK-DAG:   strt [[HI]], [r0, #4]
+define void @store_double(double* %p, double %x) {
+  store double %x, double* %p
+  ret void
+}
+
+; CHECK-LABEL: store_volatile_float:
+; CHECK-NOT:   vstr
+; CHECK:       vmov [[R:r[0-9]+]], s0
+; CHECK-NOT:   vstr
+; CHECK:       strt [[R]], [r0]
+define void @store_volatile_float(float* %p, float %x) {
+  %y = fadd float %x, %x
+  store volatile float %y, float* %p
+  ret void
+}
+
+; Privileged functions keep their privileged stores, so they are selected as
+; usual.
+; CHECK-LABEL: privileged_large_offset:
+; CHECK:       str.w r1, [r0, #1024]
+; CHECK-NEXT:  bx lr
+define void @privileged_large_offset(i32* %p, i32 %v) section "privileged_functions" {
+  %a = getelementptr i32, i32* %p, i32 256
+  store i32 %v, i32* %a
+  ret void
+}
+
+; CHECK-LABEL: privileged_store_float:
+; CHECK-NOT:   vmov
+; CHECK:       vstr s0, [r0]
+define void @privileged_store_float(float* %p, float %x) section "privileged_functions" {
+  %y = fadd float %x, %x
+  store float %y, float* %p
+  ret void
+}
@@ -0,0 +1,124 @@
+; RUN: llc < %s -mtriple=thumbv7m-none-eabi -arm-stack-usage=%t.su -o /dev/null
+; RUN: FileCheck %s < %t.su
+; RUN: llc < %s -mtriple=thumbv7m-none-eabi -arm-stack-usage=%t.ss.su \
+; RUN:   -enable-arm-silhouette-shadowstack -o /dev/null
+; RUN: FileCheck %s --check-prefix=SHADOW < %t.ss.su
+; RUN: llc < %s -mtriple=thumbv7m-none-eabi -mattr=+vfp2 -float-abi=hard \
+; RUN:   -arm-stack-usage=%t.strt.su -enable-arm-silhouette-str2strt \
+; RUN:   -o /dev/null 2>/dev/null
+; RUN: FileCheck %s --check-prefix=STRT < %t.strt.su
+; RUN: llc < %s -mtriple=thumbv7m-none-eabi -arm-stack-usage=%t.thr.su \
+; RUN:   -filetype=obj -codegen-threads=2 -o %t.thr.o
+; RUN: FileCheck %s --check-prefix=THREADS < %t.thr.su
+
+; CHECK:      function leaf frame 64{{$}}
+; CHECK-NEXT: function other frame 0{{$}}
+; CHECK-NEXT: function caller frame {{[0-9]+}}{{$}}
+; CHECK-NEXT: call leaf
+; CHECK-NEXT: call other
+; CHECK-NEXT: call ext
+; CHECK-NEXT: unknown-indirect-call
+; CHECK-NEXT: function annotated frame {{[0-9]+}}{{$}}
+; CHECK-NEXT: call leaf
+; CHECK-NEXT: call other
+; CHECK-NEXT: function tail frame 0{{$}}
+; CHECK-NEXT: tail-call ext
+; CHECK-NEXT: function dyn frame {{[0-9]+}} dynamic{{$}}
+; CHECK-NEXT: call use
+; CHECK-NEXT: function isr frame {{[0-9]+}} interrupt{{$}}
+; CHECK-NEXT: call ext
+; CHECK-NEXT: function backup frame 548{{$}}
+
+; SHADOW: function caller frame {{[0-9]+}} shadow-stack{{$}}
+
+; The store in @backup finds no free register to move %f into, so the store
+; promotion backs one up on the stack around it: the frame is 32 bytes of
+; saved registers, 512 of locals and 4 of backup. The promoted pushes of the
+; prologue are part of the frame and aren't counted twice.
+; STRT: function leaf frame 64{{$}}
+; STRT: function caller frame 8{{$}}
+; STRT: function backup frame 548{{$}}
+
+; Both partitions of a parallel code generation keep their records.
+; THREADS-DAG: function leaf frame 64{{$}}
+; THREADS-DAG: function other frame 0{{$}}
+; THREADS-DAG: function caller frame {{[0-9]+}}{{$}}
+; THREADS-DAG: function annotated frame {{[0-9]+}}{{$}}
+; THREADS-DAG: function tail frame 0{{$}}
+; THREADS-DAG: function dyn frame {{[0-9]+}} dynamic{{$}}
+; THREADS-DAG: function isr frame {{[0-9]+}} interrupt{{$}}
+; THREADS-DAG: function backup frame 548{{$}}
+
+declare void @ext()
+declare void @use(i32*)
+
+define void @leaf() {
+  %buf = alloca [16 x i32], align 4
+  %p = getelementptr inbounds [16 x i32], [16 x i32]* %buf, i32 0, i32 0
+  store volatile i32 0, i32* %p, align 4
+  ret void
+}
+
+define void @other() {
+  ret void
+}
+
+define void @caller(void ()* %fp) {
+  call void @leaf()
+  call void @other()
+  call void @ext()
+  call void %fp()
+  ret void
+}
+
+define void @annotated(void ()* %fp) {
+  call void %fp(), !callees !0
+  ret void
+}
+
+define void @tail() {
+  tail call void @ext()
+  ret void
+}
+
+define void @dyn(i32 %n) {
+  %buf = alloca i32, i32 %n, align 4
+  call void @use(i32* %buf)
+  ret void
+}
+
+define arm_aapcscc void @isr() "interrupt"="IRQ" {
+  call void @ext()
+  ret void
+}
+
+%regs = type { i32, i32, i32, i32, i32, i32, i32, i32, i32, i32, i32, i32, i32 }
+
+define void @backup(float %f) {
+  %buf = alloca [128 x i32], align 4
+  %p = getelementptr inbounds [128 x i32], [128 x i32]* %buf, i32 0, i32 0
+  %fp = bitcast i32* %p to float*
+  %r = call %regs asm sideeffect "",
+         "={r0},={r1},={r2},={r3},={r4},={r5},={r6},={r8},={r9},={r10},={r11},={r12},={lr}"()
+  %v0 = extractvalue %regs %r, 0
+  %v1 = extractvalue %regs %r, 1
+  %v2 = extractvalue %regs %r, 2
+  %v3 = extractvalue %regs %r, 3
+  %v4 = extractvalue %regs %r, 4
+  %v5 = extractvalue %regs %r, 5
+  %v6 = extractvalue %regs %r, 6
+  %v7 = extractvalue %regs %r, 7
+  %v8 = extractvalue %regs %r, 8
+  %v9 = extractvalue %regs %r, 9
+  %v10 = extractvalue %regs %r, 10
+  %v11 = extractvalue %regs %r, 11
+  %v12 = extractvalue %regs %r, 12
+  store volatile float %f, float* %fp
+  call void asm sideeffect "",
+         "{r0},{r1},{r2},{r3},{r4},{r5},{r6},{r8},{r9},{r10},{r11},{r12},{lr}"(
+         i32 %v0, i32 %v1, i32 %v2, i32 %v3, i32 %v4, i32 %v5, i32 %v6,
+         i32 %v7, i32 %v8, i32 %v9, i32 %v10, i32 %v11, i32 %v12)
+  ret void
+}
+
+!0 = !{void ()* @leaf, void ()* @other}
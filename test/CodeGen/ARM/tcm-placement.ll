@@ -0,0 +1,99 @@
+; RUN: llc < %s -mtriple=thumbv7em-none-eabi -arm-itcm-budget=64 \
+; RUN:   -pass-remarks=arm-tcm-placement -pass-remarks-missed=arm-tcm-placement \
+; RUN:   -arm-tcm-report=%t.report 2>%t.remarks | FileCheck %s
+; RUN: FileCheck %s --check-prefix=REMARK < %t.remarks
+; RUN: FileCheck %s --check-prefix=REPORT < %t.report
+; RUN: llc < %s -mtriple=thumbv7em-none-eabi | FileCheck %s --check-prefix=NOBUDGET
+
+; The hot function fits in the budget, the larger hot function does not fit in
+; what is left, and the cold function is not worth placing.
+
+; CHECK:       .section .itcm,"ax",%progbits
+; CHECK:       .type hot,%function
+; CHECK-LABEL: hot:
+; CHECK:       .text
+; CHECK:       .type big,%function
+; CHECK-LABEL: big:
+; CHECK:       .type cold,%function
+; CHECK-LABEL: cold:
+; CHECK:       .section .itcm,"ax",%progbits
+; CHECK:       .type preplaced,%function
+; CHECK-LABEL: preplaced:
+
+; Without a budget only the function placed by the source is in the ITCM.
+; NOBUDGET-NOT:   .itcm
+; NOBUDGET-LABEL: hot:
+; NOBUDGET-NOT:   .itcm
+; NOBUDGET-LABEL: big:
+; NOBUDGET-NOT:   .itcm
+; NOBUDGET-LABEL: cold:
+; NOBUDGET:       .section .itcm,"ax",%progbits
+; NOBUDGET-LABEL: preplaced:
+; NOBUDGET-NOT:   .itcm
+
+; REMARK-DAG: remark: <unknown>:0:0: placed hot in the ITCM: 8 bytes, entry count 1000, 2000 instructions executed from the ITCM
+; REMARK-DAG: remark: <unknown>:0:0: not placing big in the ITCM, as it does not fit in the remaining ITCM budget
+; REMARK-DAG: remark: <unknown>:0:0: not placing cold in the ITCM, as it is not hot
+
+; REPORT:      itcm-section .itcm budget 64 preplaced 8
+; REPORT-NEXT: placed hot size 8 entry-count 1000 gain 2000
+; REPORT-NEXT: skipped big size
+; REPORT-SAME: reason does not fit in the remaining ITCM budget
+; REPORT-NEXT: skipped cold size 8 entry-count 1 gain 2 reason is not hot
+; REPORT-NEXT: itcm-used 16
+
+define i32 @hot(i32 %a, i32 %b) !prof !15 {
+entry:
+  %add = add i32 %a, %b
+  ret i32 %add
+}
+
+define i32 @big(i32 %a, i32 %b) !prof !15 {
+entry:
+  %m0 = mul i32 %a, %b
+  %m1 = mul i32 %m0, %a
+  %m2 = mul i32 %m1, %b
+  %m3 = mul i32 %m2, %a
+  %m4 = mul i32 %m3, %b
+  %m5 = mul i32 %m4, %a
+  %m6 = mul i32 %m5, %b
+  %m7 = mul i32 %m6, %a
+  %m8 = mul i32 %m7, %b
+  %m9 = mul i32 %m8, %a
+  %m10 = mul i32 %m9, %b
+  %m11 = mul i32 %m10, %a
+  %m12 = mul i32 %m11, %b
+  %m13 = mul i32 %m12, %a
+  %m14 = mul i32 %m13, %b
+  ret i32 %m14
+}
+
+define i32 @cold(i32 %a, i32 %b) !prof !16 {
+entry:
+  %sub = sub i32 %a, %b
+  ret i32 %sub
+}
+
+define i32 @preplaced(i32 %a, i32 %b) section ".itcm" !prof !16 {
+entry:
+  %xor = xor i32 %a, %b
+  ret i32 %xor
+}
+
+!llvm.module.flags = !{!1}
+!1 = !{i32 1, !"ProfileSummary", !2}
+!2 = !{!3, !4, !5, !6, !7, !8, !9, !10}
+!3 = !{!"ProfileFormat", !"InstrProf"}
+!4 = !{!"TotalCount", i64 10000}
+!5 = !{!"MaxCount", i64 1000}
+!6 = !{!"MaxInternalCount", i64 1}
+!7 = !{!"MaxFunctionCount", i64 1000}
+!8 = !{!"NumCounts", i64 4}
+!9 = !{!"NumFunctions", i64 4}
+!10 = !{!"DetailedSummary", !11}
+!11 = !{!12, !13, !14}
+!12 = !{i32 10000, i64 1000, i32 1}
+!13 = !{i32 999000, i64 1000, i32 3}
+!14 = !{i32 999999, i64 1, i32 4}
+!15 = !{!"function_entry_count", i64 1000}
+!16 = !{!"function_entry_count", i64 1}
@@ -0,0 +1,43 @@
+; RUN: llc -filetype=asm -o - -mtriple=thumbv7m-none-eabi < %s | FileCheck %s
+; RUN: llc -filetype=asm -o - -mtriple=thumbv7-unknown-linux-gnueabi < %s | FileCheck %s
+; RUN: llc -filetype=obj -o %t -mtriple=thumbv7m-none-eabi < %s
+; RUN: llvm-objdump -d -triple=thumbv7m-none-eabi %t | FileCheck %s --check-prefix=OBJ
+; RUN: llvm-objdump -s -section=xray_instr_map %t | FileCheck %s --check-prefix=MAP
+; RUN: not llc -filetype=asm -o /dev/null -mtriple=thumbv6-unknown-linux-gnueabi < %s 2>&1 \
+; RUN:   | FileCheck %s --check-prefix=THUMB1
+
+define i32 @foo() nounwind noinline uwtable "function-instrument"="xray-always" {
+; CHECK:       .p2align	2
+; CHECK-LABEL: .Lxray_sled_0:
+; CHECK-NEXT:  b	#20
+; CHECK-COUNT-11: nop
+; CHECK-NEXT:  .Ltmp0:
+; CHECK-NEXT:  .set .Lxray_sled_thumb_0, .Lxray_sled_0+1
+  ret i32 0
+; CHECK:       .p2align	2
+; CHECK-LABEL: .Lxray_sled_1:
+; CHECK-NEXT:  b	#20
+; CHECK-COUNT-11: nop
+; CHECK-NEXT:  .Ltmp1:
+; CHECK-NEXT:  .set .Lxray_sled_thumb_1, .Lxray_sled_1+1
+; CHECK-NEXT:  bx	lr
+}
+; The sleds are recorded with the Thumb bit set.
+; CHECK-LABEL: xray_instr_map
+; CHECK-LABEL: .Lxray_sleds_start0:
+; CHECK:       .long	.Lxray_sled_thumb_0
+; CHECK:       .long	.Lxray_sled_thumb_1
+; CHECK-LABEL: .Lxray_sleds_end0:
+
+; The branch over the sled lands right after the last nop, 24 bytes after the
+; start of the sled.
+; OBJ:      foo:
+; OBJ-NEXT: 0a e0 b #20
+; OBJ-NEXT: 00 bf nop
+; OBJ:      18: 00 20 movs r0, #0
+
+; MAP:      Contents of section xray_instr_map:
+; MAP-NEXT: 0000 01000000 00000000 00010000 00000000
+; MAP-NEXT: 0010 1d000000 00000000 01010000 00000000
+
+; THUMB1: An attempt to perform XRay instrumentation for a Thumb1 function
@@ -0,0 +1,181 @@
+; RUN: llc -mtriple=thumbv8.1m.main -mattr=+mve,+lob -disable-arm-loloops=false -enable-arm-maskedldst -stop-after=mve-tail-predication %s -o - | FileCheck %s --check-prefix=IR
+; RUN: llc -mtriple=thumbv8.1m.main -mattr=+mve,+lob -disable-arm-loloops=false -enable-arm-maskedldst -verify-machineinstrs %s -o - | FileCheck %s
+; RUN: llc -mtriple=thumbv8.1m.main -mattr=+mve,+lob -disable-arm-loloops=false -enable-arm-maskedldst -disable-mve-tail-predication -verify-machineinstrs %s -o - | FileCheck %s --check-prefix=DISABLED
+
+; The loops below are what the vectorizer produces when it folds the tail into
+; the vector body: every memory operation is masked by a compare of the lane
+; induction against the backedge-taken count. The mask is replaced by a VCTP of
+; the elements left, which DLSTP/LETP then predicate implicitly.
+
+; IR-LABEL: @mul_v4i32(
+; IR:       vector.ph:
+; IR:         [[ROUND:%[0-9]+]] = add i32 %N, 3
+; IR:         [[ITERS:%[0-9]+]] = lshr i32 [[ROUND]], 2
+; IR:         call void @llvm.set.loop.iterations.i32(i32 [[ITERS]])
+; IR:       vector.body:
+; IR:         [[COUNT:%[0-9]+]] = phi i32 [ [[ITERS]], %vector.ph ]
+; IR:         %elts.rem = phi i32 [ %N, %vector.ph ], [ [[NEXT:%[0-9]+]], %vector.body ]
+; IR:         [[PRED:%[0-9]+]] = call <4 x i1> @llvm.arm.mve.vctp32(i32 %elts.rem)
+; IR:         [[NEXT]] = sub i32 %elts.rem, 4
+; IR-NOT:     icmp ule
+; IR:         call <4 x i32> @llvm.masked.load.v4i32.p0v4i32(<4 x i32>* {{.*}}, i32 4, <4 x i1> [[PRED]], <4 x i32> undef)
+; IR:         call <4 x i32> @llvm.masked.load.v4i32.p0v4i32(<4 x i32>* {{.*}}, i32 4, <4 x i1> [[PRED]], <4 x i32> undef)
+; IR:         call void @llvm.masked.store.v4i32.p0v4i32(<4 x i32> {{.*}}, <4 x i32>* {{.*}}, i32 4, <4 x i1> [[PRED]])
+; IR:         call i32 @llvm.loop.decrement.reg.i32.i32.i32(i32 [[COUNT]], i32 1)
+
+; CHECK-LABEL: mul_v4i32:
+; CHECK:       dlstp.32 lr, r3
+; CHECK-NEXT:  [[LOOP:.LBB[0-9_]+]]:
+; CHECK-NOT:   vctp
+; CHECK-NOT:   vpst
+; CHECK:       vldrw.u32 [[A:q[0-9]+]], [r0]
+; CHECK-NEXT:  vldrw.u32 [[B:q[0-9]+]], [r1]
+; CHECK-NEXT:  vmul.i32 [[MUL:q[0-9]+]], [[B]], [[A]]
+; CHECK-NEXT:  vstrw.32 [[MUL]], [r2]
+; CHECK:       letp lr, [[LOOP]]
+
+; DISABLED-LABEL: mul_v4i32:
+; DISABLED-NOT:   dlstp
+; DISABLED:       dls lr
+; DISABLED:       vcmp.u32 cs
+; DISABLED:       vpst
+; DISABLED-NEXT:  vldrwt.u32
+; DISABLED-NEXT:  vldrwt.u32
+; DISABLED:       vpst
+; DISABLED-NEXT:  vstrwt.32
+; DISABLED:       le lr
+define arm_aapcs_vfpcc void @mul_v4i32(i32* noalias nocapture readonly %a, i32* noalias nocapture readonly %b, i32* noalias nocapture %c, i32 %N) {
+entry:
+  %cmp8 = icmp eq i32 %N, 0
+  br i1 %cmp8, label %for.cond.cleanup, label %vector.ph
+
+vector.ph:
+  %n.rnd.up = add i32 %N, 3
+  %n.vec = and i32 %n.rnd.up, -4
+  %trip.count.minus.1 = add i32 %N, -1
+  %broadcast.splatinsert10 = insertelement <4 x i32> undef, i32 %trip.count.minus.1, i32 0
+  %broadcast.splat11 = shufflevector <4 x i32> %broadcast.splatinsert10, <4 x i32> undef, <4 x i32> zeroinitializer
+  br label %vector.body
+
+vector.body:
+  %index = phi i32 [ 0, %vector.ph ], [ %index.next, %vector.body ]
+  %broadcast.splatinsert = insertelement <4 x i32> undef, i32 %index, i32 0
+  %broadcast.splat = shufflevector <4 x i32> %broadcast.splatinsert, <4 x i32> undef, <4 x i32> zeroinitializer
+  %induction = add <4 x i32> %broadcast.splat, <i32 0, i32 1, i32 2, i32 3>
+  %0 = getelementptr inbounds i32, i32* %a, i32 %index
+  %1 = icmp ule <4 x i32> %induction, %broadcast.splat11
+  %2 = bitcast i32* %0 to <4 x i32>*
+  %wide.masked.load = call <4 x i32> @llvm.masked.load.v4i32.p0v4i32(<4 x i32>* %2, i32 4, <4 x i1> %1, <4 x i32> undef)
+  %3 = getelementptr inbounds i32, i32* %b, i32 %index
+  %4 = bitcast i32* %3 to <4 x i32>*
+  %wide.masked.load12 = call <4 x i32> @llvm.masked.load.v4i32.p0v4i32(<4 x i32>* %4, i32 4, <4 x i1> %1, <4 x i32> undef)
+  %5 = mul nsw <4 x i32> %wide.masked.load12, %wide.masked.load
+  %6 = getelementptr inbounds i32, i32* %c, i32 %index
+  %7 = bitcast i32* %6 to <4 x i32>*
+  call void @llvm.masked.store.v4i32.p0v4i32(<4 x i32> %5, <4 x i32>* %7, i32 4, <4 x i1> %1)
+  %index.next = add i32 %index, 4
+  %8 = icmp eq i32 %index.next, %n.vec
+  br i1 %8, label %for.cond.cleanup, label %vector.body
+
+for.cond.cleanup:
+  ret void
+}
+
+; IR-LABEL: @add_v8i16(
+; IR:         [[ROUND:%[0-9]+]] = add i32 %N, 7
+; IR:         [[ITERS:%[0-9]+]] = lshr i32 [[ROUND]], 3
+; IR:         call void @llvm.set.loop.iterations.i32(i32 [[ITERS]])
+; IR:         [[PRED:%[0-9]+]] = call <8 x i1> @llvm.arm.mve.vctp16(i32 %elts.rem)
+; IR:         sub i32 %elts.rem, 8
+; IR:         call void @llvm.masked.store.v8i16.p0v8i16(<8 x i16> {{.*}}, <8 x i16>* {{.*}}, i32 2, <8 x i1> [[PRED]])
+
+; CHECK-LABEL: add_v8i16:
+; CHECK:       dlstp.16 lr, r3
+; CHECK-NEXT:  [[LOOP:.LBB[0-9_]+]]:
+; CHECK-NOT:   vctp
+; CHECK-NOT:   vpst
+; CHECK:       vldrh.u16
+; CHECK-NEXT:  vldrh.u16
+; CHECK-NEXT:  vadd.i16
+; CHECK-NEXT:  vstrh.16
+; CHECK:       letp lr, [[LOOP]]
+define arm_aapcs_vfpcc void @add_v8i16(i16* noalias nocapture readonly %a, i16* noalias nocapture readonly %b, i16* noalias nocapture %c, i32 %N) {
+entry:
+  %cmp8 = icmp eq i32 %N, 0
+  br i1 %cmp8, label %for.cond.cleanup, label %vector.ph
+
+vector.ph:
+  %n.rnd.up = add i32 %N, 7
+  %n.vec = and i32 %n.rnd.up, -8
+  %trip.count.minus.1 = add i32 %N, -1
+  %broadcast.splatinsert10 = insertelement <8 x i32> undef, i32 %trip.count.minus.1, i32 0
+  %broadcast.splat11 = shufflevector <8 x i32> %broadcast.splatinsert10, <8 x i32> undef, <8 x i32> zeroinitializer
+  br label %vector.body
+
+vector.body:
+  %index = phi i32 [ 0, %vector.ph ], [ %index.next, %vector.body ]
+  %broadcast.splatinsert = insertelement <8 x i32> undef, i32 %index, i32 0
+  %broadcast.splat = shufflevector <8 x i32> %broadcast.splatinsert, <8 x i32> undef, <8 x i32> zeroinitializer
+  %induction = add <8 x i32> %broadcast.splat, <i32 0, i32 1, i32 2, i32 3, i32 4, i32 5, i32 6, i32 7>
+  %0 = getelementptr inbounds i16, i16* %a, i32 %index
+  %1 = icmp ule <8 x i32> %induction, %broadcast.splat11
+  %2 = bitcast i16* %0 to <8 x i16>*
+  %wide.masked.load = call <8 x i16> @llvm.masked.load.v8i16.p0v8i16(<8 x i16>* %2, i32 2, <8 x i1> %1, <8 x i16> undef)
+  %3 = getelementptr inbounds i16, i16* %b, i32 %index
+  %4 = bitcast i16* %3 to <8 x i16>*
+  %wide.masked.load12 = call <8 x i16> @llvm.masked.load.v8i16.p0v8i16(<8 x i16>* %4, i32 2, <8 x i1> %1, <8 x i16> undef)
+  %5 = add <8 x i16> %wide.masked.load12, %wide.masked.load
+  %6 = getelementptr inbounds i16, i16* %c, i32 %index
+  %7 = bitcast i16* %6 to <8 x i16>*
+  call void @llvm.masked.store.v8i16.p0v8i16(<8 x i16> %5, <8 x i16>* %7, i32 2, <8 x i1> %1)
+  %index.next = add i32 %index, 8
+  %8 = icmp eq i32 %index.next, %n.vec
+  br i1 %8, label %for.cond.cleanup, label %vector.body
+
+for.cond.cleanup:
+  ret void
+}
+
+; The store is predicated on the data rather than on the elements left, so
+; there is no tail predicate to imply and the loop stays a plain DLS/LE one.
+
+; IR-LABEL: @data_mask(
+; IR-NOT:     vctp
+; IR:         icmp sgt <4 x i32>
+
+; CHECK-LABEL: data_mask:
+; CHECK-NOT:   dlstp
+; CHECK:       dls lr
+; CHECK:       vpst
+; CHECK-NEXT:  vstrwt.32
+; CHECK:       le lr
+define arm_aapcs_vfpcc void @data_mask(i32* noalias nocapture readonly %a, i32* noalias nocapture %c, i32 %N) {
+entry:
+  %cmp8 = icmp eq i32 %N, 0
+  br i1 %cmp8, label %for.cond.cleanup, label %vector.ph
+
+vector.ph:
+  %n.vec = shl i32 %N, 2
+  br label %vector.body
+
+vector.body:
+  %index = phi i32 [ 0, %vector.ph ], [ %index.next, %vector.body ]
+  %0 = getelementptr inbounds i32, i32* %a, i32 %index
+  %1 = bitcast i32* %0 to <4 x i32>*
+  %wide.load = load <4 x i32>, <4 x i32>* %1, align 4
+  %2 = icmp sgt <4 x i32> %wide.load, zeroinitializer
+  %3 = getelementptr inbounds i32, i32* %c, i32 %index
+  %4 = bitcast i32* %3 to <4 x i32>*
+  call void @llvm.masked.store.v4i32.p0v4i32(<4 x i32> %wide.load, <4 x i32>* %4, i32 4, <4 x i1> %2)
+  %index.next = add i32 %index, 4
+  %5 = icmp eq i32 %index.next, %n.vec
+  br i1 %5, label %for.cond.cleanup, label %vector.body
+
+for.cond.cleanup:
+  ret void
+}
+
+declare <4 x i32> @llvm.masked.load.v4i32.p0v4i32(<4 x i32>*, i32 immarg, <4 x i1>, <4 x i32>)
+declare void @llvm.masked.store.v4i32.p0v4i32(<4 x i32>, <4 x i32>*, i32 immarg, <4 x i1>)
+declare <8 x i16> @llvm.masked.load.v8i16.p0v8i16(<8 x i16>*, i32 immarg, <8 x i1>, <8 x i16>)
+declare void @llvm.masked.store.v8i16.p0v8i16(<8 x i16>, <8 x i16>*, i32 immarg, <8 x i1>)
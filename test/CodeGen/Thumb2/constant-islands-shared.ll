@@ -0,0 +1,59 @@
+; RUN: llc < %s -mtriple=thumbv7em-none-eabi -mattr=+vfp4 \
+; RUN:   -arm-share-constant-islands | FileCheck %s
+; RUN: llc < %s -mtriple=thumbv7em-none-eabi -mattr=+vfp4 \
+; RUN:   | FileCheck %s --check-prefix=NOSHARE
+; RUN: llc < %s -mtriple=thumbv7em-none-eabi -mattr=+vfp4 \
+; RUN:   -arm-share-constant-islands -filetype=obj -o %t.o
+; RUN: llvm-objdump -d -triple=thumbv7em-none-eabi -mattr=+vfp4 %t.o \
+; RUN:   | FileCheck %s --check-prefix=OBJ
+
+; Minsize functions load 32-bit constants from the constant pool instead of
+; using MOVW/MOVT.
+
+; CHECK-LABEL: base:
+; CHECK-DAG:     ldr r0, [[INT:.LCPI0_[0-9]]]
+; CHECK-DAG:     vldr {{s[0-9]+}}, [[FP:.LCPI0_[0-9]]]
+; CHECK-DAG:   [[INT]]:
+; CHECK-DAG:   [[FP]]:
+define i32 @base(float* %p) minsize {
+  %v = load volatile float, float* %p
+  %a = fadd float %v, 0x3FF19999A0000000
+  store volatile float %a, float* %p
+  ret i32 1073876992
+}
+
+; The previous function's island has both constants, so there is no island.
+; CHECK-LABEL: same:
+; CHECK-DAG:     ldr.w r0, [[INT]]
+; CHECK-DAG:     vldr {{s[0-9]+}}, [[FP]]
+; CHECK-NOT:   .LCPI1_
+; CHECK-LABEL: .Lfunc_end1:
+define i32 @same(float* %p) minsize {
+  %v = load volatile float, float* %p
+  %a = fadd float %v, 0x3FF19999A0000000
+  store volatile float %a, float* %p
+  ret i32 1073876992
+}
+
+; The previous function has no island to share, so this one keeps its own.
+; CHECK-LABEL: again:
+; CHECK:         ldr r0, .LCPI2_0
+; CHECK:       .LCPI2_0:
+define i32 @again() minsize {
+  ret i32 1073876992
+}
+
+; A function in another section is not next to the island.
+; CHECK-LABEL: other_section:
+; CHECK:         ldr r0, .LCPI3_0
+; CHECK:       .LCPI3_0:
+define i32 @other_section() minsize section ".text.other" {
+  ret i32 1073876992
+}
+
+; NOSHARE-LABEL: same:
+; NOSHARE:         ldr r0, .LCPI1_{{[0-9]}}
+; NOSHARE:       .LCPI1_{{[0-9]}}:
+
+; OBJ-LABEL: same:
+; OBJ:         ldr.w r0, [pc, #-{{[0-9]+}}]
@@ -0,0 +1,81 @@
+; NOTE: Assertions have been autogenerated by utils/update_llc_test_checks.py
+; RUN: llc -mtriple=thumbv8.1m.main-arm-none-eabi -mattr=+mve.fp -enable-arm-maskedldst -verify-machineinstrs %s -o - | FileCheck %s
+
+define arm_aapcs_vfpcc <4 x i32> @ld_vctp(<4 x i32>* %p, i32 %n) {
+; CHECK-LABEL: ld_vctp:
+; CHECK:       @ %bb.0: @ %entry
+; CHECK-NEXT:    vctp.32 r1
+; CHECK-NEXT:    vpst
+; CHECK-NEXT:    vldrwt.u32 q0, [r0]
+; CHECK-NEXT:    bx lr
+entry:
+  %m = call <4 x i1> @llvm.arm.mve.vctp32(i32 %n)
+  %l = call <4 x i32> @llvm.masked.load.v4i32.p0v4i32(<4 x i32>* %p, i32 4, <4 x i1> %m, <4 x i32> undef)
+  ret <4 x i32> %l
+}
+
+define arm_aapcs_vfpcc <4 x i32> @ld_cmp(<4 x i32>* %p, <4 x i32> %a, <4 x i32> %b) {
+; CHECK-LABEL: ld_cmp:
+; CHECK:       @ %bb.0: @ %entry
+; CHECK-NEXT:    .pad #4
+; CHECK-NEXT:    sub sp, #4
+; CHECK-NEXT:    vcmp.s32 lt, q0, q1
+; CHECK-NEXT:    vmov.i32 q2, #0x0
+; CHECK-NEXT:    vmvn.i32 q3, #0x0
+; CHECK-NEXT:    vstr p0, [sp] @ 4-byte Spill
+; CHECK-NEXT:    vpsel q1, q3, q2
+; CHECK-NEXT:    vcmp.i32 ne, q1, zr
+; CHECK-NEXT:    vpst
+; CHECK-NEXT:    vldrwt.u32 q1, [r0]
+; CHECK-NEXT:    vldr p0, [sp] @ 4-byte Reload
+; CHECK-NEXT:    vpsel q0, q1, q0
+; CHECK-NEXT:    add sp, #4
+; CHECK-NEXT:    bx lr
+entry:
+  %m = icmp slt <4 x i32> %a, %b
+  %l = call <4 x i32> @llvm.masked.load.v4i32.p0v4i32(<4 x i32>* %p, i32 4, <4 x i1> %m, <4 x i32> %a)
+  ret <4 x i32> %l
+}
+
+define arm_aapcs_vfpcc void @st_vctp(<8 x i16>* %p, <8 x i16> %v, i32 %n) {
+; CHECK-LABEL: st_vctp:
+; CHECK:       @ %bb.0: @ %entry
+; CHECK-NEXT:    vctp.16 r1
+; CHECK-NEXT:    vpst
+; CHECK-NEXT:    vstrbt.8 q0, [r0]
+; CHECK-NEXT:    bx lr
+entry:
+  %m = call <8 x i1> @llvm.arm.mve.vctp16(i32 %n)
+  call void @llvm.masked.store.v8i16.p0v8i16(<8 x i16> %v, <8 x i16>* %p, i32 1, <8 x i1> %m)
+  ret void
+}
+
+define arm_aapcs_vfpcc <16 x i8> @sel(<16 x i8> %a, <16 x i8> %b) {
+; CHECK-LABEL: sel:
+; CHECK:       @ %bb.0: @ %entry
+; CHECK-NEXT:    vmax.u8 q0, q0, q1
+; CHECK-NEXT:    bx lr
+entry:
+  %m = icmp ugt <16 x i8> %a, %b
+  %s = select <16 x i1> %m, <16 x i8> %a, <16 x i8> %b
+  ret <16 x i8> %s
+}
+
+define arm_aapcs_vfpcc <4 x float> @ldf(<4 x float>* %p, i32 %n) {
+; CHECK-LABEL: ldf:
+; CHECK:       @ %bb.0: @ %entry
+; CHECK-NEXT:    vctp.32 r1
+; CHECK-NEXT:    vpst
+; CHECK-NEXT:    vldrwt.u32 q0, [r0]
+; CHECK-NEXT:    bx lr
+entry:
+  %m = call <4 x i1> @llvm.arm.mve.vctp32(i32 %n)
+  %l = call <4 x float> @llvm.masked.load.v4f32.p0v4f32(<4 x float>* %p, i32 4, <4 x i1> %m, <4 x float> zeroinitializer)
+  ret <4 x float> %l
+}
+
+declare <4 x i1> @llvm.arm.mve.vctp32(i32)
+declare <8 x i1> @llvm.arm.mve.vctp16(i32)
+declare <4 x i32> @llvm.masked.load.v4i32.p0v4i32(<4 x i32>*, i32, <4 x i1>, <4 x i32>)
+declare <4 x float> @llvm.masked.load.v4f32.p0v4f32(<4 x float>*, i32, <4 x i1>, <4 x float>)
+declare void @llvm.masked.store.v8i16.p0v8i16(<8 x i16>, <8 x i16>*, i32, <8 x i1>)
@@ -0,0 +1,93 @@
+; RUN: llc -mtriple=thumbv8.1m.main-arm-none-eabi -mattr=+mve -verify-machineinstrs %s -o - | FileCheck %s
+
+declare i32 @llvm.experimental.vector.reduce.add.v4i32(<4 x i32>)
+declare i16 @llvm.experimental.vector.reduce.add.v8i16(<8 x i16>)
+declare i8 @llvm.experimental.vector.reduce.add.v16i8(<16 x i8>)
+declare i32 @llvm.experimental.vector.reduce.add.v8i32(<8 x i32>)
+
+define arm_aapcs_vfpcc i32 @vaddv_v4i32(<4 x i32> %s1) {
+; CHECK-LABEL: vaddv_v4i32:
+; CHECK:       @ %bb.0: @ %entry
+; CHECK-NEXT:    vaddv.u32 r0, q0
+; CHECK-NEXT:    bx lr
+entry:
+  %r = call i32 @llvm.experimental.vector.reduce.add.v4i32(<4 x i32> %s1)
+  ret i32 %r
+}
+
+define arm_aapcs_vfpcc i16 @vaddv_v8i16(<8 x i16> %s1) {
+; CHECK-LABEL: vaddv_v8i16:
+; CHECK:       @ %bb.0: @ %entry
+; CHECK-NEXT:    vaddv.u16 r0, q0
+; CHECK-NEXT:    bx lr
+entry:
+  %r = call i16 @llvm.experimental.vector.reduce.add.v8i16(<8 x i16> %s1)
+  ret i16 %r
+}
+
+define arm_aapcs_vfpcc i8 @vaddv_v16i8(<16 x i8> %s1) {
+; CHECK-LABEL: vaddv_v16i8:
+; CHECK:       @ %bb.0: @ %entry
+; CHECK-NEXT:    vaddv.u8 r0, q0
+; CHECK-NEXT:    bx lr
+entry:
+  %r = call i8 @llvm.experimental.vector.reduce.add.v16i8(<16 x i8> %s1)
+  ret i8 %r
+}
+
+; Wider vectors are added together first.
+define arm_aapcs_vfpcc i32 @vaddv_v8i32(<8 x i32> %s1) {
+; CHECK-LABEL: vaddv_v8i32:
+; CHECK:       @ %bb.0: @ %entry
+; CHECK-NEXT:    vadd.i32 [[Q:q[0-9]+]], q0, q1
+; CHECK-NEXT:    vaddv.u32 r0, [[Q]]
+; CHECK-NEXT:    bx lr
+entry:
+  %r = call i32 @llvm.experimental.vector.reduce.add.v8i32(<8 x i32> %s1)
+  ret i32 %r
+}
+
+define arm_aapcs_vfpcc i32 @vaddva_v4i32(<4 x i32> %s1, i32 %x) {
+; CHECK-LABEL: vaddva_v4i32:
+; CHECK:       @ %bb.0: @ %entry
+; CHECK-NEXT:    vaddva.u32 r0, q0
+; CHECK-NEXT:    bx lr
+entry:
+  %t = call i32 @llvm.experimental.vector.reduce.add.v4i32(<4 x i32> %s1)
+  %r = add i32 %t, %x
+  ret i32 %r
+}
+
+define arm_aapcs_vfpcc i32 @vmladav_v4i32(<4 x i32> %s1, <4 x i32> %s2) {
+; CHECK-LABEL: vmladav_v4i32:
+; CHECK:       @ %bb.0: @ %entry
+; CHECK-NEXT:    vmlav.u32 r0, q0, q1
+; CHECK-NEXT:    bx lr
+entry:
+  %m = mul <4 x i32> %s1, %s2
+  %r = call i32 @llvm.experimental.vector.reduce.add.v4i32(<4 x i32> %m)
+  ret i32 %r
+}
+
+define arm_aapcs_vfpcc i16 @vmladav_v8i16(<8 x i16> %s1, <8 x i16> %s2) {
+; CHECK-LABEL: vmladav_v8i16:
+; CHECK:       @ %bb.0: @ %entry
+; CHECK-NEXT:    vmlav.u16 r0, q0, q1
+; CHECK-NEXT:    bx lr
+entry:
+  %m = mul <8 x i16> %s1, %s2
+  %r = call i16 @llvm.experimental.vector.reduce.add.v8i16(<8 x i16> %m)
+  ret i16 %r
+}
+
+define arm_aapcs_vfpcc i32 @vmladava_v4i32(<4 x i32> %s1, <4 x i32> %s2, i32 %x) {
+; CHECK-LABEL: vmladava_v4i32:
+; CHECK:       @ %bb.0: @ %entry
+; CHECK-NEXT:    vmlava.u32 r0, q0, q1
+; CHECK-NEXT:    bx lr
+entry:
+  %m = mul <4 x i32> %s1, %s2
+  %t = call i32 @llvm.experimental.vector.reduce.add.v4i32(<4 x i32> %m)
+  %r = add i32 %t, %x
+  ret i32 %r
+}
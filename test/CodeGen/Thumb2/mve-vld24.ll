@@ -0,0 +1,65 @@
+; RUN: llc -mtriple=thumbv8.1m.main-arm-none-eabi -mattr=+mve -verify-machineinstrs %s -o - | FileCheck %s
+
+declare { <4 x i32>, <4 x i32> } @llvm.arm.mve.vld2q.v4i32.p0i32(i32*)
+declare { <8 x i16>, <8 x i16>, <8 x i16>, <8 x i16> } @llvm.arm.mve.vld4q.v8i16.p0i16(i16*)
+declare void @llvm.arm.mve.vst2q.p0i32.v4i32(i32*, <4 x i32>, <4 x i32>, i32)
+declare void @llvm.arm.mve.vst4q.p0i8.v16i8(i8*, <16 x i8>, <16 x i8>, <16 x i8>, <16 x i8>, i32)
+
+define arm_aapcs_vfpcc <4 x i32> @vld2_v4i32(i32* %src) {
+; CHECK-LABEL: vld2_v4i32:
+; CHECK:         vld20.32 {[[Q0:q[0-9]+]], [[Q1:q[0-9]+]]}, [r0]
+; CHECK-NEXT:    vld21.32 {[[Q0]], [[Q1]]}, [r0]
+; CHECK-NEXT:    vadd.i32 q0, [[Q0]], [[Q1]]
+; CHECK-NEXT:    bx lr
+entry:
+  %v = call { <4 x i32>, <4 x i32> } @llvm.arm.mve.vld2q.v4i32.p0i32(i32* %src)
+  %v0 = extractvalue { <4 x i32>, <4 x i32> } %v, 0
+  %v1 = extractvalue { <4 x i32>, <4 x i32> } %v, 1
+  %r = add <4 x i32> %v0, %v1
+  ret <4 x i32> %r
+}
+
+define arm_aapcs_vfpcc <8 x i16> @vld4_v8i16(i16* %src) {
+; CHECK-LABEL: vld4_v8i16:
+; CHECK:         vld40.16 {[[Q0:q[0-9]+]], [[Q1:q[0-9]+]], [[Q2:q[0-9]+]], [[Q3:q[0-9]+]]}, [r0]
+; CHECK-NEXT:    vld41.16 {[[Q0]], [[Q1]], [[Q2]], [[Q3]]}, [r0]
+; CHECK-NEXT:    vld42.16 {[[Q0]], [[Q1]], [[Q2]], [[Q3]]}, [r0]
+; CHECK-NEXT:    vld43.16 {[[Q0]], [[Q1]], [[Q2]], [[Q3]]}, [r0]
+; CHECK:         bx lr
+entry:
+  %v = call { <8 x i16>, <8 x i16>, <8 x i16>, <8 x i16> } @llvm.arm.mve.vld4q.v8i16.p0i16(i16* %src)
+  %v0 = extractvalue { <8 x i16>, <8 x i16>, <8 x i16>, <8 x i16> } %v, 0
+  %v1 = extractvalue { <8 x i16>, <8 x i16>, <8 x i16>, <8 x i16> } %v, 1
+  %v2 = extractvalue { <8 x i16>, <8 x i16>, <8 x i16>, <8 x i16> } %v, 2
+  %v3 = extractvalue { <8 x i16>, <8 x i16>, <8 x i16>, <8 x i16> } %v, 3
+  %a0 = add <8 x i16> %v0, %v1
+  %a1 = add <8 x i16> %v2, %v3
+  %r = add <8 x i16> %a0, %a1
+  ret <8 x i16> %r
+}
+
+define arm_aapcs_vfpcc void @vst2_v4i32(i32* %dst, <4 x i32> %v0, <4 x i32> %v1) {
+; CHECK-LABEL: vst2_v4i32:
+; CHECK:         vst20.32 {q0, q1}, [r0]
+; CHECK-NEXT:    vst21.32 {q0, q1}, [r0]
+; CHECK-NEXT:    bx lr
+entry:
+  call void @llvm.arm.mve.vst2q.p0i32.v4i32(i32* %dst, <4 x i32> %v0, <4 x i32> %v1, i32 0)
+  call void @llvm.arm.mve.vst2q.p0i32.v4i32(i32* %dst, <4 x i32> %v0, <4 x i32> %v1, i32 1)
+  ret void
+}
+
+define arm_aapcs_vfpcc void @vst4_v16i8(i8* %dst, <16 x i8> %v0, <16 x i8> %v1, <16 x i8> %v2, <16 x i8> %v3) {
+; CHECK-LABEL: vst4_v16i8:
+; CHECK:         vst40.8 {q0, q1, q2, q3}, [r0]
+; CHECK-NEXT:    vst41.8 {q0, q1, q2, q3}, [r0]
+; CHECK-NEXT:    vst42.8 {q0, q1, q2, q3}, [r0]
+; CHECK-NEXT:    vst43.8 {q0, q1, q2, q3}, [r0]
+; CHECK-NEXT:    bx lr
+entry:
+  call void @llvm.arm.mve.vst4q.p0i8.v16i8(i8* %dst, <16 x i8> %v0, <16 x i8> %v1, <16 x i8> %v2, <16 x i8> %v3, i32 0)
+  call void @llvm.arm.mve.vst4q.p0i8.v16i8(i8* %dst, <16 x i8> %v0, <16 x i8> %v1, <16 x i8> %v2, <16 x i8> %v3, i32 1)
+  call void @llvm.arm.mve.vst4q.p0i8.v16i8(i8* %dst, <16 x i8> %v0, <16 x i8> %v1, <16 x i8> %v2, <16 x i8> %v3, i32 2)
+  call void @llvm.arm.mve.vst4q.p0i8.v16i8(i8* %dst, <16 x i8> %v0, <16 x i8> %v1, <16 x i8> %v2, <16 x i8> %v3, i32 3)
+  ret void
+}
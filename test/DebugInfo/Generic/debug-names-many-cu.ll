@@ -2,6 +2,7 @@
 ; RUN: %llc_dwarf -accel-tables=Dwarf -filetype=obj -o %t < %s
 ; RUN: llvm-dwarfdump -debug-names %t | FileCheck %s
 ; RUN: llvm-dwarfdump -debug-names -verify %t | FileCheck --check-prefix=VERIFY %s
+; RUN: llvm-dwarfdump -verify -verify-threads=4 %t | FileCheck --check-prefix=VERIFY %s
 
 
 ; Check the header
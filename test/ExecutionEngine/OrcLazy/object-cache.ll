@@ -0,0 +1,50 @@
+; REQUIRES: asserts
+; RUN: rm -rf %t && mkdir -p %t
+;
+; The first run compiles every function and fills the cache.
+; RUN: lli -jit-kind=orc-lazy -enable-cache-manager -object-cache-dir=%t/cache \
+; RUN:   -debug-only=orc %s 2>&1 | FileCheck --check-prefix=COLD %s
+; RUN: ls %t/cache | FileCheck --check-prefix=ENTRIES %s
+;
+; The second run loads every object from the cache.
+; RUN: lli -jit-kind=orc-lazy -enable-cache-manager -object-cache-dir=%t/cache \
+; RUN:   -debug-only=orc %s 2>&1 | FileCheck --check-prefix=WARM %s
+;
+; Pruning keeps the most recently used entry only.
+; RUN: lli -jit-kind=orc-lazy -enable-cache-manager -object-cache-dir=%t/cache \
+; RUN:   -object-cache-pruning-policy=prune_interval=0s:cache_size_files=1 %s
+; RUN: ls %t/cache | FileCheck --check-prefix=PRUNED %s
+;
+; RUN: not lli -jit-kind=orc-lazy -enable-cache-manager %s 2>&1 \
+; RUN:   | FileCheck --check-prefix=NODIR %s
+;
+; COLD-NOT: Using cached object
+; COLD:     Cached object for
+; COLD-NOT: Using cached object
+; COLD:     Cached object for
+; COLD-NOT: Using cached object
+;
+; ENTRIES: llvmcache-{{[0-9a-f]+$}}
+; ENTRIES: llvmcache-{{[0-9a-f]+$}}
+;
+; WARM-NOT: No cached object
+; WARM:     Using cached object
+; WARM-NOT: No cached object
+; WARM:     Using cached object
+; WARM-NOT: No cached object
+;
+; PRUNED:     llvmcache-
+; PRUNED-NOT: llvmcache-
+;
+; NODIR: -enable-cache-manager requires -object-cache-dir with -jit-kind=orc-lazy
+
+define i32 @foo() {
+entry:
+  ret i32 0
+}
+
+define i32 @main(i32 %argc, i8** nocapture readnone %argv) {
+entry:
+  %r = call i32 @foo()
+  ret i32 %r
+}
@@ -0,0 +1,22 @@
+; REQUIRES: thread_support, asserts
+; RUN: lli -jit-kind=orc-lazy -compile-threads=2 -speculative-compiles=4 \
+; RUN:   -stats %s 2>&1 | FileCheck %s
+; RUN: lli -jit-kind=orc-lazy -compile-threads=2 -stats %s 2>&1 \
+; RUN:   | FileCheck --check-prefix=NOSPEC %s
+;
+; Check that emitting @main looks up its callee @foo speculatively, and that
+; nothing is speculated without -speculative-compiles.
+;
+; CHECK: {{[1-9][0-9]*}} orc - Number of speculative lookups issued
+; NOSPEC-NOT: speculative lookups
+
+define i32 @foo() {
+entry:
+  ret i32 0
+}
+
+define i32 @main(i32 %argc, i8** nocapture readnone %argv) {
+entry:
+  %r = call i32 @foo()
+  ret i32 %r
+}
@@ -0,0 +1,34 @@
+; REQUIRES: thread_support
+; RUN: lli -jit-kind=orc-lazy -compile-threads=2 -speculative-compiles=4 \
+; RUN:   -print-compile-stats %s 2>&1 | FileCheck %s
+; RUN: not lli -jit-kind=orc-lazy -speculative-compiles=4 %s 2>&1 \
+; RUN:   | FileCheck --check-prefix=NOTHREADS %s
+;
+; Check that speculatively compiling the callees of each compiled function
+; does not change the behavior of the program.
+;
+; CHECK: Compiled {{[0-9]+}} modules in {{[0-9.]+}} ms (max {{[0-9.]+}} ms)
+; NOTHREADS: Speculative compilation requires compile threads
+
+define i32 @baz() {
+entry:
+  ret i32 0
+}
+
+define i32 @bar() {
+entry:
+  %r = call i32 @baz()
+  ret i32 %r
+}
+
+define i32 @foo() {
+entry:
+  %r = call i32 @bar()
+  ret i32 %r
+}
+
+define i32 @main(i32 %argc, i8** nocapture readnone %argv) {
+entry:
+  %r = call i32 @foo()
+  ret i32 %r
+}
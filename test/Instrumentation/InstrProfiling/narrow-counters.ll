@@ -0,0 +1,42 @@
+; RUN: opt < %s -S -instrprof -instrprof-counter-width=16 | FileCheck %s
+; RUN: opt < %s -S -instrprof -instrprof-counter-width=8 | FileCheck %s --check-prefix=WIDTH8
+; RUN: opt < %s -S -mtriple=thumbv7-windows-msvc -instrprof -instrprof-counter-width=16 | FileCheck %s --check-prefix=COFF
+
+target triple = "thumbv7m-none-eabi"
+
+@__profn_foo = hidden constant [3 x i8] c"foo"
+@__profn_bar = hidden constant [3 x i8] c"bar"
+
+; The counter array is padded to a multiple of 8 bytes, and the width is
+; recorded in bits 58-59 of the raw profile version. The version is in a COMDAT
+; group named after the width, so that units with different widths do not link.
+; CHECK: @__profc_foo = hidden global [4 x i16] zeroinitializer, section "__llvm_prf_cnts", align 8
+; CHECK: @__llvm_profile_raw_version = constant i64 576460752303423492, comdat($__llvm_profile_raw_version_w16)
+; WIDTH8: @__profc_foo = hidden global [8 x i8] zeroinitializer, section "__llvm_prf_cnts", align 8
+; WIDTH8: @__llvm_profile_raw_version = constant i64 864691128455135236, comdat($__llvm_profile_raw_version_w8)
+; COFF has no COMDAT groups without a leader of the same name.
+; COFF-NOT: $__llvm_profile_raw_version_w16 = comdat
+; COFF: @__llvm_profile_raw_version = weak constant i64 576460752303423492{{$}}
+
+; CHECK-LABEL: define void @foo
+; CHECK-NEXT: %pgocount = load i16, i16* getelementptr inbounds ([4 x i16], [4 x i16]* @__profc_foo, i64 0, i64 2)
+; CHECK-NEXT: [[SAT:%.*]] = call i16 @llvm.uadd.sat.i16(i16 %pgocount, i16 1)
+; CHECK-NEXT: store i16 [[SAT]], i16* getelementptr inbounds ([4 x i16], [4 x i16]* @__profc_foo, i64 0, i64 2)
+define void @foo() {
+  call void @llvm.instrprof.increment(i8* getelementptr inbounds ([3 x i8], [3 x i8]* @__profn_foo, i32 0, i32 0), i64 0, i32 3, i32 2)
+  ret void
+}
+
+; The step of a narrow counter is clamped to the counter's maximum value.
+; CHECK-LABEL: define void @bar
+; CHECK: [[CMP:%.*]] = icmp ugt i64 %step, 65535
+; CHECK-NEXT: [[CLAMP:%.*]] = select i1 [[CMP]], i64 65535, i64 %step
+; CHECK-NEXT: [[STEP:%.*]] = trunc i64 [[CLAMP]] to i16
+; CHECK: call i16 @llvm.uadd.sat.i16(i16 %pgocount, i16 [[STEP]])
+define void @bar(i64 %step) {
+  call void @llvm.instrprof.increment.step(i8* getelementptr inbounds ([3 x i8], [3 x i8]* @__profn_bar, i32 0, i32 0), i64 0, i32 1, i32 0, i64 %step)
+  ret void
+}
+
+declare void @llvm.instrprof.increment(i8*, i64, i32, i32)
+declare void @llvm.instrprof.increment.step(i8*, i64, i32, i32, i64)
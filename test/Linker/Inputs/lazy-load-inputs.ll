@@ -0,0 +1,18 @@
+define i32 @used(i32 %x) !dbg !4 {
+  %r = add i32 %x, 1
+  ret i32 %r
+}
+
+define i32 @unused(i32 %x) {
+  ret i32 %x
+}
+
+!llvm.dbg.cu = !{!0}
+!llvm.module.flags = !{!3}
+
+!0 = distinct !DICompileUnit(language: DW_LANG_C99, file: !1, producer: "clang", isOptimized: true, runtimeVersion: 0, emissionKind: FullDebug, enums: !2)
+!1 = !DIFile(filename: "b.c", directory: "/")
+!2 = !{}
+!3 = !{i32 2, !"Debug Info Version", i32 3}
+!4 = distinct !DISubprogram(name: "used", scope: !1, file: !1, line: 1, type: !5, scopeLine: 1, unit: !0, retainedNodes: !2)
+!5 = !DISubroutineType(types: !2)
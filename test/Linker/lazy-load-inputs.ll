@@ -0,0 +1,32 @@
+; RUN: llvm-as %s -o %t.1.bc
+; RUN: llvm-as %p/Inputs/lazy-load-inputs.ll -o %t.2.bc
+
+; Loading the inputs lazily must not change what gets linked.
+; RUN: llvm-link %t.1.bc %t.2.bc -disable-lazy-loading -o %t.eager.bc
+; RUN: llvm-link %t.1.bc %t.2.bc -o %t.lazy.bc
+; RUN: cmp %t.eager.bc %t.lazy.bc
+; RUN: llvm-link %t.1.bc %t.2.bc -only-needed -disable-lazy-loading -o %t.eager-needed.bc
+; RUN: llvm-link %t.1.bc %t.2.bc -only-needed -o %t.lazy-needed.bc
+; RUN: cmp %t.eager-needed.bc %t.lazy-needed.bc
+; RUN: llvm-dis %t.lazy-needed.bc -o - | FileCheck %s
+
+; Textual inputs are parsed from a null terminated copy.
+; RUN: llvm-link %s %p/Inputs/lazy-load-inputs.ll -only-needed -S -o - \
+; RUN:   | FileCheck %s
+
+; RUN: llvm-link %t.1.bc %t.2.bc -print-resource-usage \
+; RUN:   -o /dev/null 2>&1 | FileCheck --check-prefix=USAGE %s
+
+; CHECK: define i32 @main
+; CHECK: define i32 @used
+; CHECK-NOT: @unused
+
+; USAGE: Wall time: {{[0-9]+\.[0-9]+}} s
+; USAGE: Peak RSS: {{[1-9][0-9]*}} KiB
+
+declare i32 @used(i32)
+
+define i32 @main() {
+  %r = call i32 @used(i32 1)
+  ret i32 %r
+}
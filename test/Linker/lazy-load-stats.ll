@@ -0,0 +1,20 @@
+; REQUIRES: asserts
+; RUN: llvm-as %s -o %t.1.bc
+; RUN: llvm-as %p/Inputs/lazy-load-inputs.ll -o %t.2.bc
+
+; With -only-needed, only the bodies of @main and @used are read. Reading the
+; inputs completely also reads the body of @unused.
+; RUN: llvm-link %t.1.bc %t.2.bc -only-needed -stats -o /dev/null 2>&1 \
+; RUN:   | FileCheck --check-prefix=LAZY %s
+; RUN: llvm-link %t.1.bc %t.2.bc -only-needed -disable-lazy-loading -stats \
+; RUN:   -o /dev/null 2>&1 | FileCheck --check-prefix=EAGER %s
+
+; LAZY: 2 bitcode-reader - Number of function bodies materialized
+; EAGER: 3 bitcode-reader - Number of function bodies materialized
+
+declare i32 @used(i32)
+
+define i32 @main() {
+  %r = call i32 @used(i32 1)
+  ret i32 %r
+}
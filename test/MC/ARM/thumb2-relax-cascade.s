@@ -0,0 +1,28 @@
+@ RUN: llvm-mc -triple thumbv7m-none-eabi -filetype=obj -o %t %s
+@ RUN: llvm-objdump -d -triple thumbv7m-none-eabi %t | FileCheck %s
+
+@ Relaxing the conditional branch pushes the target of the unconditional one
+@ out of range, which only becomes visible on the next relaxation pass. The
+@ backward loop branch moves together with its target and stays narrow.
+
+        .syntax unified
+        .text
+        .thumb
+        .global func
+        .type func, %function
+func:
+        b L1
+        beq L2
+        .space 300
+L2:
+        .space 1746
+L1:
+        nop
+1:
+        subs r0, #1
+        bne 1b
+        bx lr
+
+@ CHECK: b.w #2050
+@ CHECK: beq.w #300
+@ CHECK: bne #-6
@@ -0,0 +1,35 @@
+@ REQUIRES: asserts
+@ RUN: llvm-mc -triple thumbv7m-none-eabi -filetype=obj -stats -o %t %s 2>&1 \
+@ RUN:   | FileCheck --check-prefix=STATS %s
+@ RUN: llvm-objdump -d -triple thumbv7m-none-eabi %t | FileCheck %s
+
+@ Once a section whose branches only target labels in the same section stops
+@ relaxing, later layout passes caused by other sections leave it alone.
+
+        .syntax unified
+        .thumb
+
+        .section .text.a,"ax",%progbits
+a:
+        beq 1f
+        .space 300
+1:
+        bx lr
+
+        .section .text.b,"ax",%progbits
+b:
+        bne 1f
+        .space 8
+1:
+        bx lr
+
+@ Every section settles on the first layout pass, which relaxes the branch in
+@ .text.a, so the second pass skips all three, including the empty .text.
+@ STATS: 2 assembler - Number of assembler layout and relaxation steps
+@ STATS: 4 assembler - Number of section layout passes{{$}}
+@ STATS: 3 assembler - Number of section layout passes skipped for settled sections
+
+@ CHECK-LABEL: Disassembly of section .text.a:
+@ CHECK: beq.w #300
+@ CHECK-LABEL: Disassembly of section .text.b:
+@ CHECK: bne #6
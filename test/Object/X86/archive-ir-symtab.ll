@@ -0,0 +1,42 @@
+; Check that the archive map of bitcode members, which is read from their
+; irsymtab, lists the same symbols as the symbol table of each member, in
+; member order.
+; RUN: llvm-as %s -o %t1.o
+; RUN: cp %t1.o %t2.o
+; RUN: rm -f %t.a
+; RUN: llvm-ar rcs %t.a %t1.o %t2.o
+; RUN: llvm-nm -M %t.a | FileCheck %s
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+module asm ".global global_asm_sym"
+module asm "global_asm_sym:"
+
+@common = common global i32 0
+@weak = weak global i32 0
+@internal = internal global i32 0
+@undef = external global i32
+
+define hidden void @hidden() {
+  ret void
+}
+
+define void @fn() {
+  %v = load i32, i32* @internal
+  store i32 %v, i32* @undef
+  ret void
+}
+
+; CHECK:      Archive map
+; CHECK-NEXT: hidden in {{.*}}1.o
+; CHECK-NEXT: fn in {{.*}}1.o
+; CHECK-NEXT: common in {{.*}}1.o
+; CHECK-NEXT: weak in {{.*}}1.o
+; CHECK-NEXT: global_asm_sym in {{.*}}1.o
+; CHECK-NEXT: hidden in {{.*}}2.o
+; CHECK-NEXT: fn in {{.*}}2.o
+; CHECK-NEXT: common in {{.*}}2.o
+; CHECK-NEXT: weak in {{.*}}2.o
+; CHECK-NEXT: global_asm_sym in {{.*}}2.o
+; CHECK-EMPTY:
@@ -0,0 +1,68 @@
+; RUN: opt -loop-vectorize -force-vector-width=4 -debug-only=loop-vectorize -disable-output < %s 2>&1 | FileCheck %s
+; REQUIRES: asserts
+
+target datalayout = "e-m:e-p:32:32-Fi8-i64:64-v128:64:128-a:0:32-n32-S64"
+target triple = "thumbv8.1m.main-none-eabi"
+
+; MVE has VLD2/VST2 and VLD4/VST4, one instruction per vector, but no
+; VLD3/VST3.
+
+%i32.2 = type {i32, i32}
+define void @i32_factor_2(%i32.2* %data, i32 %n) #0 {
+entry:
+  br label %for.body
+
+; CHECK-LABEL: Checking a loop in "i32_factor_2"
+; CHECK:         Found an estimated cost of 2 for VF 4 For instruction: %tmp2 = load i32, i32* %tmp0, align 4
+; CHECK-NEXT:    Found an estimated cost of 0 for VF 4 For instruction: %tmp3 = load i32, i32* %tmp1, align 4
+; CHECK-NEXT:    Found an estimated cost of 0 for VF 4 For instruction: store i32 0, i32* %tmp0, align 4
+; CHECK-NEXT:    Found an estimated cost of 2 for VF 4 For instruction: store i32 0, i32* %tmp1, align 4
+for.body:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %for.body ]
+  %tmp0 = getelementptr inbounds %i32.2, %i32.2* %data, i32 %i, i32 0
+  %tmp1 = getelementptr inbounds %i32.2, %i32.2* %data, i32 %i, i32 1
+  %tmp2 = load i32, i32* %tmp0, align 4
+  %tmp3 = load i32, i32* %tmp1, align 4
+  store i32 0, i32* %tmp0, align 4
+  store i32 0, i32* %tmp1, align 4
+  %i.next = add nuw nsw i32 %i, 1
+  %cond = icmp slt i32 %i.next, %n
+  br i1 %cond, label %for.body, label %for.end
+
+for.end:
+  ret void
+}
+
+%i32.4 = type {i32, i32, i32, i32}
+define void @i32_factor_4(%i32.4* %data, i32 %n) #0 {
+entry:
+  br label %for.body
+
+; CHECK-LABEL: Checking a loop in "i32_factor_4"
+; CHECK:         Found an estimated cost of 4 for VF 4 For instruction: %tmp4 = load i32, i32* %tmp0, align 4
+; CHECK-NEXT:    Found an estimated cost of 0 for VF 4 For instruction: %tmp5 = load i32, i32* %tmp1, align 4
+; CHECK-NEXT:    Found an estimated cost of 0 for VF 4 For instruction: %tmp6 = load i32, i32* %tmp2, align 4
+; CHECK-NEXT:    Found an estimated cost of 0 for VF 4 For instruction: %tmp7 = load i32, i32* %tmp3, align 4
+for.body:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %for.body ]
+  %tmp0 = getelementptr inbounds %i32.4, %i32.4* %data, i32 %i, i32 0
+  %tmp1 = getelementptr inbounds %i32.4, %i32.4* %data, i32 %i, i32 1
+  %tmp2 = getelementptr inbounds %i32.4, %i32.4* %data, i32 %i, i32 2
+  %tmp3 = getelementptr inbounds %i32.4, %i32.4* %data, i32 %i, i32 3
+  %tmp4 = load i32, i32* %tmp0, align 4
+  %tmp5 = load i32, i32* %tmp1, align 4
+  %tmp6 = load i32, i32* %tmp2, align 4
+  %tmp7 = load i32, i32* %tmp3, align 4
+  %add0 = add i32 %tmp4, %tmp5
+  %add1 = add i32 %tmp6, %tmp7
+  store i32 %add0, i32* %tmp0, align 4
+  store i32 %add1, i32* %tmp2, align 4
+  %i.next = add nuw nsw i32 %i, 1
+  %cond = icmp slt i32 %i.next, %n
+  br i1 %cond, label %for.body, label %for.end
+
+for.end:
+  ret void
+}
+
+attributes #0 = { "target-features"="+mve" }
@@ -0,0 +1,64 @@
+; RUN: opt -loop-vectorize -force-vector-interleave=1 -S < %s | FileCheck %s
+
+target datalayout = "e-m:e-p:32:32-Fi8-i64:64-v128:64:128-a:0:32-n32-S64"
+target triple = "thumbv8.1m.main-none-eabi"
+
+; MVE reduces the lanes of a vector with a single VADDV, so the vectorizer
+; keeps the add reduction as an intrinsic instead of a tree of shuffles.
+
+; CHECK-LABEL: @add_i32(
+; CHECK:       vector.body:
+; CHECK:         add <4 x i32>
+; CHECK:       middle.block:
+; CHECK-NOT:     shufflevector
+; CHECK:         call i32 @llvm.experimental.vector.reduce.add.v4i32(<4 x i32>
+define i32 @add_i32(i32* nocapture readonly %x, i32 %n) #0 {
+entry:
+  %cmp6 = icmp sgt i32 %n, 0
+  br i1 %cmp6, label %for.body, label %for.end
+
+for.body:
+  %i.08 = phi i32 [ %inc, %for.body ], [ 0, %entry ]
+  %r.07 = phi i32 [ %add, %for.body ], [ 0, %entry ]
+  %arrayidx = getelementptr inbounds i32, i32* %x, i32 %i.08
+  %0 = load i32, i32* %arrayidx, align 4
+  %add = add nsw i32 %0, %r.07
+  %inc = add nuw nsw i32 %i.08, 1
+  %exitcond = icmp eq i32 %inc, %n
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  %r.0.lcssa = phi i32 [ 0, %entry ], [ %add, %for.body ]
+  ret i32 %r.0.lcssa
+}
+
+; CHECK-LABEL: @mla_i32(
+; CHECK:       vector.body:
+; CHECK:         mul nsw <4 x i32>
+; CHECK:         add <4 x i32>
+; CHECK:       middle.block:
+; CHECK:         call i32 @llvm.experimental.vector.reduce.add.v4i32(<4 x i32>
+define i32 @mla_i32(i32* nocapture readonly %x, i32* nocapture readonly %y, i32 %n) #0 {
+entry:
+  %cmp8 = icmp sgt i32 %n, 0
+  br i1 %cmp8, label %for.body, label %for.end
+
+for.body:
+  %i.010 = phi i32 [ %inc, %for.body ], [ 0, %entry ]
+  %r.09 = phi i32 [ %add, %for.body ], [ 0, %entry ]
+  %arrayidx = getelementptr inbounds i32, i32* %x, i32 %i.010
+  %0 = load i32, i32* %arrayidx, align 4
+  %arrayidx1 = getelementptr inbounds i32, i32* %y, i32 %i.010
+  %1 = load i32, i32* %arrayidx1, align 4
+  %mul = mul nsw i32 %1, %0
+  %add = add nsw i32 %mul, %r.09
+  %inc = add nuw nsw i32 %i.010, 1
+  %exitcond = icmp eq i32 %inc, %n
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  %r.0.lcssa = phi i32 [ 0, %entry ], [ %add, %for.body ]
+  ret i32 %r.0.lcssa
+}
+
+attributes #0 = { "target-features"="+mve" }
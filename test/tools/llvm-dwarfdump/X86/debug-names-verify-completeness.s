@@ -1,4 +1,8 @@
 # RUN: llvm-mc -triple x86_64-pc-linux %s -filetype=obj -o - | not llvm-dwarfdump -verify - | FileCheck %s
+# RUN: llvm-mc -triple x86_64-pc-linux %s -filetype=obj -o %t.o
+# RUN: not llvm-dwarfdump -verify %t.o > %t.serial
+# RUN: not llvm-dwarfdump -verify -verify-threads=4 %t.o > %t.parallel
+# RUN: diff %t.serial %t.parallel
 
 # CHECK: error: Name Index @ 0x0: Entry for DIE @ 0x10 (DW_TAG_namespace) with name namesp missing.
 # CHECK: error: Name Index @ 0x0: Entry for DIE @ 0x15 (DW_TAG_variable) with name var_block_addr missing.
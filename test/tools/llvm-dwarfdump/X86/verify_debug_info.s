@@ -2,6 +2,12 @@
 # RUN: | not llvm-dwarfdump -v -verify - \
 # RUN: | FileCheck %s
 
+# Verifying units on several threads gives the same output.
+# RUN: llvm-mc %s -filetype obj -triple x86_64-apple-darwin -o %t.o
+# RUN: not llvm-dwarfdump -v -verify %t.o > %t.serial
+# RUN: not llvm-dwarfdump -v -verify -verify-threads=4 %t.o > %t.parallel
+# RUN: diff %t.serial %t.parallel
+
 # CHECK: error: DIE has invalid DW_AT_stmt_list encoding:{{[[:space:]]}}
 # CHECK-NEXT: 0x0000000c: DW_TAG_compile_unit [1] *
 # CHECK-NEXT: DW_AT_producer [DW_FORM_strp]	( .debug_str[0x00000000] = "clang version 5.0.0 (trunk 308185) (llvm/trunk 308186)")
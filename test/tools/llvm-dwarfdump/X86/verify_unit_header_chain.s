@@ -2,6 +2,12 @@
 # RUN: | not llvm-dwarfdump -verify - \
 # RUN: | FileCheck %s
 
+# Messages about unit headers stay in unit order on several threads.
+# RUN: llvm-mc %s -filetype obj -triple x86_64-apple-darwin -o %t.o
+# RUN: not llvm-dwarfdump -verify %t.o > %t.serial
+# RUN: not llvm-dwarfdump -verify -verify-threads=4 %t.o > %t.parallel
+# RUN: diff %t.serial %t.parallel
+
 # CHECK: Verifying .debug_info Unit Header Chain...
 # CHECK-NEXT: error: Units[1] - start offset: 0x0000000d
 # CHECK-NEXT: note: The unit type encoding is not valid.
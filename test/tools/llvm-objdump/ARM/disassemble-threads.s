@@ -0,0 +1,108 @@
+@ Check that disassembling on several threads prints the same output as
+@ disassembling on a single thread, including ARM/Thumb switches, data in
+@ code, and relocations and IT blocks that straddle the symbols.
+
+@RUN: llvm-mc -triple armv7-unknown-linux -filetype=obj %s -o %t.o
+@RUN: llvm-objdump -d -r %t.o > %t.serial
+@RUN: llvm-objdump -d -r --threads=4 %t.o > %t.parallel
+@RUN: cmp %t.serial %t.parallel
+@RUN: FileCheck %s < %t.parallel
+
+@CHECK-LABEL: arm0:
+@CHECK:       bl #
+@CHECK-NEXT:  R_ARM_CALL ext0
+@CHECK-LABEL: thumb0:
+@CHECK:       bl #
+@CHECK-NEXT:  R_ARM_THM_CALL ext1
+@CHECK-LABEL: arm1:
+@CHECK:       bx lr
+@CHECK:       .word 0x00000000
+@ The relocation of the data is printed after the next instruction.
+@CHECK-LABEL: thumb1:
+@CHECK-NEXT:  adds r0, r0, #1
+@CHECK-NEXT:  0000001c: R_ARM_ABS32 ext2
+@CHECK-NEXT:  it eq
+@CHECK-NEXT:  moveq r0, #0
+@CHECK-NEXT:  bx lr
+@CHECK-LABEL: arm2:
+@CHECK-NEXT:  mov r0, #3
+@CHECK-NEXT:  bx lr
+@CHECK-LABEL: thumb3:
+@CHECK:       bx lr
+@ The instructions after thumb4_else are still predicated by the IT block.
+@CHECK-LABEL: thumb4:
+@CHECK-NEXT:  itte ne
+@CHECK-NEXT:  movne r0, #1
+@CHECK-LABEL: thumb4_else:
+@CHECK-NEXT:  movne r1, #1
+@CHECK-NEXT:  moveq r0, #0
+@CHECK-NEXT:  bx lr
+
+@ The build attributes make llvm-objdump disassemble for ARMv7-A.
+	.arch armv7-a
+	.text
+	.syntax unified
+	.arm
+	.globl arm0
+	.type arm0, %function
+arm0:
+	push	{r11, lr}
+	bl	ext0
+	pop	{r11, pc}
+
+	.thumb
+	.globl thumb0
+	.type thumb0, %function
+thumb0:
+	push	{r7, lr}
+	bl	ext1
+	pop	{r7, pc}
+
+	.arm
+	.globl arm1
+	.type arm1, %function
+arm1:
+	ldr	r0, .Lpool
+	bx	lr
+.Lpool:
+	.word	ext2
+
+	.thumb
+	.globl thumb1
+	.type thumb1, %function
+thumb1:
+	adds	r0, r0, #1
+	it	eq
+	moveq	r0, #0
+	bx	lr
+
+	.globl thumb2
+	.type thumb2, %function
+thumb2:
+	movs	r0, #2
+	bx	lr
+
+	.arm
+	.globl arm2
+	.type arm2, %function
+arm2:
+	mov	r0, #3
+	bx	lr
+
+	.thumb
+	.globl thumb3
+	.type thumb3, %function
+thumb3:
+	movs	r0, #4
+	bx	lr
+
+	.globl thumb4
+	.type thumb4, %function
+thumb4:
+	itte	ne
+	movne	r0, #1
+	.globl thumb4_else
+thumb4_else:
+	movne	r1, #1
+	moveq	r0, #0
+	bx	lr
@@ -0,0 +1,73 @@
+@ RUN: llvm-mc -triple thumbv7m-eabi -filetype obj -o %t.o %s
+@ RUN: llvm-readobj --silhouette-sites %t.o | FileCheck %s
+
+@ CHECK:      SilhouetteSites [
+@ CHECK-NEXT:   Function {
+@ CHECK-NEXT:     Address: 0x101
+@ CHECK-NEXT:     NumSites: 2
+@ CHECK-NEXT:     Sites [
+@ CHECK-NEXT:       Site {
+@ CHECK-NEXT:         Address: 0x100
+@ CHECK-NEXT:         Length: 8
+@ CHECK-NEXT:         Kind: ShadowStackPush
+@ CHECK-NEXT:       }
+@ CHECK-NEXT:       Site {
+@ CHECK-NEXT:         Address: 0x11C
+@ CHECK-NEXT:         Length: 14
+@ CHECK-NEXT:         Kind: CFICheck
+@ CHECK-NEXT:       }
+@ CHECK-NEXT:     ]
+@ CHECK-NEXT:   }
+@ CHECK-NEXT:   Function {
+@ CHECK-NEXT:     Address: 0x201
+@ CHECK-NEXT:     NumSites: 1
+@ CHECK-NEXT:     Sites [
+@ CHECK-NEXT:       Site {
+@ CHECK-NEXT:         Address: 0x208
+@ CHECK-NEXT:         Length: 4
+@ CHECK-NEXT:         Kind: SFI
+@ CHECK-NEXT:       }
+@ CHECK-NEXT:     ]
+@ CHECK-NEXT:   }
+@ CHECK-NEXT:   Function {
+@ CHECK-NEXT:     Address: 0xFFFFFFE1
+@ CHECK-NEXT:     NumSites: 2
+@ CHECK-NEXT:     Sites [
+@ CHECK-NEXT:       Site {
+@ CHECK-NEXT:         Address: 0xFFFFFFFE
+@ CHECK-NEXT:         Length: 2
+@ CHECK-NEXT:         Kind: STRT
+@ CHECK-NEXT:       }
+@ CHECK-NEXT:       Site {
+@ CHECK-NEXT:         Address: 0xFFFFFFFF
+@ CHECK-NEXT:         Length: 1
+@ CHECK-NEXT:         Kind: STRT
+@ CHECK-NEXT:       }
+@ CHECK-NEXT:     ]
+@ CHECK-NEXT:   }
+@ CHECK-NEXT: ]
+
+	.section .silhouette_sites,"a",%progbits
+	.long	0x101
+	.long	2
+	.long	0x100
+	.short	8
+	.byte	1, 0
+	.long	0x11c
+	.short	14
+	.byte	6, 0
+	.long	0x201
+	.long	1
+	.long	0x208
+	.short	4
+	.byte	3, 0
+@ Sites may be anywhere in the address space, including the addresses that
+@ hash tables tend to reserve.
+	.long	0xffffffe1
+	.long	2
+	.long	0xfffffffe
+	.short	2
+	.byte	4, 0
+	.long	0xffffffff
+	.short	1
+	.byte	4, 0
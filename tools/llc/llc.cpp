@@ -13,6 +13,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/CodeGen/CommandFlags.inc"
@@ -21,6 +22,7 @@
 #include "llvm/CodeGen/MIRParser/MIRParser.h"
 #include "llvm/CodeGen/MachineFunctionPass.h"
 #include "llvm/CodeGen/MachineModuleInfo.h"
+#include "llvm/CodeGen/ParallelCG.h"
 #include "llvm/CodeGen/TargetPassConfig.h"
 #include "llvm/CodeGen/TargetSubtargetInfo.h"
 #include "llvm/IR/AutoUpgrade.h"
@@ -51,6 +53,7 @@
 #include "llvm/Support/WithColor.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Transforms/Utils/Cloning.h"
+#include <list>
 #include <memory>
 using namespace llvm;
 
@@ -77,6 +80,12 @@ TimeCompilations("time-compilations", cl::Hidden, cl::init(1u),
                  cl::value_desc("N"),
                  cl::desc("Repeat compilation N times for timing"));
 
+static cl::opt<unsigned>
+CodeGenThreads("codegen-threads", cl::init(1u), cl::value_desc("N"),
+               cl::desc("Split the module into N partitions and generate "
+                        "code for them in parallel, writing partition I to "
+                        "<output>.I. The partitions are not linked"));
+
 static cl::opt<bool>
 NoIntegratedAssembler("no-integrated-as", cl::Hidden,
                       cl::desc("Disable integrated assembler"));
@@ -183,6 +192,21 @@ static cl::opt<RunPassOption, true, cl::parser<std::string>> RunPass(
     cl::value_desc("pass-name"), cl::ZeroOrMore, cl::location(RunPassOpt));
 
 static int compileModule(char **, LLVMContext &);
+static int compileModuleInParallel(char **, std::unique_ptr<Module>,
+                                   const Target *, const Triple &,
+                                   StringRef, StringRef, const TargetOptions &,
+                                   CodeGenOpt::Level);
+
+// Add an appropriate TargetLibraryInfo pass for the module's triple.
+static void addTargetLibraryInfo(legacy::PassManagerBase &PM,
+                                 const Triple &TheTriple) {
+  TargetLibraryInfoImpl TLII(TheTriple);
+
+  // The -disable-simplify-libcalls flag actually disables all builtin optzns.
+  if (DisableSimplifyLibCalls)
+    TLII.disableAllFunctions();
+  PM.add(new TargetLibraryInfoWrapperPass(TLII));
+}
 
 static std::unique_ptr<ToolOutputFile> GetOutputStream(const char *TargetName,
                                                        Triple::OSType OS,
@@ -490,13 +514,7 @@ static int compileModule(char **argv, LLVMContext &Context) {
   // Build up all of the passes that we want to do to the module.
   legacy::PassManager PM;
 
-  // Add an appropriate TargetLibraryInfo pass for the module's triple.
-  TargetLibraryInfoImpl TLII(Triple(M->getTargetTriple()));
-
-  // The -disable-simplify-libcalls flag actually disables all builtin optzns.
-  if (DisableSimplifyLibCalls)
-    TLII.disableAllFunctions();
-  PM.add(new TargetLibraryInfoWrapperPass(TLII));
+  addTargetLibraryInfo(PM, Triple(M->getTargetTriple()));
 
   // Add the target data from the target machine, if it exists, or the module.
   M->setDataLayout(Target->createDataLayout());
@@ -523,6 +541,10 @@ static int compileModule(char **argv, LLVMContext &Context) {
     WithColor::warning(errs(), argv[0])
         << ": warning: ignoring -mc-relax-all because filetype != obj";
 
+  if (CodeGenThreads != 1)
+    return compileModuleInParallel(argv, std::move(M), TheTarget, TheTriple,
+                                   CPUStr, FeaturesStr, Options, OLvl);
+
   {
     raw_pwrite_stream *OS = &Out->os();
 
@@ -633,3 +655,74 @@ static int compileModule(char **argv, LLVMContext &Context) {
 
   return 0;
 }
+
+// Generate code for M by splitting it into CodeGenThreads partitions and
+// handing them to splitCodeGen. Partition I is written to "<output>.I", and
+// the partitions are not linked, so <output> itself is not created. The
+// partitioning only depends on the module contents, and local symbols are
+// never renamed, so linking the partitions in index order reproduces the same
+// symbol table on every run.
+static int compileModuleInParallel(char **argv, std::unique_ptr<Module> M,
+                                   const Target *TheTarget,
+                                   const Triple &TheTriple, StringRef CPUStr,
+                                   StringRef FeaturesStr,
+                                   const TargetOptions &Options,
+                                   CodeGenOpt::Level OLvl) {
+  if (CodeGenThreads == 0) {
+    WithColor::error(errs(), argv[0]) << "-codegen-threads must be positive\n";
+    return 1;
+  }
+  if (OutputFilename.empty() || OutputFilename == "-") {
+    WithColor::error(errs(), argv[0])
+        << "-codegen-threads must be specified together with -o\n";
+    return 1;
+  }
+  if (InputLanguage == "mir" || StringRef(InputFilename).endswith(".mir") ||
+      !RunPassNames->empty() || CompileTwice || !SplitDwarfOutputFile.empty()) {
+    WithColor::error(errs(), argv[0])
+        << "-codegen-threads cannot be used with MIR input, -run-pass, "
+           "-compile-twice or -split-dwarf-output\n";
+    return 1;
+  }
+
+  std::list<ToolOutputFile> OSs;
+  std::vector<raw_pwrite_stream *> OSPtrs;
+  for (unsigned I = 0; I != CodeGenThreads; ++I) {
+    std::string PartFilename = OutputFilename + "." + utostr(I);
+    std::error_code EC;
+    OSs.emplace_back(PartFilename, EC,
+                     FileType == TargetMachine::CGFT_AssemblyFile
+                         ? sys::fs::F_Text
+                         : sys::fs::F_None);
+    if (EC) {
+      WithColor::error(errs(), argv[0])
+          << "error opening the file '" << PartFilename
+          << "': " << EC.message() << '\n';
+      return 1;
+    }
+    OSPtrs.push_back(&OSs.back().os());
+  }
+
+  // Each partition is compiled in its own context on its own thread, so every
+  // thread needs a private TargetMachine.
+  std::string TripleStr = TheTriple.getTriple();
+  auto CreateTargetMachine = [&]() {
+    return std::unique_ptr<TargetMachine>(TheTarget->createTargetMachine(
+        TripleStr, CPUStr, FeaturesStr, Options, getRelocModel(),
+        getCodeModel(), OLvl));
+  };
+
+  cl::PrintOptionValues();
+
+  // Every partition has the triple of M.
+  Triple ModuleTriple(M->getTargetTriple());
+  splitCodeGen(std::move(M), OSPtrs, {}, CreateTargetMachine, FileType,
+               /*PreserveLocals=*/true,
+               [&](legacy::PassManagerBase &PM) {
+                 addTargetLibraryInfo(PM, ModuleTriple);
+               });
+
+  for (ToolOutputFile &OS : OSs)
+    OS.keep();
+  return 0;
+}
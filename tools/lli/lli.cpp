@@ -28,6 +28,7 @@
 #include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
 #include "llvm/ExecutionEngine/Orc/LLJIT.h"
 #include "llvm/ExecutionEngine/Orc/OrcRemoteTargetClient.h"
+#include "llvm/ExecutionEngine/Orc/PersistentObjectCache.h"
 #include "llvm/ExecutionEngine/OrcMCJITReplacement.h"
 #include "llvm/ExecutionEngine/SectionMemoryManager.h"
 #include "llvm/IR/IRBuilder.h"
@@ -57,6 +58,7 @@
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/Instrumentation.h"
 #include <cerrno>
+#include <mutex>
 
 #ifdef __CYGWIN__
 #include <cygwin/version.h>
@@ -104,6 +106,19 @@ namespace {
                     cl::desc("calls the given entry-point on a new thread "
                              "(jit-kind=orc-lazy only)"));
 
+  cl::opt<unsigned> SpeculativeCompiles(
+      "speculative-compiles",
+      cl::desc("Maximum number of functions to compile speculatively in the "
+               "background at any time (jit-kind=orc-lazy only, requires "
+               "-compile-threads)"),
+      cl::init(0));
+
+  cl::opt<bool> PrintCompileStats(
+      "print-compile-stats",
+      cl::desc("Print compile latency statistics to stderr on exit "
+               "(jit-kind=orc-lazy only)"),
+      cl::init(false));
+
   cl::opt<bool> PerModuleLazy(
       "per-module-lazy",
       cl::desc("Performs lazy compilation on whole module boundaries "
@@ -178,6 +193,12 @@ namespace {
                            "(must be user writable)"),
                   cl::init(""));
 
+  cl::opt<std::string> ObjectCachePruningPolicy(
+      "object-cache-pruning-policy",
+      cl::desc("Pruning policy for the -jit-kind=orc-lazy object cache, "
+               "applied after the program has run"),
+      cl::init(""));
+
   cl::opt<std::string>
   FakeArgv0("fake-argv0",
             cl::desc("Override the 'argv[0]' value passed into the executing"
@@ -750,6 +771,33 @@ static orc::IRTransformLayer::TransformFunction createDebugDumper() {
 
 static void exitOnLazyCallThroughFailure() { exit(1); }
 
+namespace {
+// Accumulates the latency of the compiles performed by the JIT.
+class CompileStats : public orc::CompileEventListener {
+public:
+  void notifyModuleCompiled(const Module &M,
+                            std::chrono::nanoseconds Latency) override {
+    std::lock_guard<std::mutex> Lock(StatsMutex);
+    ++NumCompiles;
+    TotalLatency += Latency;
+    MaxLatency = std::max(MaxLatency, Latency);
+  }
+
+  void print(raw_ostream &OS) {
+    std::lock_guard<std::mutex> Lock(StatsMutex);
+    auto Ms = [](std::chrono::nanoseconds D) { return D.count() / 1.0e6; };
+    OS << "Compiled " << NumCompiles << " modules in "
+       << format("%.3f", Ms(TotalLatency)) << " ms (max "
+       << format("%.3f", Ms(MaxLatency)) << " ms)\n";
+  }
+
+private:
+  std::mutex StatsMutex;
+  unsigned NumCompiles = 0;
+  std::chrono::nanoseconds TotalLatency{0}, MaxLatency{0};
+};
+} // end anonymous namespace
+
 int runOrcLazyJIT(const char *ProgName) {
   // Start setting up the JIT environment.
 
@@ -784,6 +832,24 @@ int runOrcLazyJIT(const char *ProgName) {
   Builder.setLazyCompileFailureAddr(
       pointerToJITTargetAddress(exitOnLazyCallThroughFailure));
   Builder.setNumCompileThreads(LazyJITCompileThreads);
+  Builder.setSpeculationLimit(SpeculativeCompiles);
+
+  CompileStats Stats;
+  if (PrintCompileStats)
+    Builder.addCompileEventListener(Stats);
+
+  // Objects are cached by content, so the cache needs a directory of its own.
+  std::unique_ptr<orc::PersistentObjectCache> CacheManager;
+  if (EnableCacheManager) {
+    if (ObjectCacheDir.empty()) {
+      errs() << "-enable-cache-manager requires -object-cache-dir with "
+                "-jit-kind=orc-lazy\n";
+      exit(1);
+    }
+    CacheManager = ExitOnErr(orc::PersistentObjectCache::Create(
+        ObjectCacheDir, *Builder.getJITTargetMachineBuilder()));
+    Builder.setObjectCache(CacheManager.get());
+  }
 
   auto J = ExitOnErr(Builder.create());
 
@@ -887,6 +953,13 @@ int runOrcLazyJIT(const char *ProgName) {
   ExitOnErr(J->runDestructors());
   CXXRuntimeOverrides.runDestructors();
 
+  if (CacheManager && !ObjectCachePruningPolicy.empty())
+    CacheManager->prune(
+        ExitOnErr(parseCachePruningPolicy(ObjectCachePruningPolicy)));
+
+  if (PrintCompileStats)
+    Stats.print(errs());
+
   return Result;
 }
 
@@ -907,6 +980,21 @@ void disallowOrcOptions() {
     errs() << "-per-module-lazy requires -jit-kind=orc-lazy\n";
     exit(1);
   }
+
+  if (SpeculativeCompiles != 0) {
+    errs() << "-speculative-compiles requires -jit-kind=orc-lazy\n";
+    exit(1);
+  }
+
+  if (PrintCompileStats) {
+    errs() << "-print-compile-stats requires -jit-kind=orc-lazy\n";
+    exit(1);
+  }
+
+  if (!ObjectCachePruningPolicy.empty()) {
+    errs() << "-object-cache-pruning-policy requires -jit-kind=orc-lazy\n";
+    exit(1);
+  }
 }
 
 std::unique_ptr<FDRawChannel> launchRemote() {
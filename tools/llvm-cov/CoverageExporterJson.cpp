@@ -48,7 +48,7 @@
 #include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/Threading.h"
 #include <algorithm>
-#include <mutex>
+#include <numeric>
 #include <utility>
 
 /// The semantic version combined as a string.
@@ -148,44 +148,55 @@ json::Object renderFile(const coverage::CoverageMapping &Coverage,
   return File;
 }
 
-json::Array renderFiles(const coverage::CoverageMapping &Coverage,
-                        ArrayRef<std::string> SourceFiles,
-                        ArrayRef<FileCoverageSummary> FileReports,
-                        const CoverageViewOptions &Options) {
+/// Render the files in chunks on a thread pool and stream each chunk in order
+/// of the file names, so that only a bounded number of rendered files is held
+/// in memory at a time.
+void renderFiles(json::OStream &JOS, const coverage::CoverageMapping &Coverage,
+                 ArrayRef<std::string> SourceFiles,
+                 ArrayRef<FileCoverageSummary> FileReports,
+                 const CoverageViewOptions &Options) {
+  // Files are written in order of their names.
+  std::vector<unsigned> Order(SourceFiles.size());
+  std::iota(Order.begin(), Order.end(), 0);
+  llvm::sort(Order, [&](unsigned A, unsigned B) {
+    return StringRef(SourceFiles[A]).compare(SourceFiles[B]) < 0;
+  });
+
   auto NumThreads = Options.NumThreads;
   if (NumThreads == 0) {
     NumThreads = std::max(1U, std::min(llvm::heavyweight_hardware_concurrency(),
                                        unsigned(SourceFiles.size())));
   }
   ThreadPool Pool(NumThreads);
-  json::Array FileArray;
-  std::mutex FileArrayMutex;
-
-  for (unsigned I = 0, E = SourceFiles.size(); I < E; ++I) {
-    auto &SourceFile = SourceFiles[I];
-    auto &FileReport = FileReports[I];
-    Pool.async([&] {
-      auto File = renderFile(Coverage, SourceFile, FileReport, Options);
-      {
-        std::lock_guard<std::mutex> Lock(FileArrayMutex);
-        FileArray.push_back(std::move(File));
-      }
-    });
+  const size_t ChunkSize = size_t(NumThreads) * 16;
+  std::vector<json::Object> Files;
+
+  for (size_t Begin = 0, E = Order.size(); Begin < E; Begin += ChunkSize) {
+    size_t End = std::min(E, Begin + ChunkSize);
+    Files.clear();
+    Files.resize(End - Begin);
+    for (size_t I = Begin; I < End; ++I) {
+      Pool.async([&, I] {
+        unsigned FileIndex = Order[I];
+        Files[I - Begin] = renderFile(Coverage, SourceFiles[FileIndex],
+                                      FileReports[FileIndex], Options);
+      });
+    }
+    Pool.wait();
+    for (json::Object &File : Files)
+      JOS.value(std::move(File));
   }
-  Pool.wait();
-  return FileArray;
 }
 
-json::Array renderFunctions(
+void renderFunctions(
+    json::OStream &JOS,
     const iterator_range<coverage::FunctionRecordIterator> &Functions) {
-  json::Array FunctionArray;
   for (const auto &F : Functions)
-    FunctionArray.push_back(
+    JOS.value(
         json::Object({{"name", F.Name},
                       {"count", int64_t(F.ExecutionCount)},
                       {"regions", renderRegions(F.CountedRegions)},
                       {"filenames", json::Array(F.Filenames)}}));
-  return FunctionArray;
 }
 
 } // end anonymous namespace
@@ -203,27 +214,26 @@ void CoverageExporterJson::renderRoot(ArrayRef<std::string> SourceFiles) {
   FileCoverageSummary Totals = FileCoverageSummary("Totals");
   auto FileReports = CoverageReport::prepareFileReports(Coverage, Totals,
                                                         SourceFiles, Options);
-  auto Files = renderFiles(Coverage, SourceFiles, FileReports, Options);
-  // Sort files in order of their names.
-  std::sort(Files.begin(), Files.end(),
-    [](const json::Value &A, const json::Value &B) {
-      const json::Object *ObjA = A.getAsObject();
-      const json::Object *ObjB = B.getAsObject();
-      assert(ObjA != nullptr && "Value A was not an Object");
-      assert(ObjB != nullptr && "Value B was not an Object");
-      const StringRef FilenameA = ObjA->getString("filename").getValue();
-      const StringRef FilenameB = ObjB->getString("filename").getValue();
-      return FilenameA.compare(FilenameB) < 0;
-    });
-  auto Export = json::Object(
-      {{"files", std::move(Files)}, {"totals", renderSummary(Totals)}});
-  // Skip functions-level information  if necessary.
-  if (!Options.ExportSummaryOnly && !Options.SkipFunctions)
-    Export["functions"] = renderFunctions(Coverage.getCoveredFunctions());
-
-  auto ExportArray = json::Array({std::move(Export)});
 
-  OS << json::Object({{"version", LLVM_COVERAGE_EXPORT_JSON_STR},
-                      {"type", LLVM_COVERAGE_EXPORT_JSON_TYPE_STR},
-                      {"data", std::move(ExportArray)}});
+  // Stream the export rather than building it as a single json::Value.  The
+  // attributes of each object are written in sorted order, as json::Value
+  // would print them.
+  json::OStream JOS(OS);
+  JOS.object([&] {
+    JOS.attributeArray("data", [&] {
+      JOS.object([&] {
+        JOS.attributeArray("files", [&] {
+          renderFiles(JOS, Coverage, SourceFiles, FileReports, Options);
+        });
+        // Skip functions-level information  if necessary.
+        if (!Options.ExportSummaryOnly && !Options.SkipFunctions)
+          JOS.attributeArray("functions", [&] {
+            renderFunctions(JOS, Coverage.getCoveredFunctions());
+          });
+        JOS.attribute("totals", renderSummary(Totals));
+      });
+    });
+    JOS.attribute("type", LLVM_COVERAGE_EXPORT_JSON_TYPE_STR);
+    JOS.attribute("version", LLVM_COVERAGE_EXPORT_JSON_STR);
+  });
 }
@@ -37,6 +37,9 @@
 
 #include "CoverageExporterLcov.h"
 #include "CoverageReport.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+#include <algorithm>
 
 using namespace llvm;
 
@@ -96,12 +99,44 @@ void renderFile(raw_ostream &OS, const coverage::CoverageMapping &Coverage,
   OS << "end_of_record\n";
 }
 
+/// Render the files in chunks on a thread pool, each into a buffer of its own,
+/// and write the buffers of a chunk in order before rendering the next one.
 void renderFiles(raw_ostream &OS, const coverage::CoverageMapping &Coverage,
                  ArrayRef<std::string> SourceFiles,
                  ArrayRef<FileCoverageSummary> FileReports,
-                 bool ExportSummaryOnly) {
-  for (unsigned I = 0, E = SourceFiles.size(); I < E; ++I)
-    renderFile(OS, Coverage, SourceFiles[I], FileReports[I], ExportSummaryOnly);
+                 const CoverageViewOptions &Options) {
+  auto NumThreads = Options.NumThreads;
+  if (NumThreads == 0) {
+    NumThreads = std::max(1U, std::min(llvm::heavyweight_hardware_concurrency(),
+                                       unsigned(SourceFiles.size())));
+  }
+  if (NumThreads == 1) {
+    for (unsigned I = 0, E = SourceFiles.size(); I < E; ++I)
+      renderFile(OS, Coverage, SourceFiles[I], FileReports[I],
+                 Options.ExportSummaryOnly);
+    return;
+  }
+
+  ThreadPool Pool(NumThreads);
+  const size_t ChunkSize = size_t(NumThreads) * 16;
+  std::vector<std::string> Buffers;
+
+  for (size_t Begin = 0, E = SourceFiles.size(); Begin < E;
+       Begin += ChunkSize) {
+    size_t End = std::min(E, Begin + ChunkSize);
+    Buffers.clear();
+    Buffers.resize(End - Begin);
+    for (size_t I = Begin; I < End; ++I) {
+      Pool.async([&, I] {
+        raw_string_ostream BufferOS(Buffers[I - Begin]);
+        renderFile(BufferOS, Coverage, SourceFiles[I], FileReports[I],
+                   Options.ExportSummaryOnly);
+      });
+    }
+    Pool.wait();
+    for (const std::string &Buffer : Buffers)
+      OS << Buffer;
+  }
 }
 
 } // end anonymous namespace
@@ -119,6 +154,5 @@ void CoverageExporterLcov::renderRoot(ArrayRef<std::string> SourceFiles) {
   FileCoverageSummary Totals = FileCoverageSummary("Totals");
   auto FileReports = CoverageReport::prepareFileReports(Coverage, Totals,
                                                         SourceFiles, Options);
-  renderFiles(OS, Coverage, SourceFiles, FileReports,
-              Options.ExportSummaryOnly);
+  renderFiles(OS, Coverage, SourceFiles, FileReports, Options);
 }
@@ -25,8 +25,11 @@
 #include "llvm/Linker/Linker.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/SystemUtils.h"
 #include "llvm/Support/ToolOutputFile.h"
@@ -35,6 +38,7 @@
 #include "llvm/Transforms/IPO/Internalize.h"
 #include "llvm/Transforms/Utils/FunctionImportUtils.h"
 
+#include <chrono>
 #include <memory>
 #include <utility>
 using namespace llvm;
@@ -85,6 +89,10 @@ static cl::opt<bool>
     DisableLazyLoad("disable-lazy-loading",
                     cl::desc("Disable lazy module loading"));
 
+static cl::opt<bool> PrintResourceUsage(
+    "print-resource-usage",
+    cl::desc("Print the wall time and peak resident set size of the link"));
+
 static cl::opt<bool>
     OutputAssembly("S", cl::desc("Write output as LLVM assembly"), cl::Hidden);
 
@@ -110,6 +118,33 @@ static cl::opt<bool> PreserveAssemblyUseListOrder(
 
 static ExitOnError ExitOnErr;
 
+// Create a module for FN whose function bodies are only read when they are
+// materialized. Bitcode is used in place: it does not need the null terminator
+// that would force a copy of files whose size is a multiple of the page size.
+// The buffer is owned by the module, so it is released as soon as the module
+// has been linked in.
+static std::unique_ptr<Module> loadLazyFile(const std::string &FN,
+                                            SMDiagnostic &Err,
+                                            LLVMContext &Context,
+                                            bool ShouldLazyLoadMetadata) {
+  ErrorOr<std::unique_ptr<MemoryBuffer>> FileOrErr =
+      MemoryBuffer::getFileOrSTDIN(FN, /*FileSize=*/-1,
+                                   /*RequiresNullTerminator=*/false);
+  if (std::error_code EC = FileOrErr.getError()) {
+    Err = SMDiagnostic(FN, SourceMgr::DK_Error,
+                       "Could not open input file: " + EC.message());
+    return nullptr;
+  }
+  std::unique_ptr<MemoryBuffer> Buffer = std::move(*FileOrErr);
+  // The assembly parser relies on the null terminator.
+  if (!isBitcode((const unsigned char *)Buffer->getBufferStart(),
+                 (const unsigned char *)Buffer->getBufferEnd()))
+    Buffer = MemoryBuffer::getMemBufferCopy(Buffer->getBuffer(),
+                                            Buffer->getBufferIdentifier());
+  return getLazyIRModule(std::move(Buffer), Err, Context,
+                         ShouldLazyLoadMetadata);
+}
+
 // Read the specified bitcode file in and return it. This routine searches the
 // link path for the specified file to try to find it...
 //
@@ -124,7 +159,7 @@ static std::unique_ptr<Module> loadFile(const char *argv0,
   if (DisableLazyLoad)
     Result = parseIRFile(FN, Err, Context);
   else
-    Result = getLazyIRFileModule(FN, Err, Context, !MaterializeMetadata);
+    Result = loadLazyFile(FN, Err, Context, !MaterializeMetadata);
 
   if (!Result) {
     Err.print(argv0, errs());
@@ -345,9 +380,18 @@ static bool linkFiles(const char *argv0, LLVMContext &Context, Linker &L,
   return true;
 }
 
+static void printResourceUsage(std::chrono::steady_clock::time_point Start) {
+  std::chrono::duration<double> Elapsed =
+      std::chrono::steady_clock::now() - Start;
+  errs() << "Wall time: " << format("%.3f", Elapsed.count()) << " s\n";
+  errs() << "Peak RSS: " << sys::Process::GetPeakResidentSetSize() / 1024
+         << " KiB\n";
+}
+
 int main(int argc, char **argv) {
   InitLLVM X(argc, argv);
   ExitOnErr.setBanner(std::string(argv[0]) + ": ");
+  auto Start = std::chrono::steady_clock::now();
 
   LLVMContext Context;
   Context.setDiagnosticHandler(
@@ -403,5 +447,8 @@ int main(int argc, char **argv) {
   // Declare success.
   Out.keep();
 
+  if (PrintResourceUsage)
+    printResourceUsage(Start);
+
   return 0;
 }
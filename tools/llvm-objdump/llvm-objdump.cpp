@@ -59,11 +59,13 @@
 #include "llvm/Support/StringSaver.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/WithColor.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cctype>
 #include <cstring>
+#include <mutex>
 #include <system_error>
 #include <unordered_map>
 #include <utility>
@@ -305,6 +307,12 @@ static cl::alias PrintSourceShort("S", cl::desc("Alias for -source"),
 static cl::opt<uint64_t>
     StartAddress("start-address", cl::desc("Disassemble beginning at address"),
                  cl::value_desc("address"), cl::init(0), cl::cat(ObjdumpCat));
+static cl::opt<unsigned> DisassembleThreads(
+    "threads",
+    cl::desc("Number of threads used to disassemble the symbols of a section. "
+             "The output is the same for any number of threads"),
+    cl::init(1), cl::cat(ObjdumpCat));
+
 static cl::opt<uint64_t> StopAddress("stop-address",
                                      cl::desc("Stop disassembly at address"),
                                      cl::value_desc("address"),
@@ -647,13 +655,13 @@ static bool hasMappingSymbols(const ObjectFile *Obj) {
 }
 
 static void printRelocation(const RelocationRef &Rel, uint64_t Address,
-                            bool Is64Bits) {
+                            bool Is64Bits, raw_ostream &OS) {
   StringRef Fmt = Is64Bits ? "\t\t%016" PRIx64 ":  " : "\t\t\t%08" PRIx64 ":  ";
   SmallString<16> Name;
   SmallString<32> Val;
   Rel.getTypeName(Name);
   error(getRelocationValueString(Rel, Val));
-  outs() << format(Fmt.data(), Address) << Name << "\t" << Val << "\n";
+  OS << format(Fmt.data(), Address) << Name << "\t" << Val << "\n";
 }
 
 class PrettyPrinter {
@@ -739,7 +747,7 @@ public:
     auto PrintReloc = [&]() -> void {
       while ((RelCur != RelEnd) && (RelCur->getOffset() <= Address.Address)) {
         if (RelCur->getOffset() == Address.Address) {
-          printRelocation(*RelCur, Address.Address, false);
+          printRelocation(*RelCur, Address.Address, false, OS);
           return;
         }
         ++RelCur;
@@ -1011,30 +1019,30 @@ static char getMappingSymbolKind(ArrayRef<MappingSymbolPair> MappingSymbols,
 static uint64_t
 dumpARMELFData(uint64_t SectionAddr, uint64_t Index, uint64_t End,
                const ObjectFile *Obj, ArrayRef<uint8_t> Bytes,
-               ArrayRef<MappingSymbolPair> MappingSymbols) {
+               ArrayRef<MappingSymbolPair> MappingSymbols, raw_ostream &OS) {
   support::endianness Endian =
       Obj->isLittleEndian() ? support::little : support::big;
   while (Index < End) {
-    outs() << format("%8" PRIx64 ":", SectionAddr + Index);
-    outs() << "\t";
+    OS << format("%8" PRIx64 ":", SectionAddr + Index);
+    OS << "\t";
     if (Index + 4 <= End) {
-      dumpBytes(Bytes.slice(Index, 4), outs());
-      outs() << "\t.word\t"
-             << format_hex(
-                    support::endian::read32(Bytes.data() + Index, Endian), 10);
+      dumpBytes(Bytes.slice(Index, 4), OS);
+      OS << "\t.word\t"
+         << format_hex(support::endian::read32(Bytes.data() + Index, Endian),
+                       10);
       Index += 4;
     } else if (Index + 2 <= End) {
-      dumpBytes(Bytes.slice(Index, 2), outs());
-      outs() << "\t\t.short\t"
-             << format_hex(
-                    support::endian::read16(Bytes.data() + Index, Endian), 6);
+      dumpBytes(Bytes.slice(Index, 2), OS);
+      OS << "\t\t.short\t"
+         << format_hex(support::endian::read16(Bytes.data() + Index, Endian),
+                       6);
       Index += 2;
     } else {
-      dumpBytes(Bytes.slice(Index, 1), outs());
-      outs() << "\t\t.byte\t" << format_hex(Bytes[0], 4);
+      dumpBytes(Bytes.slice(Index, 1), OS);
+      OS << "\t\t.byte\t" << format_hex(Bytes[0], 4);
       ++Index;
     }
-    outs() << "\n";
+    OS << "\n";
     if (getMappingSymbolKind(MappingSymbols, Index) != 'd')
       break;
   }
@@ -1042,7 +1050,7 @@ dumpARMELFData(uint64_t SectionAddr, uint64_t Index, uint64_t End,
 }
 
 static void dumpELFData(uint64_t SectionAddr, uint64_t Index, uint64_t End,
-                        ArrayRef<uint8_t> Bytes) {
+                        ArrayRef<uint8_t> Bytes, raw_ostream &OS) {
   // print out data up to 8 bytes at a time in hex and ascii
   uint8_t AsciiData[9] = {'\0'};
   uint8_t Byte;
@@ -1050,9 +1058,9 @@ static void dumpELFData(uint64_t SectionAddr, uint64_t Index, uint64_t End,
 
   for (; Index < End; ++Index) {
     if (NumBytes == 0)
-      outs() << format("%8" PRIx64 ":", SectionAddr + Index);
+      OS << format("%8" PRIx64 ":", SectionAddr + Index);
     Byte = Bytes.slice(Index)[0];
-    outs() << format(" %02x", Byte);
+    OS << format(" %02x", Byte);
     AsciiData[NumBytes] = isPrint(Byte) ? Byte : '.';
 
     uint8_t IndentOffset = 0;
@@ -1067,27 +1075,410 @@ static void dumpELFData(uint64_t SectionAddr, uint64_t Index, uint64_t End,
     }
     if (NumBytes == 8) {
       AsciiData[8] = '\0';
-      outs() << std::string(IndentOffset, ' ') << "         ";
-      outs() << reinterpret_cast<char *>(AsciiData);
-      outs() << '\n';
+      OS << std::string(IndentOffset, ' ') << "         ";
+      OS << reinterpret_cast<char *>(AsciiData);
+      OS << '\n';
       NumBytes = 0;
     }
   }
 }
 
+namespace {
+/// The objects used to decode and print instructions. With --threads, every
+/// worker has its own set.
+struct DisassemblerSet {
+  MCDisassembler *PrimaryDisAsm;
+  MCDisassembler *SecondaryDisAsm;
+  const MCSubtargetInfo *PrimarySTI;
+  const MCSubtargetInfo *SecondarySTI;
+  const MCInstrAnalysis *MIA;
+  MCInstPrinter *IP;
+};
+
+/// Disassembly state that carries over from one symbol to the next.
+struct DisassemblyState {
+  /// Whether the primary or the secondary (ARM vs Thumb) disassembler is
+  /// selected.
+  bool UsePrimary = true;
+  /// The next relocation of the section that has not been printed.
+  std::vector<RelocationRef>::const_iterator RelCur;
+  /// Comments produced by the disassembler that were not printed yet.
+  std::string Comments;
+  /// The decoder state of each disassembler, such as the rest of a Thumb IT
+  /// block, as returned by MCDisassembler::getDecoderState.
+  std::string PrimaryDecoderState;
+  std::string SecondaryDecoderState;
+
+  bool operator==(const DisassemblyState &Other) const {
+    return UsePrimary == Other.UsePrimary && RelCur == Other.RelCur &&
+           Comments == Other.Comments &&
+           PrimaryDecoderState == Other.PrimaryDecoderState &&
+           SecondaryDecoderState == Other.SecondaryDecoderState;
+  }
+  bool operator!=(const DisassemblyState &Other) const {
+    return !(*this == Other);
+  }
+};
+
+/// A symbol to disassemble. Start and End are relative to the section.
+struct SymbolDisassemblyJob {
+  unsigned SymbolIndex;
+  std::string SymbolName;
+  uint64_t Start;
+  uint64_t End;
+};
+
+/// Everything about a section that stays fixed while its symbols are
+/// disassembled.
+struct SectionDisassemblyInfo {
+  const ObjectFile *Obj;
+  SectionRef Section;
+  uint64_t SectionAddr;
+  ArrayRef<uint8_t> Bytes;
+  const SectionSymbolsTy &Symbols;
+  ArrayRef<MappingSymbolPair> MappingSymbols;
+  std::vector<RelocationRef> &Rels;
+  uint64_t VMAAdjustment;
+  bool Is64Bits;
+  bool PrimaryIsThumb;
+  const std::map<SectionRef, SectionSymbolsTy> &AllSymbols;
+  const SectionSymbolsTy &AbsoluteSymbols;
+  ArrayRef<std::pair<uint64_t, SectionRef>> SectionAddresses;
+  PrettyPrinter &PIP;
+  SourcePrinter &SP;
+};
+} // end anonymous namespace
+
+static void disassembleSymbol(const SectionDisassemblyInfo &S,
+                              const DisassemblerSet &D,
+                              const SymbolDisassemblyJob &Job,
+                              DisassemblyState &State, raw_ostream &OS) {
+  const ObjectFile *Obj = S.Obj;
+  const SectionRef &Section = S.Section;
+  const SectionSymbolsTy &Symbols = S.Symbols;
+  uint64_t SectionAddr = S.SectionAddr;
+  ArrayRef<uint8_t> Bytes = S.Bytes;
+  unsigned SI = Job.SymbolIndex;
+  uint64_t Start = Job.Start;
+  uint64_t End = Job.End;
+
+  const MCSubtargetInfo *STI = State.UsePrimary ? D.PrimarySTI : D.SecondarySTI;
+  MCDisassembler *DisAsm =
+      State.UsePrimary ? D.PrimaryDisAsm : D.SecondaryDisAsm;
+  std::vector<RelocationRef>::const_iterator RelCur = State.RelCur;
+  std::vector<RelocationRef>::const_iterator RelEnd = S.Rels.end();
+
+  SmallString<40> Comments(State.Comments);
+  raw_svector_ostream CommentStream(Comments);
+  D.PrimaryDisAsm->setDecoderState(State.PrimaryDecoderState);
+  if (D.SecondaryDisAsm)
+    D.SecondaryDisAsm->setDecoderState(State.SecondaryDecoderState);
+  auto SaveState = [&]() {
+    State.UsePrimary = DisAsm == D.PrimaryDisAsm;
+    State.RelCur = RelCur;
+    State.Comments = Comments.str();
+    State.PrimaryDecoderState = D.PrimaryDisAsm->getDecoderState();
+    if (D.SecondaryDisAsm)
+      State.SecondaryDecoderState = D.SecondaryDisAsm->getDecoderState();
+  };
+
+  OS << '\n';
+  if (!NoLeadingAddr)
+    OS << format(S.Is64Bits ? "%016" PRIx64 " " : "%08" PRIx64 " ",
+                 SectionAddr + Start + S.VMAAdjustment);
+
+  OS << Job.SymbolName << ":\n";
+
+  // Don't print raw contents of a virtual section. A virtual section
+  // doesn't have any contents in the file.
+  if (Section.isVirtual()) {
+    OS << "...\n";
+    SaveState();
+    return;
+  }
+
+#ifndef NDEBUG
+  raw_ostream &DebugOut = DebugFlag ? dbgs() : nulls();
+#else
+  raw_ostream &DebugOut = nulls();
+#endif
+
+  // Some targets (like WebAssembly) have a special prelude at the start
+  // of each symbol.
+  uint64_t Size;
+  DisAsm->onSymbolStart(Job.SymbolName, Size, Bytes.slice(Start, End - Start),
+                        SectionAddr + Start, DebugOut, CommentStream);
+  Start += Size;
+
+  uint64_t Index = Start;
+  if (SectionAddr < StartAddress)
+    Index = std::max<uint64_t>(Index, StartAddress - SectionAddr);
+
+  // If there is a data/common symbol inside an ELF text section and we are
+  // only disassembling text (applicable all architectures), we are in a
+  // situation where we must print the data and not disassemble it.
+  if (Obj->isELF() && !DisassembleAll && Section.isText()) {
+    uint8_t SymTy = std::get<2>(Symbols[SI]);
+    if (SymTy == ELF::STT_OBJECT || SymTy == ELF::STT_COMMON) {
+      dumpELFData(SectionAddr, Index, End, Bytes, OS);
+      Index = End;
+    }
+  }
+
+  bool CheckARMELFData = hasMappingSymbols(Obj) &&
+                         std::get<2>(Symbols[SI]) != ELF::STT_OBJECT &&
+                         !DisassembleAll;
+  while (Index < End) {
+    // ARM and AArch64 ELF binaries can interleave data and text in the
+    // same section. We rely on the markers introduced to understand what
+    // we need to dump. If the data marker is within a function, it is
+    // denoted as a word/short etc.
+    if (CheckARMELFData &&
+        getMappingSymbolKind(S.MappingSymbols, Index) == 'd') {
+      Index = dumpARMELFData(SectionAddr, Index, End, Obj, Bytes,
+                             S.MappingSymbols, OS);
+      continue;
+    }
+
+    // When -z or --disassemble-zeroes are given we always dissasemble
+    // them. Otherwise we might want to skip zero bytes we see.
+    if (!DisassembleZeroes) {
+      uint64_t MaxOffset = End - Index;
+      // For -reloc: print zero blocks patched by relocations, so that
+      // relocations can be shown in the dump.
+      if (RelCur != RelEnd)
+        MaxOffset = RelCur->getOffset() - Index;
+
+      if (size_t N = countSkippableZeroBytes(Bytes.slice(Index, MaxOffset))) {
+        OS << "\t\t..." << '\n';
+        Index += N;
+        continue;
+      }
+    }
+
+    if (D.SecondarySTI) {
+      if (getMappingSymbolKind(S.MappingSymbols, Index) == 'a') {
+        STI = S.PrimaryIsThumb ? D.SecondarySTI : D.PrimarySTI;
+        DisAsm = S.PrimaryIsThumb ? D.SecondaryDisAsm : D.PrimaryDisAsm;
+      } else if (getMappingSymbolKind(S.MappingSymbols, Index) == 't') {
+        STI = S.PrimaryIsThumb ? D.PrimarySTI : D.SecondarySTI;
+        DisAsm = S.PrimaryIsThumb ? D.PrimaryDisAsm : D.SecondaryDisAsm;
+      }
+    }
+
+    // Disassemble a real instruction or a data when disassemble all is
+    // provided
+    MCInst Inst;
+    bool Disassembled = DisAsm->getInstruction(
+        Inst, Size, Bytes.slice(Index), SectionAddr + Index, DebugOut,
+        CommentStream);
+    if (Size == 0)
+      Size = 1;
+
+    S.PIP.printInst(
+        *D.IP, Disassembled ? &Inst : nullptr, Bytes.slice(Index, Size),
+        {SectionAddr + Index + S.VMAAdjustment, Section.getIndex()}, OS, "",
+        *STI, &S.SP, &S.Rels);
+    OS << CommentStream.str();
+    Comments.clear();
+
+    // Try to resolve the target of a call, tail call, etc. to a specific
+    // symbol.
+    const MCInstrAnalysis *MIA = D.MIA;
+    if (MIA && (MIA->isCall(Inst) || MIA->isUnconditionalBranch(Inst) ||
+                MIA->isConditionalBranch(Inst))) {
+      uint64_t Target;
+      if (MIA->evaluateBranch(Inst, SectionAddr + Index, Size, Target)) {
+        // In a relocatable object, the target's section must reside in
+        // the same section as the call instruction or it is accessed
+        // through a relocation.
+        //
+        // In a non-relocatable object, the target may be in any section.
+        //
+        // N.B. We don't walk the relocations in the relocatable case yet.
+        static const SectionSymbolsTy NoSymbols;
+        const SectionSymbolsTy *TargetSectionSymbols = &Symbols;
+        if (!Obj->isRelocatableObject()) {
+          auto It = partition_point(
+              S.SectionAddresses,
+              [=](const std::pair<uint64_t, SectionRef> &O) {
+                return O.first <= Target;
+              });
+          if (It != S.SectionAddresses.begin()) {
+            --It;
+            auto SecSyms = S.AllSymbols.find(It->second);
+            TargetSectionSymbols =
+                SecSyms == S.AllSymbols.end() ? &NoSymbols : &SecSyms->second;
+          } else {
+            TargetSectionSymbols = &S.AbsoluteSymbols;
+          }
+        }
+
+        // Find the last symbol in the section whose offset is less than
+        // or equal to the target. If there isn't a section that contains
+        // the target, find the nearest preceding absolute symbol.
+        auto TargetSym = partition_point(
+            *TargetSectionSymbols,
+            [=](const std::tuple<uint64_t, StringRef, uint8_t> &O) {
+              return std::get<0>(O) <= Target;
+            });
+        if (TargetSym == TargetSectionSymbols->begin()) {
+          TargetSectionSymbols = &S.AbsoluteSymbols;
+          TargetSym = partition_point(
+              S.AbsoluteSymbols,
+              [=](const std::tuple<uint64_t, StringRef, uint8_t> &O) {
+                return std::get<0>(O) <= Target;
+              });
+        }
+        if (TargetSym != TargetSectionSymbols->begin()) {
+          --TargetSym;
+          uint64_t TargetAddress = std::get<0>(*TargetSym);
+          StringRef TargetName = std::get<1>(*TargetSym);
+          OS << " <" << TargetName;
+          uint64_t Disp = Target - TargetAddress;
+          if (Disp)
+            OS << "+0x" << Twine::utohexstr(Disp);
+          OS << '>';
+        }
+      }
+    }
+    OS << "\n";
+
+    // Hexagon does this in pretty printer
+    if (Obj->getArch() != Triple::hexagon) {
+      // Print relocation for instruction.
+      while (RelCur != RelEnd) {
+        uint64_t Offset = RelCur->getOffset();
+        // If this relocation is hidden, skip it.
+        if (getHidden(*RelCur) || SectionAddr + Offset < StartAddress) {
+          ++RelCur;
+          continue;
+        }
+
+        // Stop when RelCur's offset is past the current instruction.
+        if (Offset >= Index + Size)
+          break;
+
+        // When --adjust-vma is used, update the address printed.
+        if (RelCur->getSymbol() != Obj->symbol_end()) {
+          Expected<section_iterator> SymSI =
+              RelCur->getSymbol()->getSection();
+          if (SymSI && *SymSI != Obj->section_end() &&
+              shouldAdjustVA(**SymSI))
+            Offset += AdjustVMA;
+        }
+
+        printRelocation(*RelCur, SectionAddr + Offset, S.Is64Bits, OS);
+        ++RelCur;
+      }
+    }
+
+    Index += Size;
+  }
+  SaveState();
+}
+
+// Disassemble the symbols of a section on several threads. The symbols are
+// split into contiguous chunks, and each chunk starts from a guess of the
+// state the previous chunk leaves behind. Chunks are then emitted in order;
+// a chunk whose guess turns out to be wrong is disassembled again from the
+// real state, so the output is always the same as with a single thread.
+static void
+disassembleSectionInParallel(const SectionDisassemblyInfo &S,
+                             ArrayRef<SymbolDisassemblyJob> Jobs,
+                             const DisassemblerSet &MainSet,
+                             ArrayRef<DisassemblerSet> WorkerSets,
+                             DisassemblyState &State) {
+  struct Chunk {
+    ArrayRef<SymbolDisassemblyJob> Jobs;
+    DisassemblyState InitialState;
+    DisassemblyState FinalState;
+    std::string Output;
+  };
+
+  uint64_t TotalSize = 0;
+  for (const SymbolDisassemblyJob &Job : Jobs)
+    TotalSize += Job.End - Job.Start;
+  // Aim for a few chunks per thread so that one large function does not
+  // leave the other threads idle.
+  uint64_t ChunkSize = std::max<uint64_t>(
+      TotalSize / (WorkerSets.size() * 4), 1);
+
+  std::vector<Chunk> Chunks;
+  for (size_t I = 0, E = Jobs.size(); I != E;) {
+    size_t First = I;
+    uint64_t Size = 0;
+    while (I != E && (I == First || Size < ChunkSize))
+      Size += Jobs[I].End - Jobs[I].Start, ++I;
+
+    Chunk C;
+    C.Jobs = Jobs.slice(First, I - First);
+    uint64_t ChunkStart = Jobs[First].Start;
+    C.InitialState.UsePrimary = State.UsePrimary;
+    if (MainSet.SecondarySTI) {
+      char Kind = getMappingSymbolKind(S.MappingSymbols, ChunkStart);
+      if (Kind == 'a')
+        C.InitialState.UsePrimary = !S.PrimaryIsThumb;
+      else if (Kind == 't')
+        C.InitialState.UsePrimary = S.PrimaryIsThumb;
+    }
+    // An IT block rarely runs across a symbol, so only the first chunk is
+    // expected to start in the middle of one.
+    if (First == 0) {
+      C.InitialState.PrimaryDecoderState = State.PrimaryDecoderState;
+      C.InitialState.SecondaryDecoderState = State.SecondaryDecoderState;
+    }
+    C.InitialState.RelCur = partition_point(
+        S.Rels,
+        [=](const RelocationRef &R) { return R.getOffset() < ChunkStart; });
+    Chunks.push_back(std::move(C));
+  }
+
+  std::mutex SetsMutex;
+  std::vector<const DisassemblerSet *> FreeSets;
+  for (const DisassemblerSet &Set : WorkerSets)
+    FreeSets.push_back(&Set);
+
+  {
+    ThreadPool Pool(WorkerSets.size());
+    for (Chunk &C : Chunks) {
+      Pool.async([&]() {
+        const DisassemblerSet *D;
+        {
+          std::lock_guard<std::mutex> Lock(SetsMutex);
+          D = FreeSets.back();
+          FreeSets.pop_back();
+        }
+        raw_string_ostream OS(C.Output);
+        C.FinalState = C.InitialState;
+        for (const SymbolDisassemblyJob &Job : C.Jobs)
+          disassembleSymbol(S, *D, Job, C.FinalState, OS);
+        OS.flush();
+        std::lock_guard<std::mutex> Lock(SetsMutex);
+        FreeSets.push_back(D);
+      });
+    }
+  }
+
+  for (Chunk &C : Chunks) {
+    if (C.InitialState == State) {
+      outs() << C.Output;
+      State = C.FinalState;
+      continue;
+    }
+    for (const SymbolDisassemblyJob &Job : C.Jobs)
+      disassembleSymbol(S, MainSet, Job, State, outs());
+  }
+}
+
 static void disassembleObject(const Target *TheTarget, const ObjectFile *Obj,
-                              MCContext &Ctx, MCDisassembler *PrimaryDisAsm,
-                              MCDisassembler *SecondaryDisAsm,
-                              const MCInstrAnalysis *MIA, MCInstPrinter *IP,
-                              const MCSubtargetInfo *PrimarySTI,
-                              const MCSubtargetInfo *SecondarySTI,
-                              PrettyPrinter &PIP,
-                              SourcePrinter &SP, bool InlineRelocs) {
-  const MCSubtargetInfo *STI = PrimarySTI;
-  MCDisassembler *DisAsm = PrimaryDisAsm;
+                              MCContext &Ctx, const DisassemblerSet &MainSet,
+                              ArrayRef<DisassemblerSet> WorkerSets,
+                              PrettyPrinter &PIP, SourcePrinter &SP,
+                              bool InlineRelocs) {
   bool PrimaryIsThumb = false;
   if (isArmElf(Obj))
-    PrimaryIsThumb = STI->checkFeatures("+thumb-mode");
+    PrimaryIsThumb = MainSet.PrimarySTI->checkFeatures("+thumb-mode");
 
   std::map<SectionRef, std::vector<RelocationRef>> RelocMap;
   if (InlineRelocs)
@@ -1163,6 +1554,7 @@ static void disassembleObject(const Target *TheTarget, const ObjectFile *Obj,
     array_pod_sort(SecSyms.second.begin(), SecSyms.second.end());
   array_pod_sort(AbsoluteSymbols.begin(), AbsoluteSymbols.end());
 
+  DisassemblyState State;
   for (const SectionRef &Section : ToolSectionFilter(*Obj)) {
     if (FilterSections.empty() && !DisassembleAll &&
         (!Section.isText() || Section.isVirtual()))
@@ -1201,6 +1593,8 @@ static void disassembleObject(const Target *TheTarget, const ObjectFile *Obj,
         std::unique_ptr<MCSymbolizer> Symbolizer(
           TheTarget->createMCSymbolizer(
             TripleName, nullptr, nullptr, &Symbols, &Ctx, std::move(RelInfo)));
+        MCDisassembler *DisAsm =
+            State.UsePrimary ? MainSet.PrimaryDisAsm : MainSet.SecondaryDisAsm;
         DisAsm->setSymbolizer(std::move(Symbolizer));
       }
     }
@@ -1221,9 +1615,6 @@ static void disassembleObject(const Target *TheTarget, const ObjectFile *Obj,
                           Section.isText() ? ELF::STT_FUNC : ELF::STT_OBJECT));
     }
 
-    SmallString<40> Comments;
-    raw_svector_ostream CommentStream(Comments);
-
     ArrayRef<uint8_t> Bytes = arrayRefFromStringRef(
         unwrapOrError(Section.getContents(), Obj->getFileName()));
 
@@ -1231,13 +1622,8 @@ static void disassembleObject(const Target *TheTarget, const ObjectFile *Obj,
     if (shouldAdjustVA(Section))
       VMAAdjustment = AdjustVMA;
 
-    uint64_t Size;
-    uint64_t Index;
-    bool PrintedSection = false;
-    std::vector<RelocationRef> Rels = RelocMap[Section];
-    std::vector<RelocationRef>::const_iterator RelCur = Rels.begin();
-    std::vector<RelocationRef>::const_iterator RelEnd = Rels.end();
-    // Disassemble symbol by symbol.
+    // Collect the symbols to disassemble.
+    std::vector<SymbolDisassemblyJob> Jobs;
     for (unsigned SI = 0, SE = Symbols.size(); SI != SE; ++SI) {
       std::string SymbolName = std::get<1>(Symbols[SI]).str();
       if (Demangle)
@@ -1264,14 +1650,6 @@ static void disassembleObject(const Target *TheTarget, const ObjectFile *Obj,
       Start -= SectionAddr;
       End -= SectionAddr;
 
-      if (!PrintedSection) {
-        PrintedSection = true;
-        outs() << "\nDisassembly of section ";
-        if (!SegmentName.empty())
-          outs() << SegmentName << ",";
-        outs() << SectionName << ":\n";
-      }
-
       if (Obj->isELF() && Obj->getArch() == Triple::amdgcn) {
         if (std::get<2>(Symbols[SI]) == ELF::STT_AMDGPU_HSA_KERNEL) {
           // skip amd_kernel_code_t at the begining of kernel symbol (256 bytes)
@@ -1289,194 +1667,31 @@ static void disassembleObject(const Target *TheTarget, const ObjectFile *Obj,
         }
       }
 
-      outs() << '\n';
-      if (!NoLeadingAddr)
-        outs() << format(Is64Bits ? "%016" PRIx64 " " : "%08" PRIx64 " ",
-                         SectionAddr + Start + VMAAdjustment);
-
-      outs() << SymbolName << ":\n";
-
-      // Don't print raw contents of a virtual section. A virtual section
-      // doesn't have any contents in the file.
-      if (Section.isVirtual()) {
-        outs() << "...\n";
-        continue;
-      }
-
-#ifndef NDEBUG
-      raw_ostream &DebugOut = DebugFlag ? dbgs() : nulls();
-#else
-      raw_ostream &DebugOut = nulls();
-#endif
-
-      // Some targets (like WebAssembly) have a special prelude at the start
-      // of each symbol.
-      DisAsm->onSymbolStart(SymbolName, Size, Bytes.slice(Start, End - Start),
-                            SectionAddr + Start, DebugOut, CommentStream);
-      Start += Size;
-
-      Index = Start;
-      if (SectionAddr < StartAddress)
-        Index = std::max<uint64_t>(Index, StartAddress - SectionAddr);
-
-      // If there is a data/common symbol inside an ELF text section and we are
-      // only disassembling text (applicable all architectures), we are in a
-      // situation where we must print the data and not disassemble it.
-      if (Obj->isELF() && !DisassembleAll && Section.isText()) {
-        uint8_t SymTy = std::get<2>(Symbols[SI]);
-        if (SymTy == ELF::STT_OBJECT || SymTy == ELF::STT_COMMON) {
-          dumpELFData(SectionAddr, Index, End, Bytes);
-          Index = End;
-        }
-      }
-
-      bool CheckARMELFData = hasMappingSymbols(Obj) &&
-                             std::get<2>(Symbols[SI]) != ELF::STT_OBJECT &&
-                             !DisassembleAll;
-      while (Index < End) {
-        // ARM and AArch64 ELF binaries can interleave data and text in the
-        // same section. We rely on the markers introduced to understand what
-        // we need to dump. If the data marker is within a function, it is
-        // denoted as a word/short etc.
-        if (CheckARMELFData &&
-            getMappingSymbolKind(MappingSymbols, Index) == 'd') {
-          Index = dumpARMELFData(SectionAddr, Index, End, Obj, Bytes,
-                                 MappingSymbols);
-          continue;
-        }
-
-        // When -z or --disassemble-zeroes are given we always dissasemble
-        // them. Otherwise we might want to skip zero bytes we see.
-        if (!DisassembleZeroes) {
-          uint64_t MaxOffset = End - Index;
-          // For -reloc: print zero blocks patched by relocations, so that
-          // relocations can be shown in the dump.
-          if (RelCur != RelEnd)
-            MaxOffset = RelCur->getOffset() - Index;
-
-          if (size_t N =
-                  countSkippableZeroBytes(Bytes.slice(Index, MaxOffset))) {
-            outs() << "\t\t..." << '\n';
-            Index += N;
-            continue;
-          }
-        }
-
-        if (SecondarySTI) {
-          if (getMappingSymbolKind(MappingSymbols, Index) == 'a') {
-            STI = PrimaryIsThumb ? SecondarySTI : PrimarySTI;
-            DisAsm = PrimaryIsThumb ? SecondaryDisAsm : PrimaryDisAsm;
-          } else if (getMappingSymbolKind(MappingSymbols, Index) == 't') {
-            STI = PrimaryIsThumb ? PrimarySTI : SecondarySTI;
-            DisAsm = PrimaryIsThumb ? PrimaryDisAsm : SecondaryDisAsm;
-          }
-        }
+      Jobs.push_back({SI, std::move(SymbolName), Start, End});
+    }
 
-        // Disassemble a real instruction or a data when disassemble all is
-        // provided
-        MCInst Inst;
-        bool Disassembled = DisAsm->getInstruction(
-            Inst, Size, Bytes.slice(Index), SectionAddr + Index, DebugOut,
-            CommentStream);
-        if (Size == 0)
-          Size = 1;
-
-        PIP.printInst(
-            *IP, Disassembled ? &Inst : nullptr, Bytes.slice(Index, Size),
-            {SectionAddr + Index + VMAAdjustment, Section.getIndex()}, outs(),
-            "", *STI, &SP, &Rels);
-        outs() << CommentStream.str();
-        Comments.clear();
-
-        // Try to resolve the target of a call, tail call, etc. to a specific
-        // symbol.
-        if (MIA && (MIA->isCall(Inst) || MIA->isUnconditionalBranch(Inst) ||
-                    MIA->isConditionalBranch(Inst))) {
-          uint64_t Target;
-          if (MIA->evaluateBranch(Inst, SectionAddr + Index, Size, Target)) {
-            // In a relocatable object, the target's section must reside in
-            // the same section as the call instruction or it is accessed
-            // through a relocation.
-            //
-            // In a non-relocatable object, the target may be in any section.
-            //
-            // N.B. We don't walk the relocations in the relocatable case yet.
-            auto *TargetSectionSymbols = &Symbols;
-            if (!Obj->isRelocatableObject()) {
-              auto It = partition_point(
-                  SectionAddresses,
-                  [=](const std::pair<uint64_t, SectionRef> &O) {
-                    return O.first <= Target;
-                  });
-              if (It != SectionAddresses.begin()) {
-                --It;
-                TargetSectionSymbols = &AllSymbols[It->second];
-              } else {
-                TargetSectionSymbols = &AbsoluteSymbols;
-              }
-            }
-
-            // Find the last symbol in the section whose offset is less than
-            // or equal to the target. If there isn't a section that contains
-            // the target, find the nearest preceding absolute symbol.
-            auto TargetSym = partition_point(
-                *TargetSectionSymbols,
-                [=](const std::tuple<uint64_t, StringRef, uint8_t> &O) {
-                  return std::get<0>(O) <= Target;
-                });
-            if (TargetSym == TargetSectionSymbols->begin()) {
-              TargetSectionSymbols = &AbsoluteSymbols;
-              TargetSym = partition_point(
-                  AbsoluteSymbols,
-                  [=](const std::tuple<uint64_t, StringRef, uint8_t> &O) {
-                    return std::get<0>(O) <= Target;
-                  });
-            }
-            if (TargetSym != TargetSectionSymbols->begin()) {
-              --TargetSym;
-              uint64_t TargetAddress = std::get<0>(*TargetSym);
-              StringRef TargetName = std::get<1>(*TargetSym);
-              outs() << " <" << TargetName;
-              uint64_t Disp = Target - TargetAddress;
-              if (Disp)
-                outs() << "+0x" << Twine::utohexstr(Disp);
-              outs() << '>';
-            }
-          }
-        }
-        outs() << "\n";
-
-        // Hexagon does this in pretty printer
-        if (Obj->getArch() != Triple::hexagon) {
-          // Print relocation for instruction.
-          while (RelCur != RelEnd) {
-            uint64_t Offset = RelCur->getOffset();
-            // If this relocation is hidden, skip it.
-            if (getHidden(*RelCur) || SectionAddr + Offset < StartAddress) {
-              ++RelCur;
-              continue;
-            }
-
-            // Stop when RelCur's offset is past the current instruction.
-            if (Offset >= Index + Size)
-              break;
-
-            // When --adjust-vma is used, update the address printed.
-            if (RelCur->getSymbol() != Obj->symbol_end()) {
-              Expected<section_iterator> SymSI =
-                  RelCur->getSymbol()->getSection();
-              if (SymSI && *SymSI != Obj->section_end() &&
-                  shouldAdjustVA(**SymSI))
-                Offset += AdjustVMA;
-            }
-
-            printRelocation(*RelCur, SectionAddr + Offset, Is64Bits);
-            ++RelCur;
-          }
-        }
+    if (Jobs.empty())
+      continue;
 
-        Index += Size;
-      }
+    outs() << "\nDisassembly of section ";
+    if (!SegmentName.empty())
+      outs() << SegmentName << ",";
+    outs() << SectionName << ":\n";
+
+    std::vector<RelocationRef> &Rels = RelocMap[Section];
+    SectionDisassemblyInfo S{Obj,           Section,        SectionAddr,
+                             Bytes,         Symbols,        MappingSymbols,
+                             Rels,          VMAAdjustment,  Is64Bits,
+                             PrimaryIsThumb, AllSymbols,    AbsoluteSymbols,
+                             SectionAddresses, PIP,         SP};
+    State.RelCur = Rels.begin();
+    State.Comments.clear();
+
+    if (WorkerSets.empty() || Jobs.size() == 1) {
+      for (const SymbolDisassemblyJob &Job : Jobs)
+        disassembleSymbol(S, MainSet, Job, State, outs());
+    } else {
+      disassembleSectionInParallel(S, Jobs, MainSet, WorkerSets, State);
     }
   }
   StringSet<> MissingDisasmFuncsSet =
@@ -1485,6 +1700,29 @@ static void disassembleObject(const Target *TheTarget, const ObjectFile *Obj,
     warn("failed to disassemble missing function " + MissingDisasmFunc);
 }
 
+namespace {
+/// The objects backing a DisassemblerSet owned by one worker thread.
+struct WorkerDisassembler {
+  MCObjectFileInfo MOFI;
+  std::unique_ptr<MCContext> Ctx;
+  std::unique_ptr<MCDisassembler> DisAsm;
+  std::unique_ptr<MCDisassembler> SecondaryDisAsm;
+  std::unique_ptr<MCInstPrinter> IP;
+};
+} // end anonymous namespace
+
+// Returns whether symbols can be disassembled on several threads without
+// changing the output.
+static bool canDisassembleInParallel(const ObjectFile *Obj) {
+  // Source and line printing remember the previous line across symbols, and
+  // the symbolizer is not thread safe. The AMDGPU disassembler keeps a
+  // symbolizer per section and Hexagon prints relocations from its pretty
+  // printer. With -D, ARM data decoded as an IT instruction could leak IT
+  // state into the next symbol.
+  return !PrintSource && !PrintLines && !DisassembleAll &&
+         Obj->getArch() != Triple::amdgcn && Obj->getArch() != Triple::hexagon;
+}
+
 static void disassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
   const Target *TheTarget = getTarget(Obj);
 
@@ -1546,23 +1784,49 @@ static void disassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
       TheTarget->createMCInstrAnalysis(MII.get()));
 
   int AsmPrinterVariant = AsmInfo->getAssemblerDialect();
-  std::unique_ptr<MCInstPrinter> IP(TheTarget->createMCInstPrinter(
-      Triple(TripleName), AsmPrinterVariant, *AsmInfo, *MII, *MRI));
-  if (!IP)
-    report_error(Obj->getFileName(),
-                 "no instruction printer for target " + TripleName);
-  IP->setPrintImmHex(PrintImmHex);
+  auto CreateInstPrinter = [&]() {
+    std::unique_ptr<MCInstPrinter> IP(TheTarget->createMCInstPrinter(
+        Triple(TripleName), AsmPrinterVariant, *AsmInfo, *MII, *MRI));
+    if (!IP)
+      report_error(Obj->getFileName(),
+                   "no instruction printer for target " + TripleName);
+    IP->setPrintImmHex(PrintImmHex);
+
+    for (StringRef Opt : DisassemblerOptions)
+      if (!IP->applyTargetSpecificCLOption(Opt))
+        error("Unrecognized disassembler option: " + Opt);
+    return IP;
+  };
+  std::unique_ptr<MCInstPrinter> IP = CreateInstPrinter();
 
   PrettyPrinter &PIP = selectPrettyPrinter(Triple(TripleName));
   SourcePrinter SP(Obj, TheTarget->getName());
 
-  for (StringRef Opt : DisassemblerOptions)
-    if (!IP->applyTargetSpecificCLOption(Opt))
-      error("Unrecognized disassembler option: " + Opt);
+  DisassemblerSet MainSet{DisAsm.get(), SecondaryDisAsm.get(), STI.get(),
+                          SecondarySTI.get(), MIA.get(), IP.get()};
+
+  // Give every worker thread its own context, disassemblers and printer.
+  std::vector<std::unique_ptr<WorkerDisassembler>> Workers;
+  std::vector<DisassemblerSet> WorkerSets;
+  if (DisassembleThreads > 1 && canDisassembleInParallel(Obj)) {
+    for (unsigned I = 0; I != DisassembleThreads; ++I) {
+      auto W = llvm::make_unique<WorkerDisassembler>();
+      W->Ctx = llvm::make_unique<MCContext>(AsmInfo.get(), MRI.get(), &W->MOFI);
+      W->MOFI.InitMCObjectFileInfo(Triple(TripleName), false, *W->Ctx);
+      W->DisAsm.reset(TheTarget->createMCDisassembler(*STI, *W->Ctx));
+      if (SecondarySTI)
+        W->SecondaryDisAsm.reset(
+            TheTarget->createMCDisassembler(*SecondarySTI, *W->Ctx));
+      W->IP = CreateInstPrinter();
+      WorkerSets.push_back({W->DisAsm.get(), W->SecondaryDisAsm.get(),
+                            STI.get(), SecondarySTI.get(), MIA.get(),
+                            W->IP.get()});
+      Workers.push_back(std::move(W));
+    }
+  }
 
-  disassembleObject(TheTarget, Obj, Ctx, DisAsm.get(), SecondaryDisAsm.get(),
-                    MIA.get(), IP.get(), STI.get(), SecondarySTI.get(), PIP,
-                    SP, InlineRelocs);
+  disassembleObject(TheTarget, Obj, Ctx, MainSet, WorkerSets, PIP, SP,
+                    InlineRelocs);
 }
 
 void printRelocations(const ObjectFile *Obj) {
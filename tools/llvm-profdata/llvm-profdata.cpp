@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/ADT/SmallSet.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/IR/LLVMContext.h"
@@ -22,6 +23,7 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FileUtilities.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/InitLLVM.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -226,9 +228,21 @@ static void overlapInput(const std::string &BaseFilename,
   }
 }
 
-/// Load an input into a writer context.
-static void loadInput(const WeightedFile &Input, SymbolRemapper *Remapper,
-                      WriterContext *WC) {
+/// Return the shard that the function \p FuncName is merged in.
+static unsigned getShard(StringRef FuncName, unsigned NumShards) {
+  return IndexedInstrProf::ComputeHash(FuncName) % NumShards;
+}
+
+/// Load an input into a writer context. If \p ShardWriters is not empty, the
+/// records are split by shard between them instead. Errors are attributed to
+/// \p Whence, or to the input if it is empty. If \p Buffer is given, the
+/// profile is read from it instead of the input file.
+static void
+loadInput(const WeightedFile &Input, SymbolRemapper *Remapper,
+          WriterContext *WC,
+          ArrayRef<std::unique_ptr<InstrProfWriter>> ShardWriters = None,
+          StringRef Whence = "",
+          std::unique_ptr<MemoryBuffer> Buffer = nullptr) {
   std::unique_lock<std::mutex> CtxGuard{WC->Lock};
 
   // If there's a pending hard error, don't do more work.
@@ -238,9 +252,11 @@ static void loadInput(const WeightedFile &Input, SymbolRemapper *Remapper,
   // Copy the filename, because llvm::ThreadPool copied the input "const
   // WeightedFile &" by value, making a reference to the filename within it
   // invalid outside of this packaged task.
-  WC->ErrWhence = Input.Filename;
+  WC->ErrWhence = Whence.empty() ? Input.Filename : Whence.str();
+  Whence = WC->ErrWhence;
 
-  auto ReaderOrErr = InstrProfReader::create(Input.Filename);
+  auto ReaderOrErr = Buffer ? InstrProfReader::create(std::move(Buffer))
+                            : InstrProfReader::create(Input.Filename);
   if (Error E = ReaderOrErr.takeError()) {
     // Skip the empty profiles by returning sliently.
     instrprof_error IPE = InstrProfError::take(std::move(E));
@@ -258,13 +274,19 @@ static void loadInput(const WeightedFile &Input, SymbolRemapper *Remapper,
         std::error_code());
     return;
   }
+  for (const auto &Writer : ShardWriters)
+    consumeError(Writer->setIsIRLevelProfile(IsIRProfile, HasCSIRProfile));
 
   for (auto &I : *Reader) {
     if (Remapper)
       I.Name = (*Remapper)(I.Name);
+    InstrProfWriter &Writer =
+        ShardWriters.empty()
+            ? WC->Writer
+            : *ShardWriters[getShard(I.Name, ShardWriters.size())];
     const StringRef FuncName = I.Name;
     bool Reported = false;
-    WC->Writer.addRecord(std::move(I), Input.Weight, [&](Error E) {
+    Writer.addRecord(std::move(I), Input.Weight, [&](Error E) {
       if (Reported) {
         consumeError(std::move(E));
         return;
@@ -274,8 +296,8 @@ static void loadInput(const WeightedFile &Input, SymbolRemapper *Remapper,
       instrprof_error IPE = InstrProfError::take(std::move(E));
       std::unique_lock<std::mutex> ErrGuard{WC->ErrLock};
       bool firstTime = WC->WriterErrorCodes.insert(IPE).second;
-      handleMergeWriterError(make_error<InstrProfError>(IPE), Input.Filename,
-                             FuncName, firstTime);
+      handleMergeWriterError(make_error<InstrProfError>(IPE), Whence, FuncName,
+                             firstTime);
     });
   }
   if (Reader->hasError()) {
@@ -305,11 +327,253 @@ static void mergeWriterContexts(WriterContext *Dst, WriterContext *Src) {
   });
 }
 
+/// Report a deferred hard error, exiting if it is fatal.
+static void handleDeferredError(Error E, StringRef Whence) {
+  if (!E)
+    return;
+  if (!E.isA<InstrProfError>())
+    exitWithError(std::move(E), Whence);
+
+  instrprof_error IPE = InstrProfError::take(std::move(E));
+  if (isFatalError(IPE))
+    exitWithError(make_error<InstrProfError>(IPE), Whence);
+  else
+    warn(toString(make_error<InstrProfError>(IPE)), Whence);
+}
+
+namespace {
+/// The temporary file of a shard. The partitions of the shard, one per input,
+/// are appended to it as the inputs are read, followed by the merged shard,
+/// so that there is a single temporary file per shard however many inputs
+/// there are.
+struct ShardFile {
+  std::mutex Lock;
+  std::string Filename;
+  FileRemover Remover;
+  uint64_t Size = 0;
+};
+
+/// The location of an indexed profile in a shard file. An empty slice stands
+/// for a partition or a shard without records.
+struct ShardSlice {
+  uint64_t Offset = 0;
+  uint64_t Size = 0;
+};
+} // end anonymous namespace
+
+/// Append \p Writer as an indexed profile to \p File, creating the file if
+/// this is its first profile, and store where it is in \p Slice. Errors are
+/// deferred in \p WC.
+static void writeShardSlice(InstrProfWriter &Writer, ShardFile &File,
+                            ShardSlice &Slice, WriterContext *WC) {
+  // The writer patches the header once the records are written, so it cannot
+  // write to a file opened for appending.
+  std::unique_ptr<MemoryBuffer> Buffer = Writer.writeBuffer();
+
+  std::lock_guard<std::mutex> Guard(File.Lock);
+  std::error_code EC;
+  if (File.Filename.empty()) {
+    SmallString<128> Path;
+    EC = sys::fs::createTemporaryFile("profdata-shard", "profdata", Path);
+    if (EC) {
+      WC->Err = errorCodeToError(EC);
+      WC->ErrWhence = "profdata-shard";
+      return;
+    }
+    File.Remover.setFile(Path);
+    File.Filename = Path.str();
+  }
+
+  raw_fd_ostream Output(File.Filename, EC, sys::fs::F_Append);
+  if (EC) {
+    WC->Err = errorCodeToError(EC);
+    WC->ErrWhence = File.Filename;
+    return;
+  }
+  // Keep each profile 8-byte aligned, as the reader expects of its buffer
+  // when the slice is mapped from the file.
+  uint64_t Padding = alignTo(File.Size, 8) - File.Size;
+  Output.write_zeros(Padding);
+  Output << Buffer->getBuffer();
+  Slice.Offset = File.Size + Padding;
+  Slice.Size = Buffer->getBufferSize();
+  File.Size = Slice.Offset + Slice.Size;
+}
+
+/// Return the indexed profile at \p Slice of \p File.
+static ErrorOr<std::unique_ptr<MemoryBuffer>>
+readShardSlice(const ShardFile &File, const ShardSlice &Slice) {
+  return MemoryBuffer::getFileSlice(File.Filename, Slice.Size, Slice.Offset);
+}
+
+/// Read \p Input once and split its records by shard into indexed profiles,
+/// with the weight of the input applied. The partitions are appended to
+/// \p Files, and where they are is stored in \p Parts.
+static void partitionInput(const WeightedFile &Input, SymbolRemapper *Remapper,
+                           MutableArrayRef<ShardFile> Files,
+                           MutableArrayRef<ShardSlice> Parts,
+                           WriterContext *WC) {
+  std::vector<std::unique_ptr<InstrProfWriter>> ShardWriters;
+  for (unsigned Shard = 0; Shard < Files.size(); ++Shard)
+    ShardWriters.push_back(llvm::make_unique<InstrProfWriter>());
+  loadInput(Input, Remapper, WC, ShardWriters, Input.Filename);
+  for (unsigned Shard = 0; Shard < Files.size() && !WC->Err; ++Shard) {
+    if (!ShardWriters[Shard]->empty())
+      writeShardSlice(*ShardWriters[Shard], Files[Shard], Parts[Shard], WC);
+    // Release each partition as soon as it is written.
+    ShardWriters[Shard].reset();
+  }
+}
+
+/// Merge the partitions \p Parts of one shard, one per input, into an indexed
+/// profile appended to \p File, whose location is stored in \p Merged. It is
+/// left empty if the shard has no records.
+static void mergeShard(const WeightedFileVector &Inputs, ShardFile &File,
+                       ArrayRef<ShardSlice> Parts, ShardSlice &Merged,
+                       WriterContext *WC) {
+  for (unsigned I = 0; I < Inputs.size() && !WC->Err; ++I) {
+    if (!Parts[I].Size)
+      continue;
+    auto BufferOrErr = readShardSlice(File, Parts[I]);
+    if (std::error_code EC = BufferOrErr.getError()) {
+      WC->Err = errorCodeToError(EC);
+      WC->ErrWhence = File.Filename;
+      return;
+    }
+    // Warnings name the original inputs.
+    loadInput({File.Filename, 1}, nullptr, WC, None, Inputs[I].Filename,
+              std::move(BufferOrErr.get()));
+  }
+  if (!WC->Err && !WC->Writer.empty())
+    writeShardSlice(WC->Writer, File, Merged, WC);
+}
+
+/// Merge the inputs shard by shard. Every function is assigned to one of
+/// \p NumShards shards by the hash of its name. Each input is read once and
+/// split into one partition per shard, appended to the temporary file of the
+/// shard, then the partitions of each shard are merged into an indexed
+/// profile at the end of the same file. Finally, the output is written
+/// with only the function names and hashes in memory; the records of each
+/// function are read from its shard as the function is written out.
+static void mergeInstrProfileSharded(
+    const WeightedFileVector &Inputs, SymbolRemapper *Remapper,
+    StringRef OutputFilename, ProfileFormat OutputFormat, bool OutputSparse,
+    unsigned NumThreads, unsigned NumShards, std::mutex &ErrorLock,
+    SmallSet<instrprof_error, 4> &WriterErrorCodes) {
+  // Parts[I][Shard] is the partition of shard Shard of input I. The temporary
+  // files are only created for shards with records.
+  std::vector<ShardFile> Files(NumShards);
+  std::vector<std::vector<ShardSlice>> Parts(
+      Inputs.size(), std::vector<ShardSlice>(NumShards));
+  std::vector<ShardSlice> Merged(NumShards);
+
+  SmallVector<std::unique_ptr<WriterContext>, 4> InputContexts;
+  for (unsigned I = 0; I < Inputs.size(); ++I)
+    InputContexts.emplace_back(
+        llvm::make_unique<WriterContext>(false, ErrorLock, WriterErrorCodes));
+
+  // Only the errors of each shard are kept once it has been written, so that
+  // at most NumThreads shards are in memory at once.
+  std::vector<Error> ShardErrors;
+  std::vector<std::string> ShardErrWhence(NumShards);
+  for (unsigned Shard = 0; Shard < NumShards; ++Shard)
+    ShardErrors.push_back(Error::success());
+
+  auto Partition = [&](unsigned I) {
+    partitionInput(Inputs[I], Remapper, Files, Parts[I],
+                   InputContexts[I].get());
+  };
+  auto Merge = [&](unsigned Shard) {
+    std::vector<ShardSlice> ShardParts;
+    for (unsigned I = 0; I < Inputs.size(); ++I)
+      ShardParts.push_back(Parts[I][Shard]);
+    WriterContext WC(OutputSparse, ErrorLock, WriterErrorCodes);
+    mergeShard(Inputs, Files[Shard], ShardParts, Merged[Shard], &WC);
+    ShardErrors[Shard] =
+        joinErrors(std::move(ShardErrors[Shard]), std::move(WC.Err));
+    ShardErrWhence[Shard] = std::move(WC.ErrWhence);
+  };
+
+  if (NumThreads == 1) {
+    for (unsigned I = 0; I < Inputs.size(); ++I)
+      Partition(I);
+  } else {
+    ThreadPool Pool(NumThreads);
+    for (unsigned I = 0; I < Inputs.size(); ++I)
+      Pool.async(Partition, I);
+    Pool.wait();
+  }
+  // Errors reading an input are reported once, not once per shard.
+  for (std::unique_ptr<WriterContext> &WC : InputContexts)
+    handleDeferredError(std::move(WC->Err), WC->ErrWhence);
+
+  if (NumThreads == 1) {
+    for (unsigned Shard = 0; Shard < NumShards; ++Shard)
+      Merge(Shard);
+  } else {
+    ThreadPool Pool(NumThreads);
+    for (unsigned Shard = 0; Shard < NumShards; ++Shard)
+      Pool.async(Merge, Shard);
+    Pool.wait();
+  }
+  for (unsigned Shard = 0; Shard < NumShards; ++Shard)
+    handleDeferredError(std::move(ShardErrors[Shard]), ShardErrWhence[Shard]);
+
+  // The shards hold disjoint sets of functions with the weights already
+  // applied, so the output only needs to know which functions there are.
+  InstrProfWriter Writer;
+  std::vector<std::unique_ptr<IndexedInstrProfReader>> ShardReaders(NumShards);
+  for (unsigned Shard = 0; Shard < NumShards; ++Shard) {
+    if (!Merged[Shard].Size)
+      continue;
+    auto BufferOrErr = readShardSlice(Files[Shard], Merged[Shard]);
+    if (std::error_code EC = BufferOrErr.getError())
+      exitWithErrorCode(EC, Files[Shard].Filename);
+    auto ReaderOrErr =
+        IndexedInstrProfReader::create(std::move(BufferOrErr.get()));
+    if (Error E = ReaderOrErr.takeError())
+      exitWithError(std::move(E), Files[Shard].Filename);
+    ShardReaders[Shard] = std::move(ReaderOrErr.get());
+    IndexedInstrProfReader &Reader = *ShardReaders[Shard];
+    if (Error E = Writer.setIsIRLevelProfile(Reader.isIRLevelProfile(),
+                                             Reader.hasCSIRLevelProfile())) {
+      consumeError(std::move(E));
+      exitWithError("Merge IR generated profile with Clang generated profile.");
+    }
+    for (const auto &I : Reader)
+      Writer.addDeferredRecord(I.Name, I.Hash);
+    instrprof_error IPE = InstrProfError::take(Reader.getError());
+    if (isFatalError(IPE))
+      exitWithError(make_error<InstrProfError>(IPE), Files[Shard].Filename);
+  }
+
+  auto Load = [&](StringRef Name, uint64_t Hash) {
+    unsigned Shard = getShard(Name, NumShards);
+    Expected<InstrProfRecord> Record =
+        ShardReaders[Shard]->getInstrProfRecord(Name, Hash);
+    if (Error E = Record.takeError())
+      exitWithError(std::move(E), Files[Shard].Filename);
+    return std::move(Record.get());
+  };
+
+  std::error_code EC;
+  raw_fd_ostream Output(OutputFilename.data(), EC, sys::fs::F_None);
+  if (EC)
+    exitWithErrorCode(EC, OutputFilename);
+
+  if (OutputFormat == PF_Text) {
+    if (Error E = Writer.writeText(Output, Load))
+      exitWithError(std::move(E));
+  } else {
+    Writer.write(Output, Load);
+  }
+}
+
 static void mergeInstrProfile(const WeightedFileVector &Inputs,
                               SymbolRemapper *Remapper,
                               StringRef OutputFilename,
                               ProfileFormat OutputFormat, bool OutputSparse,
-                              unsigned NumThreads) {
+                              unsigned NumThreads, unsigned NumShards) {
   if (OutputFilename.compare("-") == 0)
     exitWithError("Cannot write indexed profdata format to stdout.");
 
@@ -322,8 +586,16 @@ static void mergeInstrProfile(const WeightedFileVector &Inputs,
 
   // If NumThreads is not specified, auto-detect a good default.
   if (NumThreads == 0)
-    NumThreads =
-        std::min(hardware_concurrency(), unsigned((Inputs.size() + 1) / 2));
+    NumThreads = std::min(hardware_concurrency(),
+                          NumShards > 1 ? NumShards
+                                        : unsigned((Inputs.size() + 1) / 2));
+
+  if (NumShards > 1) {
+    mergeInstrProfileSharded(Inputs, Remapper, OutputFilename, OutputFormat,
+                             OutputSparse, NumThreads, NumShards, ErrorLock,
+                             WriterErrorCodes);
+    return;
+  }
 
   // Initialize the writer contexts.
   SmallVector<std::unique_ptr<WriterContext>, 4> Contexts;
@@ -340,7 +612,8 @@ static void mergeInstrProfile(const WeightedFileVector &Inputs,
     // Load the inputs in parallel (N/NumThreads serial steps).
     unsigned Ctx = 0;
     for (const auto &Input : Inputs) {
-      Pool.async(loadInput, Input, Remapper, Contexts[Ctx].get());
+      Pool.async(loadInput, Input, Remapper, Contexts[Ctx].get(), None,
+                 StringRef(), nullptr);
       Ctx = (Ctx + 1) % NumThreads;
     }
     Pool.wait();
@@ -365,19 +638,8 @@ static void mergeInstrProfile(const WeightedFileVector &Inputs,
   }
 
   // Handle deferred hard errors encountered during merging.
-  for (std::unique_ptr<WriterContext> &WC : Contexts) {
-    if (!WC->Err)
-      continue;
-    if (!WC->Err.isA<InstrProfError>())
-      exitWithError(std::move(WC->Err), WC->ErrWhence);
-
-    instrprof_error IPE = InstrProfError::take(std::move(WC->Err));
-    if (isFatalError(IPE))
-      exitWithError(make_error<InstrProfError>(IPE), WC->ErrWhence);
-    else
-      warn(toString(make_error<InstrProfError>(IPE)),
-           WC->ErrWhence);
-  }
+  for (std::unique_ptr<WriterContext> &WC : Contexts)
+    handleDeferredError(std::move(WC->Err), WC->ErrWhence);
 
   std::error_code EC;
   raw_fd_ostream Output(OutputFilename.data(), EC, sys::fs::F_None);
@@ -431,7 +693,8 @@ static sampleprof::SampleProfileFormat FormatMap[] = {
 static void mergeSampleProfile(const WeightedFileVector &Inputs,
                                SymbolRemapper *Remapper,
                                StringRef OutputFilename,
-                               ProfileFormat OutputFormat) {
+                               ProfileFormat OutputFormat,
+                               bool UseFuncOffsetTable) {
   using namespace sampleprof;
   StringMap<FunctionSamples> ProfileMap;
   SmallVector<std::unique_ptr<sampleprof::SampleProfileReader>, 5> Readers;
@@ -473,6 +736,8 @@ static void mergeSampleProfile(const WeightedFileVector &Inputs,
     exitWithErrorCode(EC, OutputFilename);
 
   auto Writer = std::move(WriterOrErr.get());
+  if (UseFuncOffsetTable)
+    Writer->setUseFuncOffsetTable();
   Writer->write(ProfileMap);
 }
 
@@ -591,11 +856,20 @@ static int merge_main(int argc, const char *argv[]) {
                             "GCC encoding (only meaningful for -sample)")));
   cl::opt<bool> OutputSparse("sparse", cl::init(false),
       cl::desc("Generate a sparse profile (only meaningful for -instr)"));
+  cl::opt<bool> UseFuncOffsetTable(
+      "func-offset-table", cl::init(false),
+      cl::desc("Write a function offset table so that the compiler decodes "
+               "only the profiles it needs (only meaningful for -sample "
+               "-binary; -compbinary always has one)"));
   cl::opt<unsigned> NumThreads(
       "num-threads", cl::init(0),
       cl::desc("Number of merge threads to use (default: autodetect)"));
   cl::alias NumThreadsA("j", cl::desc("Alias for --num-threads"),
                         cl::aliasopt(NumThreads));
+  cl::opt<unsigned> NumShards(
+      "num-shards", cl::init(0),
+      cl::desc("Merge the functions in this many shards, one shard per thread "
+               "at a time, to bound memory use (only meaningful for -instr)"));
 
   cl::ParseCommandLineOptions(argc, argv, "LLVM profile data merger\n");
 
@@ -626,10 +900,10 @@ static int merge_main(int argc, const char *argv[]) {
 
   if (ProfileKind == instr)
     mergeInstrProfile(WeightedInputs, Remapper.get(), OutputFilename,
-                      OutputFormat, OutputSparse, NumThreads);
+                      OutputFormat, OutputSparse, NumThreads, NumShards);
   else
     mergeSampleProfile(WeightedInputs, Remapper.get(), OutputFilename,
-                       OutputFormat);
+                       OutputFormat, UseFuncOffsetTable);
 
   return 0;
 }
@@ -36,6 +36,7 @@
 #include "llvm/Object/ELFTypes.h"
 #include "llvm/Object/Error.h"
 #include "llvm/Object/ObjectFile.h"
+#include "llvm/Object/SilhouetteSiteTable.h"
 #include "llvm/Object/StackMapParser.h"
 #include "llvm/Support/AMDGPUMetadata.h"
 #include "llvm/Support/ARMAttributeParser.h"
@@ -167,6 +168,7 @@ public:
   void printGroupSections() override;
 
   void printAttributes() override;
+  void printSilhouetteSites() override;
   void printMipsPLTGOT() override;
   void printMipsABIFlags() override;
   void printMipsReginfo() override;
@@ -2054,6 +2056,33 @@ template <class ELFT> void ELFDumper<ELFT>::printAttributes() {
   W.startLine() << "Attributes not implemented.\n";
 }
 
+template <class ELFT> void ELFDumper<ELFT>::printSilhouetteSites() {
+  const ELFFile<ELFT> *Obj = ObjF->getELFFile();
+  ListScope L(W, "SilhouetteSites");
+  // Relocatable objects have one table section per function.
+  for (const Elf_Shdr &Sec : unwrapOrError(Obj->sections())) {
+    StringRef Name = unwrapOrError(Obj->getSectionName(&Sec));
+    if (Name != silhouette::SiteTableSectionName)
+      continue;
+
+    ArrayRef<uint8_t> Contents = unwrapOrError(Obj->getSectionContents(&Sec));
+    SilhouetteSiteTable Table =
+        error(SilhouetteSiteTable::parse<ELFT::TargetEndianness>(Contents));
+    for (const SilhouetteFunctionSites &F : Table.functions()) {
+      DictScope D(W, "Function");
+      W.printHex("Address", F.FunctionAddress);
+      W.printNumber("NumSites", F.Sites.size());
+      ListScope S(W, "Sites");
+      for (const SilhouetteSite &Site : F.Sites) {
+        DictScope E(W, "Site");
+        W.printHex("Address", Site.Address);
+        W.printNumber("Length", Site.Length);
+        W.printString("Kind", getSilhouetteSiteKindName(Site.Kind));
+      }
+    }
+  }
+}
+
 namespace {
 
 template <> void ELFDumper<ELF32LE>::printAttributes() {
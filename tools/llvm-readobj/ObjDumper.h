@@ -71,6 +71,7 @@ public:
 
   // Only implemented for ARM ELF at this time.
   virtual void printAttributes() { }
+  virtual void printSilhouetteSites() { }
 
   // Only implemented for MIPS ELF at this time.
   virtual void printMipsPLTGOT() { }
@@ -235,6 +235,11 @@ namespace opts {
   cl::opt<bool> ARMAttributes("arm-attributes",
                               cl::desc("Display the ARM attributes section"));
 
+  // --silhouette-sites
+  cl::opt<bool> SilhouetteSites(
+      "silhouette-sites",
+      cl::desc("Display the Silhouette instrumentation site tables"));
+
   // --mips-plt-got
   cl::opt<bool>
   MipsPLTGOT("mips-plt-got",
@@ -519,9 +524,12 @@ static void dumpObject(const ObjectFile *Obj, ScopedPrinter &Writer,
   if (Obj->isELF()) {
     if (opts::ELFLinkerOptions)
       Dumper->printELFLinkerOptions();
-    if (Obj->getArch() == llvm::Triple::arm)
+    if (Obj->getArch() == llvm::Triple::arm) {
       if (opts::ARMAttributes)
         Dumper->printAttributes();
+      if (opts::SilhouetteSites)
+        Dumper->printSilhouetteSites();
+    }
     if (isMipsArch(Obj->getArch())) {
       if (opts::MipsPLTGOT)
         Dumper->printMipsPLTGOT();
@@ -0,0 +1,276 @@
+//===-- llvm-stack-depth.cpp - Worst-case stack depth of a program --------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This program combines the stack usage records that llc writes with
+// -arm-stack-usage for each module of a program, or once for the whole
+// program under LTO, and reports the worst-case stack depth of each entry
+// point of the program, such as main, the interrupt handlers and the RTOS
+// tasks.
+//
+// Recursion, calls through unknown function pointers, dynamic stack
+// allocations and calls to functions without records make the depth of the
+// entry points that reach them a lower bound, and are reported as warnings.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/LineIterator.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/WithColor.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+static cl::list<std::string> InputFileNames(cl::Positional,
+                                            cl::desc("<stack usage files>"),
+                                            cl::OneOrMore);
+
+static cl::list<std::string>
+    Entries("entry", cl::desc("Report the stack depth of this function"),
+            cl::value_desc("function"), cl::ZeroOrMore);
+
+static cl::list<std::string>
+    Tasks("task", cl::desc("Report the stack depth of this RTOS task function"),
+          cl::value_desc("function"), cl::ZeroOrMore);
+
+static cl::opt<unsigned>
+    Limit("limit",
+          cl::desc("Fail if the stack depth of an entry point exceeds this "
+                   "many bytes"),
+          cl::value_desc("bytes"), cl::init(0));
+
+namespace {
+
+struct FunctionNode {
+  StringRef Name;
+  uint64_t Frame = 0;
+  bool HasRecord = false;
+  bool Dynamic = false;
+  bool ShadowStack = false;
+  bool Interrupt = false;
+  bool UnknownIndirectCall = false;
+  bool Called = false;
+  SetVector<FunctionNode *> Calls;
+  SetVector<FunctionNode *> TailCalls;
+
+  // Worst-case depth from the entry of this function, and the callee on the
+  // path to it, if any.
+  enum { Unvisited, Active, Done } State = Unvisited;
+  uint64_t Depth = 0;
+  FunctionNode *Next = nullptr;
+  bool Recursive = false;
+};
+
+class CallGraph {
+  StringMap<FunctionNode> Nodes;
+  // The functions, in the order they were first seen.
+  std::vector<FunctionNode *> Order;
+
+public:
+  FunctionNode &getNode(StringRef Name) {
+    auto Inserted = Nodes.try_emplace(Name);
+    FunctionNode &N = Inserted.first->second;
+    if (Inserted.second) {
+      N.Name = Inserted.first->first();
+      Order.push_back(&N);
+    }
+    return N;
+  }
+
+  ArrayRef<FunctionNode *> functions() const { return Order; }
+
+  Error read(StringRef FileName, const MemoryBuffer &Buffer);
+  uint64_t computeDepth(FunctionNode &N);
+};
+
+} // end anonymous namespace
+
+static Error makeParseError(StringRef FileName, int64_t LineNo,
+                            const Twine &Msg) {
+  return make_error<StringError>(FileName + ":" + Twine(LineNo) + ": " + Msg,
+                                 inconvertibleErrorCode());
+}
+
+Error CallGraph::read(StringRef FileName, const MemoryBuffer &Buffer) {
+  FunctionNode *Current = nullptr;
+  for (line_iterator Line(Buffer, /*SkipBlanks=*/true, '#'); !Line.is_at_eof();
+       ++Line) {
+    SmallVector<StringRef, 8> Fields;
+    Line->split(Fields, ' ', -1, /*KeepEmpty=*/false);
+    StringRef Kind = Fields[0];
+
+    if (Kind == "function") {
+      uint64_t Frame;
+      if (Fields.size() < 4 || Fields[2] != "frame" ||
+          Fields[3].getAsInteger(10, Frame))
+        return makeParseError(FileName, Line.line_number(),
+                              "malformed function record");
+      Current = &getNode(Fields[1]);
+      // A function may be defined in several modules, e.g. if it is inline.
+      Current->Frame = std::max(Current->Frame, Frame);
+      Current->HasRecord = true;
+      for (StringRef Flag : makeArrayRef(Fields).drop_front(4)) {
+        if (Flag == "dynamic")
+          Current->Dynamic = true;
+        else if (Flag == "shadow-stack")
+          Current->ShadowStack = true;
+        else if (Flag == "interrupt")
+          Current->Interrupt = true;
+      }
+      continue;
+    }
+
+    if (!Current)
+      return makeParseError(FileName, Line.line_number(),
+                            "record outside of a function");
+    if (Kind == "unknown-indirect-call") {
+      Current->UnknownIndirectCall = true;
+    } else if ((Kind == "call" || Kind == "tail-call") && Fields.size() == 2) {
+      FunctionNode &Callee = getNode(Fields[1]);
+      Callee.Called = true;
+      if (Kind == "call")
+        Current->Calls.insert(&Callee);
+      else
+        Current->TailCalls.insert(&Callee);
+    } else {
+      return makeParseError(FileName, Line.line_number(),
+                            "unknown record '" + Kind + "'");
+    }
+  }
+  return Error::success();
+}
+
+uint64_t CallGraph::computeDepth(FunctionNode &N) {
+  if (N.State == FunctionNode::Done)
+    return N.Depth;
+  if (N.State == FunctionNode::Active) {
+    // Each trip around the cycle would add to the depth; count it once.
+    N.Recursive = true;
+    return 0;
+  }
+
+  N.State = FunctionNode::Active;
+  // The frame of the caller is still on the stack during a call, but has been
+  // popped at a tail call.
+  N.Depth = N.Frame;
+  for (FunctionNode *Callee : N.Calls) {
+    uint64_t Depth = N.Frame + computeDepth(*Callee);
+    if (Depth > N.Depth) {
+      N.Depth = Depth;
+      N.Next = Callee;
+    }
+  }
+  for (FunctionNode *Callee : N.TailCalls) {
+    uint64_t Depth = computeDepth(*Callee);
+    if (Depth > N.Depth) {
+      N.Depth = Depth;
+      N.Next = Callee;
+    }
+  }
+  N.State = FunctionNode::Done;
+  return N.Depth;
+}
+
+// Return the functions reachable from Entry, in depth-first order.
+static SetVector<FunctionNode *> getReachable(FunctionNode &Entry) {
+  SetVector<FunctionNode *> Reachable;
+  SmallVector<FunctionNode *, 16> Worklist{&Entry};
+  while (!Worklist.empty()) {
+    FunctionNode *N = Worklist.pop_back_val();
+    if (!Reachable.insert(N))
+      continue;
+    Worklist.append(N->TailCalls.rbegin(), N->TailCalls.rend());
+    Worklist.append(N->Calls.rbegin(), N->Calls.rend());
+  }
+  return Reachable;
+}
+
+// Print the report for one entry point, and return its depth.
+static uint64_t report(raw_ostream &OS, CallGraph &CG, FunctionNode &Entry,
+                       StringRef EntryKind) {
+  uint64_t Depth = CG.computeDepth(Entry);
+  OS << EntryKind << " " << Entry.Name << ": " << Depth << " bytes\n";
+
+  OS << "  path:";
+  SmallPtrSet<FunctionNode *, 16> OnPath;
+  for (FunctionNode *N = &Entry; N && OnPath.insert(N).second; N = N->Next)
+    OS << (N == &Entry ? " " : " -> ") << N->Name << " (" << N->Frame << ")";
+  OS << "\n";
+
+  SetVector<FunctionNode *> Reachable = getReachable(Entry);
+  // The shadow stack mirrors the stack at a fixed offset, so it needs as much
+  // space as the stack does.
+  if (any_of(Reachable, [](FunctionNode *N) { return N->ShadowStack; }))
+    OS << "  shadow stack: " << Depth << " bytes\n";
+
+  for (FunctionNode *N : Reachable) {
+    if (!N->HasRecord)
+      OS << "  warning: no stack usage for " << N->Name << "\n";
+    if (N->Recursive)
+      OS << "  warning: recursion through " << N->Name << "\n";
+    if (N->UnknownIndirectCall)
+      OS << "  warning: unknown indirect call in " << N->Name << "\n";
+    if (N->Dynamic)
+      OS << "  warning: dynamic stack allocation in " << N->Name << "\n";
+  }
+  return Depth;
+}
+
+int main(int argc, char **argv) {
+  InitLLVM X(argc, argv);
+
+  cl::ParseCommandLineOptions(argc, argv, "LLVM stack depth analyzer\n");
+
+  CallGraph CG;
+  for (const auto &File : InputFileNames) {
+    ErrorOr<std::unique_ptr<MemoryBuffer>> Buffer =
+        MemoryBuffer::getFileOrSTDIN(File);
+    if (std::error_code EC = Buffer.getError()) {
+      WithColor::error() << File << ": " << EC.message() << "\n";
+      return EXIT_FAILURE;
+    }
+    if (Error E = CG.read(File, *Buffer.get())) {
+      logAllUnhandledErrors(std::move(E), WithColor::error());
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Without explicit entry points, report on each function that is not called
+  // by another one, and on each interrupt handler.
+  std::vector<std::pair<FunctionNode *, StringRef>> Roots;
+  for (const auto &Name : Entries)
+    Roots.emplace_back(&CG.getNode(Name), "entry");
+  for (const auto &Name : Tasks)
+    Roots.emplace_back(&CG.getNode(Name), "task");
+  if (Roots.empty())
+    for (FunctionNode *N : CG.functions())
+      if (N->HasRecord && (N->Interrupt || !N->Called))
+        Roots.emplace_back(N, N->Interrupt ? "interrupt" : "entry");
+
+  bool OverLimit = false;
+  for (auto &Root : Roots) {
+    uint64_t Depth = report(outs(), CG, *Root.first, Root.second);
+    if (Limit && Depth > Limit) {
+      WithColor::error() << Root.first->Name << " needs " << Depth
+                         << " bytes of stack, over the limit of " << Limit
+                         << "\n";
+      OverLimit = true;
+    }
+  }
+
+  return OverLimit ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -14,6 +14,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/DebugInfo/Symbolize/DIPrinter.h"
 #include "llvm/DebugInfo/Symbolize/Symbolize.h"
@@ -22,11 +23,17 @@
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/LineIterator.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
 #include <string>
+#include <tuple>
 
 using namespace llvm;
 using namespace symbolize;
@@ -154,14 +161,25 @@ static cl::opt<DIPrinter::OutputStyle>
                              clEnumValN(DIPrinter::OutputStyle::GNU, "GNU",
                                         "GNU addr2line style")));
 
+static cl::opt<std::string>
+    ClBatchFile("batch", cl::init(""), cl::value_desc("filename"),
+                cl::desc("Symbolize the input lines in <filename> ('-' for "
+                         "stdin) as one batch"));
+
+static cl::opt<unsigned>
+    ClThreads("threads", cl::init(0), cl::value_desc("N"),
+              cl::desc("Number of threads used to symbolize different "
+                       "modules of a -batch file (0 = one per hardware "
+                       "thread)"));
+
 static cl::extrahelp
     HelpResponse("\nPass @FILE as argument to read options from FILE.\n");
 
 template<typename T>
-static bool error(Expected<T> &ResOrErr) {
+static bool error(Expected<T> &ResOrErr, raw_ostream &ErrOS = errs()) {
   if (ResOrErr)
     return false;
-  logAllUnhandledErrors(ResOrErr.takeError(), errs(),
+  logAllUnhandledErrors(ResOrErr.takeError(), ErrOS,
                         "LLVMSymbolizer: error reading file: ");
   return true;
 }
@@ -212,57 +230,235 @@ static bool parseCommand(StringRef InputString, Command &Cmd,
   return !StringRef(pos, offset_length).getAsInteger(0, ModuleOffset);
 }
 
-static void symbolizeInput(StringRef InputString, LLVMSymbolizer &Symbolizer,
-                           DIPrinter &Printer) {
-  Command Cmd;
-  std::string ModuleName;
-  uint64_t Offset = 0;
-  if (!parseCommand(StringRef(InputString), Cmd, ModuleName, Offset)) {
-    outs() << InputString;
-    return;
-  }
+/// Prints the inlined frames of a code address, or only the innermost one in
+/// GNU style without -inlining.
+static void printInlinedCode(Expected<DIInliningInfo> ResOrErr,
+                             DIPrinter &Printer, raw_ostream &ErrOS) {
+  if (ClPrintInlining)
+    Printer << (error(ResOrErr, ErrOS) ? DIInliningInfo() : ResOrErr.get());
+  else
+    Printer << (error(ResOrErr, ErrOS) ? DILineInfo()
+                                       : ResOrErr.get().getFrame(0));
+}
 
-  if (ClPrintAddress) {
-    outs() << "0x";
-    outs().write_hex(Offset);
-    StringRef Delimiter = ClPrettyPrint ? ": " : "\n";
-    outs() << Delimiter;
-  }
-  Offset -= ClAdjustVMA;
+static void symbolizeAddress(Command Cmd, const std::string &ModuleName,
+                             uint64_t Offset, LLVMSymbolizer &Symbolizer,
+                             DIPrinter &Printer, raw_ostream &OS,
+                             raw_ostream &ErrOS) {
   if (Cmd == Command::Data) {
     auto ResOrErr = Symbolizer.symbolizeData(
         ModuleName, {Offset, object::SectionedAddress::UndefSection});
-    Printer << (error(ResOrErr) ? DIGlobal() : ResOrErr.get());
+    Printer << (error(ResOrErr, ErrOS) ? DIGlobal() : ResOrErr.get());
   } else if (Cmd == Command::Frame) {
     auto ResOrErr = Symbolizer.symbolizeFrame(
         ModuleName, {Offset, object::SectionedAddress::UndefSection});
-    if (!error(ResOrErr)) {
+    if (!error(ResOrErr, ErrOS)) {
       for (DILocal Local : *ResOrErr)
         Printer << Local;
       if (ResOrErr->empty())
-        outs() << "??\n";
+        OS << "??\n";
     }
-  } else if (ClPrintInlining) {
-    auto ResOrErr = Symbolizer.symbolizeInlinedCode(
-        ModuleName, {Offset, object::SectionedAddress::UndefSection});
-    Printer << (error(ResOrErr) ? DIInliningInfo() : ResOrErr.get());
-  } else if (ClOutputStyle == DIPrinter::OutputStyle::GNU) {
+  } else if (ClPrintInlining ||
+             ClOutputStyle == DIPrinter::OutputStyle::GNU) {
     // With ClPrintFunctions == FunctionNameKind::LinkageName (default)
     // and ClUseSymbolTable == true (also default), Symbolizer.symbolizeCode()
     // may override the name of an inlined function with the name of the topmost
     // caller function in the inlining chain. This contradicts the existing
     // behavior of addr2line. Symbolizer.symbolizeInlinedCode() overrides only
     // the topmost function, which suits our needs better.
-    auto ResOrErr = Symbolizer.symbolizeInlinedCode(
-        ModuleName, {Offset, object::SectionedAddress::UndefSection});
-    Printer << (error(ResOrErr) ? DILineInfo() : ResOrErr.get().getFrame(0));
+    printInlinedCode(Symbolizer.symbolizeInlinedCode(
+                         ModuleName,
+                         {Offset, object::SectionedAddress::UndefSection}),
+                     Printer, ErrOS);
   } else {
     auto ResOrErr = Symbolizer.symbolizeCode(
         ModuleName, {Offset, object::SectionedAddress::UndefSection});
-    Printer << (error(ResOrErr) ? DILineInfo() : ResOrErr.get());
+    Printer << (error(ResOrErr, ErrOS) ? DILineInfo() : ResOrErr.get());
   }
   if (ClOutputStyle == DIPrinter::OutputStyle::LLVM)
-    outs() << "\n";
+    OS << "\n";
+}
+
+static void printAddress(uint64_t Offset) {
+  if (ClPrintAddress) {
+    outs() << "0x";
+    outs().write_hex(Offset);
+    StringRef Delimiter = ClPrettyPrint ? ": " : "\n";
+    outs() << Delimiter;
+  }
+}
+
+static DIPrinter createPrinter(raw_ostream &OS) {
+  return DIPrinter(OS, ClPrintFunctions != FunctionNameKind::None,
+                   ClPrettyPrint, ClPrintSourceContextLines, ClVerbose,
+                   ClBasenames, ClOutputStyle);
+}
+
+static void symbolizeInput(StringRef InputString, LLVMSymbolizer &Symbolizer,
+                           DIPrinter &Printer) {
+  Command Cmd;
+  std::string ModuleName;
+  uint64_t Offset = 0;
+  if (!parseCommand(StringRef(InputString), Cmd, ModuleName, Offset)) {
+    outs() << InputString;
+    return;
+  }
+
+  printAddress(Offset);
+  Offset -= ClAdjustVMA;
+  symbolizeAddress(Cmd, ModuleName, Offset, Symbolizer, Printer, outs(),
+                   errs());
+}
+
+namespace {
+/// A distinct query of a batch: the command and the (adjusted) offset in a
+/// module, and what symbolizing it printed.
+struct BatchQuery {
+  uint64_t Offset;
+  Command Cmd;
+  std::string Output;
+  std::string Errors;
+
+  bool operator<(const BatchQuery &RHS) const {
+    return std::tie(Offset, Cmd) < std::tie(RHS.Offset, RHS.Cmd);
+  }
+  bool operator==(const BatchQuery &RHS) const {
+    return Offset == RHS.Offset && Cmd == RHS.Cmd;
+  }
+};
+
+/// All queries of a batch that refer to one module.
+struct BatchModule {
+  std::string Name;
+  std::vector<BatchQuery> Queries;
+};
+
+/// An input line of a batch.  Lines that do not parse are echoed.
+struct BatchLine {
+  std::string Text;
+  bool Parsed;
+  uint64_t Address;
+  unsigned Module;
+  BatchQuery Key;
+};
+} // end anonymous namespace
+
+/// Symbolizes the queries of one module with a symbolizer of its own.  When
+/// code addresses are printed with their inlined frames, they are symbolized
+/// together, so that the debug info is walked once in address order.
+static void symbolizeBatchModule(BatchModule &Module,
+                                 const LLVMSymbolizer::Options &Opts) {
+  llvm::sys::InitializeCOMRAII COM(llvm::sys::COMThreadingMode::MultiThreaded);
+  LLVMSymbolizer Symbolizer(Opts);
+
+  bool BatchCode =
+      ClPrintInlining || ClOutputStyle == DIPrinter::OutputStyle::GNU;
+  std::vector<object::SectionedAddress> CodeOffsets;
+  if (BatchCode)
+    for (const BatchQuery &Query : Module.Queries)
+      if (Query.Cmd == Command::Code)
+        CodeOffsets.push_back(
+            {Query.Offset, object::SectionedAddress::UndefSection});
+  std::vector<DIInliningInfo> Code;
+  size_t NextCode = 0;
+
+  for (BatchQuery &Query : Module.Queries) {
+    raw_string_ostream OS(Query.Output);
+    raw_string_ostream ErrOS(Query.Errors);
+    DIPrinter Printer = createPrinter(OS);
+    if (!BatchCode || Query.Cmd != Command::Code) {
+      symbolizeAddress(Query.Cmd, Module.Name, Query.Offset, Symbolizer,
+                       Printer, OS, ErrOS);
+      continue;
+    }
+
+    // Symbolize the code addresses at the first of them, so that a module
+    // that cannot be loaded is reported by the same query as it would be
+    // with separate lookups. The later queries then find nothing, too.
+    if (NextCode == 0) {
+      auto ResOrErr = Symbolizer.symbolizeInlinedCode(Module.Name, CodeOffsets);
+      if (ResOrErr) {
+        Code = std::move(*ResOrErr);
+      } else {
+        Code.resize(CodeOffsets.size());
+        printInlinedCode(ResOrErr.takeError(), Printer, ErrOS);
+        ++NextCode;
+        if (ClOutputStyle == DIPrinter::OutputStyle::LLVM)
+          OS << "\n";
+        continue;
+      }
+    }
+    printInlinedCode(std::move(Code[NextCode++]), Printer, ErrOS);
+    if (ClOutputStyle == DIPrinter::OutputStyle::LLVM)
+      OS << "\n";
+  }
+}
+
+/// Symbolizes the lines of a batch file and prints the results in input
+/// order.  The queries of a module are sorted and deduplicated, so that every
+/// distinct query is symbolized once and code addresses can be looked up in a
+/// single pass over the debug info, and different modules are symbolized on
+/// different threads.
+static bool symbolizeBatch(StringRef Filename,
+                           const LLVMSymbolizer::Options &Opts) {
+  ErrorOr<std::unique_ptr<MemoryBuffer>> BufOrErr =
+      MemoryBuffer::getFileOrSTDIN(Filename);
+  if (!BufOrErr) {
+    errs() << "llvm-symbolizer: error reading " << Filename << ": "
+           << BufOrErr.getError().message() << "\n";
+    return false;
+  }
+
+  std::vector<BatchLine> Lines;
+  std::vector<BatchModule> Modules;
+  StringMap<unsigned> ModuleIndex;
+  for (line_iterator I(**BufOrErr, /*SkipBlanks=*/false), E; I != E; ++I) {
+    BatchLine Line;
+    Line.Text = *I;
+    std::string ModuleName;
+    Line.Parsed =
+        parseCommand(Line.Text, Line.Key.Cmd, ModuleName, Line.Address);
+    if (Line.Parsed) {
+      auto Ins = ModuleIndex.insert({ModuleName, Modules.size()});
+      if (Ins.second)
+        Modules.push_back({ModuleName, {}});
+      Line.Module = Ins.first->second;
+      Line.Key.Offset = Line.Address - ClAdjustVMA;
+      Modules[Line.Module].Queries.push_back(Line.Key);
+    }
+    Lines.push_back(std::move(Line));
+  }
+
+  for (BatchModule &Module : Modules) {
+    std::vector<BatchQuery> &Queries = Module.Queries;
+    llvm::sort(Queries);
+    Queries.erase(std::unique(Queries.begin(), Queries.end()), Queries.end());
+  }
+
+  {
+    unsigned NumThreads = ClThreads ? ClThreads : hardware_concurrency();
+    NumThreads = std::min<size_t>(NumThreads, Modules.size());
+    ThreadPool Pool(std::max(NumThreads, 1U));
+    for (BatchModule &Module : Modules)
+      Pool.async(symbolizeBatchModule, std::ref(Module), std::cref(Opts));
+    Pool.wait();
+  }
+
+  for (const BatchLine &Line : Lines) {
+    if (!Line.Parsed) {
+      outs() << Line.Text << '\n';
+      continue;
+    }
+    std::vector<BatchQuery> &Queries = Modules[Line.Module].Queries;
+    auto Query = std::lower_bound(Queries.begin(), Queries.end(), Line.Key);
+    assert(Query != Queries.end() && *Query == Line.Key);
+    printAddress(Line.Address);
+    // Report the errors of a query only once.
+    errs() << Query->Errors;
+    Query->Errors.clear();
+    outs() << Query->Output;
+  }
+  return true;
 }
 
 int main(int argc, char **argv) {
@@ -304,9 +500,10 @@ int main(int argc, char **argv) {
   }
   LLVMSymbolizer Symbolizer(Opts);
 
-  DIPrinter Printer(outs(), ClPrintFunctions != FunctionNameKind::None,
-                    ClPrettyPrint, ClPrintSourceContextLines, ClVerbose,
-                    ClBasenames, ClOutputStyle);
+  if (!ClBatchFile.empty())
+    return symbolizeBatch(ClBatchFile, Opts) ? 0 : 1;
+
+  DIPrinter Printer = createPrinter(outs());
 
   if (ClInputAddresses.empty()) {
     const int kMaxInputStringLength = 1024;
@@ -9,6 +9,8 @@
 #include "llvm/ProfileData/SampleProf.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/IR/DiagnosticInfo.h"
+#include "llvm/IR/DiagnosticPrinter.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Metadata.h"
 #include "llvm/IR/Module.h"
@@ -57,11 +59,14 @@ struct SampleProfTest : ::testing::Test {
     Reader->collectFuncsToUse(M);
   }
 
-  void testRoundTrip(SampleProfileFormat Format, bool Remap) {
+  void testRoundTrip(SampleProfileFormat Format, bool Remap,
+                     bool UseFuncOffsetTable = false) {
     SmallVector<char, 128> ProfilePath;
     ASSERT_TRUE(NoError(llvm::sys::fs::createTemporaryFile("profile", "", ProfilePath)));
     StringRef Profile(ProfilePath.data(), ProfilePath.size());
     createWriter(Format, Profile);
+    if (UseFuncOffsetTable)
+      Writer->setUseFuncOffsetTable();
 
     StringRef FooName("_Z3fooi");
     FunctionSamples FooSamples;
@@ -123,7 +128,11 @@ struct SampleProfTest : ::testing::Test {
       ASSERT_TRUE(NoError(EC));
     }
 
-    ASSERT_EQ(2u, Reader->getProfiles().size());
+    // Profiles with a function offset table are decoded on first use.
+    bool OnDemand =
+        !Remap && (Format == SampleProfileFormat::SPF_Compact_Binary ||
+                   UseFuncOffsetTable);
+    ASSERT_EQ(OnDemand ? 0u : 2u, Reader->getProfiles().size());
 
     FunctionSamples *ReadFooSamples = Reader->getSamplesFor(FooName);
     ASSERT_TRUE(ReadFooSamples != nullptr);
@@ -152,6 +161,7 @@ struct SampleProfTest : ::testing::Test {
         getRepInFormat(StringviewName, Format, StringviewGUID);
     ASSERT_EQ(1000u, CTMap.get()[MconstructRep]);
     ASSERT_EQ(437u, CTMap.get()[StringviewRep]);
+    ASSERT_EQ(2u, Reader->getProfiles().size());
 
     auto VerifySummary = [](ProfileSummary &Summary) mutable {
       ASSERT_EQ(ProfileSummary::PSK_Sample, Summary.getKind());
@@ -281,6 +291,65 @@ TEST_F(SampleProfTest, roundtrip_raw_binary_profile) {
   testRoundTrip(SampleProfileFormat::SPF_Binary, false);
 }
 
+TEST_F(SampleProfTest, roundtrip_raw_binary_profile_with_offset_table) {
+  testRoundTrip(SampleProfileFormat::SPF_Binary, false, true);
+}
+
+TEST_F(SampleProfTest, offset_table_decode_error) {
+  SmallVector<char, 128> ProfilePath;
+  ASSERT_TRUE(NoError(
+      llvm::sys::fs::createTemporaryFile("profile", "", ProfilePath)));
+  StringRef Profile(ProfilePath.data(), ProfilePath.size());
+  createWriter(SampleProfileFormat::SPF_Binary, Profile);
+  Writer->setUseFuncOffsetTable();
+
+  StringMap<FunctionSamples> Profiles;
+  FunctionSamples &FooSamples = Profiles["foo"];
+  FooSamples.setName("foo");
+  FooSamples.addHeadSamples(0x55);
+  FooSamples.addTotalSamples(0x66);
+  ASSERT_TRUE(NoError(Writer->write(Profiles)));
+  Writer->getOutputStream().flush();
+
+  // Point the name of foo's record past the end of the name table. The
+  // record is only decoded once getSamplesFor asks for it.
+  auto BufferOrErr = MemoryBuffer::getFile(Profile);
+  ASSERT_TRUE(NoError(BufferOrErr.getError()));
+  std::string Bytes = (*BufferOrErr)->getBuffer().str();
+  size_t Record = Bytes.find(StringRef("\x55\x00\x66\x00\x00", 5));
+  ASSERT_NE(std::string::npos, Record);
+  Bytes[Record + 1] = 0x7f;
+  {
+    std::error_code EC;
+    raw_fd_ostream OS(Profile, EC, sys::fs::F_None);
+    ASSERT_TRUE(NoError(EC));
+    OS << Bytes;
+  }
+
+  std::vector<std::string> Diags;
+  Context.setDiagnosticHandlerCallBack(
+      [](const DiagnosticInfo &DI, void *Context) {
+        std::string Msg;
+        raw_string_ostream OS(Msg);
+        DiagnosticPrinterRawOStream DP(OS);
+        DI.print(DP);
+        static_cast<std::vector<std::string> *>(Context)->push_back(OS.str());
+      },
+      &Diags);
+
+  Module M("my_module", Context);
+  M.getOrInsertFunction("foo",
+                        FunctionType::get(Type::getVoidTy(Context), {}, false));
+  readProfile(M, Profile);
+  ASSERT_TRUE(NoError(Reader->read()));
+
+  ASSERT_EQ(nullptr, Reader->getSamplesFor("foo"));
+  ASSERT_EQ(0u, Reader->getProfiles().size());
+  ASSERT_EQ(1u, Diags.size());
+  ASSERT_NE(std::string::npos,
+            Diags[0].find("could not decode the profile of foo"));
+}
+
 TEST_F(SampleProfTest, roundtrip_compact_binary_profile) {
   testRoundTrip(SampleProfileFormat::SPF_Compact_Binary, false);
 }
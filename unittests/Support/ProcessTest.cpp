@@ -8,6 +8,7 @@
 
 #include "llvm/Support/Process.h"
 #include "gtest/gtest.h"
+#include <vector>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -25,6 +26,16 @@ TEST(ProcessTest, GetRandomNumberTest) {
   EXPECT_NE((r1 | r2), 0u);
 }
 
+TEST(ProcessTest, GetPeakResidentSetSize) {
+  size_t Before = Process::GetPeakResidentSetSize();
+  std::vector<char> Buffer(1 << 20, 1);
+  size_t After = Process::GetPeakResidentSetSize();
+  // The peak can only grow, and 0 means it is not supported.
+  if (Before != 0)
+    EXPECT_GE(After, Before);
+  EXPECT_EQ(Buffer[0], 1);
+}
+
 #ifdef _MSC_VER
 #define setenv(name, var, ignore) _putenv_s(name, var)
 #endif